@@ -158,12 +158,16 @@ int LNetMDUnlink(struct lnet_handle_md md_in);
  * releases these resources and free the EQ. LNetEQGet() retrieves the next
  * event from an EQ, and LNetEQWait() can be used to block a process until
  * an EQ has at least one event. LNetEQPoll() can be used to test or wait
- * on multiple EQs.
+ * on multiple EQs. LNetEQAllocBatch() creates a handler-only EQ whose
+ * handler is given the events that complete together as one vector.
  * @{ */
 int LNetEQAlloc(unsigned int	   count_in,
 		lnet_eq_handler_t  handler,
 		struct lnet_handle_eq *handle_out);
 
+int LNetEQAllocBatch(lnet_eq_batch_handler_t handler,
+		     struct lnet_handle_eq *handle_out);
+
 int LNetEQFree(struct lnet_handle_eq eventq_in);
 
 int LNetEQGet(struct lnet_handle_eq eventq_in,
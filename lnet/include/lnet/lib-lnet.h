@@ -186,9 +186,13 @@ lnet_net_lock_current(void)
 #define MAX_PORTALS	64
 
 #define LNET_SMALL_MD_SIZE   offsetof(struct lnet_libmd, md_iov.iov[1])
+#define LNET_LARGE_MD_SIZE   offsetof(struct lnet_libmd, md_iov.kiov[LNET_MAX_IOV])
 extern struct kmem_cache *lnet_mes_cachep;	 /* MEs kmem_cache */
 extern struct kmem_cache *lnet_small_mds_cachep; /* <= LNET_SMALL_MD_SIZE bytes
 						  * MDs kmem_cache */
+extern struct kmem_cache *lnet_large_mds_cachep; /* <= LNET_LARGE_MD_SIZE bytes
+						  * MDs kmem_cache */
+extern struct kmem_cache *lnet_msgs_cachep;	 /* messages kmem_cache */
 
 static inline struct lnet_eq *
 lnet_eq_alloc (void)
@@ -232,6 +236,19 @@ lnet_md_alloc(struct lnet_md *umd)
 			       size);
 			return NULL;
 		}
+	} else if (size <= LNET_LARGE_MD_SIZE) {
+		/* bulk MDs: the fragments are all copied in by
+		 * lnet_md_build(), only the descriptor needs clearing */
+		md = kmem_cache_alloc(lnet_large_mds_cachep, GFP_NOFS);
+		if (md) {
+			memset(md, 0, offsetof(struct lnet_libmd, md_iov));
+			CDEBUG(D_MALLOC, "slab-alloced 'md' of size %u at "
+			       "%p.\n", size, md);
+		} else {
+			CDEBUG(D_MALLOC, "failed to allocate 'md' of size %u\n",
+			       size);
+			return NULL;
+		}
 	} else {
 		LIBCFS_ALLOC(md, size);
 	}
@@ -259,6 +276,9 @@ lnet_md_free(struct lnet_libmd *md)
 	if (size <= LNET_SMALL_MD_SIZE) {
 		CDEBUG(D_MALLOC, "slab-freed 'md' at %p.\n", md);
 		kmem_cache_free(lnet_small_mds_cachep, md);
+	} else if (size <= LNET_LARGE_MD_SIZE) {
+		CDEBUG(D_MALLOC, "slab-freed 'md' at %p.\n", md);
+		kmem_cache_free(lnet_large_mds_cachep, md);
 	} else {
 		LIBCFS_FREE(md, size);
 	}
@@ -477,17 +497,21 @@ lnet_msg_alloc(void)
 {
 	struct lnet_msg *msg;
 
-	LIBCFS_ALLOC(msg, sizeof(*msg));
+	msg = kmem_cache_alloc(lnet_msgs_cachep, GFP_NOFS | __GFP_ZERO);
+	if (msg)
+		CDEBUG(D_MALLOC, "slab-alloced 'msg' at %p.\n", msg);
+	else
+		CDEBUG(D_MALLOC, "failed to allocate 'msg'\n");
 
-	/* no need to zero, LIBCFS_ALLOC does for us */
-	return (msg);
+	return msg;
 }
 
 static inline void
 lnet_msg_free(struct lnet_msg *msg)
 {
 	LASSERT(!msg->msg_onactivelist);
-	LIBCFS_FREE(msg, sizeof(*msg));
+	CDEBUG(D_MALLOC, "slab-freed 'msg' at %p.\n", msg);
+	kmem_cache_free(lnet_msgs_cachep, msg);
 }
 
 static inline struct lnet_rsp_tracker *
@@ -538,6 +562,8 @@ lnet_net2rnethash(__u32 net)
 }
 
 extern struct lnet_lnd the_lolnd;
+extern atomic64_t lolnd_copy_bytes;
+extern atomic64_t lolnd_zero_copy_bytes;
 extern int avoid_asym_router_failure;
 
 extern unsigned int lnet_nid_cpt_hash(lnet_nid_t nid, unsigned int number);
@@ -555,6 +581,7 @@ void lnet_lib_exit(void);
 extern unsigned lnet_transaction_timeout;
 extern unsigned lnet_retry_count;
 extern unsigned int lnet_numa_range;
+extern unsigned int lnet_perf_select;
 extern unsigned int lnet_health_sensitivity;
 extern unsigned int lnet_recovery_interval;
 extern unsigned int lnet_peer_discovery_disabled;
@@ -571,7 +598,8 @@ int lnet_del_route(__u32 net, lnet_nid_t gw_nid);
 void lnet_destroy_routes(void);
 int lnet_get_route(int idx, __u32 *net, __u32 *hops,
 		   lnet_nid_t *gateway, __u32 *alive, __u32 *priority);
-int lnet_get_rtr_pool_cfg(int idx, struct lnet_ioctl_pool_cfg *pool_cfg);
+int lnet_get_rtr_pool_cfg(int idx, struct lnet_ioctl_pool_cfg *pool_cfg,
+			  struct lnet_ioctl_pool_wait_hist *wait_hist);
 struct lnet_ni *lnet_get_next_ni_locked(struct lnet_net *mynet,
 					struct lnet_ni *prev);
 struct lnet_ni *lnet_get_ni_idx_locked(int idx);
@@ -588,6 +616,7 @@ void lnet_router_debugfs_fini(void);
 int  lnet_rtrpools_alloc(int im_a_router);
 void lnet_destroy_rtrbuf(struct lnet_rtrbuf *rb, int npages);
 int  lnet_rtrpools_adjust(int tiny, int small, int large);
+void lnet_rtrpools_autosize(void);
 int lnet_rtrpools_enable(void);
 void lnet_rtrpools_disable(void);
 void lnet_rtrpools_free(int keep_pools);
@@ -611,6 +640,10 @@ void lnet_msg_commit(struct lnet_msg *msg, int cpt);
 void lnet_msg_decommit(struct lnet_msg *msg, int cpt, int status);
 
 void lnet_eq_enqueue_event(struct lnet_eq *eq, struct lnet_event *ev);
+void lnet_eq_batch_flush_locked(int cpt);
+void lnet_eq_batch_flush(void);
+int lnet_eq_batches_create(void);
+void lnet_eq_batches_destroy(void);
 void lnet_prep_send(struct lnet_msg *msg, int type,
 		    struct lnet_process_id target, unsigned int offset,
 		    unsigned int len);
@@ -692,6 +725,7 @@ struct lnet_msg *lnet_create_reply_msg(struct lnet_ni *ni,
 void lnet_set_reply_msg_len(struct lnet_ni *ni, struct lnet_msg *msg,
 			    unsigned int len);
 void lnet_detach_rsp_tracker(struct lnet_libmd *md, int cpt);
+void lnet_perf_update(struct lnet_msg *msg);
 
 void lnet_finalize(struct lnet_msg *msg, int rc);
 bool lnet_send_error_simulation(struct lnet_msg *msg,
@@ -841,6 +875,7 @@ int lnet_sock_connect(struct socket **sockp, int *fatal,
 			__u32 peer_ip, int peer_port);
 
 int lnet_peers_start_down(void);
+int lnet_router_forward_empty(struct lnet_msg *msg);
 int lnet_peer_buffer_credits(struct lnet_net *net);
 
 int lnet_monitor_thr_start(void);
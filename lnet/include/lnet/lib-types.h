@@ -120,6 +120,10 @@ struct lnet_msg {
 	enum lnet_msg_hstatus	msg_health_status;
 	/* This is a recovery message */
 	bool			msg_recovery;
+	/* when the message was last handed to the LND for sending */
+	ktime_t			msg_send_time;
+	/* when the message started waiting for a router buffer */
+	ktime_t			msg_rtr_queued;
 	/* the number of times a transmission has been retried */
 	int			msg_retry_count;
 	/* flag to indicate that we do not want to resend this message */
@@ -150,6 +154,8 @@ struct lnet_msg {
 	unsigned int          msg_peertxcredit:1; /* taken a peer send credit */
 	unsigned int          msg_rtrcredit:1;    /* taken a globel router credit */
 	unsigned int          msg_peerrtrcredit:1; /* taken a peer router credit */
+	/* forwarded without router buffer, decided once on arrival */
+	unsigned int	      msg_rtr_nobuf:1;
 	unsigned int          msg_onactivelist:1; /* on the activelist */
 	unsigned int	      msg_rdma_get:1;
 
@@ -188,10 +194,27 @@ struct lnet_eq {
 	unsigned long		eq_deq_seq;
 	unsigned int		eq_size;
 	lnet_eq_handler_t	eq_callback;
+	/* handler for a vector of events, see LNetEQAllocBatch() */
+	lnet_eq_batch_handler_t	eq_batch_callback;
 	struct lnet_event	*eq_events;
 	int			**eq_refs;	/* percpt refcount for EQ */
 };
 
+/* max # events accumulated per CPT before they are handed over */
+#define LNET_EQ_BATCH_SIZE	32
+
+/*
+ * Events for batching EQs are held here, under lnet_res_lock of the CPT
+ * the MD belongs to, until the finalizer that produced them is done.
+ * Keeping a single FIFO per CPT preserves the per-MD event order, so the
+ * unlink event is still the last one a handler sees for an MD.
+ */
+struct lnet_eq_batch {
+	int			eb_nevents;
+	struct lnet_eq		*eb_eqs[LNET_EQ_BATCH_SIZE];
+	struct lnet_event	eb_events[LNET_EQ_BATCH_SIZE];
+};
+
 struct lnet_me {
 	struct list_head	me_list;
 	struct lnet_libhandle	me_lh;
@@ -366,6 +389,19 @@ struct lnet_health_local_stats {
 	atomic_t hlt_local_error;
 };
 
+/*
+ * Transmit performance measured from send completions. Updated without
+ * locking; an occasional lost sample only delays convergence.
+ */
+struct lnet_perf {
+	/* EWMA of the bandwidth of large sends, bytes/sec */
+	__u64	lpf_bw;
+	/* EWMA of the completion time of small sends, nsec */
+	__u64	lpf_lat;
+	/* predicted time at which all sends assigned so far complete */
+	__u64	lpf_busy;
+};
+
 struct lnet_health_remote_stats {
 	atomic_t hlt_remote_dropped;
 	atomic_t hlt_remote_timeout;
@@ -474,6 +510,7 @@ struct lnet_ni {
 	/* NI statistics */
 	struct lnet_element_stats ni_stats;
 	struct lnet_health_local_stats ni_hstats;
+	struct lnet_perf	ni_perf;
 
 	/* physical device CPT */
 	int			ni_dev_cpt;
@@ -557,10 +594,14 @@ struct lnet_peer_ni {
 	/* statistics kept on each peer NI */
 	struct lnet_element_stats lpni_stats;
 	struct lnet_health_remote_stats lpni_hstats;
-	/* spin lock protecting credits and lpni_txq / lpni_rtrq */
+	struct lnet_perf	lpni_perf;
+	/* spin lock protecting lpni_txq / lpni_txq_grants and the router
+	 * credits / lpni_rtrq */
 	spinlock_t		lpni_lock;
-	/* # tx credits available */
-	int			lpni_txcredits;
+	/* # tx credits available, only waiters need lpni_lock */
+	atomic_t		lpni_txcredits;
+	/* credits returned while their waiter wasn't on lpni_txq yet */
+	int			lpni_txq_grants;
 	/* low water mark */
 	int			lpni_mintxcredits;
 	/* # router credits */
@@ -568,7 +609,7 @@ struct lnet_peer_ni {
 	/* low water mark */
 	int			lpni_minrtrcredits;
 	/* bytes queued for sending */
-	long			lpni_txqnob;
+	atomic_long_t		lpni_txqnob;
 	/* alive/dead? */
 	bool			lpni_alive;
 	/* notification outstanding? */
@@ -853,6 +894,14 @@ struct lnet_rtrbufpool {
 	int			rbp_credits;
 	/* low water mark */
 	int			rbp_mincredits;
+	/* configured # buffers, automatic sizing grows from here */
+	int			rbp_base_nbuffers;
+	/* low water mark since the last automatic sizing pass */
+	int			rbp_auto_mincredits;
+	/* longest buffer wait since the last automatic sizing pass, usec */
+	__u32			rbp_auto_maxwait;
+	/* # buffers handed out, by how long the message waited */
+	__u32			rbp_wait_hist[LNET_RTRPOOL_WAIT_BUCKETS];
 };
 
 struct lnet_rtrbuf {
@@ -1009,6 +1058,8 @@ struct lnet {
 	struct lnet_res_container	ln_eq_container;
 	wait_queue_head_t		ln_eq_waitq;
 	spinlock_t			ln_eq_wait_lock;
+	/* percpt events pending for batching EQs */
+	struct lnet_eq_batch		**ln_eq_batches;
 
 	unsigned int			ln_remote_nets_hbits;
 
@@ -115,6 +115,17 @@ struct lnet_ioctl_pool_cfg {
 	__u32 pl_routing;
 };
 
+/* router buffer waits: none, < 16us, < 64us, ... < 16ms, longer */
+#define LNET_RTRPOOL_WAIT_BUCKETS	8
+
+/*
+ * IOC_LIBCFS_GET_BUF returns this after struct lnet_ioctl_pool_cfg in
+ * cfg_bulk when ioc_len leaves room for it.
+ */
+struct lnet_ioctl_pool_wait_hist {
+	__u32 pw_hist[LNET_NRBPOOLS][LNET_RTRPOOL_WAIT_BUCKETS];
+};
+
 struct lnet_ioctl_ping_data {
 	struct libcfs_ioctl_hdr ping_hdr;
 
@@ -199,6 +210,17 @@ struct lnet_ioctl_peer_ni_hstats {
 	__s32 hlpni_health_value;
 };
 
+/*
+ * Measured send performance of a local or peer NI. IOC_LIBCFS_GET_LOCAL_HSTATS
+ * returns it after struct lnet_ioctl_local_ni_hstats when ioc_len leaves room
+ * for it. IOC_LIBCFS_GET_PEER_NI returns one per peer NI after all the peer
+ * NI records in prcfg_bulk.
+ */
+struct lnet_ioctl_element_perf_stats {
+	__u32 iep_bandwidth;	/* KiB/s */
+	__u32 iep_latency;	/* usec */
+};
+
 struct lnet_ioctl_element_msg_stats {
 	struct libcfs_ioctl_hdr im_hdr;
 	__u32 im_idx;
@@ -496,6 +496,13 @@ struct lnet_md {
 	 *   struct iovec.
 	 * - LNET_MD_MAX_SIZE: The max_size field is valid.
 	 * - LNET_MD_BULK_HANDLE: The bulk_handle field is valid.
+	 * - LNET_MD_KIOV_SWAP: The pages of a LNET_MD_KIOV region belong to
+	 *   the MD only and the MD is used for one data transfer. When the
+	 *   peer MD is on the same node and has this option too, LNet may
+	 *   exchange the pages of both regions instead of copying the data,
+	 *   in the caller's array at start as well. After the transfer, the
+	 *   array of the sink refers to pages with the data, the array of the
+	 *   source to pages with undefined content.
 	 *
 	 * Note:
 	 * - LNET_MD_KIOV or LNET_MD_IOVEC allows for a scatter/gather
@@ -557,6 +564,8 @@ struct lnet_md {
 #define LNET_MD_KIOV		     (1 << 8)
 /** See struct lnet_md::options. */
 #define LNET_MD_BULK_HANDLE	     (1 << 9)
+/** See struct lnet_md::options. */
+#define LNET_MD_KIOV_SWAP	     (1 << 10)
 
 /* For compatibility with Cray Portals */
 #define LNET_MD_PHYS			     0
@@ -718,6 +727,16 @@ struct lnet_event {
  */
 typedef void (*lnet_eq_handler_t)(struct lnet_event *event);
 #define LNET_EQ_HANDLER_NONE NULL
+
+/**
+ * Batched event queue handler function type.
+ *
+ * Same rules as lnet_eq_handler_t, but the handler is given all the events
+ * that completed together, oldest first. Events for a given MD are always
+ * delivered in order, either within one vector or across calls.
+ */
+typedef void (*lnet_eq_batch_handler_t)(struct lnet_event **events,
+					int nevents);
 /** @} lnet_eq */
 
 /** \addtogroup lnet_data
@@ -39,9 +39,11 @@
 
 #define LST_FEAT_NONE		(0)
 #define LST_FEAT_BULK_LEN	(1 << 0)	/* enable variable page size */
+#define LST_FEAT_LAT_HIST	(1 << 1)	/* RPC latency histogram */
 
 #define LST_FEATS_EMPTY		(LST_FEAT_NONE)
-#define LST_FEATS_MASK		(LST_FEAT_NONE | LST_FEAT_BULK_LEN)
+#define LST_FEATS_MASK		(LST_FEAT_NONE | LST_FEAT_BULK_LEN | \
+				 LST_FEAT_LAT_HIST)
 
 #define LST_NAME_SIZE		32		/* max name buffer length */
 
@@ -64,6 +66,7 @@
 #define LSTIO_TEST_ADD		0xC26		/* add test (to batch) */
 #define LSTIO_BATCH_QUERY	0xC27		/* query batch status */
 #define LSTIO_STAT_QUERY	0xC30		/* get stats */
+#define LSTIO_LAT_QUERY		0xC31		/* get latency histogram */
 
 struct lst_sid {
 	lnet_nid_t	ses_nid;	/* nid of console node */
@@ -411,7 +414,7 @@ struct lstio_batch_info_args {
 	struct lstcon_node_ent __user *lstio_bat_dentsp;/* array of nodent */
 };
 
-/* add stat in session */
+/* add stat in session, also used by LSTIO_LAT_QUERY */
 struct lstio_stat_args {
 	/* IN: session key */
 	int			lstio_sta_key;
@@ -512,4 +515,15 @@ struct sfw_counters {
 	__u32 ping_errors;
 } WIRE_ATTR;
 
+/*
+ * Latency histogram of completed test RPCs, returned by LSTIO_LAT_QUERY
+ * as an array of LST_LAT_BUCKETS __u32 counters per node.  Latencies
+ * below (1 << LST_LAT_SUB_BITS) usec get a bucket each, every following
+ * power of two is split into (1 << LST_LAT_SUB_BITS) linear sub-buckets,
+ * so the relative error of a bucket is below 1 / (1 << LST_LAT_SUB_BITS).
+ * The last bucket also counts everything beyond it.
+ */
+#define LST_LAT_SUB_BITS	2
+#define LST_LAT_BUCKETS		112
+
 #endif
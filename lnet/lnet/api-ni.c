@@ -78,6 +78,11 @@ module_param(lnet_numa_range, uint, 0444);
 MODULE_PARM_DESC(lnet_numa_range,
 		"NUMA range to consider during Multi-Rail selection");
 
+unsigned int lnet_perf_select = 1;
+module_param(lnet_perf_select, uint, 0644);
+MODULE_PARM_DESC(lnet_perf_select,
+		"Weight Multi-Rail selection by measured bandwidth and latency");
+
 /*
  * lnet_health_sensitivity determines by how much we decrement the health
  * value on sending error. The value defaults to 0, which means health
@@ -504,6 +509,9 @@ lnet_fini_locks(void)
 struct kmem_cache *lnet_mes_cachep;	   /* MEs kmem_cache */
 struct kmem_cache *lnet_small_mds_cachep;  /* <= LNET_SMALL_MD_SIZE bytes
 					    *  MDs kmem_cache */
+struct kmem_cache *lnet_large_mds_cachep;  /* <= LNET_LARGE_MD_SIZE bytes
+					    *  MDs kmem_cache */
+struct kmem_cache *lnet_msgs_cachep;	   /* messages kmem_cache */
 
 static int
 lnet_descriptor_setup(void)
@@ -522,6 +530,22 @@ lnet_descriptor_setup(void)
 	if (!lnet_small_mds_cachep)
 		return -ENOMEM;
 
+	/* bulk MDs are too big for the small MD cache, and would otherwise
+	 * come from the next power-of-two kmalloc cache and be zeroed
+	 * entirely on every allocation */
+	lnet_large_mds_cachep = kmem_cache_create("lnet_large_MDs",
+						  LNET_LARGE_MD_SIZE, 0, 0,
+						  NULL);
+	if (!lnet_large_mds_cachep)
+		return -ENOMEM;
+
+	/* every PUT, GET, ACK and REPLY sent or received needs one */
+	lnet_msgs_cachep = kmem_cache_create("lnet_msgs",
+					     sizeof(struct lnet_msg), 0,
+					     SLAB_HWCACHE_ALIGN, NULL);
+	if (!lnet_msgs_cachep)
+		return -ENOMEM;
+
 	return 0;
 }
 
@@ -529,6 +553,16 @@ static void
 lnet_descriptor_cleanup(void)
 {
 
+	if (lnet_msgs_cachep) {
+		kmem_cache_destroy(lnet_msgs_cachep);
+		lnet_msgs_cachep = NULL;
+	}
+
+	if (lnet_large_mds_cachep) {
+		kmem_cache_destroy(lnet_large_mds_cachep);
+		lnet_large_mds_cachep = NULL;
+	}
+
 	if (lnet_small_mds_cachep) {
 		kmem_cache_destroy(lnet_small_mds_cachep);
 		lnet_small_mds_cachep = NULL;
@@ -1115,6 +1149,10 @@ lnet_prepare(lnet_pid_t requested_pid)
 	if (rc != 0)
 		goto failed;
 
+	rc = lnet_eq_batches_create();
+	if (rc != 0)
+		goto failed;
+
 	recs = lnet_res_containers_create(LNET_COOKIE_TYPE_ME);
 	if (recs == NULL) {
 		rc = -ENOMEM;
@@ -1170,6 +1208,7 @@ lnet_unprepare (void)
 		the_lnet.ln_me_containers = NULL;
 	}
 
+	lnet_eq_batches_destroy();
 	lnet_res_container_cleanup(&the_lnet.ln_eq_container);
 
 	lnet_msg_containers_destroy();
@@ -3356,7 +3395,8 @@ lnet_ni_set_healthv(lnet_nid_t nid, int value, bool all)
 }
 
 static int
-lnet_get_local_ni_hstats(struct lnet_ioctl_local_ni_hstats *stats)
+lnet_get_local_ni_hstats(struct lnet_ioctl_local_ni_hstats *stats,
+			 struct lnet_ioctl_element_perf_stats *perf)
 {
 	int cpt, rc = 0;
 	struct lnet_ni *ni;
@@ -3377,6 +3417,11 @@ lnet_get_local_ni_hstats(struct lnet_ioctl_local_ni_hstats *stats)
 	stats->hlni_local_timeout = atomic_read(&ni->ni_hstats.hlt_local_timeout);
 	stats->hlni_local_error = atomic_read(&ni->ni_hstats.hlt_local_error);
 	stats->hlni_health_value = atomic_read(&ni->ni_healthv);
+	if (perf != NULL) {
+		perf->iep_bandwidth = ni->ni_perf.lpf_bw >> 10;
+		perf->iep_latency = div_u64(ni->ni_perf.lpf_lat,
+					    NSEC_PER_USEC);
+	}
 
 unlock:
 	lnet_net_unlock(cpt);
@@ -3617,6 +3662,7 @@ LNetCtl(unsigned int cmd, void *arg)
 
 	case IOC_LIBCFS_GET_BUF: {
 		struct lnet_ioctl_pool_cfg *pool_cfg;
+		struct lnet_ioctl_pool_wait_hist *wait_hist = NULL;
 		size_t total = sizeof(*config) + sizeof(*pool_cfg);
 
 		config = arg;
@@ -3625,21 +3671,32 @@ LNetCtl(unsigned int cmd, void *arg)
 			return -EINVAL;
 
 		pool_cfg = (struct lnet_ioctl_pool_cfg *)config->cfg_bulk;
+		/* older tools only know about struct lnet_ioctl_pool_cfg */
+		if (config->cfg_hdr.ioc_len >= total + sizeof(*wait_hist))
+			wait_hist = (struct lnet_ioctl_pool_wait_hist *)
+				    (pool_cfg + 1);
 
 		mutex_lock(&the_lnet.ln_api_mutex);
-		rc = lnet_get_rtr_pool_cfg(config->cfg_count, pool_cfg);
+		rc = lnet_get_rtr_pool_cfg(config->cfg_count, pool_cfg,
+					   wait_hist);
 		mutex_unlock(&the_lnet.ln_api_mutex);
 		return rc;
 	}
 
 	case IOC_LIBCFS_GET_LOCAL_HSTATS: {
 		struct lnet_ioctl_local_ni_hstats *stats = arg;
+		struct lnet_ioctl_element_perf_stats *perf = NULL;
 
 		if (stats->hlni_hdr.ioc_len < sizeof(*stats))
 			return -EINVAL;
 
+		/* older tools only know about the health stats */
+		if (stats->hlni_hdr.ioc_len >= sizeof(*stats) + sizeof(*perf))
+			perf = (struct lnet_ioctl_element_perf_stats *)
+			       (stats + 1);
+
 		mutex_lock(&the_lnet.ln_api_mutex);
-		rc = lnet_get_local_ni_hstats(stats);
+		rc = lnet_get_local_ni_hstats(stats, perf);
 		mutex_unlock(&the_lnet.ln_api_mutex);
 
 		return rc;
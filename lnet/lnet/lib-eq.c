@@ -37,6 +37,67 @@
 #define DEBUG_SUBSYSTEM S_LNET
 #include <lnet/lib-lnet.h>
 
+static unsigned int lnet_event_batch = 1;
+module_param(lnet_event_batch, uint, 0644);
+MODULE_PARM_DESC(lnet_event_batch,
+		 "Hand events to batching EQ handlers in vectors (0 to disable)");
+
+static int
+lnet_eq_setup(unsigned int count, lnet_eq_handler_t callback,
+	      lnet_eq_batch_handler_t batch_callback,
+	      struct lnet_handle_eq *handle)
+{
+	struct lnet_eq *eq;
+
+	eq = lnet_eq_alloc();
+	if (eq == NULL)
+		return -ENOMEM;
+
+	if (count != 0) {
+		LIBCFS_ALLOC(eq->eq_events, count * sizeof(struct lnet_event));
+		if (eq->eq_events == NULL)
+			goto failed;
+		/* NB allocator has set all event sequence numbers to 0,
+		 * so all them should be earlier than eq_deq_seq */
+	}
+
+	eq->eq_deq_seq = 1;
+	eq->eq_enq_seq = 1;
+	eq->eq_size = count;
+	eq->eq_callback = callback;
+	eq->eq_batch_callback = batch_callback;
+
+	eq->eq_refs = cfs_percpt_alloc(lnet_cpt_table(),
+				       sizeof(*eq->eq_refs[0]));
+	if (eq->eq_refs == NULL)
+		goto failed;
+
+	/* MUST hold both exclusive lnet_res_lock */
+	lnet_res_lock(LNET_LOCK_EX);
+	/* NB: hold lnet_eq_wait_lock for EQ link/unlink, so we can do
+	 * both EQ lookup and poll event with only lnet_eq_wait_lock */
+	lnet_eq_wait_lock();
+
+	lnet_res_lh_initialize(&the_lnet.ln_eq_container, &eq->eq_lh);
+	list_add(&eq->eq_list, &the_lnet.ln_eq_container.rec_active);
+
+	lnet_eq_wait_unlock();
+	lnet_res_unlock(LNET_LOCK_EX);
+
+	lnet_eq2handle(handle, eq);
+	return 0;
+
+failed:
+	if (eq->eq_events != NULL)
+		LIBCFS_FREE(eq->eq_events, count * sizeof(struct lnet_event));
+
+	if (eq->eq_refs != NULL)
+		cfs_percpt_free(eq->eq_refs);
+
+	lnet_eq_free(eq);
+	return -ENOMEM;
+}
+
 /**
  * Create an event queue that has room for \a count number of events.
  *
@@ -66,8 +127,6 @@ int
 LNetEQAlloc(unsigned int count, lnet_eq_handler_t callback,
 	    struct lnet_handle_eq *handle)
 {
-	struct lnet_eq *eq;
-
 	LASSERT(the_lnet.ln_refcount > 0);
 
 	/* We need count to be a power of 2 so that when eq_{enq,deq}_seq
@@ -89,54 +148,39 @@ LNetEQAlloc(unsigned int count, lnet_eq_handler_t callback,
 	if (count == 0 && callback == LNET_EQ_HANDLER_NONE)
 		return -EINVAL;
 
-	eq = lnet_eq_alloc();
-	if (eq == NULL)
-		return -ENOMEM;
-
-	if (count != 0) {
-		LIBCFS_ALLOC(eq->eq_events, count * sizeof(struct lnet_event));
-		if (eq->eq_events == NULL)
-			goto failed;
-		/* NB allocator has set all event sequence numbers to 0,
-		 * so all them should be earlier than eq_deq_seq */
-	}
-
-	eq->eq_deq_seq = 1;
-	eq->eq_enq_seq = 1;
-	eq->eq_size = count;
-	eq->eq_callback = callback;
-
-	eq->eq_refs = cfs_percpt_alloc(lnet_cpt_table(),
-				       sizeof(*eq->eq_refs[0]));
-	if (eq->eq_refs == NULL)
-		goto failed;
-
-	/* MUST hold both exclusive lnet_res_lock */
-	lnet_res_lock(LNET_LOCK_EX);
-	/* NB: hold lnet_eq_wait_lock for EQ link/unlink, so we can do
-	 * both EQ lookup and poll event with only lnet_eq_wait_lock */
-	lnet_eq_wait_lock();
-
-	lnet_res_lh_initialize(&the_lnet.ln_eq_container, &eq->eq_lh);
-	list_add(&eq->eq_list, &the_lnet.ln_eq_container.rec_active);
-
-	lnet_eq_wait_unlock();
-	lnet_res_unlock(LNET_LOCK_EX);
-
-	lnet_eq2handle(handle, eq);
-	return 0;
+	return lnet_eq_setup(count, callback, NULL, handle);
+}
+EXPORT_SYMBOL(LNetEQAlloc);
 
-failed:
-	if (eq->eq_events != NULL)
-		LIBCFS_FREE(eq->eq_events, count * sizeof(struct lnet_event));
+/**
+ * Create a handler-only event queue whose handler takes a vector of events.
+ *
+ * Events of MDs attached to this EQ are not handed over one by one as the
+ * LNDs complete them: they are accumulated per CPT and passed to \a callback
+ * together once the finalizer which produced them runs out of work, or the
+ * batch fills up. The handler runs under the same constraints as an
+ * lnet_eq_handler_t.
+ *
+ * \param callback The handler run for each vector of events.
+ * \param handle On successful return, this location will hold a handle for
+ * the newly created EQ.
+ *
+ * \retval 0	   On success.
+ * \retval -EINVAL If \a callback is NULL.
+ * \retval -ENOMEM If memory for the EQ can't be allocated.
+ */
+int
+LNetEQAllocBatch(lnet_eq_batch_handler_t callback,
+		 struct lnet_handle_eq *handle)
+{
+	LASSERT(the_lnet.ln_refcount > 0);
 
-	if (eq->eq_refs != NULL)
-		cfs_percpt_free(eq->eq_refs);
+	if (callback == NULL)
+		return -EINVAL;
 
-	lnet_eq_free(eq);
-	return -ENOMEM;
+	return lnet_eq_setup(0, LNET_EQ_HANDLER_NONE, callback, handle);
 }
-EXPORT_SYMBOL(LNetEQAlloc);
+EXPORT_SYMBOL(LNetEQAllocBatch);
 
 /**
  * Release the resources associated with an event queue if it's idle;
@@ -162,6 +206,11 @@ LNetEQFree(struct lnet_handle_eq eqh)
 	LASSERT(the_lnet.ln_refcount > 0);
 
 	lnet_res_lock(LNET_LOCK_EX);
+	/* pending batched events may belong to this EQ even though no MD
+	 * references it any more, hand them over before it goes away */
+	for (i = 0; i < LNET_CPT_NUMBER; i++)
+		lnet_eq_batch_flush_locked(i);
+
 	/* NB: hold lnet_eq_wait_lock for EQ link/unlink, so we can do
 	 * both EQ lookup and poll event with only lnet_eq_wait_lock */
 	lnet_eq_wait_lock();
@@ -204,6 +253,90 @@ LNetEQFree(struct lnet_handle_eq eqh)
 }
 EXPORT_SYMBOL(LNetEQFree);
 
+int
+lnet_eq_batches_create(void)
+{
+	the_lnet.ln_eq_batches = cfs_percpt_alloc(lnet_cpt_table(),
+					sizeof(struct lnet_eq_batch));
+	return the_lnet.ln_eq_batches != NULL ? 0 : -ENOMEM;
+}
+
+void
+lnet_eq_batches_destroy(void)
+{
+	struct lnet_eq_batch *eb;
+	int i;
+
+	if (the_lnet.ln_eq_batches == NULL)
+		return;
+
+	cfs_percpt_for_each(eb, i, the_lnet.ln_eq_batches)
+		LASSERT(eb->eb_nevents == 0);
+
+	cfs_percpt_free(the_lnet.ln_eq_batches);
+	the_lnet.ln_eq_batches = NULL;
+}
+
+/* hand all pending events of \a cpt over, in order, one vector per run of
+ * events belonging to the same EQ. MUST be called with lnet_res_lock(cpt) */
+void
+lnet_eq_batch_flush_locked(int cpt)
+{
+	struct lnet_eq_batch *eb = the_lnet.ln_eq_batches[cpt];
+	struct lnet_event *events[LNET_EQ_BATCH_SIZE];
+	struct lnet_eq *eq;
+	int i;
+	int j;
+
+	for (i = 0; i < eb->eb_nevents; i = j) {
+		eq = eb->eb_eqs[i];
+		for (j = i; j < eb->eb_nevents && eb->eb_eqs[j] == eq; j++)
+			events[j - i] = &eb->eb_events[j];
+
+		eq->eq_batch_callback(events, j - i);
+	}
+	eb->eb_nevents = 0;
+}
+
+/* called by a finalizer once it has no more messages to complete */
+void
+lnet_eq_batch_flush(void)
+{
+	struct lnet_eq_batch *eb;
+	int cpt;
+
+	cfs_percpt_for_each(eb, cpt, the_lnet.ln_eq_batches) {
+		/* NB: events are added under lnet_res_lock(cpt) before the
+		 * producer checks for an active finalizer under lnet_net_lock,
+		 * which we have dropped since, so this peek can't miss them */
+		if (eb->eb_nevents == 0)
+			continue;
+
+		lnet_res_lock(cpt);
+		lnet_eq_batch_flush_locked(cpt);
+		lnet_res_unlock(cpt);
+	}
+}
+
+static void
+lnet_eq_batch_add_locked(struct lnet_eq *eq, struct lnet_event *ev)
+{
+	/* the MD of the event is protected by this CPT's resource lock */
+	int cpt = lnet_cpt_of_cookie(ev->md_handle.cookie);
+	struct lnet_eq_batch *eb = the_lnet.ln_eq_batches[cpt];
+
+	if (eb->eb_nevents == LNET_EQ_BATCH_SIZE)
+		lnet_eq_batch_flush_locked(cpt);
+
+	eb->eb_eqs[eb->eb_nevents] = eq;
+	eb->eb_events[eb->eb_nevents++] = *ev;
+
+	/* still go through the FIFO so that events queued before batching
+	 * was turned off are not overtaken */
+	if (!lnet_event_batch)
+		lnet_eq_batch_flush_locked(cpt);
+}
+
 void
 lnet_eq_enqueue_event(struct lnet_eq *eq, struct lnet_event *ev)
 {
@@ -211,6 +344,11 @@ lnet_eq_enqueue_event(struct lnet_eq *eq, struct lnet_event *ev)
 	int index;
 
 	if (eq->eq_size == 0) {
+		if (eq->eq_batch_callback != NULL) {
+			lnet_eq_batch_add_locked(eq, ev);
+			return;
+		}
+
 		LASSERT(eq->eq_callback != LNET_EQ_HANDLER_NONE);
 		eq->eq_callback(ev);
 		return;
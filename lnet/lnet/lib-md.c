@@ -208,6 +208,11 @@ lnet_md_build(struct lnet_libmd *lmd, struct lnet_md *umd, int unlink)
 	lmd->md_flags = (unlink == LNET_UNLINK) ? LNET_MD_FLAG_AUTO_UNLINK : 0;
 	lmd->md_bulk_handle = umd->bulk_handle;
 
+	/* only pages can be swapped */
+	if ((umd->options & LNET_MD_KIOV_SWAP) != 0 &&
+	    (umd->options & LNET_MD_KIOV) == 0)
+		return -EINVAL;
+
 	if ((umd->options & LNET_MD_IOVEC) != 0) {
 
 		if ((umd->options & LNET_MD_KIOV) != 0) /* Can't specify both */
@@ -547,6 +552,8 @@ LNetMDUnlink(struct lnet_handle_md mdh)
 	if (md->md_eq != NULL && md->md_refcount == 0) {
 		lnet_build_unlink_event(md, &ev);
 		lnet_eq_enqueue_event(md->md_eq, &ev);
+		/* no finalizer will flush this one */
+		lnet_eq_batch_flush_locked(cpt);
 	}
 
 	lnet_md_unlink(md);
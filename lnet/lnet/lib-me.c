@@ -244,6 +244,8 @@ LNetMEUnlink(struct lnet_handle_me meh)
 		if (md->md_eq != NULL && md->md_refcount == 0) {
 			lnet_build_unlink_event(md, &ev);
 			lnet_eq_enqueue_event(md->md_eq, &ev);
+			/* no finalizer will flush this one */
+			lnet_eq_batch_flush_locked(cpt);
 		}
 	}
 
@@ -763,6 +763,7 @@ lnet_ni_send(struct lnet_ni *ni, struct lnet_msg *msg)
 	LASSERT (LNET_NETTYP(LNET_NIDNET(ni->ni_nid)) == LOLND ||
 		 (msg->msg_txcredit && msg->msg_peertxcredit));
 
+	msg->msg_send_time = ktime_get();
 	rc = (ni->ni_net->net_lnd->lnd_send)(ni, priv, msg);
 	if (rc < 0) {
 		msg->msg_no_resend = true;
@@ -915,6 +916,51 @@ lnet_peer_alive_locked(struct lnet_ni *ni, struct lnet_peer_ni *lp,
 	return 0;
 }
 
+/*
+ * Peer tx credits are taken and given back with atomics, lpni_lock is only
+ * needed when the counter says there is a waiter. A sender which got a
+ * negative count queues itself on lpni_txq, but the credit it is waiting
+ * for may be returned before it gets there: the returning thread then finds
+ * lpni_txq empty and leaves a grant, which the sender takes instead of
+ * queueing.
+ *
+ * Returns true if \a msg has been queued and must wait for a credit.
+ */
+static bool
+lnet_peer_txq_wait(struct lnet_peer_ni *lp, struct lnet_msg *msg)
+{
+	spin_lock(&lp->lpni_lock);
+	if (lp->lpni_txq_grants > 0) {
+		lp->lpni_txq_grants--;
+		spin_unlock(&lp->lpni_lock);
+		return false;
+	}
+
+	msg->msg_tx_delayed = 1;
+	list_add_tail(&msg->msg_list, &lp->lpni_txq);
+	spin_unlock(&lp->lpni_lock);
+	return true;
+}
+
+/* Returns the next message waiting for a tx credit of \a lp, if any */
+static struct lnet_msg *
+lnet_peer_txq_wake(struct lnet_peer_ni *lp)
+{
+	struct lnet_msg *msg = NULL;
+
+	spin_lock(&lp->lpni_lock);
+	if (list_empty(&lp->lpni_txq)) {
+		/* the waiter is still on its way to lpni_txq */
+		lp->lpni_txq_grants++;
+	} else {
+		msg = list_entry(lp->lpni_txq.next, struct lnet_msg, msg_list);
+		list_del(&msg->msg_list);
+	}
+	spin_unlock(&lp->lpni_lock);
+
+	return msg;
+}
+
 /**
  * \param msg The message to be sent.
  * \param do_send True if lnet_ni_send() should be called in this function.
@@ -982,24 +1028,19 @@ lnet_post_send_locked(struct lnet_msg *msg, int do_send)
 	}
 
 	if (!msg->msg_peertxcredit) {
-		spin_lock(&lp->lpni_lock);
-		LASSERT((lp->lpni_txcredits < 0) ==
-			!list_empty(&lp->lpni_txq));
+		int credits;
 
 		msg->msg_peertxcredit = 1;
-		lp->lpni_txqnob += msg->msg_len + sizeof(struct lnet_hdr);
-		lp->lpni_txcredits--;
+		atomic_long_add(msg->msg_len + sizeof(struct lnet_hdr),
+				&lp->lpni_txqnob);
+		credits = atomic_dec_return(&lp->lpni_txcredits);
 
-		if (lp->lpni_txcredits < lp->lpni_mintxcredits)
-			lp->lpni_mintxcredits = lp->lpni_txcredits;
+		/* racy, but it's only a statistic */
+		if (credits < lp->lpni_mintxcredits)
+			lp->lpni_mintxcredits = credits;
 
-		if (lp->lpni_txcredits < 0) {
-			msg->msg_tx_delayed = 1;
-			list_add_tail(&msg->msg_list, &lp->lpni_txq);
-			spin_unlock(&lp->lpni_lock);
+		if (credits < 0 && lnet_peer_txq_wait(lp, msg))
 			return LNET_CREDIT_WAIT;
-		}
-		spin_unlock(&lp->lpni_lock);
 	}
 
 	if (!msg->msg_txcredit) {
@@ -1052,6 +1093,27 @@ lnet_msg2bufpool(struct lnet_msg *msg)
 	return rbp;
 }
 
+static void
+lnet_rtrpool_wait_account(struct lnet_rtrbufpool *rbp, struct lnet_msg *msg)
+{
+	__u32 usec;
+	int bucket = 0;
+
+	if (ktime_to_ns(msg->msg_rtr_queued) != 0) {
+		usec = ktime_us_delta(ktime_get(), msg->msg_rtr_queued);
+		msg->msg_rtr_queued = ktime_set(0, 0);
+
+		if (usec > rbp->rbp_auto_maxwait)
+			rbp->rbp_auto_maxwait = usec;
+
+		/* bucket 1 is < 16us, each next one 4 times as wide */
+		for (bucket = 1; bucket < LNET_RTRPOOL_WAIT_BUCKETS - 1 &&
+		     usec >= (16U << (2 * (bucket - 1))); bucket++)
+			;
+	}
+	rbp->rbp_wait_hist[bucket]++;
+}
+
 static int
 lnet_post_routed_recv_locked(struct lnet_msg *msg, int do_recv)
 {
@@ -1094,6 +1156,12 @@ lnet_post_routed_recv_locked(struct lnet_msg *msg, int do_recv)
 		spin_unlock(&lp->lpni_lock);
 	}
 
+	if (msg->msg_rtr_nobuf) {
+		/* nothing to buffer, forward straight from the header */
+		msg->msg_rx_delayed = 0;
+		goto recv;
+	}
+
 	rbp = lnet_msg2bufpool(msg);
 
 	if (!msg->msg_rtrcredit) {
@@ -1101,16 +1169,21 @@ lnet_post_routed_recv_locked(struct lnet_msg *msg, int do_recv)
 		rbp->rbp_credits--;
 		if (rbp->rbp_credits < rbp->rbp_mincredits)
 			rbp->rbp_mincredits = rbp->rbp_credits;
+		if (rbp->rbp_credits < rbp->rbp_auto_mincredits)
+			rbp->rbp_auto_mincredits = rbp->rbp_credits;
 
 		if (rbp->rbp_credits < 0) {
 			/* must have checked eager_recv before here */
 			LASSERT(msg->msg_rx_ready_delay);
 			msg->msg_rx_delayed = 1;
+			msg->msg_rtr_queued = ktime_get();
 			list_add_tail(&msg->msg_list, &rbp->rbp_msgs);
 			return LNET_CREDIT_WAIT;
 		}
 	}
 
+	lnet_rtrpool_wait_account(rbp, msg);
+
 	LASSERT(!list_empty(&rbp->rbp_bufs));
 	rb = list_entry(rbp->rbp_bufs.next, struct lnet_rtrbuf, rb_list);
 	list_del(&rb->rb_list);
@@ -1121,6 +1194,7 @@ lnet_post_routed_recv_locked(struct lnet_msg *msg, int do_recv)
 	/* unset the msg-rx_delayed flag since we're receiving the message */
 	msg->msg_rx_delayed = 0;
 
+recv:
 	if (do_recv) {
 		int cpt = msg->msg_rx_cpt;
 
@@ -1168,22 +1242,14 @@ lnet_return_tx_credits_locked(struct lnet_msg *msg)
 		/* give back peer txcredits */
 		msg->msg_peertxcredit = 0;
 
-		spin_lock(&txpeer->lpni_lock);
-		LASSERT((txpeer->lpni_txcredits < 0) ==
-			!list_empty(&txpeer->lpni_txq));
-
-		txpeer->lpni_txqnob -= msg->msg_len + sizeof(struct lnet_hdr);
-		LASSERT(txpeer->lpni_txqnob >= 0);
+		atomic_long_sub(msg->msg_len + sizeof(struct lnet_hdr),
+				&txpeer->lpni_txqnob);
+		LASSERT(atomic_long_read(&txpeer->lpni_txqnob) >= 0);
 
-		txpeer->lpni_txcredits++;
-		if (txpeer->lpni_txcredits <= 0) {
+		if (atomic_inc_return(&txpeer->lpni_txcredits) <= 0 &&
+		    (msg2 = lnet_peer_txq_wake(txpeer)) != NULL) {
 			int msg2_cpt;
 
-			msg2 = list_entry(txpeer->lpni_txq.next,
-					      struct lnet_msg, msg_list);
-			list_del(&msg2->msg_list);
-			spin_unlock(&txpeer->lpni_lock);
-
 			LASSERT(msg2->msg_txpeer == txpeer);
 			LASSERT(msg2->msg_tx_delayed);
 
@@ -1209,10 +1275,8 @@ lnet_return_tx_credits_locked(struct lnet_msg *msg)
 				lnet_net_unlock(msg2_cpt);
 				lnet_net_lock(msg->msg_tx_cpt);
 			}
-                } else {
-			spin_unlock(&txpeer->lpni_lock);
 		}
-        }
+	}
 
 	if (txni != NULL) {
 		msg->msg_txni = NULL;
@@ -1351,16 +1415,20 @@ routing_off:
 static int
 lnet_compare_peers(struct lnet_peer_ni *p1, struct lnet_peer_ni *p2)
 {
-	if (p1->lpni_txqnob < p2->lpni_txqnob)
+	if (atomic_long_read(&p1->lpni_txqnob) <
+	    atomic_long_read(&p2->lpni_txqnob))
 		return 1;
 
-	if (p1->lpni_txqnob > p2->lpni_txqnob)
+	if (atomic_long_read(&p1->lpni_txqnob) >
+	    atomic_long_read(&p2->lpni_txqnob))
 		return -1;
 
-	if (p1->lpni_txcredits > p2->lpni_txcredits)
+	if (atomic_read(&p1->lpni_txcredits) >
+	    atomic_read(&p2->lpni_txcredits))
 		return 1;
 
-	if (p1->lpni_txcredits < p2->lpni_txcredits)
+	if (atomic_read(&p1->lpni_txcredits) <
+	    atomic_read(&p2->lpni_txcredits))
 		return -1;
 
 	return 0;
@@ -1456,6 +1524,109 @@ lnet_find_route_locked(struct lnet_net *net, __u32 remote_net,
 	return lpni_best;
 }
 
+/* sends of at least this many bytes sample bandwidth, smaller ones latency */
+#define LNET_PERF_BW_MIN	(16 << 10)
+/* weight of a new sample is 1 / 2^LNET_PERF_EWMA_SHIFT */
+#define LNET_PERF_EWMA_SHIFT	3
+
+static inline __u64
+lnet_perf_ewma(__u64 avg, __u64 sample)
+{
+	if (avg == 0)
+		return sample;
+	return avg - (avg >> LNET_PERF_EWMA_SHIFT) +
+	       (sample >> LNET_PERF_EWMA_SHIFT);
+}
+
+static void
+lnet_perf_sample(struct lnet_perf *perf, unsigned int len, __u64 elapsed)
+{
+	if (len >= LNET_PERF_BW_MIN)
+		perf->lpf_bw = lnet_perf_ewma(perf->lpf_bw,
+					      div64_u64((__u64)len *
+							NSEC_PER_SEC,
+							elapsed));
+	else
+		perf->lpf_lat = lnet_perf_ewma(perf->lpf_lat, elapsed);
+}
+
+/*
+ * Called for every successfully completed send. The time between handing
+ * the message to the LND and its completion is the sample: large messages
+ * give the bandwidth of the path, small ones its latency.
+ */
+void
+lnet_perf_update(struct lnet_msg *msg)
+{
+	__u64 elapsed;
+
+	if (ktime_to_ns(msg->msg_send_time) == 0)
+		return;
+
+	elapsed = ktime_to_ns(ktime_sub(ktime_get(), msg->msg_send_time));
+	if (elapsed == 0)
+		elapsed = 1;
+
+	lnet_perf_sample(&msg->msg_txni->ni_perf, msg->msg_len, elapsed);
+	if (msg->msg_txpeer)
+		lnet_perf_sample(&msg->msg_txpeer->lpni_perf, msg->msg_len,
+				 elapsed);
+}
+
+static inline bool
+lnet_perf_valid(struct lnet_perf *perf)
+{
+	return lnet_perf_select && perf->lpf_bw != 0;
+}
+
+/* predicted time at which a path will have drained what it was given */
+static inline __u64
+lnet_perf_busy(struct lnet_perf *perf, __u64 now)
+{
+	return max(perf->lpf_busy, now);
+}
+
+/*
+ * Account a message assigned to a path: it is expected to complete
+ * len / bandwidth + latency after everything already assigned to it.
+ * Slower paths fall behind faster and are picked proportionally less.
+ */
+static void
+lnet_perf_charge(struct lnet_perf *perf, unsigned int len)
+{
+	if (!lnet_perf_valid(perf))
+		return;
+
+	perf->lpf_busy = lnet_perf_busy(perf, ktime_get_ns()) +
+			 div64_u64((__u64)len * NSEC_PER_SEC, perf->lpf_bw) +
+			 perf->lpf_lat;
+}
+
+/*
+ * Compare two paths by the time they are predicted to become idle.
+ * Returns < 0 if p1 is ahead, > 0 if p2 is, 0 if either has not been
+ * measured yet or both are idle.
+ */
+static int
+lnet_perf_compare(struct lnet_perf *p1, struct lnet_perf *p2)
+{
+	__u64 now;
+	__u64 b1;
+	__u64 b2;
+
+	if (!lnet_perf_valid(p1) || !lnet_perf_valid(p2))
+		return 0;
+
+	now = ktime_get_ns();
+	b1 = lnet_perf_busy(p1, now);
+	b2 = lnet_perf_busy(p2, now);
+	if (b1 < b2)
+		return -1;
+	if (b1 > b2)
+		return 1;
+	return 0;
+}
+
 static struct lnet_ni *
 lnet_get_best_ni(struct lnet_net *local_net, struct lnet_ni *best_ni,
 		 struct lnet_peer *peer, struct lnet_peer_net *peer_net,
@@ -1489,6 +1660,7 @@ lnet_get_best_ni(struct lnet_net *local_net, struct lnet_ni *best_ni,
 		int ni_credits;
 		int ni_healthv;
 		int ni_fatal;
+		int perf;
 
 		ni_credits = atomic_read(&ni->ni_tx_credits);
 		ni_healthv = atomic_read(&ni->ni_healthv);
@@ -1517,8 +1689,8 @@ lnet_get_best_ni(struct lnet_net *local_net, struct lnet_ni *best_ni,
 			distance = lnet_numa_range;
 
 		/*
-		 * Select on health, shorter distance, available
-		 * credits, then round-robin.
+		 * Select on health, shorter distance, measured
+		 * performance, available credits, then round-robin.
 		 */
 		if (ni_fatal) {
 			continue;
@@ -1539,6 +1711,11 @@ lnet_get_best_ni(struct lnet_net *local_net, struct lnet_ni *best_ni,
 			continue;
 		} else if (distance < shortest_distance) {
 			shortest_distance = distance;
+		} else if (best_ni &&
+			   (perf = lnet_perf_compare(&ni->ni_perf,
+						     &best_ni->ni_perf)) != 0) {
+			if (perf > 0)
+				continue;
 		} else if (ni_credits < best_credits) {
 			continue;
 		} else if (ni_credits == best_credits) {
@@ -1617,6 +1794,9 @@ lnet_handle_send(struct lnet_send_data *sd)
 	 */
 	best_lpni->lpni_seq++;
 
+	lnet_perf_charge(&best_ni->ni_perf, msg->msg_len);
+	lnet_perf_charge(&best_lpni->lpni_perf, msg->msg_len);
+
 	/*
 	 * grab a reference on the peer_ni so it sticks around even if
 	 * we need to drop and relock the lnet_net_lock below.
@@ -1751,6 +1931,8 @@ lnet_select_peer_ni(struct lnet_send_data *sd, struct lnet_peer *peer,
 	bool ni_is_pref;
 	int best_lpni_healthv = 0;
 	int lpni_healthv;
+	int lpni_credits;
+	int perf;
 
 	while ((lpni = lnet_get_next_peer_ni_locked(peer, peer_net, lpni))) {
 		/*
@@ -1761,6 +1943,7 @@ lnet_select_peer_ni(struct lnet_send_data *sd, struct lnet_peer *peer,
 							  best_ni->ni_nid);
 
 		lpni_healthv = atomic_read(&lpni->lpni_healthv);
+		lpni_credits = atomic_read(&lpni->lpni_txcredits);
 
 		CDEBUG(D_NET, "%s ni_is_pref = %d\n",
 		       libcfs_nid2str(best_ni->ni_nid), ni_is_pref);
@@ -1768,7 +1951,7 @@ lnet_select_peer_ni(struct lnet_send_data *sd, struct lnet_peer *peer,
 		if (best_lpni)
 			CDEBUG(D_NET, "%s c:[%d, %d], s:[%d, %d]\n",
 				libcfs_nid2str(lpni->lpni_nid),
-				lpni->lpni_txcredits, best_lpni_credits,
+				lpni_credits, best_lpni_credits,
 				lpni->lpni_seq, best_lpni->lpni_seq);
 
 		/* pick the healthiest peer ni */
@@ -1785,14 +1968,20 @@ lnet_select_peer_ni(struct lnet_send_data *sd, struct lnet_peer *peer,
 			 * it.
 			 */
 			continue;
-		} else if (lpni->lpni_txcredits < best_lpni_credits) {
+		} else if (best_lpni &&
+			   (perf = lnet_perf_compare(&lpni->lpni_perf,
+						     &best_lpni->lpni_perf)) != 0) {
+			/* prefer the peer NI that will drain first */
+			if (perf > 0)
+				continue;
+		} else if (lpni_credits < best_lpni_credits) {
 			/*
 			 * We already have a peer that has more credits
 			 * available than this one. No need to consider
 			 * this peer further.
 			 */
 			continue;
-		} else if (lpni->lpni_txcredits == best_lpni_credits) {
+		} else if (lpni_credits == best_lpni_credits) {
 			/*
 			 * The best peer found so far and the current peer
 			 * have the same number of available credits let's
@@ -1806,7 +1995,7 @@ lnet_select_peer_ni(struct lnet_send_data *sd, struct lnet_peer *peer,
 		}
 
 		best_lpni = lpni;
-		best_lpni_credits = lpni->lpni_txcredits;
+		best_lpni_credits = lpni_credits;
 	}
 
 	/* if we still can't find a peer ni then we can't reach it */
@@ -3349,6 +3538,9 @@ lnet_monitor_thread(void *arg)
 		if (lnet_router_checker_active())
 			lnet_check_routers();
 
+		if (the_lnet.ln_routing)
+			lnet_rtrpools_autosize();
+
 		lnet_resend_pending_msgs();
 
 		if (now >= rsp_timeout) {
@@ -3958,8 +4150,13 @@ lnet_parse_forward_locked(struct lnet_ni *ni, struct lnet_msg *msg)
 	if (!the_lnet.ln_routing)
 		return -ECANCELED;
 
+	/* router_forward_empty can change meanwhile, a delayed message is
+	 * posted again with the same decision */
+	msg->msg_rtr_nobuf = lnet_router_forward_empty(msg);
+
 	if (msg->msg_rxpeer->lpni_rtrcredits <= 0 ||
-	    lnet_msg2bufpool(msg)->rbp_credits <= 0) {
+	    (!msg->msg_rtr_nobuf &&
+	     lnet_msg2bufpool(msg)->rbp_credits <= 0)) {
 		if (ni->ni_net->net_lnd->lnd_eager_recv == NULL) {
 			msg->msg_rx_ready_delay = 1;
 		} else {
@@ -662,6 +662,8 @@ lnet_health_check(struct lnet_msg *msg)
 		if (msg->msg_txpeer)
 			lnet_inc_healthv(&msg->msg_txpeer->lpni_healthv);
 
+		lnet_perf_update(msg);
+
 		/* we can finalize this message */
 		return -1;
 	case LNET_MSG_STATUS_LOCAL_INTERRUPT:
@@ -919,6 +921,7 @@ again:
 		/* not committed to network yet */
 		LASSERT(!msg->msg_onactivelist);
 		lnet_msg_free(msg);
+		lnet_eq_batch_flush();
 		return;
 	}
 
@@ -935,8 +938,10 @@ again:
 		 * message. Otherwise just return since the message has been
 		 * put on the resend queue.
 		 */
-		if (!lnet_health_check(msg))
+		if (!lnet_health_check(msg)) {
+			lnet_eq_batch_flush();
 			return;
+		}
 
 		/*
 		 * if we get here then we need to clean up the md because we're
@@ -998,6 +1003,10 @@ again:
 	container->msc_finalizers[my_slot] = NULL;
 	lnet_net_unlock(cpt);
 
+	/* events of every message completed by me or handed to me while I
+	 * was busy go to the EQ handlers in one go */
+	lnet_eq_batch_flush();
+
 	if (rc != 0)
 		goto again;
 }
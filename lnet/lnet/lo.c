@@ -42,6 +42,93 @@ lolnd_send(struct lnet_ni *ni, void *private, struct lnet_msg *lntmsg)
 	return lnet_parse(ni, &lntmsg->msg_hdr, ni->ni_nid, lntmsg, 0);
 }
 
+/* payload bytes delivered by copying / without moving them */
+atomic64_t lolnd_copy_bytes = ATOMIC64_INIT(0);
+atomic64_t lolnd_zero_copy_bytes = ATOMIC64_INIT(0);
+
+/*
+ * Sender and receiver are both on this node, so a receive buffer may be
+ * the very pages the payload is sent from (e.g. a buffer sent to itself
+ * or a bulk that describes the same pages on both sides). The data is
+ * then already in place.
+ */
+static bool
+lolnd_kiov_same(unsigned int niov, lnet_kiov_t *kiov, unsigned int offset,
+		struct lnet_msg *sendmsg, unsigned int mlen)
+{
+	lnet_kiov_t *skiov = sendmsg->msg_kiov;
+	unsigned int nob = 0;
+	unsigned int i;
+
+	if (kiov == NULL || skiov == NULL || mlen == 0 ||
+	    offset != sendmsg->msg_offset)
+		return false;
+
+	for (i = 0; i < niov && nob < offset + mlen; i++) {
+		if (i >= sendmsg->msg_niov ||
+		    kiov[i].kiov_page != skiov[i].kiov_page ||
+		    kiov[i].kiov_offset != skiov[i].kiov_offset ||
+		    kiov[i].kiov_len != skiov[i].kiov_len)
+			return false;
+		nob += kiov[i].kiov_len;
+	}
+
+	return nob >= offset + mlen;
+}
+
+/*
+ * Both MDs own their pages (LNET_MD_KIOV_SWAP) and lay the payload out in
+ * the same fragments: exchange the pages between them instead of copying.
+ * Every array, the MD copies and the callers' ones, keeps one page per
+ * fragment, so each caller frees what it finds in its array as usual.
+ */
+static bool
+lolnd_kiov_swap(struct lnet_msg *recvmsg, unsigned int niov,
+		lnet_kiov_t *kiov, unsigned int offset,
+		struct lnet_msg *sendmsg, unsigned int mlen)
+{
+	struct lnet_libmd *rmd = recvmsg->msg_md;
+	struct lnet_libmd *smd = sendmsg->msg_md;
+	lnet_kiov_t *skiov = sendmsg->msg_kiov;
+	lnet_kiov_t *rstart;
+	lnet_kiov_t *sstart;
+	struct page *page;
+	unsigned int nob = 0;
+	unsigned int n;
+	unsigned int i;
+
+	if (rmd == NULL || smd == NULL || mlen == 0 ||
+	    (rmd->md_options & LNET_MD_KIOV_SWAP) == 0 ||
+	    (smd->md_options & LNET_MD_KIOV_SWAP) == 0 ||
+	    kiov != rmd->md_iov.kiov || skiov != smd->md_iov.kiov ||
+	    offset != 0 || sendmsg->msg_offset != 0)
+		return false;
+
+	for (n = 0; n < niov && nob < mlen; n++) {
+		if (n >= sendmsg->msg_niov ||
+		    kiov[n].kiov_offset != skiov[n].kiov_offset ||
+		    kiov[n].kiov_len != skiov[n].kiov_len)
+			return false;
+		nob += kiov[n].kiov_len;
+	}
+
+	/* the sink keeps its own page past the payload */
+	if (nob != mlen)
+		return false;
+
+	rstart = (lnet_kiov_t *)rmd->md_start;
+	sstart = (lnet_kiov_t *)smd->md_start;
+	for (i = 0; i < n; i++) {
+		page = kiov[i].kiov_page;
+		kiov[i].kiov_page = skiov[i].kiov_page;
+		skiov[i].kiov_page = page;
+		rstart[i].kiov_page = kiov[i].kiov_page;
+		sstart[i].kiov_page = page;
+	}
+
+	return true;
+}
+
 static int
 lolnd_recv(struct lnet_ni *ni, void *private, struct lnet_msg *lntmsg,
 	   int delayed, unsigned int niov,
@@ -51,6 +138,14 @@ lolnd_recv(struct lnet_ni *ni, void *private, struct lnet_msg *lntmsg,
 	struct lnet_msg *sendmsg = private;
 
 	if (lntmsg != NULL) {			/* not discarding */
+		if (lolnd_kiov_same(niov, kiov, offset, sendmsg, mlen) ||
+		    lolnd_kiov_swap(lntmsg, niov, kiov, offset, sendmsg,
+				    mlen)) {
+			atomic64_add(mlen, &lolnd_zero_copy_bytes);
+			goto out;
+		}
+
+		atomic64_add(mlen, &lolnd_copy_bytes);
 		if (sendmsg->msg_iov != NULL) {
 			if (iov != NULL)
 				lnet_copy_iov2iov(niov, iov, offset,
@@ -74,7 +169,7 @@ lolnd_recv(struct lnet_ni *ni, void *private, struct lnet_msg *lntmsg,
 						    sendmsg->msg_kiov,
 						    sendmsg->msg_offset, mlen);
 		}
-
+out:
 		lnet_finalize(lntmsg, 0);
 	}
 
@@ -69,9 +69,10 @@ lnet_peer_net_added(struct lnet_net *net)
 			lpni->lpni_net = net;
 
 			spin_lock(&lpni->lpni_lock);
-			lpni->lpni_txcredits =
-				lpni->lpni_net->net_tunables.lct_peer_tx_credits;
-			lpni->lpni_mintxcredits = lpni->lpni_txcredits;
+			atomic_set(&lpni->lpni_txcredits,
+				lpni->lpni_net->net_tunables.lct_peer_tx_credits);
+			lpni->lpni_mintxcredits =
+				atomic_read(&lpni->lpni_txcredits);
 			lpni->lpni_rtrcredits =
 				lnet_peer_buffer_credits(lpni->lpni_net);
 			lpni->lpni_minrtrcredits = lpni->lpni_rtrcredits;
@@ -181,8 +182,9 @@ lnet_peer_ni_alloc(lnet_nid_t nid)
 	net = lnet_get_net_locked(LNET_NIDNET(nid));
 	lpni->lpni_net = net;
 	if (net) {
-		lpni->lpni_txcredits = net->net_tunables.lct_peer_tx_credits;
-		lpni->lpni_mintxcredits = lpni->lpni_txcredits;
+		atomic_set(&lpni->lpni_txcredits,
+			   net->net_tunables.lct_peer_tx_credits);
+		lpni->lpni_mintxcredits = atomic_read(&lpni->lpni_txcredits);
 		lpni->lpni_rtrcredits = lnet_peer_buffer_credits(net);
 		lpni->lpni_minrtrcredits = lpni->lpni_rtrcredits;
 	} else {
@@ -1572,7 +1574,7 @@ lnet_destroy_peer_ni_locked(struct lnet_peer_ni *lpni)
 	LASSERT(atomic_read(&lpni->lpni_refcount) == 0);
 	LASSERT(lpni->lpni_rtr_refcount == 0);
 	LASSERT(list_empty(&lpni->lpni_txq));
-	LASSERT(lpni->lpni_txqnob == 0);
+	LASSERT(atomic_long_read(&lpni->lpni_txqnob) == 0);
 	LASSERT(list_empty(&lpni->lpni_peer_nis));
 	LASSERT(list_empty(&lpni->lpni_on_remote_peer_ni_list));
 
@@ -3268,7 +3270,8 @@ lnet_debug_peer(lnet_nid_t nid)
 	       libcfs_nid2str(lp->lpni_nid), atomic_read(&lp->lpni_refcount),
 	       aliveness, lp->lpni_net->net_tunables.lct_peer_tx_credits,
 	       lp->lpni_rtrcredits, lp->lpni_minrtrcredits,
-	       lp->lpni_txcredits, lp->lpni_mintxcredits, lp->lpni_txqnob);
+	       atomic_read(&lp->lpni_txcredits), lp->lpni_mintxcredits,
+	       atomic_long_read(&lp->lpni_txqnob));
 
 	lnet_peer_ni_decref_locked(lp);
 
@@ -3324,10 +3327,10 @@ int lnet_get_peer_ni_info(__u32 peer_index, __u64 *nid,
 			*refcount = atomic_read(&lp->lpni_refcount);
 			*ni_peer_tx_credits =
 				lp->lpni_net->net_tunables.lct_peer_tx_credits;
-			*peer_tx_credits = lp->lpni_txcredits;
+			*peer_tx_credits = atomic_read(&lp->lpni_txcredits);
 			*peer_rtr_credits = lp->lpni_rtrcredits;
 			*peer_min_rtr_credits = lp->lpni_mintxcredits;
-			*peer_tx_qnob = lp->lpni_txqnob;
+			*peer_tx_qnob = atomic_long_read(&lp->lpni_txqnob);
 
 			found = true;
 		}
@@ -3346,6 +3349,7 @@ int lnet_get_peer_info(struct lnet_ioctl_peer_cfg *cfg, void __user *bulk)
 	struct lnet_ioctl_element_stats *lpni_stats;
 	struct lnet_ioctl_element_msg_stats *lpni_msg_stats;
 	struct lnet_ioctl_peer_ni_hstats *lpni_hstats;
+	struct lnet_ioctl_element_perf_stats lpni_perf;
 	struct lnet_peer_ni_credit_info *lpni_info;
 	struct lnet_peer_ni *lpni;
 	struct lnet_peer *lp;
@@ -3360,8 +3364,11 @@ int lnet_get_peer_info(struct lnet_ioctl_peer_cfg *cfg, void __user *bulk)
 		goto out;
 	}
 
+	/* the performance stats follow all the peer NI records, so that
+	 * older tools which do not know about them can skip them */
 	size = sizeof(nid) + sizeof(*lpni_info) + sizeof(*lpni_stats)
-		+ sizeof(*lpni_msg_stats) + sizeof(*lpni_hstats);
+		+ sizeof(*lpni_msg_stats) + sizeof(*lpni_hstats)
+		+ sizeof(lpni_perf);
 	size *= lp->lp_nnis;
 	if (size > cfg->prcfg_size) {
 		cfg->prcfg_size = size;
@@ -3410,11 +3417,13 @@ int lnet_get_peer_info(struct lnet_ioctl_peer_cfg *cfg, void __user *bulk)
 		lpni_info->cr_refcount = atomic_read(&lpni->lpni_refcount);
 		lpni_info->cr_ni_peer_tx_credits = (lpni->lpni_net != NULL) ?
 			lpni->lpni_net->net_tunables.lct_peer_tx_credits : 0;
-		lpni_info->cr_peer_tx_credits = lpni->lpni_txcredits;
+		lpni_info->cr_peer_tx_credits =
+			atomic_read(&lpni->lpni_txcredits);
 		lpni_info->cr_peer_rtr_credits = lpni->lpni_rtrcredits;
 		lpni_info->cr_peer_min_rtr_credits = lpni->lpni_minrtrcredits;
 		lpni_info->cr_peer_min_tx_credits = lpni->lpni_mintxcredits;
-		lpni_info->cr_peer_tx_qnob = lpni->lpni_txqnob;
+		lpni_info->cr_peer_tx_qnob =
+			atomic_long_read(&lpni->lpni_txqnob);
 		if (copy_to_user(bulk, lpni_info, sizeof(*lpni_info)))
 			goto out_free_hstats;
 		bulk += sizeof(*lpni_info);
@@ -3447,6 +3456,16 @@ int lnet_get_peer_info(struct lnet_ioctl_peer_cfg *cfg, void __user *bulk)
 			goto out_free_hstats;
 		bulk += sizeof(*lpni_hstats);
 	}
+
+	lpni = NULL;
+	while ((lpni = lnet_get_next_peer_ni_locked(lp, NULL, lpni)) != NULL) {
+		lpni_perf.iep_bandwidth = lpni->lpni_perf.lpf_bw >> 10;
+		lpni_perf.iep_latency =
+		  div_u64(lpni->lpni_perf.lpf_lat, NSEC_PER_USEC);
+		if (copy_to_user(bulk, &lpni_perf, sizeof(lpni_perf)))
+			goto out_free_hstats;
+		bulk += sizeof(lpni_perf);
+	}
 	rc = 0;
 
 out_free_hstats:
@@ -21,6 +21,7 @@
  */
 
 #define DEBUG_SUBSYSTEM S_LNET
+#include <libcfs/linux/linux-mem.h>
 #include <lnet/lib-lnet.h>
 
 #define LNET_NRB_TINY_MIN	512	/* min value for each CPT */
@@ -50,6 +51,14 @@ static int peer_buffer_credits;
 module_param(peer_buffer_credits, int, 0444);
 MODULE_PARM_DESC(peer_buffer_credits, "# router buffer credits per peer");
 
+static int auto_router_buffers = 4;
+module_param(auto_router_buffers, int, 0644);
+MODULE_PARM_DESC(auto_router_buffers, "Grow router buffer pools under load up to this multiple of their configured size (<= 1 to disable)");
+
+static int router_forward_empty = 1;
+module_param(router_forward_empty, int, 0644);
+MODULE_PARM_DESC(router_forward_empty, "Forward messages without payload (ACK, GET) without a router buffer, payload is still store-and-forward (0 to disable)");
+
 static int auto_down = 1;
 module_param(auto_down, int, 0444);
 MODULE_PARM_DESC(auto_down, "Automatically mark peers down on comms error");
@@ -94,6 +103,18 @@ lnet_peers_start_down(void)
 	return check_routers_before_use;
 }
 
+int
+lnet_router_forward_empty(struct lnet_msg *msg)
+{
+	/* A message without payload is complete as soon as its header has
+	 * arrived, so there is nothing to stage in a router buffer: hand it
+	 * to the outbound NI right away.  Back-pressure on the sender still
+	 * comes from the peer router credits.  This is not cut-through:
+	 * a PUT carrying data is still fully received into a router buffer
+	 * before it is sent on, so bulk latency is unchanged. */
+	return router_forward_empty && msg->msg_len == 0;
+}
+
 void
 lnet_notify_locked(struct lnet_peer_ni *lp, int notifylnd, int alive,
 		   time64_t when)
@@ -574,7 +595,8 @@ lnet_destroy_routes (void)
 	lnet_del_route(LNET_NIDNET(LNET_NID_ANY), LNET_NID_ANY);
 }
 
-int lnet_get_rtr_pool_cfg(int idx, struct lnet_ioctl_pool_cfg *pool_cfg)
+int lnet_get_rtr_pool_cfg(int idx, struct lnet_ioctl_pool_cfg *pool_cfg,
+			  struct lnet_ioctl_pool_wait_hist *wait_hist)
 {
 	int i, rc = -ENOENT, j;
 
@@ -593,6 +615,10 @@ int lnet_get_rtr_pool_cfg(int idx, struct lnet_ioctl_pool_cfg *pool_cfg)
 			pool_cfg->pl_pools[i].pl_nbuffers = rbp[i].rbp_nbuffers;
 			pool_cfg->pl_pools[i].pl_credits = rbp[i].rbp_credits;
 			pool_cfg->pl_pools[i].pl_mincredits = rbp[i].rbp_mincredits;
+			if (wait_hist != NULL)
+				memcpy(wait_hist->pw_hist[i],
+				       rbp[i].rbp_wait_hist,
+				       sizeof(wait_hist->pw_hist[i]));
 			rc = 0;
 			break;
 		}
@@ -1391,7 +1417,7 @@ lnet_rtrpool_free_bufs(struct lnet_rtrbufpool *rbp, int cpt)
 }
 
 static int
-lnet_rtrpool_adjust_bufs(struct lnet_rtrbufpool *rbp, int nbufs, int cpt)
+lnet_rtrpool_resize_bufs(struct lnet_rtrbufpool *rbp, int nbufs, int cpt)
 {
 	struct list_head rb_list;
 	struct lnet_rtrbuf *rb;
@@ -1469,6 +1495,229 @@ failed:
 	return -ENOMEM;
 }
 
+/* set the configured size of a pool, dropping any automatic growth */
+static int
+lnet_rtrpool_adjust_bufs(struct lnet_rtrbufpool *rbp, int nbufs, int cpt)
+{
+	lnet_net_lock(cpt);
+	rbp->rbp_base_nbuffers = nbufs;
+	lnet_net_unlock(cpt);
+
+	return lnet_rtrpool_resize_bufs(rbp, nbufs, cpt);
+}
+
+/* don't try to grow again for a while after an allocation failure */
+static time64_t lnet_rtrpools_grow_after;
+
+/*
+ * Called from the monitor thread about once a second while routing.
+ * A pool that had messages queued for buffers since the last pass grows
+ * by at least the peak queue depth, twice that if a message waited for
+ * a millisecond or longer, up to auto_router_buffers times its
+ * configured size. The new buffers are allocated here, in the
+ * background; pools are shrunk back by the shrinker under memory
+ * pressure.
+ *
+ * ln_api_mutex serializes this with the pool ioctls, as for
+ * lnet_rtrpools_adjust(). It is only tried: LNetNIFini() holds it while
+ * it waits for the monitor thread to stop, and a pass skipped here is
+ * made up by the next one.
+ */
+void
+lnet_rtrpools_autosize(void)
+{
+	struct lnet_rtrbufpool *rtrp;
+	int i;
+	int j;
+
+	if (auto_router_buffers <= 1 ||
+	    ktime_get_seconds() < lnet_rtrpools_grow_after)
+		return;
+
+	if (!mutex_trylock(&the_lnet.ln_api_mutex))
+		return;
+
+	if (the_lnet.ln_rtrpools == NULL || !the_lnet.ln_routing)
+		goto out;
+
+	cfs_percpt_for_each(rtrp, i, the_lnet.ln_rtrpools) {
+		for (j = 0; j < LNET_NRBPOOLS; j++) {
+			struct lnet_rtrbufpool *rbp = &rtrp[j];
+			int limit;
+			int grow;
+			int nbufs;
+
+			lnet_net_lock(i);
+			limit = rbp->rbp_base_nbuffers * auto_router_buffers;
+			grow = -rbp->rbp_auto_mincredits;
+			if (rbp->rbp_auto_maxwait >= USEC_PER_MSEC)
+				grow *= 2;
+			grow = max(grow, rbp->rbp_req_nbuffers / 8);
+			nbufs = min(rbp->rbp_req_nbuffers + grow, limit);
+			if (rbp->rbp_auto_mincredits >= 0 ||
+			    nbufs <= rbp->rbp_req_nbuffers)
+				nbufs = 0;
+			rbp->rbp_auto_mincredits = rbp->rbp_credits;
+			rbp->rbp_auto_maxwait = 0;
+			lnet_net_unlock(i);
+
+			if (nbufs == 0)
+				continue;
+
+			CDEBUG(D_NET, "cpt %d: growing %d page router pool to %d buffers\n",
+			       i, rbp->rbp_npages, nbufs);
+			if (lnet_rtrpool_resize_bufs(rbp, nbufs, i) != 0) {
+				lnet_rtrpools_grow_after = ktime_get_seconds() +
+							   60;
+				goto out;
+			}
+		}
+	}
+out:
+	mutex_unlock(&the_lnet.ln_api_mutex);
+}
+
+/* # pages (or descriptors, for tiny buffers) the pools grew beyond their
+ * configured size. Read without locks: it is only an estimate, and the
+ * shrinker is unregistered before the pools are freed. */
+static unsigned long
+lnet_rtrpools_count(void)
+{
+	struct lnet_rtrbufpool *rtrp;
+	unsigned long count = 0;
+	int i;
+	int j;
+
+	if (the_lnet.ln_rtrpools == NULL)
+		return 0;
+
+	cfs_percpt_for_each(rtrp, i, the_lnet.ln_rtrpools) {
+		for (j = 0; j < LNET_NRBPOOLS; j++) {
+			int excess = rtrp[j].rbp_nbuffers -
+				     rtrp[j].rbp_base_nbuffers;
+
+			if (excess > 0)
+				count += excess * max(rtrp[j].rbp_npages, 1);
+		}
+	}
+
+	return count;
+}
+
+/*
+ * Give back buffers above the configured pool sizes. Free buffers are
+ * released right away, buffers in use when they are returned.
+ *
+ * ln_api_mutex serializes this with lnet_rtrpools_autosize() and the pool
+ * ioctls. It is only tried, as the shrinker may run from an allocation
+ * made under it; the pools are left alone if it is busy.
+ */
+static unsigned long
+lnet_rtrpools_scan(unsigned long nr)
+{
+	struct lnet_rtrbufpool *rtrp;
+	struct lnet_rtrbuf *rb;
+	struct list_head tmp;
+	unsigned long freed = 0;
+	int i;
+	int j;
+
+	if (!mutex_trylock(&the_lnet.ln_api_mutex))
+		return SHRINK_STOP;
+
+	if (the_lnet.ln_rtrpools == NULL) {
+		mutex_unlock(&the_lnet.ln_api_mutex);
+		return SHRINK_STOP;
+	}
+
+	cfs_percpt_for_each(rtrp, i, the_lnet.ln_rtrpools) {
+		for (j = LNET_NRBPOOLS - 1; j >= 0 && freed < nr; j--) {
+			struct lnet_rtrbufpool *rbp = &rtrp[j];
+			int npages = max(rbp->rbp_npages, 1);
+			int target;
+
+			INIT_LIST_HEAD(&tmp);
+
+			lnet_net_lock(i);
+			if (rbp->rbp_req_nbuffers <= rbp->rbp_base_nbuffers) {
+				lnet_net_unlock(i);
+				continue;
+			}
+			target = rbp->rbp_req_nbuffers -
+				 DIV_ROUND_UP(nr - freed, npages);
+			target = max(target, rbp->rbp_base_nbuffers);
+			rbp->rbp_req_nbuffers = target;
+			while (rbp->rbp_nbuffers > target &&
+			       rbp->rbp_credits > 0) {
+				rb = list_entry(rbp->rbp_bufs.next,
+						struct lnet_rtrbuf, rb_list);
+				list_move(&rb->rb_list, &tmp);
+				rbp->rbp_nbuffers--;
+				rbp->rbp_credits--;
+				freed += npages;
+			}
+			lnet_net_unlock(i);
+
+			while (!list_empty(&tmp)) {
+				rb = list_entry(tmp.next, struct lnet_rtrbuf,
+						rb_list);
+				list_del(&rb->rb_list);
+				lnet_destroy_rtrbuf(rb, rbp->rbp_npages);
+			}
+		}
+	}
+	mutex_unlock(&the_lnet.ln_api_mutex);
+
+	return freed;
+}
+
+#ifdef HAVE_SHRINKER_COUNT
+static unsigned long
+lnet_rtrpools_shrink_count(struct shrinker *s, struct shrink_control *sc)
+{
+	return lnet_rtrpools_count();
+}
+
+static unsigned long
+lnet_rtrpools_shrink_scan(struct shrinker *s, struct shrink_control *sc)
+{
+	return lnet_rtrpools_scan(sc->nr_to_scan);
+}
+#else
+static int
+lnet_rtrpools_shrink(SHRINKER_ARGS(sc, nr_to_scan, gfp_mask))
+{
+	unsigned long nr = shrink_param(sc, nr_to_scan);
+
+	if (nr != 0)
+		lnet_rtrpools_scan(nr);
+
+	return lnet_rtrpools_count();
+}
+#endif
+
+static struct shrinker *lnet_rtrpools_shrinker;
+
+static void
+lnet_rtrpools_shrinker_init(void)
+{
+	DEF_SHRINKER_VAR(shvar, lnet_rtrpools_shrink,
+			 lnet_rtrpools_shrink_count,
+			 lnet_rtrpools_shrink_scan);
+
+	if (lnet_rtrpools_shrinker == NULL)
+		lnet_rtrpools_shrinker = set_shrinker(DEFAULT_SEEKS, &shvar);
+}
+
+static void
+lnet_rtrpools_shrinker_fini(void)
+{
+	if (lnet_rtrpools_shrinker != NULL) {
+		remove_shrinker(lnet_rtrpools_shrinker);
+		lnet_rtrpools_shrinker = NULL;
+	}
+}
+
 static void
 lnet_rtrpool_init(struct lnet_rtrbufpool *rbp, int npages)
 {
@@ -1478,6 +1727,10 @@ lnet_rtrpool_init(struct lnet_rtrbufpool *rbp, int npages)
 	rbp->rbp_npages = npages;
 	rbp->rbp_credits = 0;
 	rbp->rbp_mincredits = 0;
+	rbp->rbp_base_nbuffers = 0;
+	rbp->rbp_auto_mincredits = 0;
+	rbp->rbp_auto_maxwait = 0;
+	memset(rbp->rbp_wait_hist, 0, sizeof(rbp->rbp_wait_hist));
 }
 
 void
@@ -1489,6 +1742,9 @@ lnet_rtrpools_free(int keep_pools)
 	if (the_lnet.ln_rtrpools == NULL) /* uninitialized or freed */
 		return;
 
+	if (!keep_pools)
+		lnet_rtrpools_shrinker_fini();
+
 	cfs_percpt_for_each(rtrp, i, the_lnet.ln_rtrpools) {
 		lnet_rtrpool_free_bufs(&rtrp[LNET_TINY_BUF_IDX], i);
 		lnet_rtrpool_free_bufs(&rtrp[LNET_SMALL_BUF_IDX], i);
@@ -1626,6 +1882,8 @@ lnet_rtrpools_alloc(int im_a_router)
 			goto failed;
 	}
 
+	lnet_rtrpools_shrinker_init();
+
 	lnet_net_lock(LNET_LOCK_EX);
 	the_lnet.ln_routing = 1;
 	lnet_net_unlock(LNET_LOCK_EX);
@@ -136,6 +136,37 @@ proc_lnet_stats(struct ctl_table *table, int write, void __user *buffer,
 				    __proc_lnet_stats);
 }
 
+static int __proc_lnet_lolnd(void *data, int write,
+			     loff_t pos, void __user *buffer, int nob)
+{
+	char	tmpstr[128];
+	int	len;
+
+	if (write) {
+		atomic64_set(&lolnd_copy_bytes, 0);
+		atomic64_set(&lolnd_zero_copy_bytes, 0);
+		return 0;
+	}
+
+	len = snprintf(tmpstr, sizeof(tmpstr),
+		       "copy_bytes: %lld\nzero_copy_bytes: %lld",
+		       (long long)atomic64_read(&lolnd_copy_bytes),
+		       (long long)atomic64_read(&lolnd_zero_copy_bytes));
+
+	if (pos >= min_t(int, len, strlen(tmpstr)))
+		return 0;
+
+	return cfs_trace_copyout_string(buffer, nob, tmpstr + pos, "\n");
+}
+
+static int
+proc_lnet_lolnd(struct ctl_table *table, int write, void __user *buffer,
+		size_t *lenp, loff_t *ppos)
+{
+	return lprocfs_call_handler(table->data, write, ppos, buffer, lenp,
+				    __proc_lnet_lolnd);
+}
+
 static int
 proc_lnet_routes(struct ctl_table *table, int write, void __user *buffer,
 		 size_t *lenp, loff_t *ppos)
@@ -427,7 +458,7 @@ proc_lnet_peers(struct ctl_table *table, int write, void __user *buffer,
 						    &ptable->pt_hash[hash],
 						    lpni_hashlist) {
 					peer->lpni_mintxcredits =
-						peer->lpni_txcredits;
+					    atomic_read(&peer->lpni_txcredits);
 					peer->lpni_minrtrcredits =
 						peer->lpni_rtrcredits;
 				}
@@ -527,11 +558,11 @@ proc_lnet_peers(struct ctl_table *table, int write, void __user *buffer,
 			char *aliveness = "NA";
 			int maxcr = (peer->lpni_net) ?
 			  peer->lpni_net->net_tunables.lct_peer_tx_credits : 0;
-			int txcr = peer->lpni_txcredits;
+			int txcr = atomic_read(&peer->lpni_txcredits);
 			int mintxcr = peer->lpni_mintxcredits;
 			int rtrcr = peer->lpni_rtrcredits;
 			int minrtrcr = peer->lpni_minrtrcredits;
-			int txqnob = peer->lpni_txqnob;
+			int txqnob = atomic_long_read(&peer->lpni_txqnob);
 
 			if (lnet_isrouter(peer) ||
 			    lnet_peer_aliveness_enabled(peer))
@@ -952,6 +983,12 @@ static struct ctl_table lnet_table[] = {
 		.mode		= 0644,
 		.proc_handler	= &proc_lnet_portal_rotor,
 	},
+	{
+		INIT_CTL_NAME
+		.procname	= "lolnd_stats",
+		.mode		= 0644,
+		.proc_handler	= &proc_lnet_lolnd,
+	},
 	{ .procname = NULL }
 };
 
@@ -663,7 +663,7 @@ lst_batch_info_ioctl(struct lstio_batch_info_args *args)
 }
 
 static int
-lst_stat_query_ioctl(struct lstio_stat_args *args)
+lst_stat_query_ioctl(struct lstio_stat_args *args, int transop)
 {
         int             rc;
 	char           *name = NULL;
@@ -680,8 +680,8 @@ lst_stat_query_ioctl(struct lstio_stat_args *args)
 			return -EINVAL;
 
 		rc = lstcon_nodes_stat(args->lstio_sta_count,
-                                       args->lstio_sta_idsp,
-                                       args->lstio_sta_timeout,
+				       args->lstio_sta_idsp, transop,
+				       args->lstio_sta_timeout,
                                        args->lstio_sta_resultp);
 	} else if (args->lstio_sta_namep != NULL) {
 		if (args->lstio_sta_nmlen <= 0 ||
@@ -695,7 +695,8 @@ lst_stat_query_ioctl(struct lstio_stat_args *args)
 		rc = copy_from_user(name, args->lstio_sta_namep,
 				    args->lstio_sta_nmlen);
 		if (rc == 0)
-			rc = lstcon_group_stat(name, args->lstio_sta_timeout,
+			rc = lstcon_group_stat(name, transop,
+					       args->lstio_sta_timeout,
 					       args->lstio_sta_resultp);
 		else
 			rc = -EFAULT;
@@ -910,7 +911,12 @@ lstcon_ioctl_entry(struct notifier_block *nb,
 		rc = lst_test_add_ioctl((struct lstio_test_args *)buf);
 		break;
 	case LSTIO_STAT_QUERY:
-		rc = lst_stat_query_ioctl((struct lstio_stat_args *)buf);
+		rc = lst_stat_query_ioctl((struct lstio_stat_args *)buf,
+					  LST_TRANS_STATQRY);
+		break;
+	case LSTIO_LAT_QUERY:
+		rc = lst_stat_query_ioctl((struct lstio_stat_args *)buf,
+					  LST_TRANS_LATQRY);
 		break;
 	default:
 		rc = -EINVAL;
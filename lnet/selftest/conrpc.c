@@ -224,6 +224,9 @@ lstcon_rpc_trans_name(int transop)
         if (transop == LST_TRANS_STATQRY)
                 return "STATQRY";
 
+	if (transop == LST_TRANS_LATQRY)
+		return "LATQRY";
+
         return "Unknown";
 }
 
@@ -699,6 +702,25 @@ lstcon_statrpc_prep(struct lstcon_node *nd, unsigned int feats,
         return 0;
 }
 
+int
+lstcon_latrpc_prep(struct lstcon_node *nd, unsigned int feats, __u32 first,
+		   struct lstcon_rpc **crpc)
+{
+	struct srpc_lat_reqst *lrq;
+	int rc;
+
+	rc = lstcon_rpc_prep(nd, SRPC_SERVICE_QUERY_LAT, feats, 0, 0, crpc);
+	if (rc != 0)
+		return rc;
+
+	lrq = &(*crpc)->crp_rpc->crpc_reqstmsg.msg_body.lat_reqst;
+
+	lrq->lat_sid   = console_session.ses_id;
+	lrq->lat_first = first;
+
+	return 0;
+}
+
 static struct lnet_process_id_packed *
 lstcon_next_id(int idx, int nkiov, lnet_kiov_t *kiov)
 {
@@ -866,6 +888,8 @@ lstcon_testrpc_prep(struct lstcon_node *nd, int transop, unsigned int feats,
                 }
 
                 bulk->bk_sink = 0;
+		/* freed with the RPC, see lstcon_rpc_put() */
+		bulk->bk_swap = 1;
 
                 LASSERT (transop == LST_TRANS_TSBCLIADD);
 
@@ -972,6 +996,7 @@ lstcon_rpc_stat_reply(struct lstcon_rpc_trans *trans, struct srpc_msg *msg,
 	struct srpc_batch_reply *bat_rep;
 	struct srpc_test_reply *test_rep;
 	struct srpc_stat_reply *stat_rep;
+	struct srpc_lat_reply *lat_rep;
 	int rc = 0;
 
 	switch (trans->tas_opc) {
@@ -1073,6 +1098,18 @@ lstcon_rpc_stat_reply(struct lstcon_rpc_trans *trans, struct srpc_msg *msg,
                 rc = stat_rep->str_status;
                 break;
 
+	case LST_TRANS_LATQRY:
+		lat_rep = &msg->msg_body.lat_reply;
+
+		if (lat_rep->lat_status == 0) {
+			lstcon_statqry_stat_success(stat, 1);
+			return;
+		}
+
+		lstcon_statqry_stat_failure(stat, 1);
+		rc = lat_rep->lat_status;
+		break;
+
         default:
                 LBUG();
         }
@@ -1146,6 +1183,10 @@ lstcon_rpc_trans_ndlist(struct list_head *ndlist,
 		case LST_TRANS_STATQRY:
 			rc = lstcon_statrpc_prep(nd, feats, &rpc);
                         break;
+		case LST_TRANS_LATQRY:
+			rc = lstcon_latrpc_prep(nd, feats, *(__u32 *)arg,
+						&rpc);
+			break;
                 default:
                         rc = -EINVAL;
                         break;
@@ -1492,13 +1492,71 @@ lstcon_statrpc_readent(int transop, struct srpc_msg *msg,
 }
 
 static int
-lstcon_ndlist_stat(struct list_head *ndlist,
+lstcon_latrpc_readent(int transop, struct srpc_msg *msg,
+		      struct lstcon_rpc_ent __user *ent_up)
+{
+	struct srpc_lat_reply *rep = &msg->msg_body.lat_reply;
+	__u32 __user *hist = (__u32 __user *)&ent_up->rpe_payload[0];
+
+	if (rep->lat_status != 0)
+		return 0;
+
+	if (rep->lat_first >= LST_LAT_BUCKETS ||
+	    rep->lat_first % SRPC_LAT_PAGE_BUCKETS != 0)
+		return -EPROTO;
+
+	if (copy_to_user(&hist[rep->lat_first], rep->lat_hist,
+			 sizeof(rep->lat_hist)))
+		return -EFAULT;
+
+	return 0;
+}
+
+static int
+lstcon_ndlist_lat(struct list_head *ndlist,
+		  int timeout, struct list_head __user *result_up)
+{
+	struct list_head head;
+	struct lstcon_rpc_trans *trans;
+	__u32 first;
+	int rc = 0;
+
+	if ((console_session.ses_features & LST_FEAT_LAT_HIST) == 0)
+		return -EOPNOTSUPP;
+
+	/* the histogram doesn't fit in one reply, fetch it page by page */
+	for (first = 0; first < LST_LAT_BUCKETS && rc == 0;
+	     first += SRPC_LAT_PAGE_BUCKETS) {
+		INIT_LIST_HEAD(&head);
+
+		rc = lstcon_rpc_trans_ndlist(ndlist, &head, LST_TRANS_LATQRY,
+					     &first, NULL, &trans);
+		if (rc != 0) {
+			CERROR("Can't create transaction: %d\n", rc);
+			return rc;
+		}
+
+		lstcon_rpc_trans_postwait(trans, LST_VALIDATE_TIMEOUT(timeout));
+
+		rc = lstcon_rpc_trans_interpreter(trans, result_up,
+						  lstcon_latrpc_readent);
+		lstcon_rpc_trans_destroy(trans);
+	}
+
+	return rc;
+}
+
+static int
+lstcon_ndlist_stat(struct list_head *ndlist, int transop,
 		   int timeout, struct list_head __user *result_up)
 {
 	struct list_head    head;
 	struct lstcon_rpc_trans *trans;
 	int		    rc;
 
+	if (transop == LST_TRANS_LATQRY)
+		return lstcon_ndlist_lat(ndlist, timeout, result_up);
+
 	INIT_LIST_HEAD(&head);
 
         rc = lstcon_rpc_trans_ndlist(ndlist, &head,
@@ -1518,7 +1576,7 @@ lstcon_ndlist_stat(struct list_head *ndlist,
 }
 
 int
-lstcon_group_stat(char *grp_name, int timeout,
+lstcon_group_stat(char *grp_name, int transop, int timeout,
 		  struct list_head __user *result_up)
 {
 	struct lstcon_group *grp;
@@ -1530,7 +1588,8 @@ lstcon_group_stat(char *grp_name, int timeout,
                 return rc;
         }
 
-        rc = lstcon_ndlist_stat(&grp->grp_ndl_list, timeout, result_up);
+	rc = lstcon_ndlist_stat(&grp->grp_ndl_list, transop, timeout,
+				result_up);
 
 	lstcon_group_decref(grp);
 
@@ -1539,7 +1598,7 @@ lstcon_group_stat(char *grp_name, int timeout,
 
 int
 lstcon_nodes_stat(int count, struct lnet_process_id __user *ids_up,
-		  int timeout, struct list_head __user *result_up)
+		  int transop, int timeout, struct list_head __user *result_up)
 {
 	struct lstcon_ndlink *ndl;
 	struct lstcon_group *tmp;
@@ -1574,7 +1633,8 @@ lstcon_nodes_stat(int count, struct lnet_process_id __user *ids_up,
                 return rc;
         }
 
-        rc = lstcon_ndlist_stat(&tmp->grp_ndl_list, timeout, result_up);
+	rc = lstcon_ndlist_stat(&tmp->grp_ndl_list, transop, timeout,
+				result_up);
 
 	lstcon_group_decref(tmp);
 
@@ -410,6 +410,61 @@ sfw_get_stats(struct srpc_stat_reqst *request, struct srpc_stat_reply *reply)
 	return 0;
 }
 
+/* map a latency to its bucket, see LST_LAT_BUCKETS */
+static int
+sfw_lat_bucket(s64 usec)
+{
+	int msb;
+	int idx;
+
+	if (usec < (1 << LST_LAT_SUB_BITS))
+		return usec < 0 ? 0 : usec;
+
+	msb = fls64(usec) - 1;
+	idx = ((msb - LST_LAT_SUB_BITS + 1) << LST_LAT_SUB_BITS) +
+	      ((usec >> (msb - LST_LAT_SUB_BITS)) &
+	       ((1 << LST_LAT_SUB_BITS) - 1));
+
+	return min(idx, LST_LAT_BUCKETS - 1);
+}
+
+void
+sfw_lat_record(struct sfw_session *sn, struct srpc_client_rpc *rpc)
+{
+	s64 usec = ktime_us_delta(ktime_get(), rpc->crpc_start);
+
+	atomic_inc(&sn->sn_lat_hist[sfw_lat_bucket(usec)]);
+}
+
+static int
+sfw_get_latency(struct srpc_lat_reqst *request, struct srpc_lat_reply *reply)
+{
+	struct sfw_session *sn = sfw_data.fw_session;
+	int i;
+
+	reply->lat_sid = (sn == NULL) ? LST_INVALID_SID : sn->sn_id;
+	reply->lat_first = request->lat_first;
+
+	if (request->lat_sid.ses_nid == LNET_NID_ANY ||
+	    request->lat_first >= LST_LAT_BUCKETS ||
+	    request->lat_first % SRPC_LAT_PAGE_BUCKETS != 0) {
+		reply->lat_status = EINVAL;
+		return 0;
+	}
+
+	if (sn == NULL || !sfw_sid_equal(request->lat_sid, sn->sn_id)) {
+		reply->lat_status = ESRCH;
+		return 0;
+	}
+
+	for (i = 0; i < SRPC_LAT_PAGE_BUCKETS; i++)
+		reply->lat_hist[i] =
+			atomic_read(&sn->sn_lat_hist[request->lat_first + i]);
+
+	reply->lat_status = 0;
+	return 0;
+}
+
 int
 sfw_make_session(struct srpc_mksn_reqst *request, struct srpc_mksn_reply *reply)
 {
@@ -1125,6 +1180,8 @@ sfw_alloc_pages(struct srpc_server_rpc *rpc, int cpt, int npages, int len,
 	if (rpc->srpc_bulk == NULL)
 		return -ENOMEM;
 
+	/* freed with the RPC, see sfw_server_rpc_done() */
+	rpc->srpc_bulk->bk_swap = 1;
 	return 0;
 }
 
@@ -1315,6 +1372,11 @@ sfw_handle_server_rpc(struct srpc_server_rpc *rpc)
                                    &reply->msg_body.stat_reply);
                 break;
 
+	case SRPC_SERVICE_QUERY_LAT:
+		rc = sfw_get_latency(&request->msg_body.lat_reqst,
+				     &reply->msg_body.lat_reply);
+		break;
+
         case SRPC_SERVICE_DEBUG:
                 rc = sfw_debug_session(&request->msg_body.dbg_reqst,
                                        &reply->msg_body.dbg_reply);
@@ -1460,6 +1522,27 @@ sfw_unpack_message(struct srpc_msg *msg)
                 return;
         }
 
+	if (msg->msg_type == SRPC_MSG_LAT_REQST) {
+		struct srpc_lat_reqst *req = &msg->msg_body.lat_reqst;
+
+		__swab64s(&req->lat_rpyid);
+		sfw_unpack_sid(req->lat_sid);
+		__swab32s(&req->lat_first);
+		return;
+	}
+
+	if (msg->msg_type == SRPC_MSG_LAT_REPLY) {
+		struct srpc_lat_reply *rep = &msg->msg_body.lat_reply;
+		int i;
+
+		__swab32s(&rep->lat_status);
+		sfw_unpack_sid(rep->lat_sid);
+		__swab32s(&rep->lat_first);
+		for (i = 0; i < SRPC_LAT_PAGE_BUCKETS; i++)
+			__swab32s(&rep->lat_hist[i]);
+		return;
+	}
+
         if (msg->msg_type == SRPC_MSG_MKSN_REQST) {
 		struct srpc_mksn_reqst *req = &msg->msg_body.mksn_reqst;
 
@@ -1607,6 +1690,7 @@ sfw_post_rpc(struct srpc_client_rpc *rpc)
 static struct srpc_service sfw_services[] = {
 	{ .sv_id = SRPC_SERVICE_DEBUG,		.sv_name = "debug", },
 	{ .sv_id = SRPC_SERVICE_QUERY_STAT,	.sv_name = "query stats", },
+	{ .sv_id = SRPC_SERVICE_QUERY_LAT,	.sv_name = "query latency", },
 	{ .sv_id = SRPC_SERVICE_MAKE_SESSION,	.sv_name = "make session", },
 	{ .sv_id = SRPC_SERVICE_REMOVE_SESSION,	.sv_name = "remove session", },
 	{ .sv_id = SRPC_SERVICE_BATCH,		.sv_name = "batch service", },
@@ -93,6 +93,9 @@ lnet_selftest_structure_assertion(void)
 	CLASSERT(offsetof(struct srpc_msg, msg_body.tes_reqst.tsr_ndest) == 78);
 	CLASSERT(sizeof(struct srpc_stat_reply) == 136);
 	CLASSERT(sizeof(struct srpc_stat_reqst) == 28);
+	CLASSERT(sizeof(struct srpc_lat_reply) == 136);
+	CLASSERT(sizeof(struct srpc_lat_reqst) == 28);
+	CLASSERT(LST_LAT_BUCKETS % SRPC_LAT_PAGE_BUCKETS == 0);
 
 }
 
@@ -843,6 +843,8 @@ srpc_prepare_bulk(struct srpc_client_rpc *rpc)
 
         opt = bk->bk_sink ? LNET_MD_OP_PUT : LNET_MD_OP_GET;
         opt |= LNET_MD_KIOV;
+	if (bk->bk_swap)
+		opt |= LNET_MD_KIOV_SWAP;
 
         ev->ev_fired = 0;
         ev->ev_data  = rpc;
@@ -873,6 +875,8 @@ srpc_do_bulk(struct srpc_server_rpc *rpc)
 
         opt = bk->bk_sink ? LNET_MD_OP_GET : LNET_MD_OP_PUT;
         opt |= LNET_MD_KIOV;
+	if (bk->bk_swap)
+		opt |= LNET_MD_KIOV_SWAP;
 
         ev->ev_fired = 0;
         ev->ev_data  = rpc;
@@ -1341,6 +1345,7 @@ srpc_post_rpc(struct srpc_client_rpc *rpc)
                 libcfs_id2str(rpc->crpc_dest), rpc->crpc_service,
                 rpc->crpc_timeout);
 
+	rpc->crpc_start = ktime_get();
         srpc_add_client_rpc_timer(rpc);
         swi_schedule_workitem(&rpc->crpc_wi);
         return;
@@ -59,6 +59,8 @@ enum srpc_msg_type {
         SRPC_MSG_PING_REPLY     = 15,
         SRPC_MSG_JOIN_REQST     = 16,
         SRPC_MSG_JOIN_REPLY     = 17,
+	SRPC_MSG_LAT_REQST	= 18,
+	SRPC_MSG_LAT_REPLY	= 19,
 };
 
 /* CAVEAT EMPTOR:
@@ -164,6 +166,22 @@ struct srpc_stat_reply {
 	struct lnet_counters_common str_lnet;
 } WIRE_ATTR;
 
+/* # of latency buckets that fit in one reply */
+#define SRPC_LAT_PAGE_BUCKETS	28
+
+struct srpc_lat_reqst {
+	__u64			lat_rpyid;	/* reply buffer matchbits */
+	struct lst_sid		lat_sid;	/* session id */
+	__u32			lat_first;	/* first bucket wanted */
+} WIRE_ATTR;
+
+struct srpc_lat_reply {
+	__u32			lat_status;
+	struct lst_sid		lat_sid;
+	__u32			lat_first;	/* first bucket returned */
+	__u32			lat_hist[SRPC_LAT_PAGE_BUCKETS];
+} WIRE_ATTR;
+
 struct test_bulk_req {
         __u32                   blk_opc;        /* bulk operation code */
         __u32                   blk_npg;        /* # of pages */
@@ -266,6 +284,8 @@ struct srpc_msg {
 		struct srpc_batch_reply		bat_reply;
 		struct srpc_stat_reqst		stat_reqst;
 		struct srpc_stat_reply		stat_reply;
+		struct srpc_lat_reqst		lat_reqst;
+		struct srpc_lat_reply		lat_reply;
 		struct srpc_test_reqst		tes_reqst;
 		struct srpc_test_reply		tes_reply;
 		struct srpc_join_reqst		join_reqst;
@@ -77,6 +77,7 @@ struct sfw_test_instance;
 #define SRPC_SERVICE_TEST               4
 #define SRPC_SERVICE_QUERY_STAT         5
 #define SRPC_SERVICE_JOIN               6
+#define SRPC_SERVICE_QUERY_LAT		7
 #define SRPC_FRAMEWORK_SERVICE_MAX_ID   10
 /* other services start from SRPC_FRAMEWORK_SERVICE_MAX_ID+1 */
 #define SRPC_SERVICE_BRW                11
@@ -121,6 +122,9 @@ srpc_service2request (int service)
 
         case SRPC_SERVICE_JOIN:
                 return SRPC_MSG_JOIN_REQST;
+
+	case SRPC_SERVICE_QUERY_LAT:
+		return SRPC_MSG_LAT_REQST;
         }
 }
 
@@ -154,6 +158,8 @@ struct srpc_bulk {
         int              bk_len;  /* len of bulk data */
 	struct lnet_handle_md bk_mdh;
         int              bk_sink; /* sink/source */
+	int		 bk_swap; /* pages owned by this bulk only,
+				   * see LNET_MD_KIOV_SWAP */
         int              bk_niov; /* # iov in bk_iovs */
         lnet_kiov_t      bk_iovs[0];
 };
@@ -204,6 +210,8 @@ struct srpc_client_rpc {
 	atomic_t		crpc_refcount;
 	/* # seconds to wait for reply */
 	int			crpc_timeout;
+	/* when the RPC was posted */
+	ktime_t			crpc_start;
 	struct stt_timer	crpc_timer;
 	struct swi_workitem	crpc_wi;
 	struct lnet_process_id	crpc_dest;
@@ -334,6 +342,8 @@ struct sfw_session {
 	atomic_t		sn_brw_errors;
 	atomic_t		sn_ping_errors;
 	ktime_t			sn_started;
+	/* latency of completed test RPCs, see LST_LAT_BUCKETS */
+	atomic_t		sn_lat_hist[LST_LAT_BUCKETS];
 };
 
 #define sfw_sid_equal(sid0, sid1)     ((sid0).ses_nid == (sid1).ses_nid && \
@@ -418,6 +428,7 @@ void sfw_abort_rpc(struct srpc_client_rpc *rpc);
 void sfw_post_rpc(struct srpc_client_rpc *rpc);
 void sfw_client_rpc_done(struct srpc_client_rpc *rpc);
 void sfw_unpack_message(struct srpc_msg *msg);
+void sfw_lat_record(struct sfw_session *sn, struct srpc_client_rpc *rpc);
 void sfw_free_pages(struct srpc_server_rpc *rpc);
 void sfw_add_bulk_page(struct srpc_bulk *bk, struct page *pg, int i);
 int sfw_alloc_pages(struct srpc_server_rpc *rpc, int cpt, int npages, int len,
@@ -2134,7 +2134,12 @@ int lustre_lnet_show_net(char *nw, int detail, int seq_no,
 	struct lnet_ioctl_config_lnd_tunables *lnd;
 	struct lnet_ioctl_element_stats *stats;
 	struct lnet_ioctl_element_msg_stats msg_stats;
-	struct lnet_ioctl_local_ni_hstats hstats;
+	/* the kernel returns the performance stats after the health stats
+	 * if there is room for them, older ones leave them zeroed */
+	struct {
+		struct lnet_ioctl_local_ni_hstats hs;
+		struct lnet_ioctl_element_perf_stats perf;
+	} hstats;
 	__u32 net = LNET_NIDNET(LNET_NID_ANY);
 	__u32 prev_net = LNET_NIDNET(LNET_NID_ANY);
 	int rc = LUSTRE_CFG_RC_OUT_OF_MEM, i, j;
@@ -2143,7 +2148,7 @@ int lustre_lnet_show_net(char *nw, int detail, int seq_no,
 		*net_node = NULL, *interfaces = NULL,
 		*item = NULL, *first_seq = NULL,
 		*tmp = NULL, *statistics = NULL,
-		*yhstats = NULL;
+		*yhstats = NULL, *yperf = NULL;
 	int str_buf_len = LNET_MAX_SHOW_NUM_CPT * 2;
 	char str_buf[str_buf_len];
 	char *pos;
@@ -2335,8 +2340,8 @@ int lustre_lnet_show_net(char *nw, int detail, int seq_no,
 					goto out;
 			}
 
-			LIBCFS_IOC_INIT_V2(hstats, hlni_hdr);
-			hstats.hlni_nid = ni_data->lic_nid;
+			LIBCFS_IOC_INIT_V2(hstats, hs.hlni_hdr);
+			hstats.hs.hlni_nid = ni_data->lic_nid;
 			/* grab health stats */
 			rc = l_ioctl(LNET_DEV_ID,
 				     IOC_LIBCFS_GET_LOCAL_HSTATS,
@@ -2349,31 +2354,42 @@ int lustre_lnet_show_net(char *nw, int detail, int seq_no,
 			if (!yhstats)
 				goto out;
 			if (cYAML_create_number(yhstats, "health value",
-						hstats.hlni_health_value)
+						hstats.hs.hlni_health_value)
 							== NULL)
 				goto out;
 			if (cYAML_create_number(yhstats, "interrupts",
-						hstats.hlni_local_interrupt)
+						hstats.hs.hlni_local_interrupt)
 							== NULL)
 				goto out;
 			if (cYAML_create_number(yhstats, "dropped",
-						hstats.hlni_local_dropped)
+						hstats.hs.hlni_local_dropped)
 							== NULL)
 				goto out;
 			if (cYAML_create_number(yhstats, "aborted",
-						hstats.hlni_local_aborted)
+						hstats.hs.hlni_local_aborted)
 							== NULL)
 				goto out;
 			if (cYAML_create_number(yhstats, "no route",
-						hstats.hlni_local_no_route)
+						hstats.hs.hlni_local_no_route)
 							== NULL)
 				goto out;
 			if (cYAML_create_number(yhstats, "timeouts",
-						hstats.hlni_local_timeout)
+						hstats.hs.hlni_local_timeout)
 							== NULL)
 				goto out;
 			if (cYAML_create_number(yhstats, "error",
-						hstats.hlni_local_error)
+						hstats.hs.hlni_local_error)
+							== NULL)
+				goto out;
+			yperf = cYAML_create_object(item, "performance");
+			if (!yperf)
+				goto out;
+			if (cYAML_create_number(yperf, "bandwidth (KiB/s)",
+						hstats.perf.iep_bandwidth)
+							== NULL)
+				goto out;
+			if (cYAML_create_number(yperf, "latency (usec)",
+						hstats.perf.iep_latency)
 							== NULL)
 				goto out;
 
@@ -2711,22 +2727,25 @@ int lustre_lnet_show_routing(int seq_no, struct cYAML **show_rc,
 {
 	struct lnet_ioctl_config_data *data;
 	struct lnet_ioctl_pool_cfg *pool_cfg = NULL;
+	struct lnet_ioctl_pool_wait_hist *wait_hist = NULL;
 	int rc = LUSTRE_CFG_RC_OUT_OF_MEM;
 	int l_errno = 0;
 	char *buf;
 	char *pools[LNET_NRBPOOLS] = {"tiny", "small", "large"};
+	const char *wait_buckets[LNET_RTRPOOL_WAIT_BUCKETS] = {
+		"none", "16us", "64us", "256us", "1ms", "4ms", "16ms", "more" };
 	int buf_count[LNET_NRBPOOLS] = {0};
 	struct cYAML *root = NULL, *pools_node = NULL,
 		     *type_node = NULL, *item = NULL, *cpt = NULL,
-		     *first_seq = NULL, *buffers = NULL;
-	int i, j;
+		     *first_seq = NULL, *buffers = NULL, *wait_node = NULL;
+	int i, j, k;
 	char err_str[LNET_MAX_STR_LEN];
 	char node_name[LNET_MAX_STR_LEN];
 	bool exist = false;
 
 	snprintf(err_str, sizeof(err_str), "\"out of memory\"");
 
-	buf = calloc(1, sizeof(*data) + sizeof(*pool_cfg));
+	buf = calloc(1, sizeof(*data) + sizeof(*pool_cfg) + sizeof(*wait_hist));
 	if (buf == NULL)
 		goto out;
 
@@ -2746,7 +2765,8 @@ int lustre_lnet_show_routing(int seq_no, struct cYAML **show_rc,
 	for (i = 0;; i++) {
 		LIBCFS_IOC_INIT_V2(*data, cfg_hdr);
 		data->cfg_hdr.ioc_len = sizeof(struct lnet_ioctl_config_data) +
-					sizeof(struct lnet_ioctl_pool_cfg);
+					sizeof(struct lnet_ioctl_pool_cfg) +
+					sizeof(struct lnet_ioctl_pool_wait_hist);
 		data->cfg_count = i;
 
 		rc = l_ioctl(LNET_DEV_ID, IOC_LIBCFS_GET_BUF, data);
@@ -2758,6 +2778,8 @@ int lustre_lnet_show_routing(int seq_no, struct cYAML **show_rc,
 		exist = true;
 
 		pool_cfg = (struct lnet_ioctl_pool_cfg *)data->cfg_bulk;
+		/* left zeroed by kernels without the histogram */
+		wait_hist = (struct lnet_ioctl_pool_wait_hist *)(pool_cfg + 1);
 
 		if (backup)
 			goto calculate_buffers;
@@ -2802,6 +2824,20 @@ calculate_buffers:
 						pool_cfg->pl_pools[j].
 						   pl_mincredits) == NULL)
 				goto out;
+			if (!backup) {
+				wait_node = cYAML_create_object(type_node,
+								"wait_hist");
+				if (wait_node == NULL)
+					goto out;
+				for (k = 0; k < LNET_RTRPOOL_WAIT_BUCKETS;
+				     k++) {
+					if (cYAML_create_number(wait_node,
+						(char *)wait_buckets[k],
+						wait_hist->pw_hist[j][k]) ==
+					    NULL)
+						goto out;
+				}
+			}
 			/* keep track of the total count for each of the
 			 * tiny, small and large buffers */
 			buf_count[j] += pool_cfg->pl_pools[j].pl_nbuffers;
@@ -2895,6 +2931,7 @@ int lustre_lnet_show_peer(char *knid, int detail, int seq_no,
 	struct lnet_ioctl_element_stats *lpni_stats;
 	struct lnet_ioctl_element_msg_stats *msg_stats;
 	struct lnet_ioctl_peer_ni_hstats *hstats;
+	struct lnet_ioctl_element_perf_stats *perf;
 	lnet_nid_t *nidp;
 	int rc = LUSTRE_CFG_RC_OUT_OF_MEM;
 	int i, j, k;
@@ -2904,7 +2941,7 @@ int lustre_lnet_show_peer(char *knid, int detail, int seq_no,
 	struct cYAML *root = NULL, *peer = NULL, *peer_ni = NULL,
 		     *first_seq = NULL, *peer_root = NULL, *tmp = NULL,
 		     *msg_statistics = NULL, *statistics = NULL,
-		     *yhstats;
+		     *yhstats, *yperf;
 	char err_str[LNET_MAX_STR_LEN];
 	struct lnet_process_id *list = NULL;
 	void *data = NULL;
@@ -3038,6 +3075,17 @@ int lustre_lnet_show_peer(char *knid, int detail, int seq_no,
 		if (tmp == NULL)
 			goto out;
 
+		/* the performance stats of all peer NIs follow the peer NI
+		 * records, older kernels do not return them */
+		perf = NULL;
+		if (peer_info.prcfg_size >= peer_info.prcfg_count *
+		    (sizeof(*nidp) + sizeof(*lpni_cri) + sizeof(*lpni_stats) +
+		     sizeof(*msg_stats) + sizeof(*hstats) + sizeof(*perf)))
+			perf = data + peer_info.prcfg_count *
+			       (sizeof(*nidp) + sizeof(*lpni_cri) +
+				sizeof(*lpni_stats) + sizeof(*msg_stats) +
+				sizeof(*hstats));
+
 		lpni_data = data;
 		for (j = 0; j < peer_info.prcfg_count; j++) {
 			nidp = lpni_data;
@@ -3163,6 +3211,19 @@ int lustre_lnet_show_peer(char *knid, int detail, int seq_no,
 						hstats->hlpni_network_timeout)
 							== NULL)
 				goto out;
+			if (!perf)
+				continue;
+			yperf = cYAML_create_object(peer_ni, "performance");
+			if (!yperf)
+				goto out;
+			if (cYAML_create_number(yperf, "bandwidth (KiB/s)",
+						perf[j].iep_bandwidth)
+							== NULL)
+				goto out;
+			if (cYAML_create_number(yperf, "latency (usec)",
+						perf[j].iep_latency)
+							== NULL)
+				goto out;
 		}
 	}
 
@@ -1501,12 +1501,30 @@ lst_stat_ioctl(char *name, int count, struct lnet_process_id *idsp,
 	return lst_ioctl(LSTIO_STAT_QUERY, &args, sizeof(args));
 }
 
+int
+lst_lat_ioctl(char *name, int count, struct lnet_process_id *idsp,
+	      int timeout, struct list_head *resultp)
+{
+	struct lstio_stat_args args = { 0 };
+
+	args.lstio_sta_key     = session_key;
+	args.lstio_sta_timeout = timeout;
+	args.lstio_sta_nmlen   = strlen(name);
+	args.lstio_sta_namep   = name;
+	args.lstio_sta_count   = count;
+	args.lstio_sta_idsp    = idsp;
+	args.lstio_sta_resultp = resultp;
+
+	return lst_ioctl(LSTIO_LAT_QUERY, &args, sizeof(args));
+}
+
 typedef struct {
 	struct list_head              srp_link;
         int                     srp_count;
         char                   *srp_name;
 	struct lnet_process_id      *srp_ids;
 	struct list_head              srp_result[2];
+	struct list_head	srp_lat[2];	/* latency histograms */
 } lst_stat_req_param_t;
 
 static void
@@ -1514,8 +1532,10 @@ lst_stat_req_param_free(lst_stat_req_param_t *srp)
 {
         int     i;
 
-        for (i = 0; i < 2; i++)
-                lst_free_rpcent(&srp->srp_result[i]);
+	for (i = 0; i < 2; i++) {
+		lst_free_rpcent(&srp->srp_result[i]);
+		lst_free_rpcent(&srp->srp_lat[i]);
+	}
 
         if (srp->srp_ids != NULL)
                 free(srp->srp_ids);
@@ -1524,7 +1544,8 @@ lst_stat_req_param_free(lst_stat_req_param_t *srp)
 }
 
 static int
-lst_stat_req_param_alloc(char *name, lst_stat_req_param_t **srpp, int save_old)
+lst_stat_req_param_alloc(char *name, lst_stat_req_param_t **srpp, int save_old,
+			 int lat)
 {
         lst_stat_req_param_t *srp = NULL;
         int                   count = save_old ? 2 : 1;
@@ -1538,6 +1559,8 @@ lst_stat_req_param_alloc(char *name, lst_stat_req_param_t **srpp, int save_old)
         memset(srp, 0, sizeof(*srp));
 	INIT_LIST_HEAD(&srp->srp_result[0]);
 	INIT_LIST_HEAD(&srp->srp_result[1]);
+	INIT_LIST_HEAD(&srp->srp_lat[0]);
+	INIT_LIST_HEAD(&srp->srp_lat[1]);
 
         rc = lst_get_node_count(LST_OPC_GROUP, name,
                                 &srp->srp_count, NULL);
@@ -1562,6 +1585,9 @@ lst_stat_req_param_alloc(char *name, lst_stat_req_param_t **srpp, int save_old)
 				      sizeof(struct sfw_counters)  +
 				      sizeof(struct srpc_counters) +
 				      sizeof(struct lnet_counters_common));
+		if (rc == 0 && lat)
+			rc = lst_alloc_rpcent(&srp->srp_lat[i], srp->srp_count,
+					      LST_LAT_BUCKETS * sizeof(__u32));
 		if (rc != 0) {
 			fprintf(stderr, "Out of memory\n");
 			break;
@@ -1767,10 +1793,203 @@ lst_print_lnet_stat(char *name, int bwrt, int rdwr, int type, int mbs)
 	}
 }
 
+#define LST_FMT_TEXT	0
+#define LST_FMT_YAML	1
+#define LST_FMT_JSON	2
+
+static int
+lst_fmt_parse(const char *str)
+{
+	if (strcasecmp(str, "text") == 0)
+		return LST_FMT_TEXT;
+	if (strcasecmp(str, "yaml") == 0)
+		return LST_FMT_YAML;
+	if (strcasecmp(str, "json") == 0)
+		return LST_FMT_JSON;
+
+	return -1;
+}
+
+/* percentiles reported from the latency histogram, in 1/1000 */
+static const int lst_lat_pcts[] = { 500, 900, 990, 999 };
+static const char *lst_lat_pct_names[] = { "p50", "p90", "p99", "p99.9" };
+#define LST_LAT_NPCTS	(sizeof(lst_lat_pcts) / sizeof(lst_lat_pcts[0]))
+
+typedef struct {
+	__u64		lat_count;		/* # of RPCs completed */
+	__u64		lat_pct[LST_LAT_NPCTS];	/* usec */
+	__u64		lat_max;		/* usec */
+} lst_lat_result_t;
+
+/* lowest latency (usec) counted by bucket @idx, see LST_LAT_BUCKETS */
+static __u64
+lst_lat_bucket_lower(int idx)
+{
+	int sub = 1 << LST_LAT_SUB_BITS;
+
+	if (idx < sub)
+		return idx;
+
+	return (__u64)(sub + idx % sub) << (idx / sub - 1);
+}
+
+/*
+ * Sum up the histograms collected since the previous sample of all nodes
+ * and derive the percentiles from that, each reported as the highest
+ * latency of the bucket it falls into.  Returns # of nodes accounted.
+ */
+static int
+lst_cal_lat(struct list_head *resultp, int idx, lst_lat_result_t *res)
+{
+	struct list_head *pnew = resultp[idx].next;
+	struct list_head *pold = resultp[1 - idx].next;
+	struct lstcon_rpc_ent *new;
+	struct lstcon_rpc_ent *old;
+	__u64 hist[LST_LAT_BUCKETS] = { 0 };
+	__u64 sum = 0;
+	int nodes = 0;
+	int i;
+	int j;
+
+	memset(res, 0, sizeof(*res));
+
+	for (; pnew != &resultp[idx] && pold != &resultp[1 - idx];
+	     pnew = pnew->next, pold = pold->next) {
+		__u32 *hnew;
+		__u32 *hold;
+
+		new = list_entry(pnew, struct lstcon_rpc_ent, rpe_link);
+		old = list_entry(pold, struct lstcon_rpc_ent, rpe_link);
+
+		/* first sample or the group has changed */
+		if (new->rpe_peer.nid == LNET_NID_ANY ||
+		    new->rpe_peer.nid != old->rpe_peer.nid ||
+		    new->rpe_peer.pid != old->rpe_peer.pid)
+			break;
+
+		if (new->rpe_rpc_errno != 0 || new->rpe_fwk_errno != 0 ||
+		    old->rpe_rpc_errno != 0 || old->rpe_fwk_errno != 0)
+			continue;
+
+		hnew = (__u32 *)&new->rpe_payload[0];
+		hold = (__u32 *)&old->rpe_payload[0];
+		for (i = 0; i < LST_LAT_BUCKETS; i++) {
+			hist[i] += (__u32)(hnew[i] - hold[i]);
+			res->lat_count += (__u32)(hnew[i] - hold[i]);
+		}
+		nodes++;
+	}
+
+	if (res->lat_count == 0)
+		return nodes;
+
+	for (i = 0, j = 0; i < LST_LAT_BUCKETS; i++) {
+		if (hist[i] == 0)
+			continue;
+
+		sum += hist[i];
+		res->lat_max = lst_lat_bucket_lower(i + 1) - 1;
+		while (j < LST_LAT_NPCTS &&
+		       sum * 1000 >= res->lat_count * lst_lat_pcts[j])
+			res->lat_pct[j++] = res->lat_max;
+	}
+
+	return nodes;
+}
+
 static void
-lst_print_stat(char *name, struct list_head *resultp,
-	       int idx, int lnet, int bwrt, int rdwr, int type,
-	       int mbs)
+lst_print_lat_stat(char *name, lst_lat_result_t *res)
+{
+	int i;
+
+	fprintf(stdout, "[LNet Latency of %s]\n", name);
+	fprintf(stdout, "[L] RPCs: %-8llu ",
+		(unsigned long long)res->lat_count);
+	for (i = 0; i < LST_LAT_NPCTS; i++)
+		fprintf(stdout, "%s: %-8llu ", lst_lat_pct_names[i],
+			(unsigned long long)res->lat_pct[i]);
+	fprintf(stdout, "Max: %-8llu usec\n",
+		(unsigned long long)res->lat_max);
+}
+
+/* one YAML sequence entry or one JSON object per line for each sample,
+ * \a errcount is the number of nodes that could not be sampled */
+static void
+lst_print_stat_fmt(char *name, int errcount, int lnet, lst_lat_result_t *lat,
+		   int mbs, int fmt)
+{
+	static const char *kinds[] = { "rates", "bandwidth" };
+	static const char *dirs[] = { "read", "write" };
+	int json = fmt == LST_FMT_JSON;
+	int i;
+	int j;
+
+	if (json)
+		fprintf(stdout, "{\"group\": \"%s\"", name);
+	else
+		fprintf(stdout, "- group: %s\n", name);
+
+	fprintf(stdout, json ? ", \"errors\": %d" : "  errors: %d\n",
+		errcount);
+
+	for (i = 0; lnet && i < 2; i++) {
+		if (json)
+			fprintf(stdout, ", \"%s\": {", kinds[i]);
+		else
+			fprintf(stdout, "  %s:\n", kinds[i]);
+
+		for (j = 0; j < 2; j++) {
+			if (json)
+				fprintf(stdout, "%s\"%s\": {\"avg\": %.2f, "
+					"\"min\": %.2f, \"max\": %.2f}",
+					j == 0 ? "" : ", ", dirs[j],
+					lst_lnet_stat_value(i, j, 0),
+					lst_lnet_stat_value(i, j, 1),
+					lst_lnet_stat_value(i, j, 2));
+			else
+				fprintf(stdout, "    %s: { avg: %.2f, "
+					"min: %.2f, max: %.2f }\n", dirs[j],
+					lst_lnet_stat_value(i, j, 0),
+					lst_lnet_stat_value(i, j, 1),
+					lst_lnet_stat_value(i, j, 2));
+		}
+
+		if (json)
+			fprintf(stdout, "}");
+	}
+
+	if (lnet) {
+		fprintf(stdout, json ? ", \"units\": \"%s\"" :
+				       "  units: %s\n",
+			mbs ? "MB/s" : "MiB/s");
+	}
+
+	if (lat != NULL) {
+		if (json)
+			fprintf(stdout, ", \"latency\": {\"rpcs\": %llu",
+				(unsigned long long)lat->lat_count);
+		else
+			fprintf(stdout, "  latency:\n    rpcs: %llu\n",
+				(unsigned long long)lat->lat_count);
+
+		for (i = 0; i < LST_LAT_NPCTS; i++)
+			fprintf(stdout, json ? ", \"%s\": %llu" :
+					       "    %s: %llu\n",
+				lst_lat_pct_names[i],
+				(unsigned long long)lat->lat_pct[i]);
+
+		fprintf(stdout, json ? ", \"max\": %llu}" : "    max: %llu\n",
+			(unsigned long long)lat->lat_max);
+	}
+
+	if (json)
+		fprintf(stdout, "}\n");
+	fflush(stdout);
+}
+
+/* calculate lnet_stat_result from two samples, returns # of failed nodes */
+static int
+lst_cal_stat(struct list_head *resultp, int idx, int lnet, int mbs)
 {
 	struct list_head tmp[2];
 	struct lstcon_rpc_ent *new;
@@ -1865,13 +2084,41 @@ lst_print_stat(char *name, struct list_head *resultp,
 	list_splice(&tmp[idx], &resultp[idx]);
 	list_splice(&tmp[1 - idx], &resultp[1 - idx]);
 
+	return errcount;
+}
+
+static void
+lst_print_stat(char *name, lst_stat_req_param_t *srp,
+	       int idx, int lnet, int lat, int bwrt, int rdwr, int type,
+	       int mbs, int fmt)
+{
+	lst_lat_result_t lat_result;
+	int lat_nodes = 0;
+	int errcount;
+
+	errcount = lst_cal_stat(srp->srp_result, idx, lnet, mbs);
+
+	if (lat)
+		lat_nodes = lst_cal_lat(srp->srp_lat, idx, &lat_result);
+
+	/* keep the output parseable, failures are counted in the record */
+	if (fmt != LST_FMT_TEXT) {
+		if ((lnet && lnet_stat_result.lnet_stat_count > 0) ||
+		    lat_nodes > 0 || errcount > 0)
+			lst_print_stat_fmt(name, errcount, lnet,
+					   lat_nodes > 0 ? &lat_result : NULL,
+					   mbs, fmt);
+		return;
+	}
+
 	if (errcount > 0)
 		fprintf(stdout, "Failed to stat on %d nodes\n", errcount);
 
-	if (!lnet)  /* TODO */
-		return;
+	if (lnet)
+		lst_print_lnet_stat(name, bwrt, rdwr, type, mbs);
 
-	lst_print_lnet_stat(name, bwrt, rdwr, type, mbs);
+	if (lat_nodes > 0)
+		lst_print_lat_stat(name, &lat_result);
 }
 
 int
@@ -1892,6 +2139,8 @@ jt_lst_stat(int argc, char **argv)
 	int		      rc;
 	int		      c;
 	int		      mbs     = 0; /* report as MB/s */
+	int		      lat     = 0; /* latency percentiles */
+	int		      fmt     = LST_FMT_TEXT;
 
 	static const struct option stat_opts[] = {
 		{ .name = "timeout", .has_arg = required_argument, .val = 't' },
@@ -1907,6 +2156,8 @@ jt_lst_stat(int argc, char **argv)
 		{ .name = "min",     .has_arg = no_argument,       .val = 'n' },
 		{ .name = "max",     .has_arg = no_argument,       .val = 'x' },
 		{ .name = "mbs",     .has_arg = no_argument,       .val = 'm' },
+		{ .name = "lat",     .has_arg = no_argument,       .val = 'L' },
+		{ .name = "format",  .has_arg = required_argument, .val = 'f' },
 		{ .name = NULL } };
 
         if (session_key == 0) {
@@ -1916,7 +2167,7 @@ jt_lst_stat(int argc, char **argv)
         }
 
         while (1) {
-		c = getopt_long(argc, argv, "t:d:lcbarwgnxm", stat_opts,
+		c = getopt_long(argc, argv, "t:d:lcbarwgnxmLf:", stat_opts,
 				&optidx);
 
                 if (c == -1)
@@ -1974,6 +2225,16 @@ jt_lst_stat(int argc, char **argv)
 		case 'm':
 			mbs = 1;
 			break;
+		case 'L':
+			lat = 1;
+			break;
+		case 'f':
+			fmt = lst_fmt_parse(optarg);
+			if (fmt < 0) {
+				fprintf(stderr, "Invalid format %s\n", optarg);
+				return -1;
+			}
+			break;
 
 		default:
 			lst_print_usage(argv[0]);
@@ -2003,7 +2264,7 @@ jt_lst_stat(int argc, char **argv)
 	INIT_LIST_HEAD(&head);
 
         while (optind < argc) {
-                rc = lst_stat_req_param_alloc(argv[optind++], &srp, 1);
+		rc = lst_stat_req_param_alloc(argv[optind++], &srp, 1, lat);
                 if (rc != 0)
                         goto out;
 
@@ -2029,10 +2290,31 @@ jt_lst_stat(int argc, char **argv)
                                 goto out;
                         }
 
-			lst_print_stat(srp->srp_name, srp->srp_result,
-				       idx, lnet, bwrt, rdwr, type, mbs);
+			if (lat) {
+				rc = lst_lat_ioctl(srp->srp_name,
+						   srp->srp_count,
+						   srp->srp_ids, timeout,
+						   &srp->srp_lat[idx]);
+				if (rc == -1 && errno == EOPNOTSUPP) {
+					fprintf(stderr, "Latency histogram "
+						"isn't supported by all nodes "
+						"of this session\n");
+					goto out;
+				}
+				if (rc == -1) {
+					lst_print_error("stat", "Failed to "
+							"get latency of %s: "
+							"%s\n", srp->srp_name,
+							strerror(errno));
+					goto out;
+				}
+			}
+
+			lst_print_stat(srp->srp_name, srp, idx, lnet, lat,
+				       bwrt, rdwr, type, mbs, fmt);
 
 			lst_reset_rpcent(&srp->srp_result[1 - idx]);
+			lst_reset_rpcent(&srp->srp_lat[1 - idx]);
 		}
 
                 idx = 1 - idx;
@@ -2101,7 +2383,7 @@ jt_lst_show_error(int argc, char **argv)
 	INIT_LIST_HEAD(&head);
 
         while (optind < argc) {
-                rc = lst_stat_req_param_alloc(argv[optind++], &srp, 0);
+                rc = lst_stat_req_param_alloc(argv[optind++], &srp, 0, 0);
                 if (rc != 0)
                         goto out;
 
@@ -3244,6 +3526,427 @@ out:
         return rc;
 }
 
+#define LST_SWEEP_MAX	16
+
+/* parse comma separated positive numbers with optional K/M suffix */
+static int
+lst_parse_sweep_list(char *str, int *vals, int max)
+{
+	char *end;
+	long val;
+	int n = 0;
+
+	while (*str != '\0') {
+		if (n == max)
+			return -1;
+
+		val = strtol(str, &end, 0);
+		if (end == str || val <= 0)
+			return -1;
+
+		if (*end == 'k' || *end == 'K') {
+			val *= 1024;
+			end++;
+		} else if (*end == 'm' || *end == 'M') {
+			val *= 1024 * 1024;
+			end++;
+		}
+
+		if (*end == ',')
+			end++;
+		else if (*end != '\0')
+			return -1;
+
+		vals[n++] = val;
+		str = end;
+	}
+
+	return n;
+}
+
+static void
+lst_print_sweep_row(int concur, int size, lst_lat_result_t *lat, int mbs,
+		    int fmt, int first)
+{
+	float rate_r = lnet_stat_result.lnet_total_rcvrate;
+	float rate_w = lnet_stat_result.lnet_total_sndrate;
+	float bw_r = lnet_stat_result.lnet_total_rcvperf;
+	float bw_w = lnet_stat_result.lnet_total_sndperf;
+	int i;
+
+	switch (fmt) {
+	case LST_FMT_TEXT:
+		if (first) {
+			fprintf(stdout, "%-8s %-8s %10s %10s %10s %10s",
+				"concur", "size", "RPC/s(R)", "RPC/s(W)",
+				mbs ? "MB/s(R)" : "MiB/s(R)",
+				mbs ? "MB/s(W)" : "MiB/s(W)");
+			for (i = 0; i < LST_LAT_NPCTS; i++)
+				fprintf(stdout, " %8s", lst_lat_pct_names[i]);
+			fprintf(stdout, " %8s\n", "max(us)");
+		}
+
+		fprintf(stdout, "%-8d %-8d %10.0f %10.0f %10.2f %10.2f",
+			concur, size, rate_r, rate_w, bw_r, bw_w);
+		for (i = 0; i < LST_LAT_NPCTS; i++)
+			fprintf(stdout, " %8llu",
+				(unsigned long long)lat->lat_pct[i]);
+		fprintf(stdout, " %8llu\n", (unsigned long long)lat->lat_max);
+		break;
+
+	case LST_FMT_YAML:
+		fprintf(stdout, "- concurrency: %d\n  size: %d\n"
+			"  rates: { read: %.0f, write: %.0f }\n"
+			"  bandwidth: { read: %.2f, write: %.2f }\n"
+			"  units: %s\n  latency:\n    rpcs: %llu\n",
+			concur, size, rate_r, rate_w, bw_r, bw_w,
+			mbs ? "MB/s" : "MiB/s",
+			(unsigned long long)lat->lat_count);
+		for (i = 0; i < LST_LAT_NPCTS; i++)
+			fprintf(stdout, "    %s: %llu\n", lst_lat_pct_names[i],
+				(unsigned long long)lat->lat_pct[i]);
+		fprintf(stdout, "    max: %llu\n",
+			(unsigned long long)lat->lat_max);
+		break;
+
+	case LST_FMT_JSON:
+		fprintf(stdout, "{\"concurrency\": %d, \"size\": %d, "
+			"\"rates\": {\"read\": %.0f, \"write\": %.0f}, "
+			"\"bandwidth\": {\"read\": %.2f, \"write\": %.2f}, "
+			"\"units\": \"%s\", \"latency\": {\"rpcs\": %llu",
+			concur, size, rate_r, rate_w, bw_r, bw_w,
+			mbs ? "MB/s" : "MiB/s",
+			(unsigned long long)lat->lat_count);
+		for (i = 0; i < LST_LAT_NPCTS; i++)
+			fprintf(stdout, ", \"%s\": %llu", lst_lat_pct_names[i],
+				(unsigned long long)lat->lat_pct[i]);
+		fprintf(stdout, ", \"max\": %llu}}\n",
+			(unsigned long long)lat->lat_max);
+		break;
+	}
+	fflush(stdout);
+}
+
+static int
+lst_sweep_sample(lst_stat_req_param_t *srp, int idx, int timeout)
+{
+	int rc;
+
+	lst_reset_rpcent(&srp->srp_result[idx]);
+	lst_reset_rpcent(&srp->srp_lat[idx]);
+
+	rc = lst_stat_ioctl(srp->srp_name, srp->srp_count, srp->srp_ids,
+			    timeout, &srp->srp_result[idx]);
+	if (rc == -1)
+		return rc;
+
+	return lst_lat_ioctl(srp->srp_name, srp->srp_count, srp->srp_ids,
+			     timeout, &srp->srp_lat[idx]);
+}
+
+/* run one step of the sweep in its own batch and sample the clients */
+static int
+lst_sweep_step(char *batch, int type, int concur, int dist, int span,
+	       char *from, char *to, void *param, int plen, int duration,
+	       int timeout, int mbs, lst_stat_req_param_t *srp,
+	       struct list_head *head, lst_lat_result_t *lat)
+{
+	int ret = 0;
+	int rc;
+
+	rc = lst_add_batch_ioctl(batch);
+	if (rc != 0) {
+		lst_print_error("batch", "Failed to create batch %s: %s\n",
+				batch, strerror(errno));
+		return -1;
+	}
+
+	lst_reset_rpcent(head);
+	rc = lst_add_test_ioctl(batch, type, -1, concur, dist, span,
+				from, to, param, plen, &ret, head);
+	if (rc != 0) {
+		if (rc == -1)
+			lst_print_error("test", "Failed to add test: %s\n",
+					strerror(errno));
+		else
+			lst_print_transerr(head, "add test");
+		return -1;
+	}
+
+	lst_reset_rpcent(head);
+	rc = lst_start_batch_ioctl(batch, timeout, head);
+	if (rc != 0) {
+		if (rc == -1)
+			lst_print_error("batch", "Failed to start batch: %s\n",
+					strerror(errno));
+		else
+			lst_print_transerr(head, "run batch");
+		return -1;
+	}
+
+	rc = lst_sweep_sample(srp, 0, timeout);
+	if (rc != -1) {
+		sleep(duration);
+		rc = lst_sweep_sample(srp, 1, timeout);
+	}
+
+	if (rc == -1) {
+		lst_print_error("stat", "Failed to stat %s: %s\n",
+				srp->srp_name, strerror(errno));
+	} else {
+		rc = lst_cal_stat(srp->srp_result, 1, 1, mbs);
+		if (rc > 0)
+			fprintf(stderr, "Failed to stat on %d nodes\n", rc);
+		lst_cal_lat(srp->srp_lat, 1, lat);
+		rc = 0;
+	}
+
+	lst_reset_rpcent(head);
+	if (lst_stop_batch_ioctl(batch, 0, head) != 0) {
+		lst_print_transerr(head, "stop batch");
+		return -1;
+	}
+
+	/* don't let the next step overlap with this one */
+	while (1) {
+		lst_reset_rpcent(head);
+		if (lst_query_batch_ioctl(batch, 0, 0, timeout, head) != 0) {
+			lst_print_transerr(head, "query batch");
+			return -1;
+		}
+
+		if (lstcon_tsbqry_stat_run(&trans_stat, 0) == 0 &&
+		    lstcon_tsbqry_stat_failure(&trans_stat, 0) == 0)
+			break;
+
+		sleep(1);
+	}
+
+	return rc;
+}
+
+int
+jt_lst_sweep(int argc, char **argv)
+{
+	lst_stat_req_param_t *srp = NULL;
+	struct list_head head;
+	lst_lat_result_t lat;
+	char bname[LST_NAME_SIZE];
+	char sizebuf[32];
+	char **targv = NULL;
+	char *batch = "sweep";
+	char *cstr = "1";
+	char *dstr = NULL;
+	char *from = NULL;
+	char *to = NULL;
+	char *test;
+	void *param = NULL;
+	int concurs[LST_SWEEP_MAX];
+	int sizes[LST_SWEEP_MAX] = { 0 };
+	int nconcur;
+	int nsize = 1;
+	int sidx = -1;
+	int duration = 10;
+	int timeout = 5;
+	int fmt = LST_FMT_TEXT;
+	int mbs = 0;
+	int dist = 1;
+	int span = 1;
+	int fcount = 0;
+	int tcount = 0;
+	int optidx = 0;
+	int step = 0;
+	int plen = 0;
+	int type;
+	int rc;
+	int c;
+	int i;
+	int j;
+
+	static const struct option sweep_opts[] = {
+	{ .name = "batch",	 .has_arg = required_argument, .val = 'b' },
+	{ .name = "concurrency", .has_arg = required_argument, .val = 'c' },
+	{ .name = "distribute",	 .has_arg = required_argument, .val = 'd' },
+	{ .name = "duration",	 .has_arg = required_argument, .val = 'D' },
+	{ .name = "from",	 .has_arg = required_argument, .val = 'f' },
+	{ .name = "to",		 .has_arg = required_argument, .val = 't' },
+	{ .name = "timeout",	 .has_arg = required_argument, .val = 'T' },
+	{ .name = "format",	 .has_arg = required_argument, .val = 'F' },
+	{ .name = "mbs",	 .has_arg = no_argument,       .val = 'm' },
+	{ .name = NULL } };
+
+	if (session_key == 0) {
+		fprintf(stderr,
+			"Can't find env LST_SESSION or value is not valid\n");
+		return -1;
+	}
+
+	while (1) {
+		c = getopt_long(argc, argv, "b:c:d:D:f:t:T:F:m",
+				sweep_opts, &optidx);
+		if (c == -1)
+			break;
+
+		switch (c) {
+		case 'b':
+			batch = optarg;
+			break;
+		case 'c':
+			cstr = optarg;
+			break;
+		case 'd':
+			dstr = optarg;
+			break;
+		case 'D':
+			duration = atoi(optarg);
+			break;
+		case 'f':
+			from = optarg;
+			break;
+		case 't':
+			to = optarg;
+			break;
+		case 'T':
+			timeout = atoi(optarg);
+			break;
+		case 'F':
+			fmt = lst_fmt_parse(optarg);
+			if (fmt < 0) {
+				fprintf(stderr, "Invalid format %s\n", optarg);
+				return -1;
+			}
+			break;
+		case 'm':
+			mbs = 1;
+			break;
+		default:
+			lst_print_usage(argv[0]);
+			return -1;
+		}
+	}
+
+	if (optind == argc || from == NULL || to == NULL) {
+		lst_print_usage(argv[0]);
+		return -1;
+	}
+
+	/* room for the step number appended to the batch name */
+	if (strlen(batch) >= LST_NAME_SIZE - 4) {
+		fprintf(stderr, "Batch name length is limited to %d\n",
+			LST_NAME_SIZE - 5);
+		return -1;
+	}
+
+	if (duration <= 0 || timeout <= 0) {
+		fprintf(stderr, "Invalid duration or timeout value\n");
+		return -1;
+	}
+
+	nconcur = lst_parse_sweep_list(cstr, concurs, LST_SWEEP_MAX);
+	for (i = 0; i < nconcur; i++) {
+		if (concurs[i] > LST_MAX_CONCUR)
+			nconcur = -1;
+	}
+	if (nconcur <= 0) {
+		fprintf(stderr, "Invalid concurrency list: %s\n", cstr);
+		return -1;
+	}
+
+	if (dstr != NULL && lst_parse_distribute(dstr, &dist, &span) != 0) {
+		fprintf(stderr, "Invalid distribution: %s\n", dstr);
+		return -1;
+	}
+
+	test = argv[optind++];
+	argc -= optind;
+	argv += optind;
+
+	/* a list of sizes turns into one step per size */
+	targv = malloc(sizeof(*targv) * (argc + 1));
+	if (targv == NULL) {
+		fprintf(stderr, "Out of memory\n");
+		return -1;
+	}
+
+	for (i = 0; i < argc; i++) {
+		targv[i] = argv[i];
+		if (strncasecmp(argv[i], "size=", 5) == 0 ||
+		    strncasecmp(argv[i], "s=", 2) == 0)
+			sidx = i;
+	}
+	targv[argc] = NULL;
+
+	if (sidx >= 0) {
+		nsize = lst_parse_sweep_list(strchr(argv[sidx], '=') + 1,
+					     sizes, LST_SWEEP_MAX);
+		if (nsize <= 0) {
+			fprintf(stderr, "Invalid size list: %s\n", argv[sidx]);
+			free(targv);
+			return -1;
+		}
+	}
+
+	INIT_LIST_HEAD(&head);
+
+	rc = lst_get_node_count(LST_OPC_GROUP, from, &fcount, NULL);
+	if (rc == 0)
+		rc = lst_get_node_count(LST_OPC_GROUP, to, &tcount, NULL);
+	if (rc != 0) {
+		fprintf(stderr, "Can't get count of nodes from %s/%s: %s\n",
+			from, to, strerror(errno));
+		goto out;
+	}
+
+	rc = lst_alloc_rpcent(&head, fcount > tcount ? fcount : tcount, 0);
+	if (rc != 0) {
+		fprintf(stderr, "Out of memory\n");
+		goto out;
+	}
+
+	/* clients complete the RPCs, so they see the latency */
+	rc = lst_stat_req_param_alloc(from, &srp, 1, 1);
+	if (rc != 0)
+		goto out;
+
+	for (i = 0; i < nsize; i++) {
+		if (sidx >= 0) {
+			snprintf(sizebuf, sizeof(sizebuf), "size=%d", sizes[i]);
+			targv[sidx] = sizebuf;
+		}
+
+		type = lst_get_test_param(test, argc, targv, &param, &plen);
+		if (type < 0) {
+			fprintf(stderr, "Failed to add test (%s)\n", test);
+			rc = -1;
+			goto out;
+		}
+
+		for (j = 0; j < nconcur; j++, step++) {
+			snprintf(bname, sizeof(bname), "%s_%d", batch, step);
+
+			rc = lst_sweep_step(bname, type, concurs[j], dist, span,
+					    from, to, param, plen, duration,
+					    timeout, mbs, srp, &head, &lat);
+			if (rc != 0)
+				goto out;
+
+			lst_print_sweep_row(concurs[j], sizes[i], &lat, mbs,
+					    fmt, step == 0);
+		}
+
+		free(param);
+		param = NULL;
+	}
+out:
+	if (srp != NULL)
+		lst_stat_req_param_free(srp);
+	lst_free_rpcent(&head);
+	free(param);
+	free(targv);
+
+	return rc;
+}
+
 static command_t lst_cmdlist[] = {
 	{"new_session",		jt_lst_new_session,	NULL,
          "Usage: lst new_session [--timeout TIME] [--force] [NAME]"	                },
@@ -3263,7 +3966,8 @@ static command_t lst_cmdlist[] = {
           "Usage: lst list_group [--active] [--busy] [--down] [--unknown] GROUP ..."    },
 	{"stat",                jt_lst_stat,            NULL,
 	 "Usage: lst stat [--bw] [--rate] [--read] [--write] [--max] [--min] [--avg] "
-	 " [--mbs] [--timeout #] [--delay #] [--count #] GROUP [GROUP]"                 },
+	 " [--mbs] [--lat] [--format text|yaml|json] [--timeout #] [--delay #] "
+	 " [--count #] GROUP [GROUP]"							},
         {"show_error",          jt_lst_show_error,      NULL,
          "Usage: lst show_error NAME | IDS ..."                                         },
         {"add_batch",           jt_lst_add_batch,       NULL,
@@ -3279,6 +3983,10 @@ static command_t lst_cmdlist[] = {
         {"add_test",            jt_lst_add_test,        NULL,
          "Usage: lst add_test [--batch BATCH] [--loop #] [--concurrency #] "
          " [--distribute #:#] [--from GROUP] [--to GROUP] TEST..."                      },
+	{"sweep",		jt_lst_sweep,		NULL,
+	 "Usage: lst sweep [--batch PREFIX] [--concurrency #,#...] [--duration #] "
+	 " [--distribute #:#] [--timeout #] [--mbs] [--format text|yaml|json] "
+	 " --from GROUP --to GROUP brw [size=#,#...] ... | ping"			},
         {"help",                Parser_help,            0,     "help"                   },
 	{"--list-commands",     lst_list_commands,      0,     "list commands"          },
         {0,                     0,                      0,      NULL                    }
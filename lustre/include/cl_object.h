@@ -757,6 +757,11 @@ struct cl_page {
 	struct lu_ref_link       cp_queue_ref;
 	/** Assigned if doing a sync_io */
 	struct cl_sync_io       *cp_sync_io;
+	/**
+	 * Slab cache the page was allocated from, NULL if it came from
+	 * kmalloc because the cache could not be created.
+	 */
+	struct kmem_cache	*cp_kmem;
 };
 
 /**
@@ -1909,6 +1914,12 @@ struct cl_io {
 			     ci_pio:1,
 	/* Tell sublayers not to expand LDLM locks requested for this IO */
 			     ci_lock_no_expand:1,
+	/**
+	 * Direct IO with pages of all stripes in flight together. An
+	 * iteration covers all stripes of a layout component, so that locks
+	 * of all of them are held until the pages are transferred.
+	 */
+			     ci_parallel_dio:1,
 	/**
 	 * Set if non-delay RPC should be used for this IO.
 	 *
@@ -1979,6 +1990,14 @@ struct cache_stats {
 /** These are not exported so far */
 void cache_stats_init (struct cache_stats *cs, const char *name);
 
+/**
+ * Page statistical counters of a client site on one cpu.
+ */
+struct cl_site_page_stats {
+	long			cps_stats[CS_NR];
+	long			cps_state[CPS_NR];
+};
+
 /**
  * Client-side site. This represents particular client stack. "Global"
  * variables should (directly or indirectly) be added here to allow multiple
@@ -1987,16 +2006,16 @@ void cache_stats_init (struct cache_stats *cs, const char *name);
 struct cl_site {
 	struct lu_site		cs_lu;
 	/**
-	 * Statistical counters. Atomics do not scale, something better like
-	 * per-cpu counters is needed.
+	 * Statistical counters, per-cpu so that page allocation and state
+	 * changes do not share cache lines between cpus. They are summed
+	 * up when read.
 	 *
 	 * These are exported as /proc/fs/lustre/llite/.../site
 	 *
 	 * When interpreting keep in mind that both sub-locks (and sub-pages)
 	 * and top-locks (and top-pages) are accounted here.
 	 */
-	struct cache_stats	cs_pages;
-	atomic_t		cs_pages_state[CPS_NR];
+	struct cl_site_page_stats __percpu *cs_pages;
 };
 
 int  cl_site_init(struct cl_site *s, struct cl_device *top);
@@ -508,6 +508,13 @@ struct ldlm_namespace {
 	 */
 	unsigned		ns_max_nolock_size;
 
+	/**
+	 * Size the extent locks granted on a contended resource to the
+	 * access granularity observed for each client, rather than growing
+	 * them as much as possible.
+	 */
+	unsigned int		ns_extent_adaptive;
+
 	/** Limit of parallel AST RPC count. */
 	unsigned		ns_max_parallel_ast;
 
@@ -1025,6 +1032,13 @@ struct ldlm_resource {
 		struct inode	*lr_lvb_inode;
 	};
 
+	/**
+	 * Conflict history of an extent resource, used to size the locks
+	 * granted while it is contended. Server side only, protected by
+	 * lr_lock, allocated at the first conflict.
+	 */
+	struct ldlm_extent_history *lr_ext_history;
+
 	/** Type of locks this resource can hold. Only one type per resource. */
 	enum ldlm_type		lr_type; /* LDLM_{PLAIN,EXTENT,FLOCK,IBITS} */
 
@@ -399,6 +399,14 @@
 #define ldlm_is_ndelay(_l)		 LDLM_TEST_FLAG((_l), 1ULL << 58)
 #define ldlm_set_ndelay(_l)		 LDLM_SET_FLAG((_l), 1ULL << 58)
 
+/**
+ * Set once a blocked extent lock is counted in the conflict history of its
+ * resource, so reprocessing the waiting queue does not count it again.
+ */
+#define LDLM_FL_EXT_CONFLICT		 0x0800000000000000ULL /* bit  59 */
+#define ldlm_is_ext_conflict(_l)	 LDLM_TEST_FLAG((_l), 1ULL << 59)
+#define ldlm_set_ext_conflict(_l)	 LDLM_SET_FLAG((_l), 1ULL << 59)
+
 /** l_flags bits marked as "ast" bits */
 #define LDLM_FL_AST_MASK                (LDLM_FL_FLOCK_DEADLOCK		|\
 					 LDLM_FL_DISCARD_DATA)
@@ -422,6 +422,14 @@ static inline bool imp_connect_shortio(struct obd_import *imp)
 	return ocd->ocd_connect_flags & OBD_CONNECT_SHORTIO;
 }
 
+static inline bool imp_connect_multiobj_brw(struct obd_import *imp)
+{
+	struct obd_connect_data *ocd = &imp->imp_connect_data;
+
+	return (ocd->ocd_connect_flags & OBD_CONNECT_FLAGS2) &&
+	       (ocd->ocd_connect_flags2 & OBD_CONNECT2_MULTIOBJ_BRW);
+}
+
 static inline __u64 exp_connect_ibits(struct obd_export *exp)
 {
 	struct obd_connect_data *ocd;
@@ -455,6 +463,16 @@ static inline int exp_connect_lock_convert(struct obd_export *exp)
 	return !!(exp_connect_flags2(exp) & OBD_CONNECT2_LOCK_CONVERT);
 }
 
+static inline int exp_connect_multiobj_brw(struct obd_export *exp)
+{
+	return !!(exp_connect_flags2(exp) & OBD_CONNECT2_MULTIOBJ_BRW);
+}
+
+static inline int exp_connect_parent_locked(struct obd_export *exp)
+{
+	return !!(exp_connect_flags2(exp) & OBD_CONNECT2_PARENT_LOCKED);
+}
+
 extern struct obd_export *class_conn2export(struct lustre_handle *conn);
 
 #define KKUC_CT_DATA_MAGIC	0x092013cea
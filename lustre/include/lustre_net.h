@@ -51,6 +51,7 @@
  * @{
  */
 #include <linux/kobject.h>
+#include <linux/llist.h>
 #include <linux/uio.h>
 #include <libcfs/libcfs.h>
 #include <lnet/api.h>
@@ -108,6 +109,8 @@
 #define DT_DEF_BRW_SIZE		(4 * ONE_MB_BRW_SIZE)
 #define DT_MAX_BRW_PAGES	(DT_MAX_BRW_SIZE >> PAGE_SHIFT)
 #define OFD_MAX_BRW_SIZE	(1U << LNET_MTU_BITS)
+/* maximum number of objects in one multi-object OST_WRITE */
+#define PTLRPC_MAX_BRW_OBJS	16
 
 /* When PAGE_SIZE is a constant, we can check our arithmetic here with cpp! */
 #if ((PTLRPC_MAX_BRW_PAGES & (PTLRPC_MAX_BRW_PAGES - 1)) != 0)
@@ -471,6 +474,7 @@
  * 	DT_MAX_BRW_PAGES * niobuf_remote
  *
  * - single object with 16 pages is 512 bytes
+ * - a multi-object write adds one ost_body and obd_ioobj per extra object
  * - OST_IO_MAXREQSIZE must be at least 1 page of cookies plus some spillover
  * - Must be a multiple of 1024
  */
@@ -481,7 +485,10 @@
 			      sizeof(struct niobuf_remote))
 #define _OST_MAXREQSIZE_SUM (_OST_MAXREQSIZE_BASE + \
 			     sizeof(struct niobuf_remote) * \
-			     (DT_MAX_BRW_PAGES - 1))
+			     (DT_MAX_BRW_PAGES - 1) + \
+			     (sizeof(struct ost_body) + \
+			      sizeof(struct obd_ioobj)) * \
+			     (PTLRPC_MAX_BRW_OBJS - 1))
 /**
  * FIEMAP request can be 4K+ for now
  */
@@ -580,8 +587,6 @@ typedef int (*set_producer_func)(struct ptlrpc_request_set *, void *);
  */
 struct ptlrpc_request_set {
 	atomic_t		set_refcount;
-	/** number of in queue requests */
-	atomic_t		set_new_count;
 	/** number of uncompleted requests */
 	atomic_t		set_remaining;
 	/** wait queue to wait on for request events */
@@ -589,13 +594,12 @@ struct ptlrpc_request_set {
 	/** List of requests in the set */
 	struct list_head	set_requests;
 	/**
-	 * Lock for \a set_new_requests manipulations
-	 * locked so that any old caller can communicate requests to
-	 * the set holder who can then fold them into the lock-free set
+	 * Lockless list of new yet unsent requests, so that any caller can
+	 * communicate requests to the set holder who can then fold them into
+	 * \a set_requests. Requests are linked by ptlrpc_cli_req::cr_new_node.
+	 * Only used with ptlrpcd now.
 	 */
-	spinlock_t		set_new_req_lock;
-	/** List of new yet unsent requests. Only used with ptlrpcd now. */
-	struct list_head	set_new_requests;
+	struct llist_head	set_new_requests;
 
 	/** rq_status of requests that have been freed already */
 	int			set_rc;
@@ -799,6 +803,8 @@ struct ptlrpc_cli_req {
 	wait_queue_head_t		 cr_set_waitq;
 	/** Link item for request set lists */
 	struct list_head		 cr_set_chain;
+	/** Link item for ptlrpc_request_set::set_new_requests */
+	struct llist_node		 cr_new_node;
 	/** link to waited ctx */
 	struct list_head		 cr_ctx_chain;
 
@@ -539,6 +539,10 @@ struct osc_page {
 	 * If the page is in osc_object::oo_tree.
 	 */
 				ops_intree:1;
+	/**
+	 * CPT of the part of client_obd::cl_lru_parts the page is added to.
+	 */
+	int			ops_lru_cpt;
 	/**
 	 * lru page list. See osc_lru_{del|use}() in osc_page.c for usage.
 	 */
@@ -549,8 +553,20 @@ struct osc_page {
 	ktime_t			ops_submit_time;
 };
 
+/**
+ * Objects of a write RPC carrying pages of several objects. The pages of
+ * each object follow each other in aa_ppga, in the order of bo_oa[], and
+ * bo_oa[0] is the same as aa_oa.
+ */
+struct osc_brw_objs {
+	int			 bo_count;
+	u32			 bo_pages[PTLRPC_MAX_BRW_OBJS];
+	struct obdo		*bo_oa[PTLRPC_MAX_BRW_OBJS];
+};
+
 struct osc_brw_async_args {
 	struct obdo		*aa_oa;
+	struct osc_brw_objs	*aa_objs;
 	int			 aa_requested_nob;
 	int			 aa_nio_count;
 	u32			 aa_page_count;
@@ -307,6 +307,7 @@ extern struct req_msg_field RMF_MGS_TARGET_INFO;
 extern struct req_msg_field RMF_MGS_SEND_PARAM;
 
 extern struct req_msg_field RMF_OST_BODY;
+extern struct req_msg_field RMF_OST_BODIES;
 extern struct req_msg_field RMF_OBD_IOOBJ;
 extern struct req_msg_field RMF_OBD_ID;
 extern struct req_msg_field RMF_FID;
@@ -135,6 +135,7 @@ struct timeout_item {
 #define OSC_MAX_DIRTY_DEFAULT	2000	 /* Arbitrary large value */
 #define OSC_MAX_DIRTY_MB_MAX	2048     /* arbitrary, but < MAX_LONG bytes */
 #define OSC_DEFAULT_RESENDS	10
+#define OSC_DEFAULT_MAX_OBJS_PER_RPC	8
 
 /* possible values for fo_sync_lock_cancel */
 enum {
@@ -161,6 +162,17 @@ enum obd_cl_sem_lock_class {
 
 struct mdc_rpc_lock;
 struct obd_import;
+/**
+ * Part of the LRU page list of a client_obd, there is one per CPU partition
+ * so that adding and removing pages on different CPUs do not contend.
+ */
+struct cl_lru_part {
+	spinlock_t		clp_lock;
+	struct list_head	clp_list;
+	/** # of pages in clp_list */
+	long			clp_nr;
+};
+
 struct client_obd {
 	struct rw_semaphore	 cl_sem;
 	struct obd_uuid		 cl_target_uuid;
@@ -198,6 +210,12 @@ struct client_obd {
 	 */
 	__u32			 cl_dom_min_inline_repsize;
 
+	/* Directory pages are read ahead of the readdir caller by up to
+	 * this many asynchronous MDS_READPAGE RPCs, 0 to disable. */
+	__u32			 cl_readdir_ra;
+	atomic_t		 cl_readdir_ra_rpcs;
+	atomic_t		 cl_readdir_ra_pages;
+
 	enum lustre_sec_part	 cl_sp_me;
 	enum lustre_sec_part	 cl_sp_to;
 	struct sptlrpc_flavor	 cl_flvr_mgc; /* fixed flavor of mgc->mgs */
@@ -260,12 +278,15 @@ struct client_obd {
 	u32			cl_max_pages_per_rpc;
 	u32			cl_max_rpcs_in_flight;
 	u32			cl_max_short_io_bytes;
+	/* max # of objects packed into a single write RPC */
+	u32			cl_max_objs_per_rpc;
 	struct obd_histogram	cl_read_rpc_hist;
 	struct obd_histogram	cl_write_rpc_hist;
 	struct obd_histogram	cl_read_page_hist;
 	struct obd_histogram	cl_write_page_hist;
 	struct obd_histogram	cl_read_offset_hist;
 	struct obd_histogram	cl_write_offset_hist;
+	struct obd_histogram	cl_write_obj_hist;
 
 	/** LRU for osc caching pages */
 	struct cl_client_cache  *cl_cache;
@@ -291,10 +312,14 @@ struct client_obd {
 	 * reclaim is sync, initiated by IO thread when the LRU slots are
 	 * in shortage. */
 	__u64                    cl_lru_reclaim;
-	/** List of LRU pages for this client_obd */
-	struct list_head         cl_lru_list;
-	/** Lock for LRU page list */
-	spinlock_t		 cl_lru_list_lock;
+	/** Per-CPT lists of LRU pages for this client_obd */
+	struct cl_lru_part	**cl_lru_parts;
+	/** The part of cl_lru_parts the next shrink starts from */
+	unsigned int		 cl_lru_part_next;
+	/** latency of LRU shrinks, in usec */
+	struct obd_histogram	 cl_lru_shrink_hist;
+	/** latency of LRU reclaims by IO threads, in usec */
+	struct obd_histogram	 cl_lru_reclaim_hist;
 	/** # of unstable pages in this client_obd.
 	 * An unstable page is a page state that WRITE RPC has finished but
 	 * the transaction has NOT yet committed. */
@@ -826,6 +851,9 @@ enum md_cli_flags {
 	CLI_HASH64      = 1 << 2,
 	CLI_API32       = 1 << 3,
 	CLI_MIGRATE     = 1 << 4,
+	/* create replayed from client write-back cache: op_fid2 is
+	 * preallocated and the mode is final, already with umask applied */
+	CLI_WBC_CREATE  = 1 << 5,
 };
 
 /**
@@ -828,6 +828,9 @@ struct ptlrpc_body_v2 {
 #define OBD_CONNECT2_WBC_INTENTS	0x40ULL /* create/unlink/... intents for wbc, also operations under client-held parent locks */
 #define OBD_CONNECT2_LOCK_CONVERT	0x80ULL /* IBITS lock convert support */
 #define OBD_CONNECT2_ARCHIVE_ID_ARRAY	0x100ULL /* store HSM archive_id in array */
+/* 0x200 - 0x80000000000 are taken on the master branch, see README below */
+#define OBD_CONNECT2_MULTIOBJ_BRW	0x100000000000ULL /* several objects per OST_WRITE */
+#define OBD_CONNECT2_PARENT_LOCKED	0x200000000000ULL /* create under client EX parent lock */
 
 /* XXX README XXX:
  * Please DO NOT add flag values here before first ensuring that this same
@@ -881,7 +884,8 @@ struct ptlrpc_body_v2 {
 #define MDT_CONNECT_SUPPORTED2 (OBD_CONNECT2_FILE_SECCTX | OBD_CONNECT2_FLR | \
                                 OBD_CONNECT2_SUM_STATFS | \
 				OBD_CONNECT2_LOCK_CONVERT | \
-				OBD_CONNECT2_DIR_MIGRATE)
+				OBD_CONNECT2_DIR_MIGRATE | \
+				OBD_CONNECT2_PARENT_LOCKED)
 
 #define OST_CONNECT_SUPPORTED  (OBD_CONNECT_SRVLOCK | OBD_CONNECT_GRANT | \
 				OBD_CONNECT_REQPORTAL | OBD_CONNECT_VERSION | \
@@ -902,7 +906,8 @@ struct ptlrpc_body_v2 {
 				OBD_CONNECT_GRANT_PARAM | \
 				OBD_CONNECT_SHORTIO | OBD_CONNECT_FLAGS2)
 
-#define OST_CONNECT_SUPPORTED2 OBD_CONNECT2_LOCKAHEAD
+#define OST_CONNECT_SUPPORTED2 (OBD_CONNECT2_LOCKAHEAD | \
+				OBD_CONNECT2_MULTIOBJ_BRW)
 
 #define ECHO_CONNECT_SUPPORTED (OBD_CONNECT_FID)
 #define ECHO_CONNECT_SUPPORTED2 0
@@ -1930,6 +1935,7 @@ enum mds_op_bias {
 	MDS_CLOSE_RESYNC_DONE	= 1 << 16,
 	MDS_CLOSE_LAYOUT_SPLIT	= 1 << 17,
 	MDS_TRUNC_KEEP_LEASE	= 1 << 18,
+	MDS_PARENT_LOCKED	= 1 << 19,
 };
 
 #define MDS_CLOSE_INTENT (MDS_HSM_RELEASE | MDS_CLOSE_LAYOUT_SWAP |         \
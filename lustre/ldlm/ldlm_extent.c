@@ -264,6 +264,184 @@ ldlm_extent_internal_policy_waiting(struct ldlm_lock *req,
 }
 
 
+/*
+ * Contention history.
+ *
+ * Greedy growth works well while a resource is used by one client, but on
+ * shared files written by many clients each grown lock covers the regions
+ * the other clients are about to write, and is called back at their next
+ * enqueue. Once a resource sees conflicts, it remembers for each client the
+ * length of its runs of adjacent requests (its access granularity), and
+ * locks granted during the following ns_contention_time seconds are sized
+ * to that granularity instead of grown as much as possible. A client whose
+ * lock is called back by a request that does not overlap its own request
+ * had its lock grown too much, so its granularity is halved. Greedy growth
+ * is back once no conflict happened for ns_contention_time.
+ */
+static struct ldlm_extent_history *
+ldlm_extent_history_get(struct ldlm_resource *res)
+{
+	if (res->lr_ext_history == NULL)
+		/* under lr_lock, skip the history if memory is short */
+		OBD_ALLOC_GFP(res->lr_ext_history,
+			      sizeof(*res->lr_ext_history), GFP_ATOMIC);
+
+	return res->lr_ext_history;
+}
+
+/* Find the entry of the client owning \a lock, reuse the oldest if needed. */
+static struct ldlm_extent_client *
+ldlm_extent_client_get(struct ldlm_extent_history *leh,
+		       struct ldlm_lock *lock)
+{
+	__u64 cookie = lock->l_export->exp_handle.h_cookie;
+	struct ldlm_extent_client *oldest = &leh->leh_clients[0];
+	int i;
+
+	for (i = 0; i < LDLM_EXTENT_HISTORY_CLIENTS; i++) {
+		struct ldlm_extent_client *lec = &leh->leh_clients[i];
+
+		if (lec->lec_cookie == cookie)
+			return lec;
+		if (lec->lec_time < oldest->lec_time)
+			oldest = lec;
+	}
+
+	memset(oldest, 0, sizeof(*oldest));
+	oldest->lec_cookie = cookie;
+
+	return oldest;
+}
+
+static inline __u64 ldlm_extent_len(const struct ldlm_extent *ex)
+{
+	return ex->end - ex->start + 1;
+}
+
+/* \a lock conflicts with \a req, a blocking AST is about to be queued for it */
+static void ldlm_extent_history_conflict(struct ldlm_lock *req,
+					 struct ldlm_lock *lock)
+{
+	struct ldlm_extent_history *leh;
+	struct ldlm_extent_client *lec;
+
+	if (req->l_export == NULL)
+		return;
+
+	leh = ldlm_extent_history_get(req->l_resource);
+	if (leh == NULL)
+		return;
+
+	leh->leh_callbacks++;
+	leh->leh_conflict_time = ktime_get_seconds();
+
+	/* only the growth of the lock conflicts, shrink it next time */
+	if (lock->l_export != NULL &&
+	    !ldlm_extent_overlap(&lock->l_req_extent, &req->l_req_extent)) {
+		lec = ldlm_extent_client_get(leh, lock);
+		lec->lec_grain = max(lec->lec_grain / 2,
+				     ldlm_extent_len(&lock->l_req_extent));
+	}
+}
+
+/* Update the access pattern of the client enqueueing \a lock. */
+static struct ldlm_extent_client *
+ldlm_extent_history_update(struct ldlm_extent_history *leh,
+			   struct ldlm_lock *lock, time64_t now)
+{
+	struct ldlm_extent_client *lec = ldlm_extent_client_get(leh, lock);
+	__u64 req_start = lock->l_req_extent.start;
+	__u64 req_end = lock->l_req_extent.end;
+
+	if (lec->lec_time != 0 && req_start >= lec->lec_run_start &&
+	    req_start <= lec->lec_run_end + 1) {
+		/* the run of adjacent requests goes on */
+		lec->lec_run_end = max(lec->lec_run_end, req_end);
+	} else {
+		if (lec->lec_time != 0) {
+			__u64 len = lec->lec_run_end - lec->lec_run_start + 1;
+
+			lec->lec_grain = lec->lec_grain == 0 ? len :
+					 (3 * lec->lec_grain + len) / 4;
+		}
+		lec->lec_run_start = req_start;
+		lec->lec_run_end = req_end;
+	}
+	lec->lec_time = now;
+
+	return lec;
+}
+
+/* Limit \a new_ex to the access granularity of the client while the
+ * resource is contended. */
+static void ldlm_extent_policy_history(struct ldlm_resource *res,
+				       struct ldlm_lock *lock,
+				       struct ldlm_extent *new_ex)
+{
+	struct ldlm_namespace *ns = ldlm_res_to_ns(res);
+	struct ldlm_extent_history *leh = res->lr_ext_history;
+	struct ldlm_extent_client *lec;
+	__u64 req_start = lock->l_req_extent.start;
+	__u64 req_end = lock->l_req_extent.end;
+	time64_t now;
+	__u64 limit;
+
+	if (leh == NULL || !ns->ns_extent_adaptive ||
+	    lock->l_req_mode == LCK_GROUP)
+		return;
+
+	now = ktime_get_seconds();
+	lec = ldlm_extent_history_update(leh, lock, now);
+
+	if (now >= leh->leh_conflict_time + ns->ns_contention_time)
+		return;
+
+	if (lec->lec_grain == 0 ||
+	    lec->lec_grain > OBD_OBJECT_EOF - lec->lec_run_start)
+		limit = req_end;
+	else
+		limit = max(req_end, lec->lec_run_start + lec->lec_grain - 1);
+
+	if (new_ex->start == req_start && new_ex->end <= limit)
+		return;
+
+	new_ex->start = req_start;
+	new_ex->end = min(new_ex->end, limit);
+	ldlm_extent_internal_policy_fixup(lock, new_ex, 0);
+	leh->leh_sized++;
+}
+
+void ldlm_extent_history_dump(struct seq_file *m, struct ldlm_resource *res)
+{
+	struct ldlm_extent_history *leh = res->lr_ext_history;
+	time64_t now = ktime_get_seconds();
+	int i;
+
+	seq_printf(m, "- resource: "DLDLMRES"\n"
+		      "  contended: %s\n"
+		      "  last_conflict: %lld\n"
+		      "  conflicts: %llu\n"
+		      "  callbacks: %llu\n"
+		      "  sized_grants: %llu\n"
+		      "  clients:\n",
+		   PLDLMRES(res),
+		   now < leh->leh_conflict_time +
+			 ldlm_res_to_ns(res)->ns_contention_time ? "yes" : "no",
+		   (s64)leh->leh_conflict_time, leh->leh_conflicts,
+		   leh->leh_callbacks, leh->leh_sized);
+
+	for (i = 0; i < LDLM_EXTENT_HISTORY_CLIENTS; i++) {
+		struct ldlm_extent_client *lec = &leh->leh_clients[i];
+
+		if (lec->lec_cookie == 0)
+			continue;
+		seq_printf(m, "  - { export: %#llx, grain: %llu, "
+			      "conflicts: %llu, last_request: %lld }\n",
+			   lec->lec_cookie, lec->lec_grain, lec->lec_conflicts,
+			   (s64)lec->lec_time);
+	}
+}
+
 /* In order to determine the largest possible extent we can grant, we need
  * to scan all of the queues. */
 static void ldlm_extent_policy(struct ldlm_resource *res,
@@ -292,6 +470,7 @@ static void ldlm_extent_policy(struct ldlm_resource *res,
 	if (likely(!(lock->l_flags & LDLM_FL_NO_EXPANSION))) {
 		ldlm_extent_internal_policy_granted(lock, &new_ex);
 		ldlm_extent_internal_policy_waiting(lock, &new_ex);
+		ldlm_extent_policy_history(res, lock, &new_ex);
 	} else {
 		LDLM_DEBUG(lock, "Not expanding manually requested lock.\n");
 		new_ex.start = lock->l_policy_data.l_extent.start;
@@ -354,8 +533,12 @@ static enum interval_iter ldlm_extent_compat_cb(struct interval_node *n,
                          ldlm_lockname[lock->l_granted_mode]);
                 count++;
 		if (lock->l_blocking_ast &&
-		    lock->l_granted_mode != LCK_GROUP)
-                        ldlm_add_ast_work_item(lock, enq, work_list);
+		    lock->l_granted_mode != LCK_GROUP) {
+			/* count only conflicts which queue a blocking AST */
+			if (!ldlm_is_ast_sent(lock))
+				ldlm_extent_history_conflict(enq, lock);
+			ldlm_add_ast_work_item(lock, enq, work_list);
+		}
         }
 
         /* don't count conflicting glimpse locks */
@@ -646,8 +829,12 @@ ldlm_extent_compat_queue(struct list_head *queue, struct ldlm_lock *req,
 
                         compat = 0;
 			if (lock->l_blocking_ast &&
-			    lock->l_req_mode != LCK_GROUP)
-                                ldlm_add_ast_work_item(lock, req, work_list);
+			    lock->l_req_mode != LCK_GROUP) {
+				if (!ldlm_is_ast_sent(lock))
+					ldlm_extent_history_conflict(req,
+								     lock);
+				ldlm_add_ast_work_item(lock, req, work_list);
+			}
                 }
         }
 
@@ -843,10 +1030,21 @@ int ldlm_process_extent_lock(struct ldlm_lock *lock, __u64 *flags,
 		ldlm_resource_unlink_lock(lock);
 		ldlm_grant_lock(lock, grant_work);
 	} else {
+		struct ldlm_extent_history *leh = res->lr_ext_history;
+
 		/* Adding LDLM_FL_NO_TIMEOUT flag to granted lock to
 		 * force client to wait for the lock endlessly once
 		 * the lock is enqueued -bzzz */
 		*flags |= LDLM_FL_NO_TIMEOUT;
+
+		/* allocated by ldlm_extent_history_conflict(), count
+		 * each blocked lock once however often it is reprocessed */
+		if (leh != NULL && lock->l_export != NULL &&
+		    !ldlm_is_ext_conflict(lock)) {
+			ldlm_set_ext_conflict(lock);
+			leh->leh_conflicts++;
+			ldlm_extent_client_get(leh, lock)->lec_conflicts++;
+		}
 	}
 	rc = LDLM_ITER_CONTINUE;
 
@@ -208,6 +208,29 @@ int ldlm_process_inodebits_lock(struct ldlm_lock *lock, __u64 *flags,
 int ldlm_process_extent_lock(struct ldlm_lock *lock, __u64 *flags,
 			     enum ldlm_process_intention intention,
 			     enum ldlm_error *err, struct list_head *work_list);
+
+/* clients remembered per contended extent resource */
+#define LDLM_EXTENT_HISTORY_CLIENTS	8
+
+/* access pattern of one client on a contended extent resource */
+struct ldlm_extent_client {
+	__u64		lec_cookie;	/* export handle, 0 if unused */
+	__u64		lec_run_start;	/* current run of adjacent requests */
+	__u64		lec_run_end;
+	__u64		lec_grain;	/* average length of the runs */
+	__u64		lec_conflicts;	/* enqueues which conflicted */
+	time64_t	lec_time;	/* last request */
+};
+
+struct ldlm_extent_history {
+	time64_t	leh_conflict_time;	/* last conflict */
+	__u64		leh_conflicts;		/* enqueues which conflicted */
+	__u64		leh_callbacks;		/* blocking ASTs they caused */
+	__u64		leh_sized;		/* grants limited to the grain */
+	struct ldlm_extent_client leh_clients[LDLM_EXTENT_HISTORY_CLIENTS];
+};
+
+void ldlm_extent_history_dump(struct seq_file *m, struct ldlm_resource *res);
 #endif
 void ldlm_extent_add_lock(struct ldlm_resource *res, struct ldlm_lock *lock);
 void ldlm_extent_unlink_lock(struct ldlm_lock *lock);
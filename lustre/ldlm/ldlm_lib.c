@@ -255,6 +255,19 @@ static int osc_on_mdt(char *obdname)
 	return 0;
 }
 
+/* Initialize the per-CPT parts of the client page LRU */
+static void client_obd_lru_parts_init(struct client_obd *cli)
+{
+	struct cl_lru_part *part;
+	int i;
+
+	cfs_percpt_for_each(part, i, cli->cl_lru_parts) {
+		spin_lock_init(&part->clp_lock);
+		INIT_LIST_HEAD(&part->clp_list);
+		part->clp_nr = 0;
+	}
+}
+
 /* Configure an RPC client OBD device.
  *
  * lcfg parameters:
@@ -381,14 +394,15 @@ int client_obd_setup(struct obd_device *obddev, struct lustre_cfg *lcfg)
 	spin_lock_init(&cli->cl_write_page_hist.oh_lock);
 	spin_lock_init(&cli->cl_read_offset_hist.oh_lock);
 	spin_lock_init(&cli->cl_write_offset_hist.oh_lock);
+	spin_lock_init(&cli->cl_write_obj_hist.oh_lock);
 
 	/* lru for osc. */
 	INIT_LIST_HEAD(&cli->cl_lru_osc);
 	atomic_set(&cli->cl_lru_shrinkers, 0);
 	atomic_long_set(&cli->cl_lru_busy, 0);
 	atomic_long_set(&cli->cl_lru_in_list, 0);
-	INIT_LIST_HEAD(&cli->cl_lru_list);
-	spin_lock_init(&cli->cl_lru_list_lock);
+	spin_lock_init(&cli->cl_lru_shrink_hist.oh_lock);
+	spin_lock_init(&cli->cl_lru_reclaim_hist.oh_lock);
 	atomic_long_set(&cli->cl_unstable_count, 0);
 	INIT_LIST_HEAD(&cli->cl_shrink_list);
 	INIT_LIST_HEAD(&cli->cl_grant_chain);
@@ -417,6 +431,7 @@ int client_obd_setup(struct obd_device *obddev, struct lustre_cfg *lcfg)
 	cli->cl_max_pages_per_rpc = PTLRPC_MAX_BRW_PAGES;
 
 	cli->cl_max_short_io_bytes = OBD_MAX_SHORT_IO_BYTES;
+	cli->cl_max_objs_per_rpc = OSC_DEFAULT_MAX_OBJS_PER_RPC;
 
 	/* set cl_chunkbits default value to PAGE_SHIFT,
 	 * it will be updated at OSC connection time. */
@@ -455,6 +470,12 @@ int client_obd_setup(struct obd_device *obddev, struct lustre_cfg *lcfg)
 			GOTO(err, rc = -ENOMEM);
 	}
 
+	cli->cl_lru_parts = cfs_percpt_alloc(cfs_cpt_table,
+					     sizeof(struct cl_lru_part));
+	if (cli->cl_lru_parts == NULL)
+		GOTO(err, rc = -ENOMEM);
+	client_obd_lru_parts_init(cli);
+
         rc = ldlm_get_ref();
         if (rc) {
                 CERROR("ldlm_get_ref failed: %d\n", rc);
@@ -526,6 +547,9 @@ err_import:
 err_ldlm:
         ldlm_put_ref();
 err:
+	if (cli->cl_lru_parts != NULL)
+		cfs_percpt_free(cli->cl_lru_parts);
+	cli->cl_lru_parts = NULL;
 	if (cli->cl_mod_tag_bitmap != NULL)
 		OBD_FREE(cli->cl_mod_tag_bitmap,
 			 BITS_TO_LONGS(OBD_MAX_RIF_MAX) * sizeof(long));
@@ -548,6 +572,9 @@ int client_obd_cleanup(struct obd_device *obddev)
 
 	ldlm_put_ref();
 
+	if (cli->cl_lru_parts != NULL)
+		cfs_percpt_free(cli->cl_lru_parts);
+	cli->cl_lru_parts = NULL;
 	if (cli->cl_mod_tag_bitmap != NULL)
 		OBD_FREE(cli->cl_mod_tag_bitmap,
 			 BITS_TO_LONGS(OBD_MAX_RIF_MAX) * sizeof(long));
@@ -635,6 +635,34 @@ static ssize_t contended_locks_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(contended_locks);
 
+static ssize_t extent_adaptive_show(struct kobject *kobj,
+				    struct attribute *attr, char *buf)
+{
+	struct ldlm_namespace *ns = container_of(kobj, struct ldlm_namespace,
+						 ns_kobj);
+
+	return sprintf(buf, "%u\n", ns->ns_extent_adaptive);
+}
+
+static ssize_t extent_adaptive_store(struct kobject *kobj,
+				     struct attribute *attr,
+				     const char *buffer, size_t count)
+{
+	struct ldlm_namespace *ns = container_of(kobj, struct ldlm_namespace,
+						 ns_kobj);
+	bool val;
+	int err;
+
+	err = kstrtobool(buffer, &val);
+	if (err != 0)
+		return -EINVAL;
+
+	ns->ns_extent_adaptive = val;
+
+	return count;
+}
+LUSTRE_RW_ATTR(extent_adaptive);
+
 static ssize_t max_parallel_ast_show(struct kobject *kobj,
 				     struct attribute *attr, char *buf)
 {
@@ -680,6 +708,7 @@ static struct attribute *ldlm_ns_attrs[] = {
 	&lustre_attr_max_nolock_bytes.attr,
 	&lustre_attr_contention_seconds.attr,
 	&lustre_attr_contended_locks.attr,
+	&lustre_attr_extent_adaptive.attr,
 	&lustre_attr_max_parallel_ast.attr,
 #endif
 	NULL,
@@ -737,6 +766,38 @@ int ldlm_namespace_sysfs_register(struct ldlm_namespace *ns)
 	return err;
 }
 
+#ifdef HAVE_SERVER_SUPPORT
+static int ldlm_res_history_dump(struct cfs_hash *hs, struct cfs_hash_bd *bd,
+				 struct hlist_node *hnode, void *arg)
+{
+	struct ldlm_resource *res = cfs_hash_object(hs, hnode);
+	struct seq_file *m = arg;
+
+	lock_res(res);
+	if (res->lr_ext_history != NULL)
+		ldlm_extent_history_dump(m, res);
+	unlock_res(res);
+
+	return 0;
+}
+
+static int ldlm_extent_contention_seq_show(struct seq_file *m, void *v)
+{
+	struct ldlm_namespace *ns = m->private;
+
+	cfs_hash_for_each_nolock(ns->ns_rs_hash, ldlm_res_history_dump, m, 0);
+
+	return 0;
+}
+LDEBUGFS_SEQ_FOPS_RO(ldlm_extent_contention);
+
+static struct lprocfs_vars ldlm_ns_server_debugfs_list[] = {
+	{ .name	=	"extent_contention",
+	  .fops	=	&ldlm_extent_contention_fops	},
+	{ NULL }
+};
+#endif /* HAVE_SERVER_SUPPORT */
+
 static int ldlm_namespace_debugfs_register(struct ldlm_namespace *ns)
 {
 	struct dentry *ns_entry;
@@ -751,6 +812,11 @@ static int ldlm_namespace_debugfs_register(struct ldlm_namespace *ns)
 		ns->ns_debugfs_entry = ns_entry;
 	}
 
+#ifdef HAVE_SERVER_SUPPORT
+	if (ns_is_server(ns))
+		return ldebugfs_add_vars(ns_entry, ldlm_ns_server_debugfs_list,
+					 ns);
+#endif
 	return 0;
 }
 #undef MAX_STRING_SIZE
@@ -984,6 +1050,7 @@ struct ldlm_namespace *ldlm_namespace_new(struct obd_device *obd, char *name,
 	ns->ns_max_nolock_size    = NS_DEFAULT_MAX_NOLOCK_BYTES;
 	ns->ns_contention_time    = NS_DEFAULT_CONTENTION_SECONDS;
 	ns->ns_contended_locks    = NS_DEFAULT_CONTENDED_LOCKS;
+	ns->ns_extent_adaptive    = 1;
 
         ns->ns_max_parallel_ast   = LDLM_DEFAULT_PARALLEL_AST_LIMIT;
         ns->ns_nr_unused          = 0;
@@ -1573,6 +1640,10 @@ int ldlm_resource_putref(struct ldlm_resource *res)
 		cfs_hash_bd_unlock(ns->ns_rs_hash, &bd, 1);
 		if (ns->ns_lvbo && ns->ns_lvbo->lvbo_free)
 			ns->ns_lvbo->lvbo_free(res);
+#ifdef HAVE_SERVER_SUPPORT
+		if (res->lr_ext_history != NULL)
+			OBD_FREE_PTR(res->lr_ext_history);
+#endif
 		if (res->lr_itree != NULL)
 			OBD_SLAB_FREE(res->lr_itree, ldlm_interval_tree_slab,
 				      sizeof(*res->lr_itree) * LCK_MODE_NUM);
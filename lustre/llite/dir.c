@@ -1195,6 +1195,15 @@ static long ll_dir_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
 		return -ENOTTY;
 
 	ll_stats_ops_tally(ll_i2sbi(inode), LPROC_LL_IOCTL, 1);
+
+	/* ioctls by name expect the entries created in write-back cache
+	 * to exist on MDT */
+	if (ll_i2info(inode)->lli_wbc_children > 0) {
+		rc = ll_wbc_flush_all(sbi);
+		if (rc != 0)
+			RETURN(rc);
+	}
+
 	switch (cmd) {
 	case FS_IOC_GETFLAGS:
 	case FS_IOC_SETFLAGS:
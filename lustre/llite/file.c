@@ -73,6 +73,7 @@ static struct ll_file_data *ll_file_data_get(void)
 		return NULL;
 
 	fd->fd_write_failed = false;
+	spin_lock_init(&fd->fd_lah.lah_lock);
 
 	return fd;
 }
@@ -669,6 +670,22 @@ int ll_file_open(struct inode *inode, struct file *file)
                 it = &oit;
         }
 
+	/* Directory created in write-back cache is flushed together with
+	 * everything queued before its children, so that readdir on MDT sees
+	 * them. Regular files can be opened locally, see below. */
+	if (S_ISDIR(inode->i_mode) &&
+	    (ll_wbc_pending(inode) || lli->lli_wbc_children > 0)) {
+		rc = ll_wbc_flush_all(ll_i2sbi(inode));
+		if (rc == 0)
+			rc = ll_wbc_flush(inode);
+	} else if (ll_wbc_pending(inode) &&
+		   (!S_ISREG(inode->i_mode) ||
+		    cl_is_lov_delay_create(file->f_flags))) {
+		rc = ll_wbc_flush(inode);
+	}
+	if (rc != 0)
+		GOTO(out_openerr, rc);
+
 restart:
         /* Let's see if we have file open on MDS already. */
         if (it->it_flags & FMODE_WRITE) {
@@ -703,6 +720,18 @@ restart:
 			mutex_unlock(&lli->lli_och_mutex);
                         GOTO(out_openerr, rc);
                 }
+	} else if (ll_wbc_pending(inode) && !it->it_disposition) {
+		/* Not on MDT yet, the open handle is taken at flush time by
+		 * ll_wbc_open_replay(), which also clears the pending flag
+		 * under lli_och_mutex. */
+		(*och_usecount)++;
+
+		rc = ll_local_open(file, it, fd, NULL);
+		if (rc) {
+			(*och_usecount)--;
+			mutex_unlock(&lli->lli_och_mutex);
+			GOTO(out_openerr, rc);
+		}
         } else {
                 LASSERT(*och_usecount == 0);
 		if (!it->it_disposition) {
@@ -731,6 +760,8 @@ restart:
 			if (ldd && ldd->lld_nfs_dentry) {
 				ldd->lld_nfs_dentry = 0;
 				it->it_flags |= MDS_OPEN_LOCK;
+			} else {
+				ll_intent_ro_open_lock(ll_i2sbi(inode), it);
 			}
 
 			 /*
@@ -807,6 +838,93 @@ out_nofiledata:
         return rc;
 }
 
+/**
+ * Get MDT open handles for a file created in write-back cache.
+ *
+ * The file may have been opened locally while its create was deferred, in
+ * which case the open counts are set but there is no handle to close. Once
+ * the create reached MDT, open it by FID for each mode in use, so that
+ * close and recovery work as for any other file. The pending flag is
+ * cleared when no mode is left without a handle.
+ *
+ * \retval 0 on success, negative errno otherwise (flag left set)
+ */
+int ll_wbc_open_replay(struct inode *inode, struct dentry *dentry)
+{
+	struct ll_inode_info *lli = ll_i2info(inode);
+	int rc = 0;
+	ENTRY;
+
+	while (1) {
+		struct lookup_intent it = { .it_op = IT_OPEN };
+		struct obd_client_handle **och_p;
+		struct obd_client_handle *och;
+		__u64 *och_usecount;
+
+		mutex_lock(&lli->lli_och_mutex);
+		if (lli->lli_open_fd_write_count > 0 &&
+		    lli->lli_mds_write_och == NULL) {
+			och_p = &lli->lli_mds_write_och;
+			och_usecount = &lli->lli_open_fd_write_count;
+			it.it_flags = FMODE_WRITE;
+		} else if (lli->lli_open_fd_exec_count > 0 &&
+			   lli->lli_mds_exec_och == NULL) {
+			och_p = &lli->lli_mds_exec_och;
+			och_usecount = &lli->lli_open_fd_exec_count;
+			it.it_flags = FMODE_EXEC;
+		} else if (lli->lli_open_fd_read_count > 0 &&
+			   lli->lli_mds_read_och == NULL) {
+			och_p = &lli->lli_mds_read_och;
+			och_usecount = &lli->lli_open_fd_read_count;
+			it.it_flags = FMODE_READ;
+		} else {
+			ll_file_clear_flag(lli, LLIF_WBC_PENDING);
+			mutex_unlock(&lli->lli_och_mutex);
+			break;
+		}
+		/* see ll_file_open(), no enqueue under lli_och_mutex */
+		mutex_unlock(&lli->lli_och_mutex);
+
+		it.it_flags |= MDS_OPEN_BY_FID | MDS_OPEN_OWNEROVERRIDE;
+		rc = ll_intent_file_open(dentry, NULL, 0, &it);
+		if (rc != 0)
+			break;
+
+		mutex_lock(&lli->lli_och_mutex);
+		if (*och_usecount == 0 || *och_p != NULL) {
+			/* closed meanwhile */
+			mutex_unlock(&lli->lli_och_mutex);
+			ll_release_openhandle(dentry, &it);
+			ll_intent_release(&it);
+			continue;
+		}
+
+		OBD_ALLOC_PTR(och);
+		if (och == NULL) {
+			rc = -ENOMEM;
+		} else {
+			rc = ll_och_fill(ll_i2sbi(inode)->ll_md_exp, &it, och);
+			if (rc == 0)
+				*och_p = och;
+			else
+				OBD_FREE_PTR(och);
+		}
+		mutex_unlock(&lli->lli_och_mutex);
+
+		if (rc != 0)
+			ll_release_openhandle(dentry, &it);
+		if (it_disposition(&it, DISP_ENQ_OPEN_REF)) {
+			ptlrpc_req_finished(it.it_request);
+			it_clear_disposition(&it, DISP_ENQ_OPEN_REF);
+		}
+		ll_intent_release(&it);
+		if (rc != 0)
+			break;
+	}
+
+	RETURN(rc);
+}
+
 static int ll_md_blocking_lease_ast(struct ldlm_lock *lock,
 			struct ldlm_lock_desc *desc, void *data, int flag)
 {
@@ -1329,6 +1447,9 @@ static void ll_io_init(struct cl_io *io, struct file *file, enum cl_io_type iot)
 		io->ci_lockreq = CILR_MANDATORY;
 	}
 	io->ci_noatime = file_is_noatime(file);
+	io->ci_parallel_dio = !!(file->f_flags & O_DIRECT) &&
+			      ll_sbi_has_parallel_dio(ll_i2sbi(inode)) &&
+			      !io->u.ci_rw.rw_append;
 	if (ll_i2sbi(inode)->ll_flags & LL_SBI_PIO)
 		io->ci_pio = !io->u.ci_rw.rw_append;
 	else
@@ -1437,6 +1558,14 @@ ll_file_io_generic(const struct lu_env *env, struct vvp_io_args *args,
 		file_dentry(file)->d_name.name,
 		iot == CIT_READ ? "read" : "write", pos, pos + count);
 
+	/* the layout is only created on MDT */
+	rc = ll_wbc_flush(inode);
+	if (rc != 0)
+		RETURN(rc);
+
+	if (iot == CIT_WRITE)
+		vvp_io_lockahead(file, pos, count);
+
 restart:
 	io = vvp_env_thread_io(env);
 	ll_io_init(io, file, iot);
@@ -3323,6 +3452,10 @@ ll_file_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
 	if (_IOC_TYPE(cmd) == 'T' || _IOC_TYPE(cmd) == 't') /* tty ioctls */
 		RETURN(-ENOTTY);
 
+	rc = ll_wbc_flush(inode);
+	if (rc != 0)
+		RETURN(rc);
+
 	switch (cmd) {
 	case LL_IOC_GETFLAGS:
 		/* Get the current value of the file flags */
@@ -3895,6 +4028,10 @@ int ll_fsync(struct file *file, struct dentry *dentry, int datasync)
 	       PFID(ll_inode2fid(inode)), inode);
 	ll_stats_ops_tally(ll_i2sbi(inode), LPROC_LL_FSYNC, 1);
 
+	rc = ll_wbc_flush(inode);
+	if (rc != 0)
+		RETURN(rc);
+
 #ifdef HAVE_FILE_FSYNC_4ARGS
 	rc = filemap_write_and_wait_range(inode->i_mapping, start, end);
 	lock_inode = !lli->lli_inode_locked;
@@ -3969,6 +4106,10 @@ ll_file_flock(struct file *file, int cmd, struct file_lock *file_lock)
 
         ll_stats_ops_tally(ll_i2sbi(inode), LPROC_LL_FLOCK, 1);
 
+	rc = ll_wbc_flush(inode);
+	if (rc != 0)
+		RETURN(rc);
+
         if (file_lock->fl_flags & FL_FLOCK) {
                 LASSERT((cmd == F_SETLKW) || (cmd == F_SETLK));
                 /* flocks are whole-file locks */
@@ -4479,6 +4620,11 @@ int ll_getattr(struct vfsmount *mnt, struct dentry *de, struct kstat *stat)
 
 	ll_stats_ops_tally(sbi, LPROC_LL_GETATTR, 1);
 
+	/* created in write-back cache, or the root of a cached tree under its
+	 * EX lock: local attributes are authoritative */
+	if (ll_wbc_pending(inode) || ll_wbc_root_locked(inode))
+		goto fill_attr;
+
 	rc = ll_inode_revalidate(de, IT_GETATTR);
 	if (rc < 0)
 		RETURN(rc);
@@ -4512,6 +4658,7 @@ int ll_getattr(struct vfsmount *mnt, struct dentry *de, struct kstat *stat)
 
 	OBD_FAIL_TIMEOUT(OBD_FAIL_GETATTR_DELAY, 30);
 
+fill_attr:
 	if (ll_need_32bit_api(sbi)) {
 		stat->ino = cl_fid_build_ino(&lli->lli_fid, 1);
 		stat->dev = ll_compat_encode_dev(inode->i_sb->s_dev);
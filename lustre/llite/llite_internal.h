@@ -235,6 +235,25 @@ struct ll_inode_info {
 	struct rw_semaphore		lli_xattrs_list_rwsem;
 	struct mutex			lli_xattrs_enq_lock;
 	struct list_head		lli_xattrs; /* ll_xattr_entry->xe_list */
+
+	/* write-back cache of namespace operations, see wbc.c.
+	 * lli_wbc_item is linked to ll_sb_info::ll_wbc_list while the create
+	 * of this inode is not yet sent to MDT, lli_wbc_dentry holds the name
+	 * to create it with. Both are protected by ll_sb_info::ll_wbc_lock. */
+	struct list_head		lli_wbc_item;
+	struct dentry			*lli_wbc_dentry;
+	/* number of pending children, for directory */
+	unsigned int			lli_wbc_children;
+	/* root of the cached tree of a pending entry */
+	struct inode			*lli_wbc_root;
+	/* for the root of a cached tree: the EX lock protecting the names
+	 * cached in it, and the number of pending entries in the tree */
+	struct lustre_handle		lli_wbc_lockh;
+	unsigned int			lli_wbc_tree;
+	/* credentials of the creator, to replay the create with */
+	__u32				lli_wbc_fsuid;
+	__u32				lli_wbc_fsgid;
+	cfs_cap_t			lli_wbc_cap;
 };
 
 static inline __u32 ll_layout_version_get(struct ll_inode_info *lli)
@@ -264,6 +283,10 @@ enum ll_file_flags {
 	LLIF_XATTR_CACHE	= 2,
 	/* Project inherit */
 	LLIF_PROJECT_INHERIT	= 3,
+	/* Created locally, not yet known to MDT (write-back cache) */
+	LLIF_WBC_PENDING	= 4,
+	/* Directory on MDT whose new entries are cached (write-back cache) */
+	LLIF_WBC_ROOT		= 5,
 };
 
 static inline void ll_file_set_flag(struct ll_inode_info *lli,
@@ -453,6 +476,8 @@ enum stats_track_type {
 #define LL_SBI_FILE_SECCTX   0x800000 /* set file security context at create */
 #define LL_SBI_PIO          0x1000000 /* parallel IO support */
 #define LL_SBI_TINY_WRITE   0x2000000 /* tiny write support */
+#define LL_SBI_RO_OPEN_CACHE 0x4000000 /* cache read-only open handles */
+#define LL_SBI_PARALLEL_DIO 0x8000000 /* direct IO without waiting per chunk */
 
 #define LL_SBI_FLAGS { 	\
 	"nolck",	\
@@ -481,6 +506,8 @@ enum stats_track_type {
 	"file_secctx",	\
 	"pio",		\
 	"tiny_write",		\
+	"ro_open_cache",	\
+	"parallel_dio",		\
 }
 
 /* This is embedded into llite super-blocks to keep track of connect
@@ -569,6 +596,29 @@ struct ll_sb_info {
 
 	struct kset		  ll_kset;	/* sysfs object */
 	struct completion	  ll_kobj_unregister;
+
+	/* write-back cache of namespace operations, see wbc.c */
+	spinlock_t		  ll_wbc_lock;
+	struct list_head	  ll_wbc_list;	/* pending inodes, in creation
+						 * order */
+	unsigned int		  ll_wbc_count;	/* length of ll_wbc_list */
+	unsigned int		  ll_wbc_max_pending; /* 0 means disabled */
+	struct mutex		  ll_wbc_mutex;	/* serializes flush/cancel */
+	struct rw_semaphore	  ll_wbc_sem;	/* cached creates vs. root
+						 * stopping to cache */
+	struct work_struct	  ll_wbc_work;	/* background flush */
+	atomic_t		  ll_wbc_deferred;
+	atomic_t		  ll_wbc_flushed;
+	atomic_t		  ll_wbc_cancelled;
+	atomic_t		  ll_wbc_lookups;
+	atomic_t		  ll_wbc_errors;
+
+	/* automatic lockahead for strided writes, see vvp_io_lockahead() */
+	unsigned int		  ll_lockahead_depth; /* extents requested
+						       * ahead, 0: disabled */
+	atomic_t		  ll_lockahead_patterns; /* strided writers
+							  * detected */
+	atomic_t		  ll_lockahead_requests; /* locks requested */
 };
 
 /*
@@ -656,10 +706,39 @@ struct ll_readahead_state {
         unsigned long   ras_consecutive_stride_requests;
 };
 
+/*
+ * per file-descriptor state of the strided write detection, used to request
+ * write locks ahead of the writes, see vvp_io_lockahead().
+ *
+ * ...|--count--|*******gap*******|--count--|*******gap*******|...
+ *    |lah_pos  |                 |
+ *    |-------lah_stride----------|
+ */
+struct ll_lockahead_state {
+	spinlock_t	lah_lock;
+	/* start and length of the last write */
+	loff_t		lah_pos;
+	size_t		lah_count;
+	/* distance between the starts of the last two writes */
+	loff_t		lah_stride;
+	/* number of consecutive writes found at lah_stride */
+	unsigned int	lah_hits;
+	/* first offset not yet covered by a lockahead request */
+	loff_t		lah_next;
+	/* server does not support lockahead */
+	unsigned int	lah_disabled:1;
+};
+
+/* consecutive strided writes before locks are requested ahead */
+#define LL_LOCKAHEAD_HITS	2
+#define LL_LOCKAHEAD_DEPTH_DEF	4
+#define LL_LOCKAHEAD_DEPTH_MAX	64
+
 extern struct kmem_cache *ll_file_data_slab;
 struct lustre_handle;
 struct ll_file_data {
 	struct ll_readahead_state fd_ras;
+	struct ll_lockahead_state fd_lah;
 	struct ll_grouplock fd_grouplock;
 	__u64 lfd_pos;
 	__u32 fd_flags;
@@ -728,6 +807,11 @@ static inline bool ll_sbi_has_tiny_write(struct ll_sb_info *sbi)
 	return !!(sbi->ll_flags & LL_SBI_TINY_WRITE);
 }
 
+static inline bool ll_sbi_has_parallel_dio(struct ll_sb_info *sbi)
+{
+	return !!(sbi->ll_flags & LL_SBI_PARALLEL_DIO);
+}
+
 void ll_ras_enter(struct file *f);
 
 /* llite/lcommon_misc.c */
@@ -749,6 +833,8 @@ enum {
 	LPROC_LL_WRITE_BYTES,
 	LPROC_LL_BRW_READ,
 	LPROC_LL_BRW_WRITE,
+	LPROC_LL_DIO_ZERO_COPY,
+	LPROC_LL_DIO_BOUNCE,
 	LPROC_LL_IOCTL,
 	LPROC_LL_OPEN,
 	LPROC_LL_RELEASE,
@@ -819,6 +905,7 @@ int ll_md_blocking_ast(struct ldlm_lock *, struct ldlm_lock_desc *,
 struct dentry *ll_splice_alias(struct inode *inode, struct dentry *de);
 int ll_rmdir_entry(struct inode *dir, char *name, int namelen);
 void ll_update_times(struct ptlrpc_request *request, struct inode *inode);
+void ll_invalidate_negative_children(struct inode *dir);
 
 /* llite/rw.c */
 int ll_writepage(struct page *page, struct writeback_control *wbc);
@@ -852,6 +939,7 @@ int ll_file_open(struct inode *inode, struct file *file);
 int ll_file_release(struct inode *inode, struct file *file);
 int ll_release_openhandle(struct dentry *, struct lookup_intent *);
 int ll_md_real_close(struct inode *inode, fmode_t fmode);
+int ll_wbc_open_replay(struct inode *inode, struct dentry *dentry);
 extern void ll_rw_stats_tally(struct ll_sb_info *sbi, pid_t pid,
                               struct ll_file_data *file, loff_t pos,
                               size_t count, int rw);
@@ -1134,6 +1222,30 @@ static inline struct ll_sb_info *ll_i2sbi(struct inode *inode)
         return ll_s2sbi(inode->i_sb);
 }
 
+/*
+ * Read-only open requests OPEN lock along with the open if enabled, which
+ * the MDT grants if the file opened is a regular file. The open handle is
+ * cached then and released lazily when lock is cancelled, so close and
+ * repeated open of the file don't need RPCs. This is useful for tools
+ * scanning many files like backup or indexers.
+ *
+ * The open reply carries attributes, layout and, with a DoM lock, small
+ * file data. Other xattrs are not in it and are still fetched by one
+ * IT_GETXATTR for the xattr cache.
+ */
+static inline void ll_intent_ro_open_lock(struct ll_sb_info *sbi,
+					  struct lookup_intent *it)
+{
+	if (!(sbi->ll_flags & LL_SBI_RO_OPEN_CACHE))
+		return;
+
+	if (it->it_flags & (FMODE_WRITE | FMODE_EXEC | O_CREAT | O_TRUNC |
+			    O_DIRECTORY | MDS_OPEN_LEASE | MDS_OPEN_LOCK))
+		return;
+
+	it->it_flags |= MDS_OPEN_RO_LOCK;
+}
+
 static inline struct obd_export *ll_i2dtexp(struct inode *inode)
 {
         return ll_s2dtexp(inode->i_sb);
@@ -1180,6 +1292,49 @@ int ll_xattr_list(struct inode *inode, const char *name, int type,
 		  void *buffer, size_t size, u64 valid);
 const struct xattr_handler *get_xattr_type(const char *name);
 
+/* llite/wbc.c */
+#define LL_WBC_MAX_PENDING_MAX	65536
+
+void ll_wbc_init(struct ll_sb_info *sbi);
+void ll_wbc_fini(struct ll_sb_info *sbi);
+bool ll_wbc_may_root(struct inode *dir, struct dentry *dchild, umode_t mode);
+void ll_wbc_root_set(struct inode *inode);
+int ll_wbc_create(struct inode *dir, struct dentry *dchild, umode_t mode,
+		  dev_t rdev);
+struct dentry *ll_wbc_lookup(struct inode *dir, struct dentry *dentry);
+int ll_wbc_cancel(struct inode *dir, struct dentry *dchild);
+int ll_wbc_flush_inode(struct inode *inode);
+int ll_wbc_flush_all(struct ll_sb_info *sbi);
+int ll_sync_fs(struct super_block *sb, int wait);
+
+static inline bool ll_wbc_pending(struct inode *inode)
+{
+	return ll_file_test_flag(ll_i2info(inode), LLIF_WBC_PENDING);
+}
+
+static inline bool ll_wbc_root(struct inode *inode)
+{
+	return ll_file_test_flag(ll_i2info(inode), LLIF_WBC_ROOT);
+}
+
+/* The root of a cached tree holds its EX lock, nobody else can change it */
+static inline bool ll_wbc_root_locked(struct inode *inode)
+{
+	return ll_wbc_root(inode) &&
+	       lustre_handle_is_used(&ll_i2info(inode)->lli_wbc_lockh);
+}
+
+/* Make sure @inode, if created in the write-back cache, exists on MDT before
+ * an operation which needs it there. The root of a cached tree has its
+ * entries flushed and stops caching. */
+static inline int ll_wbc_flush(struct inode *inode)
+{
+	if (likely(!ll_wbc_pending(inode) && !ll_wbc_root(inode)))
+		return 0;
+
+	return ll_wbc_flush_inode(inode);
+}
+
 /**
  * Common IO arguments for various VFS I/O interfaces.
  */
@@ -132,6 +132,12 @@ static struct ll_sb_info *ll_init_sbi(void)
 	sbi->ll_flags |= LL_SBI_AGL_ENABLED;
 	sbi->ll_flags |= LL_SBI_FAST_READ;
 	sbi->ll_flags |= LL_SBI_TINY_WRITE;
+	sbi->ll_flags |= LL_SBI_PARALLEL_DIO;
+
+	/* lock ahead of strided writes */
+	sbi->ll_lockahead_depth = LL_LOCKAHEAD_DEPTH_DEF;
+	atomic_set(&sbi->ll_lockahead_patterns, 0);
+	atomic_set(&sbi->ll_lockahead_requests, 0);
 
 	/* root squash */
 	sbi->ll_squash.rsi_uid = 0;
@@ -139,6 +145,8 @@ static struct ll_sb_info *ll_init_sbi(void)
 	INIT_LIST_HEAD(&sbi->ll_squash.rsi_nosquash_nids);
 	init_rwsem(&sbi->ll_squash.rsi_sem);
 
+	ll_wbc_init(sbi);
+
 	RETURN(sbi);
 }
 
@@ -221,7 +229,8 @@ static int client_common_fill_super(struct super_block *sb, char *md, char *dt,
 	data->ocd_connect_flags2 = OBD_CONNECT2_FLR |
 				   OBD_CONNECT2_LOCK_CONVERT |
 				   OBD_CONNECT2_DIR_MIGRATE |
-				   OBD_CONNECT2_SUM_STATFS;
+				   OBD_CONNECT2_SUM_STATFS |
+				   OBD_CONNECT2_PARENT_LOCKED;
 
 #ifdef HAVE_LRU_RESIZE_SUPPORT
         if (sbi->ll_flags & LL_SBI_LRU_RESIZE)
@@ -424,7 +433,8 @@ static int client_common_fill_super(struct super_block *sb, char *md, char *dt,
 	data->ocd_connect_flags |= OBD_CONNECT_LOCKAHEAD_OLD;
 #endif
 
-	data->ocd_connect_flags2 = OBD_CONNECT2_LOCKAHEAD;
+	data->ocd_connect_flags2 = OBD_CONNECT2_LOCKAHEAD |
+				   OBD_CONNECT2_MULTIOBJ_BRW;
 
 	if (!OBD_FAIL_CHECK(OBD_FAIL_OSC_CONNECT_GRANT_PARAM))
 		data->ocd_connect_flags |= OBD_CONNECT_GRANT_PARAM;
@@ -770,6 +780,9 @@ void ll_kill_super(struct super_block *sb)
 		sb->s_dev = sbi->ll_sdev_orig;
 		sbi->ll_umounting = 1;
 
+		/* no new cached creates from now on, push the queued ones */
+		ll_wbc_fini(sbi);
+
 		/* wait running statahead threads to quit */
 		while (atomic_read(&sbi->ll_sa_running) > 0) {
 			set_current_state(TASK_UNINTERRUPTIBLE);
@@ -937,6 +950,12 @@ void ll_lli_init(struct ll_inode_info *lli)
         lli->lli_open_fd_write_count = 0;
         lli->lli_open_fd_exec_count = 0;
 	mutex_init(&lli->lli_och_mutex);
+	INIT_LIST_HEAD(&lli->lli_wbc_item);
+	lli->lli_wbc_dentry = NULL;
+	lli->lli_wbc_children = 0;
+	lli->lli_wbc_root = NULL;
+	lli->lli_wbc_lockh.cookie = 0;
+	lli->lli_wbc_tree = 0;
 	spin_lock_init(&lli->lli_agl_lock);
 	spin_lock_init(&lli->lli_layout_lock);
 	ll_layout_version_set(lli, CL_LAYOUT_GEN_NONE);
@@ -1602,6 +1621,10 @@ int ll_setattr_raw(struct dentry *dentry, struct iattr *attr,
 	       inode, i_size_read(inode), attr->ia_size, attr->ia_valid,
 	       hsm_import);
 
+	rc = ll_wbc_flush(inode);
+	if (rc != 0)
+		RETURN(rc);
+
 	if (attr->ia_valid & ATTR_SIZE) {
                 /* Check new size against VFS/VM file size limit and rlimit */
                 rc = inode_newsize_ok(inode, attr->ia_size);
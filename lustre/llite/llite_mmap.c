@@ -509,6 +509,10 @@ int ll_file_mmap(struct file *file, struct vm_area_struct * vma)
                 RETURN(-EOPNOTSUPP);
 
         ll_stats_ops_tally(ll_i2sbi(inode), LPROC_LL_MAP, 1);
+	rc = ll_wbc_flush(inode);
+	if (rc != 0)
+		RETURN(rc);
+
         rc = generic_file_mmap(file, vma);
         if (rc == 0) {
                 vma->vm_ops = &ll_file_vm_ops;
@@ -836,6 +836,42 @@ static int ll_statahead_stats_seq_show(struct seq_file *m, void *v)
 
 LDEBUGFS_SEQ_FOPS_RO(ll_statahead_stats);
 
+static int ll_wbc_stats_seq_show(struct seq_file *m, void *v)
+{
+	struct super_block *sb = m->private;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+
+	seq_printf(m, "pending: %u\n"
+		      "deferred: %u\n"
+		      "flushed: %u\n"
+		      "cancelled: %u\n"
+		      "local lookups: %u\n"
+		      "errors: %u\n",
+		   sbi->ll_wbc_count,
+		   atomic_read(&sbi->ll_wbc_deferred),
+		   atomic_read(&sbi->ll_wbc_flushed),
+		   atomic_read(&sbi->ll_wbc_cancelled),
+		   atomic_read(&sbi->ll_wbc_lookups),
+		   atomic_read(&sbi->ll_wbc_errors));
+	return 0;
+}
+
+LDEBUGFS_SEQ_FOPS_RO(ll_wbc_stats);
+
+static int ll_lockahead_stats_seq_show(struct seq_file *m, void *v)
+{
+	struct super_block *sb = m->private;
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+
+	seq_printf(m, "strided writers: %u\n"
+		      "lockahead requests: %u\n",
+		   atomic_read(&sbi->ll_lockahead_patterns),
+		   atomic_read(&sbi->ll_lockahead_requests));
+	return 0;
+}
+
+LDEBUGFS_SEQ_FOPS_RO(ll_lockahead_stats);
+
 static ssize_t lazystatfs_show(struct kobject *kobj,
 			       struct attribute *attr,
 			       char *buf)
@@ -1048,6 +1084,151 @@ static ssize_t tiny_write_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(tiny_write);
 
+static ssize_t ro_open_cache_show(struct kobject *kobj,
+				  struct attribute *attr,
+				  char *buf)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+
+	return sprintf(buf, "%u\n", !!(sbi->ll_flags & LL_SBI_RO_OPEN_CACHE));
+}
+
+static ssize_t ro_open_cache_store(struct kobject *kobj,
+				   struct attribute *attr,
+				   const char *buffer,
+				   size_t count)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+	bool val;
+	int rc;
+
+	rc = kstrtobool(buffer, &val);
+	if (rc)
+		return rc;
+
+	spin_lock(&sbi->ll_lock);
+	if (val)
+		sbi->ll_flags |= LL_SBI_RO_OPEN_CACHE;
+	else
+		sbi->ll_flags &= ~LL_SBI_RO_OPEN_CACHE;
+	spin_unlock(&sbi->ll_lock);
+
+	return count;
+}
+LUSTRE_RW_ATTR(ro_open_cache);
+
+static ssize_t parallel_dio_show(struct kobject *kobj,
+				 struct attribute *attr,
+				 char *buf)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+
+	return sprintf(buf, "%u\n", ll_sbi_has_parallel_dio(sbi));
+}
+
+static ssize_t parallel_dio_store(struct kobject *kobj,
+				  struct attribute *attr,
+				  const char *buffer,
+				  size_t count)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+	bool val;
+	int rc;
+
+	rc = kstrtobool(buffer, &val);
+	if (rc)
+		return rc;
+
+	spin_lock(&sbi->ll_lock);
+	if (val)
+		sbi->ll_flags |= LL_SBI_PARALLEL_DIO;
+	else
+		sbi->ll_flags &= ~LL_SBI_PARALLEL_DIO;
+	spin_unlock(&sbi->ll_lock);
+
+	return count;
+}
+LUSTRE_RW_ATTR(parallel_dio);
+
+static ssize_t wbc_max_pending_show(struct kobject *kobj,
+				    struct attribute *attr,
+				    char *buf)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+
+	return sprintf(buf, "%u\n", sbi->ll_wbc_max_pending);
+}
+
+static ssize_t wbc_max_pending_store(struct kobject *kobj,
+				     struct attribute *attr,
+				     const char *buffer,
+				     size_t count)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+	unsigned long val;
+	int rc;
+
+	rc = kstrtoul(buffer, 0, &val);
+	if (rc)
+		return rc;
+
+	if (val > LL_WBC_MAX_PENDING_MAX) {
+		CERROR("Bad wbc_max_pending value %lu. Valid values are in the range [0, %d]\n",
+		       val, LL_WBC_MAX_PENDING_MAX);
+		return -ERANGE;
+	}
+
+	sbi->ll_wbc_max_pending = val;
+	/* shrink the write-back cache to the new limit */
+	if (sbi->ll_wbc_count > val)
+		schedule_work(&sbi->ll_wbc_work);
+
+	return count;
+}
+LUSTRE_RW_ATTR(wbc_max_pending);
+
+static ssize_t lockahead_depth_show(struct kobject *kobj,
+				    struct attribute *attr,
+				    char *buf)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+
+	return sprintf(buf, "%u\n", sbi->ll_lockahead_depth);
+}
+
+static ssize_t lockahead_depth_store(struct kobject *kobj,
+				     struct attribute *attr,
+				     const char *buffer,
+				     size_t count)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+	unsigned long val;
+	int rc;
+
+	rc = kstrtoul(buffer, 0, &val);
+	if (rc)
+		return rc;
+
+	if (val > LL_LOCKAHEAD_DEPTH_MAX) {
+		CERROR("Bad lockahead_depth value %lu. Valid values are in the range [0, %d]\n",
+		       val, LL_LOCKAHEAD_DEPTH_MAX);
+		return -ERANGE;
+	}
+
+	sbi->ll_lockahead_depth = val;
+
+	return count;
+}
+LUSTRE_RW_ATTR(lockahead_depth);
+
 static ssize_t fast_read_show(struct kobject *kobj,
 			      struct attribute *attr,
 			      char *buf)
@@ -1252,6 +1433,10 @@ struct lprocfs_vars lprocfs_llite_obd_vars[] = {
 	  .fops	=	&ll_max_cached_mb_fops			},
 	{ .name	=	"statahead_stats",
 	  .fops	=	&ll_statahead_stats_fops		},
+	{ .name	=	"wbc_stats",
+	  .fops	=	&ll_wbc_stats_fops			},
+	{ .name	=	"lockahead_stats",
+	  .fops	=	&ll_lockahead_stats_fops		},
 	{ .name	=	"unstable_stats",
 	  .fops	=	&ll_unstable_stats_fops			},
 	{ .name =	"sbi_flags",
@@ -1291,6 +1476,10 @@ static struct attribute *llite_attrs[] = {
 	&lustre_attr_fast_read.attr,
 	&lustre_attr_pio.attr,
 	&lustre_attr_tiny_write.attr,
+	&lustre_attr_ro_open_cache.attr,
+	&lustre_attr_parallel_dio.attr,
+	&lustre_attr_wbc_max_pending.attr,
+	&lustre_attr_lockahead_depth.attr,
 	NULL,
 };
 
@@ -1323,6 +1512,8 @@ static const struct llite_file_opcode {
                                    "brw_read" },
         { LPROC_LL_BRW_WRITE,      LPROCFS_CNTR_AVGMINMAX|LPROCFS_TYPE_PAGES,
                                    "brw_write" },
+	{ LPROC_LL_DIO_ZERO_COPY,  LPROCFS_TYPE_REGS, "dio_unaligned_zero_copy" },
+	{ LPROC_LL_DIO_BOUNCE,     LPROCFS_TYPE_REGS, "dio_unaligned_bounce" },
         { LPROC_LL_IOCTL,          LPROCFS_TYPE_REGS, "ioctl" },
         { LPROC_LL_OPEN,           LPROCFS_TYPE_REGS, "open" },
         { LPROC_LL_RELEASE,        LPROCFS_TYPE_REGS, "close" },
@@ -156,7 +156,7 @@ struct inode *ll_iget(struct super_block *sb, ino_t hash,
         RETURN(inode);
 }
 
-static void ll_invalidate_negative_children(struct inode *dir)
+void ll_invalidate_negative_children(struct inode *dir)
 {
 	struct dentry *dentry, *tmp_subdir;
 	DECLARE_LL_D_HLIST_NODE_PTR(p);
@@ -705,6 +705,22 @@ static struct dentry *ll_lookup_it(struct inode *parent, struct dentry *dentry,
 	if (it == NULL || it->it_op == IT_GETXATTR)
 		it = &lookup_it;
 
+	if (ll_wbc_pending(parent)) {
+		if (!(it->it_op & IT_CREAT))
+			RETURN(ll_wbc_lookup(parent, dentry));
+
+		/* open(O_CREAT) which is not cached, see ll_atomic_open() */
+		rc = ll_wbc_flush(parent);
+		if (rc != 0)
+			RETURN(ERR_PTR(rc));
+	} else if (ll_wbc_root_locked(parent)) {
+		/* the lookup on MDT would conflict with the root lock anyway,
+		 * stop caching in @parent before, not from its blocking AST */
+		rc = ll_wbc_flush(parent);
+		if (rc != 0)
+			RETURN(ERR_PTR(rc));
+	}
+
 	if (it->it_op == IT_GETATTR && dentry_may_statahead(parent, dentry)) {
 		rc = ll_statahead(parent, &dentry, 0);
 		if (rc == 1)
@@ -878,6 +894,19 @@ static int ll_atomic_open(struct inode *dir, struct dentry *dentry,
 		d_drop(dentry);
 	}
 
+	/* create and open in a directory created in write-back cache */
+	if (open_flags & O_CREAT && ll_wbc_pending(dir) &&
+	    !cl_is_lov_delay_create(open_flags)) {
+		rc = ll_wbc_create(dir, dentry, (mode & S_IALLUGO) | S_IFREG, 0);
+		if (rc == 0) {
+			*opened |= FILE_CREATED;
+			rc = finish_open(file, dentry, NULL, opened);
+		}
+		if (rc <= 0)
+			RETURN(rc);
+		rc = 0;
+	}
+
 	OBD_ALLOC(it, sizeof(*it));
 	if (!it)
 		RETURN(-ENOMEM);
@@ -890,6 +919,7 @@ static int ll_atomic_open(struct inode *dir, struct dentry *dentry,
 	it->it_create_mode = (mode & S_IALLUGO) | S_IFREG;
 	it->it_flags = (open_flags & ~O_ACCMODE) | OPEN_FMODE(open_flags);
 	it->it_flags &= ~MDS_OPEN_FL_INTERNAL;
+	ll_intent_ro_open_lock(ll_i2sbi(dir), it);
 
 	/* Dentry added to dcache tree in ll_lookup_it */
 	de = ll_lookup_it(dir, dentry, it, &secctx, &secctxlen);
@@ -998,6 +1028,8 @@ static struct dentry *ll_lookup_nd(struct inode *parent, struct dentry *dentry,
 				(nd->path.mnt->mnt_sb->s_flags & MS_RDONLY));
 			if (IS_ERR(it))
 				RETURN((struct dentry *)it);
+			if (it->it_op & IT_OPEN)
+				ll_intent_ro_open_lock(ll_i2sbi(parent), it);
 		}
 
 		de = ll_lookup_it(parent, dentry, it, NULL, NULL);
@@ -1171,6 +1203,10 @@ static int ll_new_node(struct inode *dir, struct dentry *dchild,
         if (unlikely(tgt != NULL))
                 tgt_len = strlen(tgt) + 1;
 
+	err = ll_wbc_flush(dir);
+	if (err != 0)
+		RETURN(err);
+
 again:
 	op_data = ll_prep_md_op_data(NULL, dir, NULL, name->name,
 				     name->len, 0, opc, NULL);
@@ -1289,8 +1325,11 @@ static int ll_mknod(struct inode *dir, struct dentry *dchild, ll_umode_t mode,
         case S_IFBLK:
         case S_IFIFO:
         case S_IFSOCK:
-		err = ll_new_node(dir, dchild, NULL, mode, old_encode_dev(rdev),
-				  LUSTRE_OPC_MKNOD);
+		err = ll_wbc_create(dir, dchild, mode, rdev);
+		if (err > 0)
+			err = ll_new_node(dir, dchild, NULL, mode,
+					  old_encode_dev(rdev),
+					  LUSTRE_OPC_MKNOD);
                 break;
         case S_IFDIR:
                 err = -EPERM;
@@ -1419,6 +1458,12 @@ static int ll_link(struct dentry *old_dentry, struct inode *dir,
 	       "target=%.*s\n", PFID(ll_inode2fid(src)), src,
 	       PFID(ll_inode2fid(dir)), dir, name->len, name->name);
 
+	err = ll_wbc_flush(src);
+	if (err == 0)
+		err = ll_wbc_flush(dir);
+	if (err != 0)
+		RETURN(err);
+
         op_data = ll_prep_md_op_data(NULL, src, dir, name->name, name->len,
                                      0, LUSTRE_OPC_ANY, NULL);
         if (IS_ERR(op_data))
@@ -1451,7 +1496,16 @@ static int ll_mkdir(struct inode *dir, struct dentry *dchild, ll_umode_t mode)
 
 	mode = (mode & (S_IRWXUGO|S_ISVTX)) | S_IFDIR;
 
-	err = ll_new_node(dir, dchild, NULL, mode, 0, LUSTRE_OPC_MKDIR);
+	err = ll_wbc_create(dir, dchild, mode, 0);
+	if (err > 0) {
+		/* the root of a cached tree is created on MDT */
+		bool root = ll_wbc_may_root(dir, dchild, mode);
+
+		err = ll_new_node(dir, dchild, NULL, mode, 0,
+				  LUSTRE_OPC_MKDIR);
+		if (err == 0 && root)
+			ll_wbc_root_set(dchild->d_inode);
+	}
 	if (err == 0)
 		ll_stats_ops_tally(ll_i2sbi(dir), LPROC_LL_MKDIR, 1);
 
@@ -1472,6 +1526,15 @@ static int ll_rmdir(struct inode *dir, struct dentry *dchild)
 	if (unlikely(d_mountpoint(dchild)))
                 RETURN(-EBUSY);
 
+	/* directory created in write-back cache is dropped locally */
+	if (dchild->d_inode != NULL && ll_wbc_pending(dchild->d_inode)) {
+		rc = ll_wbc_cancel(dir, dchild);
+		if (rc == 0)
+			ll_stats_ops_tally(ll_i2sbi(dir), LPROC_LL_RMDIR, 1);
+		if (rc != -EAGAIN)
+			RETURN(rc);
+	}
+
         op_data = ll_prep_md_op_data(NULL, dir, NULL, name->name, name->len,
                                      S_IFDIR, LUSTRE_OPC_ANY, NULL);
         if (IS_ERR(op_data))
@@ -1539,6 +1602,20 @@ static int ll_unlink(struct inode *dir, struct dentry *dchild)
 	if (unlikely(d_mountpoint(dchild)))
 		RETURN(-EBUSY);
 
+	/* file created in write-back cache is dropped locally, unless it is
+	 * open: then it is created on MDT to be open-unlinked there */
+	if (ll_wbc_pending(dchild->d_inode)) {
+		rc = ll_wbc_cancel(dir, dchild);
+		if (rc == 0) {
+			ll_stats_ops_tally(ll_i2sbi(dir), LPROC_LL_UNLINK, 1);
+			RETURN(0);
+		}
+		if (rc == -EBUSY)
+			rc = ll_wbc_flush(dchild->d_inode);
+		if (rc != 0 && rc != -EAGAIN)
+			RETURN(rc);
+	}
+
 	op_data = ll_prep_md_op_data(NULL, dir, NULL, name->name, name->len, 0,
 				     LUSTRE_OPC_ANY, NULL);
 	if (IS_ERR(op_data))
@@ -1597,6 +1674,17 @@ static int ll_rename(struct inode *src, struct dentry *src_dchild,
 	if (unlikely(d_mountpoint(src_dchild) || d_mountpoint(tgt_dchild)))
 		RETURN(-EBUSY);
 
+	/* rename is not cached, the entries must be on MDT */
+	err = ll_wbc_flush(src);
+	if (err == 0)
+		err = ll_wbc_flush(tgt);
+	if (err == 0 && src_dchild->d_inode != NULL)
+		err = ll_wbc_flush(src_dchild->d_inode);
+	if (err == 0 && tgt_dchild->d_inode != NULL)
+		err = ll_wbc_flush(tgt_dchild->d_inode);
+	if (err != 0)
+		RETURN(err);
+
 	op_data = ll_prep_md_op_data(NULL, src, tgt, NULL, 0, 0,
 				     LUSTRE_OPC_ANY, NULL);
 	if (IS_ERR(op_data))
@@ -174,10 +174,103 @@ static int ll_releasepage(struct page *vmpage, RELEASEPAGE_ARG_TYPE gfp_mask)
 
 #define MAX_DIRECTIO_SIZE 2*1024*1024*1024UL
 
+/**
+ * Submit direct IO pages without waiting for them.
+ *
+ * Pages sent are kept in vvp_io::vui_dio_pages and counted by
+ * vvp_io::vui_dio_anchor, so chunks of all stripes of the IO iteration are
+ * in flight together. ll_dio_wait() waits for them and releases the pages.
+ */
+static int ll_dio_submit(const struct lu_env *env, struct cl_io *io,
+			 enum cl_req_type crt, struct cl_2queue *queue)
+{
+	struct vvp_io *vio = vvp_env_io(env);
+	struct cl_sync_io *anchor = &vio->vui_dio_anchor;
+	struct cl_page *pg;
+	int rc;
+
+	if (!vio->vui_dio_inflight) {
+		/* the reference of the submitter is dropped in ll_dio_wait() */
+		cl_sync_io_init(anchor, 1, &cl_sync_io_end);
+		cl_page_list_init(&vio->vui_dio_pages);
+		vio->vui_dio_inflight = true;
+	}
+
+	cl_page_list_for_each(pg, &queue->c2_qin) {
+		LASSERT(pg->cp_sync_io == NULL);
+		pg->cp_sync_io = anchor;
+	}
+	atomic_add(queue->c2_qin.pl_nr, &anchor->csi_sync_nr);
+
+	rc = cl_io_submit_rw(env, io, crt, queue);
+	if (rc == 0) {
+		/* pages not sent for any reason are completed already */
+		cl_page_list_for_each(pg, &queue->c2_qin) {
+			pg->cp_sync_io = NULL;
+			cl_sync_io_note(env, anchor, 1);
+		}
+		cl_page_list_splice(&queue->c2_qout, &vio->vui_dio_pages);
+	} else {
+		LASSERT(list_empty(&queue->c2_qout.pl_pages));
+		cl_page_list_for_each(pg, &queue->c2_qin)
+			pg->cp_sync_io = NULL;
+		atomic_sub(queue->c2_qin.pl_nr, &anchor->csi_sync_nr);
+	}
+
+	return rc;
+}
+
+/**
+ * Wait for direct IO pages submitted by ll_dio_submit() and release them.
+ *
+ * Called at the end of ->direct_IO(), while the locks of the IO iteration
+ * and, for read, the inode lock are still held. The caller extends i_size
+ * and reports bytes done only after this.
+ *
+ * \retval 0		all pages were transferred, or there were none
+ * \retval negative	error of the first failed page
+ */
+static int ll_dio_wait(const struct lu_env *env, struct cl_io *io)
+{
+	struct vvp_io *vio = vvp_env_io(env);
+	struct cl_page_list *plist = &vio->vui_dio_pages;
+	struct cl_page *pg;
+	int rc;
+
+	ENTRY;
+
+	if (!vio->vui_dio_inflight)
+		RETURN(0);
+
+	cl_sync_io_note(env, &vio->vui_dio_anchor, 0);
+	rc = cl_sync_io_wait(env, &vio->vui_dio_anchor, 0);
+
+	cl_page_list_assume(env, io, plist);
+	/* user pages have been filled, see ll_free_user_pages() */
+	if (io->ci_type == CIT_READ) {
+		cl_page_list_for_each(pg, plist)
+			set_page_dirty_lock(cl_page_vmpage(pg));
+	}
+	cl_page_list_discard(env, io, plist);
+	cl_page_list_disown(env, io, plist);
+	cl_page_list_fini(env, plist);
+	vio->vui_dio_inflight = false;
+
+	RETURN(rc);
+}
+
+/**
+ * Direct IO of \a size bytes at \a file_offset from or to \a pages.
+ *
+ * \a pages hold the file pages covering the range, the first one at the
+ * offset of \a file_offset in page, so unaligned head and tail of the range
+ * are sent as partial pages. The transfer is waited for if \a wait is set,
+ * otherwise it may be left in flight until ll_dio_wait().
+ */
 static ssize_t
 ll_direct_IO_seg(const struct lu_env *env, struct cl_io *io, int rw,
 		 struct inode *inode, size_t size, loff_t file_offset,
-		 struct page **pages, int page_count)
+		 struct page **pages, int page_count, bool wait)
 {
 	struct cl_page *clp;
 	struct cl_2queue *queue;
@@ -186,6 +279,8 @@ ll_direct_IO_seg(const struct lu_env *env, struct cl_io *io, int rw,
 	ssize_t rc = 0;
 	size_t page_size = cl_page_size(obj);
 	size_t orig_size = size;
+	size_t from;
+	size_t to;
 	bool do_io;
 	int io_pages = 0;
 
@@ -193,7 +288,8 @@ ll_direct_IO_seg(const struct lu_env *env, struct cl_io *io, int rw,
 	queue = &io->ci_queue;
 	cl_2queue_init(queue);
 	for (i = 0; i < page_count; i++) {
-		LASSERT(!(file_offset & (page_size - 1)));
+		from = file_offset & (page_size - 1);
+		to = min(page_size, from + size);
 		clp = cl_page_find(env, obj, cl_index(obj, file_offset),
 				   pages[i], CPT_TRANSIENT);
 		if (IS_ERR(clp)) {
@@ -225,7 +321,7 @@ ll_direct_IO_seg(const struct lu_env *env, struct cl_io *io, int rw,
 
 			src = ll_kmap_atomic(src_page, KM_USER0);
 			dst = ll_kmap_atomic(dst_page, KM_USER1);
-			memcpy(dst, src, min(page_size, size));
+			memcpy(dst + from, src + from, to - from);
 			ll_kunmap_atomic(dst, KM_USER1);
 			ll_kunmap_atomic(src, KM_USER0);
 
@@ -252,21 +348,26 @@ ll_direct_IO_seg(const struct lu_env *env, struct cl_io *io, int rw,
 			 * Set page clip to tell transfer formation engine
 			 * that page has to be sent even if it is beyond KMS.
 			 */
-			cl_page_clip(env, clp, 0, min(size, page_size));
+			cl_page_clip(env, clp, from, to);
 
 			++io_pages;
 		}
 
 		/* drop the reference count for cl_page_find */
 		cl_page_put(env, clp);
-		size -= page_size;
-		file_offset += page_size;
+		size -= to - from;
+		file_offset += to - from;
 	}
 
 	if (rc == 0 && io_pages) {
-		rc = cl_io_submit_sync(env, io,
-				       rw == READ ? CRT_READ : CRT_WRITE,
-				       queue, 0);
+		if (!wait && io->ci_parallel_dio)
+			rc = ll_dio_submit(env, io,
+					   rw == READ ? CRT_READ : CRT_WRITE,
+					   queue);
+		else
+			rc = cl_io_submit_sync(env, io,
+					       rw == READ ? CRT_READ : CRT_WRITE,
+					       queue, 0);
 	}
 	if (rc == 0)
 		rc = orig_size;
@@ -298,6 +399,89 @@ static void ll_free_user_pages(struct page **pages, int npages, int do_dirty)
 #endif
 }
 
+/* Maximum size of direct IO done through bounce pages at once */
+#define LL_DIO_BOUNCE_SIZE	(4UL << 20)
+
+/**
+ * Copy \a len bytes from \a src pages at offset \a soff in the first page
+ * to \a dst pages at offset \a doff in the first page.
+ */
+static void ll_dio_copy_pages(struct page **dst, size_t doff,
+			      struct page **src, size_t soff, size_t len)
+{
+	while (len > 0) {
+		size_t count = min_t(size_t, len,
+				     PAGE_SIZE - max(doff, soff));
+		void *s;
+		void *d;
+
+		s = ll_kmap_atomic(*src, KM_USER0);
+		d = ll_kmap_atomic(*dst, KM_USER1);
+		memcpy(d + doff, s + soff, count);
+		ll_kunmap_atomic(d, KM_USER1);
+		ll_kunmap_atomic(s, KM_USER0);
+
+		len -= count;
+		doff += count;
+		soff += count;
+		if (doff == PAGE_SIZE) {
+			dst++;
+			doff = 0;
+		}
+		if (soff == PAGE_SIZE) {
+			src++;
+			soff = 0;
+		}
+	}
+}
+
+/**
+ * Direct IO through bounce pages.
+ *
+ * Used when the user buffer is not at the same offset in page as
+ * \a file_offset is, so user pages cannot be sent as file pages. Data is
+ * copied between \a pages at offset \a offs and bounce pages, which are
+ * not in the page cache, and the transfer is waited for.
+ */
+static ssize_t
+ll_direct_IO_bounce(const struct lu_env *env, struct cl_io *io, int rw,
+		    struct inode *inode, size_t size, loff_t file_offset,
+		    struct page **pages, size_t offs)
+{
+	size_t foff = file_offset & ~PAGE_MASK;
+	int page_count = DIV_ROUND_UP(foff + size, PAGE_SIZE);
+	struct page **bounce;
+	ssize_t rc;
+	int i;
+
+	ENTRY;
+
+	OBD_ALLOC_LARGE(bounce, page_count * sizeof(*bounce));
+	if (bounce == NULL)
+		RETURN(-ENOMEM);
+
+	for (i = 0; i < page_count; i++) {
+		bounce[i] = alloc_page(GFP_NOFS);
+		if (bounce[i] == NULL)
+			GOTO(out, rc = -ENOMEM);
+	}
+
+	if (rw == WRITE)
+		ll_dio_copy_pages(bounce, foff, pages, offs, size);
+
+	rc = ll_direct_IO_seg(env, io, rw, inode, size, file_offset,
+			      bounce, page_count, true);
+
+	if (rc > 0 && rw == READ)
+		ll_dio_copy_pages(pages, offs, bounce, foff, rc);
+out:
+	for (i = 0; i < page_count && bounce[i] != NULL; i++)
+		put_page(bounce[i]);
+	OBD_FREE_LARGE(bounce, page_count * sizeof(*bounce));
+
+	RETURN(rc);
+}
+
 #ifdef KMALLOC_MAX_SIZE
 #define MAX_MALLOC KMALLOC_MAX_SIZE
 #else
@@ -339,13 +523,11 @@ ll_direct_IO(
 	ssize_t count = iov_iter_count(iter);
 	ssize_t tot_bytes = 0, result = 0;
 	size_t size = MAX_DIO_SIZE;
+	int rc;
 
 	/* Check EOF by ourselves */
 	if (iov_iter_rw(iter) == READ && file_offset >= i_size_read(inode))
 		return 0;
-	/* FIXME: io smaller than PAGE_SIZE is broken on ia64 ??? */
-	if ((file_offset & ~PAGE_MASK) || (count & ~PAGE_MASK))
-		return -EINVAL;
 
 	CDEBUG(D_VFSTRACE, "VFS Op:inode="DFID"(%p), size=%zd (max %lu), "
 	       "offset=%lld=%llx, pages %zd (max %lu)\n",
@@ -353,10 +535,6 @@ ll_direct_IO(
 	       file_offset, file_offset, count >> PAGE_SHIFT,
 	       MAX_DIO_SIZE >> PAGE_SHIFT);
 
-	/* Check that all user buffers are aligned as well */
-	if (iov_iter_alignment(iter) & ~PAGE_MASK)
-		return -EINVAL;
-
 	lcc = ll_cl_find(file);
 	if (lcc == NULL)
 		RETURN(-EIO);
@@ -390,9 +568,28 @@ ll_direct_IO(
 		if (likely(result > 0)) {
 			int n = DIV_ROUND_UP(result + offs, PAGE_SIZE);
 
-			result = ll_direct_IO_seg(env, io, iov_iter_rw(iter),
-						  inode, result, file_offset,
-						  pages, n);
+			/* Unaligned head and tail are sent as partial pages
+			 * if the user buffer is at the same offset in page as
+			 * the file, otherwise data goes through bounce pages.
+			 */
+			if (offs == (file_offset & ~PAGE_MASK)) {
+				if (offs != 0 || (result & ~PAGE_MASK))
+					ll_stats_ops_tally(ll_i2sbi(inode),
+						LPROC_LL_DIO_ZERO_COPY, 1);
+				result = ll_direct_IO_seg(env, io,
+							  iov_iter_rw(iter),
+							  inode, result,
+							  file_offset, pages,
+							  n, false);
+			} else {
+				ll_stats_ops_tally(ll_i2sbi(inode),
+						   LPROC_LL_DIO_BOUNCE, 1);
+				result = ll_direct_IO_bounce(env, io,
+						iov_iter_rw(iter), inode,
+						min_t(size_t, result,
+						      LL_DIO_BOUNCE_SIZE),
+						file_offset, pages, offs);
+			}
 			ll_free_user_pages(pages, n,
 					   iov_iter_rw(iter) == READ);
 
@@ -421,6 +618,12 @@ ll_direct_IO(
 		file_offset += result;
 	}
 out:
+	rc = ll_dio_wait(env, io);
+	if (rc < 0) {
+		tot_bytes = 0;
+		result = rc;
+	}
+
 	if (iov_iter_rw(iter) == READ)
 		inode_unlock(inode);
 
@@ -478,6 +681,7 @@ ll_direct_IO(int rw, struct kiocb *iocb, const struct iovec *iov,
 	ssize_t tot_bytes = 0, result = 0;
 	unsigned long seg = 0;
 	size_t size = MAX_DIO_SIZE;
+	int rc;
 	ENTRY;
 
         /* FIXME: io smaller than PAGE_SIZE is broken on ia64 ??? */
@@ -530,7 +734,8 @@ ll_direct_IO(int rw, struct kiocb *iocb, const struct iovec *iov,
 					bytes = page_count << PAGE_SHIFT;
 				result = ll_direct_IO_seg(env, io, rw, inode,
 							  bytes, file_offset,
-							  pages, page_count);
+							  pages, page_count,
+							  false);
                                 ll_free_user_pages(pages, max_pages, rw==READ);
                         } else if (page_count == 0) {
                                 GOTO(out, result = -EFAULT);
@@ -564,6 +769,12 @@ ll_direct_IO(int rw, struct kiocb *iocb, const struct iovec *iov,
                 }
         }
 out:
+	rc = ll_dio_wait(env, io);
+	if (rc < 0) {
+		tot_bytes = 0;
+		result = rc;
+	}
+
         if (tot_bytes > 0) {
 		struct vvp_io *vio = vvp_env_io(env);
 
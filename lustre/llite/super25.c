@@ -90,6 +90,7 @@ struct super_operations lustre_super_operations =
 #endif
         .put_super     = ll_put_super,
         .statfs        = ll_statfs,
+        .sync_fs       = ll_sync_fs,
         .umount_begin  = ll_umount_begin,
         .remount_fs    = ll_remount_fs,
         .show_options  = ll_show_options,
@@ -116,6 +116,12 @@ struct vvp_io {
 	pgoff_t	vui_ra_count;
 	/* Set when vui_ra_{start,count} have been initialized. */
 	bool		vui_ra_valid;
+	/* Set when direct IO pages are in flight, see ll_dio_wait() */
+	bool			vui_dio_inflight;
+	/* Anchor counting direct IO pages in flight */
+	struct cl_sync_io	vui_dio_anchor;
+	/* Direct IO pages in flight */
+	struct cl_page_list	vui_dio_pages;
 };
 
 extern struct lu_device_type vvp_device_type;
@@ -307,6 +313,7 @@ int lov_read_and_clear_async_rc(struct cl_object *clob);
 int vvp_io_init(const struct lu_env *env, struct cl_object *obj,
 		struct cl_io *io);
 int vvp_io_write_commit(const struct lu_env *env, struct cl_io *io);
+void vvp_io_lockahead(struct file *file, loff_t pos, size_t count);
 int vvp_page_init(const struct lu_env *env, struct cl_object *obj,
 		  struct cl_page *page, pgoff_t index);
 struct lu_object *vvp_object_alloc(const struct lu_env *env,
@@ -303,6 +303,7 @@ static void vvp_io_fini(const struct lu_env *env, const struct cl_io_slice *ios)
 	ENTRY;
 
 	CLOBINVRNT(env, obj, vvp_object_invariant(obj));
+	LASSERT(!vio->vui_dio_inflight);
 
 	CDEBUG(D_VFSTRACE, DFID" ignore/verify layout %d/%d, layout version %d "
 	       "need write layout %d, restore needed %d\n",
@@ -590,15 +591,112 @@ static int vvp_io_fault_lock(const struct lu_env *env,
 				     io->u.ci_fault.ft_index);
 }
 
+/**
+ * Request write locks ahead of strided writes.
+ *
+ * In N-to-1 checkpoints every writer writes a fixed size block at a fixed
+ * stride in the shared file. The write locks are expanded by the server to
+ * cover the blocks of the other writers, and called back at their next
+ * write, so most of the time goes to lock callbacks. Once a file descriptor
+ * did LL_LOCKAHEAD_HITS consecutive writes of the same size at the same
+ * stride, with a gap in between, its write locks are no longer expanded
+ * (see vvp_io_write_lock()) and locks for the next ll_lockahead_depth
+ * blocks are requested with asynchronous, non-blocking lockahead, as an
+ * application would do with LU_LADVISE_LOCKAHEAD.
+ *
+ * Called before the write io is set up, as the lock requests need their own
+ * io on the object.
+ */
+void vvp_io_lockahead(struct file *file, loff_t pos, size_t count)
+{
+	struct ll_file_data *fd = LUSTRE_FPRIVATE(file);
+	struct ll_lockahead_state *lah = &fd->fd_lah;
+	struct ll_sb_info *sbi = ll_i2sbi(file_inode(file));
+	unsigned int depth = sbi->ll_lockahead_depth;
+	loff_t stride;
+	loff_t next;
+	loff_t last;
+	int rc;
+	ENTRY;
+
+	/* applications managing locks themselves, see ll_lock_noexpand() */
+	if (depth == 0 || count == 0 || fd->ll_lock_no_expand ||
+	    lah->lah_disabled || file->f_flags & O_APPEND ||
+	    ll_file_nolock(file))
+		RETURN_EXIT;
+
+	spin_lock(&lah->lah_lock);
+	if (count == lah->lah_count && lah->lah_stride > count &&
+	    pos - lah->lah_pos == lah->lah_stride) {
+		if (lah->lah_hits < LL_LOCKAHEAD_HITS) {
+			lah->lah_hits++;
+			if (lah->lah_hits == LL_LOCKAHEAD_HITS)
+				atomic_inc(&sbi->ll_lockahead_patterns);
+		}
+	} else {
+		lah->lah_stride = pos - lah->lah_pos;
+		lah->lah_hits = 0;
+		lah->lah_next = 0;
+	}
+	lah->lah_pos = pos;
+	lah->lah_count = count;
+
+	if (lah->lah_hits < LL_LOCKAHEAD_HITS) {
+		spin_unlock(&lah->lah_lock);
+		RETURN_EXIT;
+	}
+
+	stride = lah->lah_stride;
+	next = max(lah->lah_next, pos + stride);
+	last = pos + depth * stride;
+	lah->lah_next = last + stride;
+	spin_unlock(&lah->lah_lock);
+
+	for (; next <= last; next += stride) {
+		struct llapi_lu_ladvise ladvise = {
+			.lla_advice		= LU_LADVISE_LOCKAHEAD,
+			.lla_lockahead_mode	= MODE_WRITE_USER,
+			.lla_peradvice_flags	= LF_ASYNC,
+			.lla_start		= next,
+			.lla_end		= next + count - 1,
+		};
+
+		rc = ll_file_lock_ahead(file, &ladvise);
+		if (rc == -EOPNOTSUPP) {
+			spin_lock(&lah->lah_lock);
+			lah->lah_disabled = 1;
+			lah->lah_hits = 0;
+			spin_unlock(&lah->lah_lock);
+			break;
+		}
+		/* LLA_RESULT_{SAME,DIFFERENT}: a lock is already there */
+		if (rc < 0) {
+			CDEBUG(D_DLMTRACE, "%s: lockahead [%lld, %lld]: rc = %d\n",
+			       file_dentry(file)->d_name.name, next,
+			       next + count - 1, rc);
+			break;
+		}
+		atomic_inc(&sbi->ll_lockahead_requests);
+	}
+
+	EXIT;
+}
+
 static int vvp_io_write_lock(const struct lu_env *env,
                              const struct cl_io_slice *ios)
 {
 	struct cl_io *io = ios->cis_io;
+	struct vvp_io *vio = cl2vvp_io(env, ios);
 	loff_t start;
 	loff_t end;
 	int rc;
 
 	ENTRY;
+	/* the next blocks are locked ahead, do not grab them with this one */
+	if (vio->vui_fd != NULL &&
+	    vio->vui_fd->fd_lah.lah_hits >= LL_LOCKAHEAD_HITS)
+		io->ci_lock_no_expand = 1;
+
 	if (io->u.ci_rw.rw_append) {
 		start = 0;
 		end   = OBD_OBJECT_EOF;
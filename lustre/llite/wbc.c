@@ -0,0 +1,806 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * GPL HEADER END
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ * Lustre is a trademark of Sun Microsystems, Inc.
+ *
+ * lustre/llite/wbc.c
+ *
+ * Write-back cache of namespace operations.
+ *
+ * Jobs where every rank creates and later removes its own scratch tree send
+ * one synchronous RPC per created and removed entry. With
+ * llite.*.wbc_max_pending set, such a tree is cached on the client instead.
+ * Its top directory is created on MDT as usual, so that mkdir(2) of a name
+ * which exists or is created concurrently by another client fails there,
+ * and becomes the root of the cached tree (LLIF_WBC_ROOT). Directories and
+ * special files created in the root are cached: the FID is allocated
+ * locally, the inode is instantiated from local attributes and queued on
+ * ll_sb_info::ll_wbc_list. Nobody else can see a directory which is not on
+ * MDT yet, so the client knows its whole content: lookup of an uncached
+ * name in it is negative without RPC, and files, directories and special
+ * files created in it are cached as well. open(2) of a cached regular file
+ * is local too, it is replayed on MDT after the create.
+ *
+ * The names cached in the root itself are protected by an EX UPDATE|LOOKUP
+ * lock on it, taken at the first cached create and held while any entry of
+ * the tree is pending (lli_wbc_tree). Other clients can neither create a
+ * name in the root nor reach the tree below it meanwhile; their access
+ * conflicts with the lock, the client flushes the tree from its blocking AST
+ * and the root stops caching. The creates in the root are sent to MDT with
+ * the lock handle (MDS_PARENT_LOCKED), MDT doesn't take the parent lock for
+ * them. A lookup or any other operation on the root on this client stops
+ * caching in it too.
+ *
+ * Cached creates are sent to MDT in creation order, so a parent is always
+ * there before its children:
+ * - in the background, once more than wbc_max_pending creates are queued;
+ * - before an operation which needs the object or its name on MDT: IO,
+ *   setattr, setxattr, link, rename, readdir, symlink in a cached directory;
+ * - at sync(2) and umount.
+ * unlink(2) and rmdir(2) of a cached entry which is not open just drop it.
+ *
+ * File data needs the layout from MDT, so the first IO flushes the file.
+ * A delayed create can fail on MDT (quota, or a name in the root created by
+ * another client after this one was evicted and lost the root lock), that
+ * is reported on the console and counted in wbc_stats, the entry and its
+ * subtree are dropped.
+ */
+
+#define DEBUG_SUBSYSTEM S_LLITE
+
+#include <linux/fs.h>
+#include <linux/sched.h>
+#include <linux/selinux.h>
+#include <linux/workqueue.h>
+
+#include <obd_support.h>
+#include <obd_class.h>
+#include <lustre_dlm.h>
+#include "llite_internal.h"
+
+/* Whether the write-back cache is usable for @dchild at all. */
+static bool ll_wbc_enabled(struct inode *dir, struct dentry *dchild)
+{
+	struct ll_sb_info *sbi = ll_i2sbi(dir);
+
+	if (sbi->ll_wbc_max_pending == 0 || sbi->ll_umounting)
+		return false;
+
+	if (sbi->ll_flags & LL_SBI_FILE_SECCTX || selinux_is_enabled())
+		return false;
+
+	return !filename_is_volatile(dchild->d_name.name, dchild->d_name.len,
+				     NULL);
+}
+
+/*
+ * Whether a create in @dir can be cached: @dir is cached itself, or is the
+ * root of a cached tree.
+ */
+static bool ll_wbc_may_cache(struct inode *dir, struct dentry *dchild)
+{
+	if (!ll_wbc_pending(dir) && !ll_wbc_root(dir))
+		return false;
+
+	return ll_wbc_enabled(dir, dchild);
+}
+
+/**
+ * Whether the directory @dchild, to be created in @dir on MDT, can be the
+ * root of a cached tree. Anything the MDT could decide differently from the
+ * client for the entries below it is excluded: striped directories and
+ * directories with default stripe, inherited default ACL, security labels.
+ */
+bool ll_wbc_may_root(struct inode *dir, struct dentry *dchild, umode_t mode)
+{
+	struct ll_inode_info *lli = ll_i2info(dir);
+	int rc;
+
+	/* the names cached in the root are created under its lock */
+	if (!exp_connect_parent_locked(ll_i2mdexp(dir)))
+		return false;
+
+	if (!ll_wbc_enabled(dir, dchild))
+		return false;
+
+	if (!S_ISDIR(mode) || lli->lli_lsm_md != NULL ||
+	    lli->lli_def_stripe_offset != -1)
+		return false;
+
+	if (!IS_POSIXACL(dir))
+		return true;
+
+	rc = ll_xattr_list(dir, XATTR_NAME_POSIX_ACL_DEFAULT,
+			   XATTR_ACL_DEFAULT_T, NULL, 0, OBD_MD_FLXATTR);
+
+	return rc == -ENODATA;
+}
+
+/* Make the directory @inode, just created on MDT, the root of a cached tree */
+void ll_wbc_root_set(struct inode *inode)
+{
+	ll_file_set_flag(ll_i2info(inode), LLIF_WBC_ROOT);
+
+	CDEBUG(D_INODE, "%s: "DFID" is the root of a cached tree\n",
+	       ll_get_fsname(inode->i_sb, NULL, 0), PFID(ll_inode2fid(inode)));
+}
+
+/*
+ * Account a pending entry in the cached tree of @dir, a pending directory or
+ * the root itself, if the root is still caching under its lock. Called with
+ * ll_wbc_sem held for read, the root doesn't stop caching until the entry
+ * is queued. Returns the root, or NULL if the create is not to be cached.
+ */
+static struct inode *ll_wbc_tree_get(struct ll_sb_info *sbi,
+				     struct inode *dir)
+{
+	struct inode *root;
+
+	spin_lock(&sbi->ll_wbc_lock);
+	root = ll_wbc_root(dir) ? dir : ll_i2info(dir)->lli_wbc_root;
+	if (root != NULL && ll_wbc_root_locked(root))
+		ll_i2info(root)->lli_wbc_tree++;
+	else
+		root = NULL;
+	spin_unlock(&sbi->ll_wbc_lock);
+
+	return root;
+}
+
+/*
+ * Release a pending entry of the tree of @root. The lock of the root is not
+ * needed anymore once nothing is pending in the tree, it is cancelled, the
+ * next cached create in the root takes it again.
+ */
+static void ll_wbc_tree_put(struct ll_sb_info *sbi, struct inode *root)
+{
+	struct ll_inode_info *lli = ll_i2info(root);
+	struct lustre_handle lockh = { 0 };
+
+	spin_lock(&sbi->ll_wbc_lock);
+	if (--lli->lli_wbc_tree == 0 && ll_wbc_root(root)) {
+		lockh = lli->lli_wbc_lockh;
+		lli->lli_wbc_lockh.cookie = 0;
+	}
+	spin_unlock(&sbi->ll_wbc_lock);
+
+	if (lustre_handle_is_used(&lockh))
+		ldlm_cli_cancel(&lockh, LCF_ASYNC);
+}
+
+/* Remove @lli from the flush list, called with ll_wbc_mutex held. */
+static void ll_wbc_dequeue(struct ll_sb_info *sbi, struct ll_inode_info *lli)
+{
+	struct inode *dir = lli->lli_wbc_dentry->d_parent->d_inode;
+	struct inode *root;
+
+	spin_lock(&sbi->ll_wbc_lock);
+	list_del_init(&lli->lli_wbc_item);
+	sbi->ll_wbc_count--;
+	ll_i2info(dir)->lli_wbc_children--;
+	root = lli->lli_wbc_root;
+	lli->lli_wbc_root = NULL;
+	spin_unlock(&sbi->ll_wbc_lock);
+
+	ll_wbc_tree_put(sbi, root);
+}
+
+static int ll_wbc_root_lock(struct inode *dir);
+
+/**
+ * Create @dchild in @dir in the write-back cache.
+ *
+ * \retval 0		created locally, the create is queued for MDT
+ * \retval 1		the create can't be cached, it is to be sent to MDT
+ * \retval negative	error
+ */
+int ll_wbc_create(struct inode *dir, struct dentry *dchild, umode_t mode,
+		  dev_t rdev)
+{
+	struct ll_sb_info *sbi = ll_i2sbi(dir);
+	struct ll_inode_info *plli = ll_i2info(dir);
+	struct lustre_md md = { NULL };
+	struct mdt_body body = { 0 };
+	struct md_op_data *op_data;
+	struct ll_inode_info *lli;
+	struct inode *inode;
+	struct inode *root;
+	bool flush;
+	s64 now;
+	int rc;
+	ENTRY;
+
+	if (!ll_wbc_may_cache(dir, dchild))
+		RETURN(1);
+
+	if (ll_wbc_root(dir) && ll_wbc_root_lock(dir) < 0)
+		RETURN(1);
+
+	down_read(&sbi->ll_wbc_sem);
+	root = ll_wbc_tree_get(sbi, dir);
+	if (root == NULL)
+		GOTO(out_sem, rc = 1);
+
+	/* no default ACL to inherit, see ll_wbc_may_root() */
+	mode &= ~current_umask();
+
+	op_data = ll_prep_md_op_data(NULL, dir, NULL, dchild->d_name.name,
+				     dchild->d_name.len, mode,
+				     S_ISDIR(mode) ? LUSTRE_OPC_MKDIR :
+						     LUSTRE_OPC_MKNOD, NULL);
+	if (IS_ERR(op_data))
+		GOTO(out_put, rc = PTR_ERR(op_data));
+
+	/* choose MDT exactly as lmv_create() would */
+	rc = obd_fid_alloc(NULL, sbi->ll_md_exp, &body.mbo_fid1, op_data);
+	ll_finish_md_op_data(op_data);
+	if (rc < 0)
+		GOTO(out_put, rc);
+
+	/* the root lock is on the MDT of the root */
+	if (root == dir &&
+	    ll_get_mdt_idx_by_fid(sbi, &body.mbo_fid1) !=
+	    ll_get_mdt_idx_by_fid(sbi, ll_inode2fid(dir)))
+		GOTO(out_put, rc = 1);
+
+	rc = ll_d_init(dchild);
+	if (rc < 0)
+		GOTO(out_put, rc);
+
+	body.mbo_uid = from_kuid(&init_user_ns, current_fsuid());
+	body.mbo_gid = from_kgid(&init_user_ns, current_fsgid());
+	/* as inode_init_owner() and MDT do */
+	if (dir->i_mode & S_ISGID) {
+		body.mbo_gid = from_kgid(&init_user_ns, dir->i_gid);
+		if (S_ISDIR(mode))
+			mode |= S_ISGID;
+	} else if (mode & S_ISGID && !in_group_p(current_fsgid()) &&
+		   !cfs_capable(CFS_CAP_FSETID)) {
+		mode &= ~S_ISGID;
+	}
+
+	now = ktime_get_real_seconds();
+	body.mbo_valid = OBD_MD_FLID | OBD_MD_FLTYPE | OBD_MD_FLMODE |
+			 OBD_MD_FLUID | OBD_MD_FLGID | OBD_MD_FLNLINK |
+			 OBD_MD_FLATIME | OBD_MD_FLMTIME | OBD_MD_FLCTIME |
+			 OBD_MD_FLSIZE | OBD_MD_FLBLOCKS | OBD_MD_FLRDEV |
+			 OBD_MD_FLPROJID;
+	body.mbo_mode = mode;
+	body.mbo_nlink = S_ISDIR(mode) ? 2 : 1;
+	body.mbo_atime = now;
+	body.mbo_mtime = now;
+	body.mbo_ctime = now;
+	body.mbo_rdev = old_encode_dev(rdev);
+	if (ll_file_test_flag(plli, LLIF_PROJECT_INHERIT)) {
+		body.mbo_projid = plli->lli_projid;
+		if (S_ISDIR(mode)) {
+			body.mbo_valid |= OBD_MD_FLFLAGS;
+			body.mbo_flags = LUSTRE_PROJINHERIT_FL;
+		}
+	}
+	md.body = &body;
+
+	inode = ll_iget(dir->i_sb, cl_fid_build_ino(&body.mbo_fid1,
+					sbi->ll_flags & LL_SBI_32BIT_API), &md);
+	if (IS_ERR(inode))
+		GOTO(out_put, rc = PTR_ERR(inode));
+
+	lli = ll_i2info(inode);
+	lli->lli_wbc_fsuid = from_kuid(&init_user_ns, current_fsuid());
+	lli->lli_wbc_fsgid = from_kgid(&init_user_ns, current_fsgid());
+	lli->lli_wbc_cap = cfs_curproc_cap_pack();
+	lli->lli_wbc_dentry = dget(dchild);
+	ll_file_set_flag(lli, LLIF_WBC_PENDING);
+
+	/* queue before the entry is visible, anybody finding it may flush */
+	spin_lock(&sbi->ll_wbc_lock);
+	list_add_tail(&lli->lli_wbc_item, &sbi->ll_wbc_list);
+	sbi->ll_wbc_count++;
+	plli->lli_wbc_children++;
+	lli->lli_wbc_root = root;
+	flush = sbi->ll_wbc_count > sbi->ll_wbc_max_pending;
+	spin_unlock(&sbi->ll_wbc_lock);
+	up_read(&sbi->ll_wbc_sem);
+
+	if (d_unhashed(dchild))
+		d_add(dchild, inode);
+	else
+		d_instantiate(dchild, inode);
+	/* valid while cached, without a LOOKUP lock, see ll_dcompare() */
+	d_lustre_revalidate(dchild);
+
+	/* nobody else changes @dir meanwhile, see ll_getattr() */
+	LTIME_S(dir->i_mtime) = now;
+	LTIME_S(dir->i_ctime) = now;
+	plli->lli_mtime = now;
+	plli->lli_ctime = now;
+
+	atomic_inc(&sbi->ll_wbc_deferred);
+	if (flush)
+		schedule_work(&sbi->ll_wbc_work);
+
+	CDEBUG(D_INODE, "%s: cached create of "DFID" '%.*s' in "DFID"\n",
+	       ll_get_fsname(dir->i_sb, NULL, 0), PFID(&lli->lli_fid),
+	       dchild->d_name.len, dchild->d_name.name,
+	       PFID(ll_inode2fid(dir)));
+
+	RETURN(0);
+out_put:
+	ll_wbc_tree_put(sbi, root);
+out_sem:
+	up_read(&sbi->ll_wbc_sem);
+	RETURN(rc);
+}
+
+/*
+ * Lookup of a name not in dcache under the cached directory @dir. All the
+ * entries of @dir are in dcache, so the name does not exist.
+ */
+struct dentry *ll_wbc_lookup(struct inode *dir, struct dentry *dentry)
+{
+	struct dentry *de;
+
+	de = ll_splice_alias(NULL, dentry);
+	if (IS_ERR(de))
+		return de;
+
+	d_lustre_revalidate(dentry);
+	atomic_inc(&ll_i2sbi(dir)->ll_wbc_lookups);
+
+	/* @dir may have been flushed meanwhile, other clients may create
+	 * entries in it from now on. The flush clears LLIF_WBC_PENDING
+	 * before it invalidates the negative dentries of @dir. */
+	smp_mb();
+	if (!ll_wbc_pending(dir))
+		d_lustre_invalidate(dentry, 0);
+
+	return NULL;
+}
+
+/*
+ * Send the cached create of @lli to MDT and release it, called with
+ * ll_wbc_mutex held. If that fails, the entry stays LLIF_WBC_PENDING,
+ * but is not queued anymore: it exists only locally and can be unlinked.
+ */
+static int ll_wbc_flush_one(struct ll_sb_info *sbi, struct ll_inode_info *lli)
+{
+	struct inode *inode = ll_info2i(lli);
+	struct dentry *dentry = lli->lli_wbc_dentry;
+	struct inode *dir = dentry->d_parent->d_inode;
+	struct ptlrpc_request *req = NULL;
+	struct md_op_data *op_data;
+	bool root_locked;
+	int rc;
+	ENTRY;
+
+	/* a name in the root is created under the root lock */
+	root_locked = lli->lli_wbc_root == dir && ll_wbc_root_locked(dir);
+
+	op_data = ll_prep_md_op_data(NULL, dir, NULL, dentry->d_name.name,
+				     dentry->d_name.len, 0,
+				     S_ISDIR(inode->i_mode) ? LUSTRE_OPC_MKDIR :
+							      LUSTRE_OPC_MKNOD,
+				     NULL);
+	if (IS_ERR(op_data))
+		GOTO(out, rc = PTR_ERR(op_data));
+
+	op_data->op_fid2 = lli->lli_fid;
+	op_data->op_cli_flags |= CLI_WBC_CREATE;
+	op_data->op_mod_time = LTIME_S(inode->i_ctime);
+	op_data->op_fsuid = lli->lli_wbc_fsuid;
+	op_data->op_fsgid = lli->lli_wbc_fsgid;
+	op_data->op_cap = lli->lli_wbc_cap;
+	if (root_locked) {
+		struct ldlm_lock *lock;
+
+		lock = ldlm_handle2lock(&ll_i2info(dir)->lli_wbc_lockh);
+		if (lock != NULL) {
+			op_data->op_open_handle = lock->l_remote_handle;
+			op_data->op_bias |= MDS_PARENT_LOCKED;
+			LDLM_LOCK_PUT(lock);
+		}
+	}
+
+	rc = md_create(sbi->ll_md_exp, op_data, NULL, 0, inode->i_mode,
+		       lli->lli_wbc_fsuid, lli->lli_wbc_fsgid, lli->lli_wbc_cap,
+		       old_encode_dev(inode->i_rdev), &req);
+	ll_finish_md_op_data(op_data);
+	if (rc == 0)
+		rc = ll_prep_inode(&inode, req, NULL, NULL);
+	ptlrpc_req_finished(req);
+	if (rc != 0)
+		GOTO(out, rc);
+
+	if (S_ISREG(inode->i_mode))
+		rc = ll_wbc_open_replay(inode, dentry);
+	else
+		ll_file_clear_flag(lli, LLIF_WBC_PENDING);
+	EXIT;
+out:
+	ll_wbc_dequeue(sbi, lli);
+	lli->lli_wbc_dentry = NULL;
+
+	if (rc == 0) {
+		/* the entry is shared with other clients from now on */
+		if (S_ISDIR(inode->i_mode))
+			ll_invalidate_negative_children(inode);
+		/* until the root lock is cancelled, see ll_wbc_root_ast() */
+		if (!root_locked)
+			d_lustre_invalidate(dentry, 0);
+		atomic_inc(&sbi->ll_wbc_flushed);
+	} else {
+		CERROR("%s: cannot create cached "DFID" '%.*s' in "DFID
+		       ": rc = %d\n", ll_get_fsname(inode->i_sb, NULL, 0),
+		       PFID(&lli->lli_fid), dentry->d_name.len,
+		       dentry->d_name.name, PFID(ll_inode2fid(dir)), rc);
+		atomic_inc(&sbi->ll_wbc_errors);
+	}
+	dput(dentry);
+
+	return rc;
+}
+
+/* Flush the oldest cached create, called with ll_wbc_mutex held. */
+static int ll_wbc_flush_first(struct ll_sb_info *sbi)
+{
+	struct ll_inode_info *lli = NULL;
+
+	spin_lock(&sbi->ll_wbc_lock);
+	if (!list_empty(&sbi->ll_wbc_list))
+		lli = list_entry(sbi->ll_wbc_list.next, struct ll_inode_info,
+				 lli_wbc_item);
+	spin_unlock(&sbi->ll_wbc_lock);
+
+	if (lli == NULL)
+		return -ENOENT;
+
+	return ll_wbc_flush_one(sbi, lli);
+}
+
+/*
+ * Stop caching in the root @inode and flush its tree, called with
+ * ll_wbc_mutex held. The root lock, if any, is returned in @lockh for the
+ * caller to cancel. If @flush is false, e.g. after eviction, the pending
+ * entries are sent later in order, without the root lock.
+ */
+static void ll_wbc_root_stop(struct ll_sb_info *sbi, struct inode *inode,
+			     bool flush, struct lustre_handle *lockh)
+{
+	struct ll_inode_info *lli = ll_i2info(inode);
+
+	/* wait for the creates which found the root still caching */
+	down_write(&sbi->ll_wbc_sem);
+	ll_file_clear_flag(lli, LLIF_WBC_ROOT);
+	up_write(&sbi->ll_wbc_sem);
+
+	while (flush && lli->lli_wbc_tree > 0) {
+		if (ll_wbc_flush_first(sbi) == -ENOENT)
+			break;
+	}
+
+	spin_lock(&sbi->ll_wbc_lock);
+	*lockh = lli->lli_wbc_lockh;
+	lli->lli_wbc_lockh.cookie = 0;
+	spin_unlock(&sbi->ll_wbc_lock);
+
+	CDEBUG(D_INODE, "%s: "DFID" stopped caching\n",
+	       ll_get_fsname(inode->i_sb, NULL, 0), PFID(ll_inode2fid(inode)));
+}
+
+/* Names flushed from the root @dir stayed valid under its lock only */
+static void ll_wbc_root_invalidate(struct inode *dir)
+{
+	struct dentry *dentry, *child;
+	DECLARE_LL_D_HLIST_NODE_PTR(p);
+
+	ll_lock_dcache(dir);
+	ll_d_hlist_for_each_entry(dentry, p, &dir->i_dentry) {
+		spin_lock(&dentry->d_lock);
+		list_for_each_entry(child, &dentry->d_subdirs, d_child) {
+			if (child->d_inode != NULL &&
+			    !ll_wbc_pending(child->d_inode))
+				d_lustre_invalidate(child, 1);
+		}
+		spin_unlock(&dentry->d_lock);
+	}
+	ll_unlock_dcache(dir);
+}
+
+/*
+ * Blocking AST of the root lock. Another client accesses the root, the tree
+ * is flushed before the lock is cancelled. Cancelling the lock when nothing
+ * is pending anymore, see ll_wbc_tree_put(), doesn't stop the root.
+ */
+static int ll_wbc_root_ast(struct ldlm_lock *lock, struct ldlm_lock_desc *desc,
+			   void *data, int flag)
+{
+	struct lustre_handle lockh;
+	struct lustre_handle stopped;
+	struct ll_sb_info *sbi;
+	struct ll_inode_info *lli;
+	struct inode *inode;
+	bool held;
+
+	if (flag != LDLM_CB_CANCELING)
+		return ll_md_blocking_ast(lock, desc, data, flag);
+
+	inode = ll_inode_from_resource_lock(lock);
+	if (inode == NULL)
+		return ll_md_blocking_ast(lock, desc, data, flag);
+
+	sbi = ll_i2sbi(inode);
+	lli = ll_i2info(inode);
+	ldlm_lock2handle(lock, &lockh);
+
+	/* not under ll_wbc_mutex, a cached create may be cancelling it */
+	spin_lock(&sbi->ll_wbc_lock);
+	held = lustre_handle_equal(&lli->lli_wbc_lockh, &lockh);
+	spin_unlock(&sbi->ll_wbc_lock);
+
+	if (held) {
+		mutex_lock(&sbi->ll_wbc_mutex);
+		ll_wbc_root_stop(sbi, inode, !ldlm_is_local_only(lock),
+				 &stopped);
+		mutex_unlock(&sbi->ll_wbc_mutex);
+		/* released and taken again meanwhile */
+		if (lustre_handle_is_used(&stopped) &&
+		    !lustre_handle_equal(&stopped, &lockh))
+			ldlm_cli_cancel(&stopped, LCF_ASYNC);
+	}
+	ll_wbc_root_invalidate(inode);
+	iput(inode);
+
+	return ll_md_blocking_ast(lock, desc, data, flag);
+}
+
+/*
+ * Take the EX lock on the root @dir for the first cached create in it, the
+ * cached names in @dir are not on MDT yet and nobody else may create them.
+ * The lock is held without reference and out of LRU until the tree is
+ * flushed.
+ */
+static int ll_wbc_root_lock(struct inode *dir)
+{
+	struct ll_sb_info *sbi = ll_i2sbi(dir);
+	struct ll_inode_info *lli = ll_i2info(dir);
+	struct ldlm_enqueue_info einfo = {
+		.ei_type	= LDLM_IBITS,
+		.ei_mode	= LCK_EX,
+		.ei_cb_bl	= ll_wbc_root_ast,
+		.ei_cb_cp	= ldlm_completion_ast,
+		.ei_cbdata	= dir,
+	};
+	union ldlm_policy_data policy = {
+		.l_inodebits = { MDS_INODELOCK_UPDATE | MDS_INODELOCK_LOOKUP },
+	};
+	struct lustre_handle lockh;
+	struct md_op_data *op_data;
+	struct dentry *dentry;
+	DECLARE_LL_D_HLIST_NODE_PTR(p);
+	bool used;
+	int rc;
+	ENTRY;
+
+	if (ll_wbc_root_locked(dir))
+		RETURN(0);
+
+	op_data = ll_prep_md_op_data(NULL, dir, NULL, NULL, 0, 0,
+				     LUSTRE_OPC_ANY, NULL);
+	if (IS_ERR(op_data))
+		RETURN(PTR_ERR(op_data));
+
+	rc = md_enqueue(sbi->ll_md_exp, &einfo, &policy, op_data, &lockh,
+			LDLM_FL_NO_LRU | LDLM_FL_EXCL);
+	ll_finish_md_op_data(op_data);
+	if (rc < 0)
+		RETURN(rc);
+
+	spin_lock(&sbi->ll_wbc_lock);
+	used = ll_wbc_root(dir) && !lustre_handle_is_used(&lli->lli_wbc_lockh);
+	if (used)
+		lli->lli_wbc_lockh = lockh;
+	spin_unlock(&sbi->ll_wbc_lock);
+
+	if (!used) {
+		ldlm_lock_decref_and_cancel(&lockh, LCK_EX);
+		RETURN(-ESTALE);
+	}
+	ldlm_lock_decref(&lockh, LCK_EX);
+
+	/* the LOOKUP locks of this client on @dir were cancelled for the EX
+	 * one, it protects the name of @dir as well */
+	ll_lock_dcache(dir);
+	ll_d_hlist_for_each_entry(dentry, p, &dir->i_dentry)
+		d_lustre_revalidate(dentry);
+	ll_unlock_dcache(dir);
+
+	CDEBUG(D_INODE, "%s: "DFID" locked for caching\n",
+	       ll_get_fsname(dir->i_sb, NULL, 0), PFID(ll_inode2fid(dir)));
+
+	RETURN(0);
+}
+
+/**
+ * Flush cached creates in creation order, until @inode is on MDT and, if it
+ * is the root of a cached tree, its entries too.
+ *
+ * \retval 0		@inode exists on MDT
+ * \retval -EIO		the create of @inode failed on MDT
+ */
+int ll_wbc_flush_inode(struct inode *inode)
+{
+	struct ll_sb_info *sbi = ll_i2sbi(inode);
+	struct ll_inode_info *lli = ll_i2info(inode);
+	struct lustre_handle lockh = { 0 };
+	int rc = 0;
+	ENTRY;
+
+	mutex_lock(&sbi->ll_wbc_mutex);
+	while (ll_wbc_pending(inode) && lli->lli_wbc_dentry != NULL) {
+		if (ll_wbc_flush_first(sbi) == -ENOENT)
+			break;
+	}
+	if (ll_wbc_pending(inode))
+		rc = -EIO;
+	if (ll_wbc_root(inode))
+		ll_wbc_root_stop(sbi, inode, true, &lockh);
+	mutex_unlock(&sbi->ll_wbc_mutex);
+
+	if (lustre_handle_is_used(&lockh))
+		ldlm_cli_cancel(&lockh, LCF_ASYNC);
+
+	RETURN(rc);
+}
+
+/* Flush everything cached so far, for sync(2), readdir and umount. */
+int ll_wbc_flush_all(struct ll_sb_info *sbi)
+{
+	unsigned int count;
+	int rc = 0;
+	int rc2;
+	ENTRY;
+
+	mutex_lock(&sbi->ll_wbc_mutex);
+	for (count = sbi->ll_wbc_count; count > 0; count--) {
+		rc2 = ll_wbc_flush_first(sbi);
+		if (rc2 == -ENOENT)
+			break;
+		if (rc == 0)
+			rc = rc2;
+	}
+	mutex_unlock(&sbi->ll_wbc_mutex);
+
+	RETURN(rc);
+}
+
+/**
+ * Drop the cached create of @dchild, for unlink(2) and rmdir(2) of it.
+ *
+ * \retval 0		dropped, MDT never knew about it
+ * \retval -EAGAIN	not cached, it is to be removed on MDT
+ * \retval -EBUSY	file is open, it is to be flushed and removed on MDT
+ * \retval -ENOTEMPTY	directory has cached entries
+ */
+int ll_wbc_cancel(struct inode *dir, struct dentry *dchild)
+{
+	struct inode *inode = dchild->d_inode;
+	struct ll_sb_info *sbi = ll_i2sbi(inode);
+	struct ll_inode_info *lli = ll_i2info(inode);
+	struct dentry *dentry = NULL;
+	int rc = 0;
+	ENTRY;
+
+	mutex_lock(&sbi->ll_wbc_mutex);
+	if (!ll_wbc_pending(inode))
+		GOTO(out, rc = -EAGAIN);
+
+	if (S_ISDIR(inode->i_mode) && lli->lli_wbc_children > 0)
+		GOTO(out, rc = -ENOTEMPTY);
+
+	/* local opens are replayed on MDT when the file is flushed, then it
+	 * is an open-unlinked file there */
+	mutex_lock(&lli->lli_och_mutex);
+	if (lli->lli_wbc_dentry != NULL &&
+	    (lli->lli_open_fd_read_count > 0 ||
+	     lli->lli_open_fd_write_count > 0 ||
+	     lli->lli_open_fd_exec_count > 0))
+		rc = -EBUSY;
+	else
+		ll_file_clear_flag(lli, LLIF_WBC_PENDING);
+	mutex_unlock(&lli->lli_och_mutex);
+	if (rc != 0)
+		GOTO(out, rc);
+
+	if (lli->lli_wbc_dentry != NULL) {
+		dentry = lli->lli_wbc_dentry;
+		ll_wbc_dequeue(sbi, lli);
+		lli->lli_wbc_dentry = NULL;
+		atomic_inc(&sbi->ll_wbc_cancelled);
+	}
+	clear_nlink(inode);
+
+	CDEBUG(D_INODE, "%s: dropped cached "DFID" '%.*s' in "DFID"\n",
+	       ll_get_fsname(inode->i_sb, NULL, 0), PFID(&lli->lli_fid),
+	       dchild->d_name.len, dchild->d_name.name,
+	       PFID(ll_inode2fid(dir)));
+	EXIT;
+out:
+	mutex_unlock(&sbi->ll_wbc_mutex);
+	if (dentry != NULL)
+		dput(dentry);
+
+	return rc;
+}
+
+/* Background flush, down to half of wbc_max_pending cached creates. */
+static void ll_wbc_work_fn(struct work_struct *work)
+{
+	struct ll_sb_info *sbi = container_of(work, struct ll_sb_info,
+					      ll_wbc_work);
+
+	mutex_lock(&sbi->ll_wbc_mutex);
+	while (sbi->ll_wbc_count > sbi->ll_wbc_max_pending / 2) {
+		if (ll_wbc_flush_first(sbi) == -ENOENT)
+			break;
+	}
+	mutex_unlock(&sbi->ll_wbc_mutex);
+}
+
+void ll_wbc_init(struct ll_sb_info *sbi)
+{
+	spin_lock_init(&sbi->ll_wbc_lock);
+	INIT_LIST_HEAD(&sbi->ll_wbc_list);
+	sbi->ll_wbc_count = 0;
+	sbi->ll_wbc_max_pending = 0;
+	mutex_init(&sbi->ll_wbc_mutex);
+	init_rwsem(&sbi->ll_wbc_sem);
+	INIT_WORK(&sbi->ll_wbc_work, ll_wbc_work_fn);
+	atomic_set(&sbi->ll_wbc_deferred, 0);
+	atomic_set(&sbi->ll_wbc_flushed, 0);
+	atomic_set(&sbi->ll_wbc_cancelled, 0);
+	atomic_set(&sbi->ll_wbc_lookups, 0);
+	atomic_set(&sbi->ll_wbc_errors, 0);
+}
+
+/* Called at umount before dcache is shrunk, cached entries pin dentries. */
+void ll_wbc_fini(struct ll_sb_info *sbi)
+{
+	cancel_work_sync(&sbi->ll_wbc_work);
+	ll_wbc_flush_all(sbi);
+}
+
+/* sync(2) and syncfs(2) push cached creates to MDT */
+int ll_sync_fs(struct super_block *sb, int wait)
+{
+	struct ll_sb_info *sbi = ll_s2sbi(sb);
+
+	if (sbi->ll_wbc_count == 0)
+		return 0;
+
+	if (!wait) {
+		schedule_work(&sbi->ll_wbc_work);
+		return 0;
+	}
+
+	return ll_wbc_flush_all(sbi);
+}
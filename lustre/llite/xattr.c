@@ -113,6 +113,10 @@ static int ll_xattr_set_common(const struct xattr_handler *handler,
 		valid = OBD_MD_FLXATTR;
 	}
 
+	rc = ll_wbc_flush(inode);
+	if (rc)
+		RETURN(rc);
+
 	/* FIXME: enable IMA when the conditions are ready */
 	if (handler->flags == XATTR_SECURITY_T &&
 	    (!strcmp(name, "ima") || !strcmp(name, "evm")))
@@ -320,9 +324,14 @@ static int ll_xattr_set(const struct xattr_handler *handler,
 	if (!strcmp(name, "lov")) {
 		int op_type = flags == XATTR_REPLACE ? LPROC_LL_REMOVEXATTR :
 						       LPROC_LL_SETXATTR;
+		int rc;
 
 		ll_stats_ops_tally(ll_i2sbi(inode), op_type, 1);
 
+		rc = ll_wbc_flush(inode);
+		if (rc)
+			return rc;
+
 		return ll_setstripe_ea(dentry, (struct lov_user_md *)value,
 				       size);
 	} else if (!strcmp(name, "lma") || !strcmp(name, "link")) {
@@ -347,6 +356,10 @@ int ll_xattr_list(struct inode *inode, const char *name, int type, void *buffer,
 	int rc;
 	ENTRY;
 
+	/* created in write-back cache, see ll_wbc_may_root() */
+	if (ll_wbc_pending(inode))
+		RETURN(valid & OBD_MD_FLXATTRLS ? 0 : -ENODATA);
+
 	if (sbi->ll_xattr_cache_enabled && type != XATTR_ACL_ACCESS_T &&
 	    (type != XATTR_SECURITY_T || strcmp(name, "security.selinux"))) {
 		rc = ll_xattr_cache_get(inode, name, buffer, size, valid);
@@ -464,6 +477,10 @@ static ssize_t ll_getxattr_lov(struct inode *inode, void *buf, size_t buf_size)
 {
 	ssize_t rc;
 
+	/* neither layout nor default striping yet */
+	if (ll_wbc_pending(inode))
+		return -ENODATA;
+
 	if (S_ISREG(inode->i_mode)) {
 		struct cl_object *obj = ll_i2info(inode)->lli_clob;
 		struct cl_layout cl = {
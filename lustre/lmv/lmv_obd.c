@@ -1699,9 +1699,13 @@ int lmv_create(struct obd_export *exp, struct md_op_data *op_data,
 		(int)op_data->op_namelen, op_data->op_name,
 		PFID(&op_data->op_fid1), op_data->op_mds);
 
-	rc = lmv_fid_alloc(NULL, exp, &op_data->op_fid2, op_data);
-	if (rc)
-		RETURN(rc);
+	/* FID of a create replayed from client write-back cache was allocated
+	 * when the create was cached, and the client uses it already. */
+	if (!(op_data->op_cli_flags & CLI_WBC_CREATE)) {
+		rc = lmv_fid_alloc(NULL, exp, &op_data->op_fid2, op_data);
+		if (rc)
+			RETURN(rc);
+	}
 
 	if (exp_connect_flags(exp) & OBD_CONNECT_DIR_STRIPE) {
 		/* Send the create request to the MDT where the object
@@ -1718,7 +1722,9 @@ int lmv_create(struct obd_export *exp, struct md_op_data *op_data,
 	CDEBUG(D_INODE, "CREATE obj "DFID" -> mds #%x\n",
 	       PFID(&op_data->op_fid2), op_data->op_mds);
 
-	op_data->op_flags |= MF_MDC_CANCEL_FID1;
+	/* the parent lock held for the create must not be cancelled */
+	if (!(op_data->op_bias & MDS_PARENT_LOCKED))
+		op_data->op_flags |= MF_MDC_CANCEL_FID1;
 	rc = md_create(tgt->ltd_exp, op_data, data, datalen, mode, uid, gid,
 		       cap_effective, rdev, request);
 	if (rc == 0) {
@@ -3370,6 +3376,7 @@ struct obd_ops lmv_obd_ops = {
         .o_notify               = lmv_notify,
         .o_get_uuid             = lmv_get_uuid,
         .o_iocontrol            = lmv_iocontrol,
+	.o_fid_alloc		= lmv_fid_alloc,
         .o_quotactl             = lmv_quotactl
 };
 
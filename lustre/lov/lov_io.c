@@ -839,8 +839,10 @@ static int lov_io_rw_iter_init(const struct lu_env *env,
 
 	lse = lov_lse(lio->lis_object, index);
 
+	/* parallel direct IO takes locks of all stripes of the component at
+	 * once, see cl_io::ci_parallel_dio */
 	next = MAX_LFS_FILESIZE;
-	if (lse->lsme_stripe_count > 1) {
+	if (lse->lsme_stripe_count > 1 && !io->ci_parallel_dio) {
 		unsigned long ssize = lse->lsme_stripe_size;
 
 		lov_do_div64(start, ssize);
@@ -874,7 +876,8 @@ static int lov_io_rw_iter_init(const struct lu_env *env,
 
 	/*
 	 * XXX The following call should be optimized: we know, that
-	 * [lio->lis_pos, lio->lis_endpos) intersects with exactly one stripe.
+	 * [lio->lis_pos, lio->lis_endpos) intersects with exactly one stripe,
+	 * unless this is parallel direct IO.
 	 */
 	RETURN(lov_io_iter_init(env, ios));
 }
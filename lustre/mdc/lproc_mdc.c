@@ -484,6 +484,63 @@ static ssize_t mdc_dom_min_repsize_seq_write(struct file *file,
 }
 LPROC_SEQ_FOPS(mdc_dom_min_repsize);
 
+static int mdc_readdir_ra_seq_show(struct seq_file *m, void *v)
+{
+	struct obd_device *dev = m->private;
+
+	seq_printf(m, "%u\n", dev->u.cli.cl_readdir_ra);
+
+	return 0;
+}
+
+static ssize_t mdc_readdir_ra_seq_write(struct file *file,
+					const char __user *buffer,
+					size_t count, loff_t *off)
+{
+	struct obd_device *dev;
+	unsigned int val;
+	int rc;
+
+	dev =  ((struct seq_file *)file->private_data)->private;
+	rc = kstrtouint_from_user(buffer, count, 0, &val);
+	if (rc)
+		return rc;
+
+	if (val > MDC_READDIR_RA_MAX)
+		return -ERANGE;
+
+	dev->u.cli.cl_readdir_ra = val;
+	return count;
+}
+LPROC_SEQ_FOPS(mdc_readdir_ra);
+
+static int mdc_readdir_ra_stats_seq_show(struct seq_file *m, void *v)
+{
+	struct obd_device *dev = m->private;
+	struct client_obd *cli = &dev->u.cli;
+
+	seq_printf(m, "rpcs: %d\npages: %d\n",
+		   atomic_read(&cli->cl_readdir_ra_rpcs),
+		   atomic_read(&cli->cl_readdir_ra_pages));
+
+	return 0;
+}
+
+static ssize_t mdc_readdir_ra_stats_seq_write(struct file *file,
+					      const char __user *buffer,
+					      size_t count, loff_t *off)
+{
+	struct obd_device *dev;
+
+	/* any write resets the counters */
+	dev =  ((struct seq_file *)file->private_data)->private;
+	atomic_set(&dev->u.cli.cl_readdir_ra_rpcs, 0);
+	atomic_set(&dev->u.cli.cl_readdir_ra_pages, 0);
+
+	return count;
+}
+LPROC_SEQ_FOPS(mdc_readdir_ra_stats);
+
 LPROC_SEQ_FOPS_RO_TYPE(mdc, connect_flags);
 LPROC_SEQ_FOPS_RO_TYPE(mdc, server_uuid);
 LPROC_SEQ_FOPS_RO_TYPE(mdc, timeouts);
@@ -519,6 +576,10 @@ struct lprocfs_vars lprocfs_mdc_obd_vars[] = {
 	  .fops	=	&mdc_stats_fops			},
 	{ .name	=	"mdc_dom_min_repsize",
 	  .fops	=	&mdc_dom_min_repsize_fops	},
+	{ .name	=	"readdir_ra",
+	  .fops	=	&mdc_readdir_ra_fops		},
+	{ .name	=	"readdir_ra_stats",
+	  .fops	=	&mdc_readdir_ra_stats_fops	},
 	{ NULL }
 };
 
@@ -176,4 +176,8 @@ int mdc_fill_lvb(struct ptlrpc_request *req, struct ost_lvb *lvb);
 #define MDC_DOM_DEF_INLINE_REPSIZE 8192
 #define MDC_DOM_MAX_INLINE_REPSIZE XATTR_SIZE_MAX
 
+/* # RPCs of directory pages read ahead of readdir */
+#define MDC_READDIR_RA_DEF	2
+#define MDC_READDIR_RA_MAX	16
+
 #endif
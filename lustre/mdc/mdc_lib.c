@@ -189,7 +189,14 @@ void mdc_create_pack(struct ptlrpc_request *req, struct md_op_data *op_data,
 		flags |= MDS_OPEN_VOLATILE;
 	set_mrc_cr_flags(rec, flags);
 	rec->cr_bias     = op_data->op_bias;
-	rec->cr_umask    = current_umask();
+	/* server handle of the parent lock, see MDS_PARENT_LOCKED */
+	if (op_data->op_bias & MDS_PARENT_LOCKED)
+		rec->cr_open_handle_old = op_data->op_open_handle;
+	/* the caller may not be the process that created the file */
+	if (op_data->op_cli_flags & CLI_WBC_CREATE)
+		rec->cr_umask = 0;
+	else
+		rec->cr_umask = current_umask();
 
 	mdc_pack_name(req, &RMF_NAME, op_data->op_name, op_data->op_namelen);
 	if (data) {
@@ -819,10 +819,12 @@ static int mdc_enqueue_base(struct obd_export *exp,
 resend:
 	flags = saved_flags;
 	if (it == NULL) {
-		/* The only way right now is FLOCK. */
-		LASSERTF(einfo->ei_type == LDLM_FLOCK, "lock type %d\n",
+		/* FLOCK, or a plain IBITS lock without intent */
+		LASSERTF(einfo->ei_type == LDLM_FLOCK ||
+			 einfo->ei_type == LDLM_IBITS, "lock type %d\n",
 			 einfo->ei_type);
-		res_id.name[3] = LDLM_FLOCK;
+		if (einfo->ei_type == LDLM_FLOCK)
+			res_id.name[3] = LDLM_FLOCK;
 	} else if (it->it_op & IT_OPEN) {
 		req = mdc_intent_open_pack(exp, it, op_data, acl_bufsize);
 	} else if (it->it_op & (IT_GETATTR | IT_LOOKUP)) {
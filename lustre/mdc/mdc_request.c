@@ -1103,8 +1103,8 @@ static struct page *mdc_page_locate(struct address_space *mapping, __u64 *hash,
 		 * page cannot be truncated (while DLM lock is held) and,
 		 * hence, can avoid restart.
 		 *
-		 * In fact, page cannot be locked here at all, because
-		 * mdc_read_page_remote does synchronous io.
+		 * Page can be locked here only by readdir readahead, wait
+		 * for its RPC to complete.
 		 */
 		wait_on_page_locked(page);
 		if (PageUptodate(page)) {
@@ -1141,6 +1141,11 @@ static struct page *mdc_page_locate(struct address_space *mapping, __u64 *hash,
 				    le32_to_cpu(dp->ldp_flags) & LDF_COLLIDE);
 				page = NULL;
 			}
+		} else if (page->mapping == NULL) {
+			/* failed readahead page was removed from cache,
+			 * mdc_read_page_remote() will read it again */
+			put_page(page);
+			page = NULL;
 		} else {
 			put_page(page);
 			page = ERR_PTR(-EIO);
@@ -1336,6 +1341,9 @@ static int mdc_read_page_remote(void *data, struct page *page0)
 
 		mdc_adjust_dirpages(page_pool, rd_pgs, lu_pgs);
 
+		/* reader will start readahead of pages after this batch */
+		if (rp->rp_exp->exp_obd->u.cli.cl_readdir_ra)
+			SetPageReadahead(page0);
 		SetPageUptodate(page0);
 	}
 	unlock_page(page0);
@@ -1379,6 +1387,329 @@ static int mdc_read_page_remote(void *data, struct page *page0)
 	RETURN(rc);
 }
 
+/* runs mdc_readdir_ra_free() */
+static struct workqueue_struct *mdc_readdir_ra_wq;
+
+/* readdir readahead RPC, freed by mdc_readdir_ra_free() */
+struct mdc_readdir_ra_args {
+	struct work_struct	 mra_work;
+	struct inode		*mra_inode;
+	struct lu_fid		 mra_fid;
+	struct lustre_handle	 mra_lockh;
+	enum ldlm_mode		 mra_mode;
+	/* # batches to read, this one included */
+	int			 mra_nbatch;
+	int			 mra_npages;
+	int			 mra_max_pages;
+	int			 mra_hash64;
+	struct page		*mra_pages[0];
+};
+
+/**
+ * Drop the inode reference of readdir readahead and free it.
+ *
+ * This runs from a work item instead of the ptlrpcd thread which finished
+ * the RPC: the last iput() evicts the inode, which must not be done by
+ * ptlrpcd.
+ */
+static void mdc_readdir_ra_free(struct work_struct *work)
+{
+	struct mdc_readdir_ra_args *aa;
+
+	aa = container_of(work, struct mdc_readdir_ra_args, mra_work);
+	iput(aa->mra_inode);
+	OBD_FREE(aa, offsetof(struct mdc_readdir_ra_args,
+			      mra_pages[aa->mra_max_pages]));
+}
+
+static int mdc_readdir_ra_send(struct obd_device *obd, struct inode *dir,
+			       const struct lu_fid *fid,
+			       struct lustre_handle *lockh, enum ldlm_mode mode,
+			       __u64 hash, int hash64, int nbatch);
+
+/**
+ * Finish readdir readahead RPC.
+ *
+ * Pages read are added to the directory page cache the same way as
+ * mdc_read_page_remote() does, the first page was added to cache already
+ * before the RPC was sent and is unlocked once the others are in cache.
+ * That page is marked for readahead, so the reader starts next readahead
+ * once it reaches this batch. If more batches are to be read, the next one
+ * is sent from here, as only now the hash it starts from is known.
+ * The lock reference is held until pages are in cache, so lock cancel and
+ * cached pages invalidation can't race with that.
+ */
+static int mdc_readdir_ra_interpret(const struct lu_env *env,
+				    struct ptlrpc_request *req,
+				    void *args, int rc)
+{
+	union ptlrpc_async_args *pa = args;
+	struct mdc_readdir_ra_args *aa = pa->pointer_arg[0];
+	struct obd_device *obd = req->rq_import->imp_obd;
+	struct client_obd *cli = &obd->u.cli;
+	struct inode *inode = aa->mra_inode;
+	struct page *page0 = aa->mra_pages[0];
+	struct page *page;
+	struct lu_dirpage *dp;
+	__u64 next = MDS_DIR_END_OFF;
+	int rd_pgs = 0;
+	int i;
+
+	ENTRY;
+
+	if (rc == 0)
+		rc = sptlrpc_cli_unwrap_bulk_read(req, req->rq_bulk,
+					req->rq_bulk->bd_nob_transferred);
+	if (rc >= 0 && req->rq_bulk->bd_nob_transferred & ~LU_PAGE_MASK)
+		rc = -EPROTO;
+
+	if (rc < 0) {
+		/* page0 is special, which was added into page cache early */
+		delete_from_page_cache(page0);
+	} else {
+		int lu_pgs;
+
+		rd_pgs = (req->rq_bulk->bd_nob_transferred + PAGE_SIZE - 1) >>
+			 PAGE_SHIFT;
+		lu_pgs = req->rq_bulk->bd_nob_transferred >> LU_PAGE_SHIFT;
+		mdc_adjust_dirpages(aa->mra_pages, rd_pgs, lu_pgs);
+
+		if (rd_pgs > 0) {
+			SetPageReadahead(page0);
+			SetPageUptodate(page0);
+			atomic_inc(&cli->cl_readdir_ra_rpcs);
+			atomic_add(rd_pgs, &cli->cl_readdir_ra_pages);
+
+			dp = kmap(aa->mra_pages[rd_pgs - 1]);
+			next = le64_to_cpu(dp->ldp_hash_end);
+			kunmap(aa->mra_pages[rd_pgs - 1]);
+		} else {
+			delete_from_page_cache(page0);
+		}
+	}
+
+	CDEBUG(D_CACHE, "readahead %d/%d pages: rc = %d\n",
+	       rd_pgs, aa->mra_npages, rc);
+	for (i = 1; i < aa->mra_npages; i++) {
+		unsigned long offset;
+		__u64 hash;
+		int ret;
+
+		page = aa->mra_pages[i];
+		if (rc < 0 || i >= rd_pgs) {
+			put_page(page);
+			continue;
+		}
+
+		SetPageUptodate(page);
+
+		dp = kmap(page);
+		hash = le64_to_cpu(dp->ldp_hash_start);
+		kunmap(page);
+
+		offset = hash_x_index(hash, aa->mra_hash64);
+		ret = add_to_page_cache_lru(page, inode->i_mapping, offset,
+					    GFP_NOFS);
+		if (ret == 0)
+			unlock_page(page);
+		else
+			CDEBUG(D_VFSTRACE, "page %lu add to page cache failed:"
+			       " rc = %d\n", offset, ret);
+		put_page(page);
+	}
+	unlock_page(page0);
+	put_page(page0);
+
+	if (aa->mra_nbatch > 1 && next != MDS_DIR_END_OFF)
+		mdc_readdir_ra_send(obd, inode, &aa->mra_fid, &aa->mra_lockh,
+				    aa->mra_mode, next, aa->mra_hash64,
+				    aa->mra_nbatch - 1);
+
+	ldlm_lock_decref(&aa->mra_lockh, aa->mra_mode);
+	INIT_WORK(&aa->mra_work, mdc_readdir_ra_free);
+	queue_work(mdc_readdir_ra_wq, &aa->mra_work);
+
+	RETURN(0);
+}
+
+/**
+ * Send asynchronous MDS_READPAGE RPC to read pages starting from \a hash.
+ *
+ * The first page is added into the page cache locked, so that concurrent
+ * readers wait for the RPC in mdc_page_locate() instead of sending the
+ * same RPC, and that also prevents sending duplicate readahead RPCs.
+ * \a nbatch RPCs are sent one after the other, each by the interpreter of
+ * the previous one.
+ *
+ * This is called from ptlrpcd for all but the first batch, so pages are
+ * allocated without FS reclaim.
+ */
+static int mdc_readdir_ra_send(struct obd_device *obd, struct inode *dir,
+			       const struct lu_fid *fid,
+			       struct lustre_handle *lockh, enum ldlm_mode mode,
+			       __u64 hash, int hash64, int nbatch)
+{
+	struct address_space *mapping = dir->i_mapping;
+	gfp_t gfp = (mapping_gfp_mask(mapping) & ~__GFP_FS) | __GFP_COLD;
+	int max_pages = obd->u.cli.cl_max_pages_per_rpc;
+	struct mdc_readdir_ra_args *aa;
+	union ptlrpc_async_args *pa;
+	struct ptlrpc_request *req;
+	struct ptlrpc_bulk_desc *desc;
+	struct page *page;
+	int npages = 0;
+	int i;
+	int rc;
+
+	ENTRY;
+
+	/* pages are valid only under the lock, keep it until they are
+	 * added into cache. Don't read ahead under a lock being cancelled */
+	if (ldlm_lock_addref_try(lockh, mode) != 0)
+		RETURN(-EAGAIN);
+
+	OBD_ALLOC(aa, offsetof(struct mdc_readdir_ra_args,
+			       mra_pages[max_pages]));
+	if (aa == NULL)
+		GOTO(out_decref, rc = -ENOMEM);
+	aa->mra_max_pages = max_pages;
+
+	aa->mra_inode = igrab(dir);
+	if (aa->mra_inode == NULL)
+		GOTO(out_free, rc = -ENOENT);
+
+	page = __page_cache_alloc(gfp);
+	if (page == NULL)
+		GOTO(out_iput, rc = -ENOMEM);
+
+	rc = add_to_page_cache_lru(page, mapping, hash_x_index(hash, hash64),
+				   GFP_NOFS);
+	if (rc) {
+		/* -EEXIST: pages are read already by somebody else */
+		put_page(page);
+		GOTO(out_iput, rc);
+	}
+	aa->mra_pages[0] = page;
+
+	for (npages = 1; npages < max_pages; npages++) {
+		page = __page_cache_alloc(gfp);
+		if (page == NULL)
+			break;
+		aa->mra_pages[npages] = page;
+	}
+
+	req = ptlrpc_request_alloc(obd->u.cli.cl_import, &RQF_MDS_READPAGE);
+	if (req == NULL)
+		GOTO(out_pages, rc = -ENOMEM);
+
+	rc = ptlrpc_request_pack(req, LUSTRE_MDS_VERSION, MDS_READPAGE);
+	if (rc) {
+		ptlrpc_request_free(req);
+		GOTO(out_pages, rc);
+	}
+
+	req->rq_request_portal = MDS_READPAGE_PORTAL;
+	ptlrpc_at_set_req_timeout(req);
+
+	desc = ptlrpc_prep_bulk_imp(req, npages, 1,
+				    PTLRPC_BULK_PUT_SINK | PTLRPC_BULK_BUF_KIOV,
+				    MDS_BULK_PORTAL,
+				    &ptlrpc_bulk_kiov_pin_ops);
+	if (desc == NULL) {
+		ptlrpc_req_finished(req);
+		GOTO(out_pages, rc = -ENOMEM);
+	}
+
+	/* NB req now owns desc and will free it when it gets freed */
+	for (i = 0; i < npages; i++)
+		desc->bd_frag_ops->add_kiov_frag(desc, aa->mra_pages[i], 0,
+						 PAGE_SIZE);
+
+	mdc_readdir_pack(req, hash, PAGE_SIZE * npages, fid);
+	ptlrpc_request_set_replen(req);
+
+	aa->mra_fid = *fid;
+	aa->mra_lockh = *lockh;
+	aa->mra_mode = mode;
+	aa->mra_nbatch = nbatch;
+	aa->mra_npages = npages;
+	aa->mra_hash64 = hash64;
+
+	pa = ptlrpc_req_async_args(req);
+	pa->pointer_arg[0] = aa;
+	req->rq_interpret_reply = mdc_readdir_ra_interpret;
+	ptlrpcd_add_req(req);
+
+	CDEBUG(D_INODE, "%s: readahead "DFID" at %#llx, %d pages, %d batches\n",
+	       obd->obd_name, PFID(fid), hash, npages, nbatch);
+	RETURN(0);
+
+out_pages:
+	delete_from_page_cache(aa->mra_pages[0]);
+	unlock_page(aa->mra_pages[0]);
+	for (i = 0; i < npages; i++)
+		put_page(aa->mra_pages[i]);
+out_iput:
+	/* not the last reference, the caller holds one */
+	iput(aa->mra_inode);
+out_free:
+	OBD_FREE(aa, offsetof(struct mdc_readdir_ra_args,
+			      mra_pages[max_pages]));
+out_decref:
+	ldlm_lock_decref(lockh, mode);
+	RETURN(rc);
+}
+
+/**
+ * Start readdir readahead after the batch of pages \a page belongs to.
+ *
+ * The page is the first page of the batch just read, either synchronously
+ * or by previous readahead. Walk through the cached pages after it to find
+ * the hash the next batch starts from, and read as many batches as needed
+ * to have readdir_ra batches cached or in flight ahead of the reader.
+ * For striped directory each stripe has its own readahead, so the pages of
+ * all stripes are read concurrently.
+ */
+static void mdc_readdir_ra(struct obd_export *exp, struct md_op_data *op_data,
+			   struct lustre_handle *lockh, enum ldlm_mode mode,
+			   struct page *page, int hash64)
+{
+	struct client_obd *cli = &exp->exp_obd->u.cli;
+	struct inode *dir = op_data->op_data;
+	struct lu_dirpage *dp = page_address(page);
+	__u64 hash = le64_to_cpu(dp->ldp_hash_end);
+	int batch = cli->cl_max_pages_per_rpc;
+	int window = cli->cl_readdir_ra;
+	int count = 0;
+
+	if (window == 0)
+		return;
+
+	while (hash != MDS_DIR_END_OFF) {
+		struct page *next;
+
+		next = find_get_page(dir->i_mapping, hash_x_index(hash, hash64));
+		if (next == NULL)
+			break;
+
+		/* readahead is in progress, or there was an error */
+		if (!PageUptodate(next) || ++count >= window * batch) {
+			put_page(next);
+			return;
+		}
+
+		dp = kmap(next);
+		hash = le64_to_cpu(dp->ldp_hash_end);
+		kunmap(next);
+		put_page(next);
+	}
+
+	if (hash != MDS_DIR_END_OFF)
+		mdc_readdir_ra_send(exp->exp_obd, dir, &op_data->op_fid1,
+				    lockh, mode, hash, hash64,
+				    window - count / batch);
+}
+
 /**
  * Read dir page from cache first, if it can not find it, read it from
  * server and add into the cache.
@@ -1516,6 +1847,11 @@ hash_collision:
 		 */
 		goto fail;
 	}
+
+	if (TestClearPageReadahead(page))
+		mdc_readdir_ra(exp, op_data, &lockh, it.it_lock_mode, page,
+			       rp_param.rp_hash64);
+
 	*ppage = page;
 out_unlock:
 	ldlm_lock_decref(&lockh, it.it_lock_mode);
@@ -2628,6 +2964,9 @@ int mdc_setup(struct obd_device *obd, struct lustre_cfg *cfg)
 		GOTO(err_osc_cleanup, rc);
 
 	obd->u.cli.cl_dom_min_inline_repsize = MDC_DOM_DEF_INLINE_REPSIZE;
+	obd->u.cli.cl_readdir_ra = MDC_READDIR_RA_DEF;
+	atomic_set(&obd->u.cli.cl_readdir_ra_rpcs, 0);
+	atomic_set(&obd->u.cli.cl_readdir_ra_pages, 0);
 
 	ns_register_cancel(obd->obd_namespace, mdc_cancel_weight);
 
@@ -2691,6 +3030,8 @@ static int mdc_precleanup(struct obd_device *obd)
 	mdc_changelog_cdev_finish(obd);
 
 	obd_cleanup_client_import(obd);
+	/* readahead RPCs are done, drop their inode references */
+	flush_workqueue(mdc_readdir_ra_wq);
 	ptlrpc_lprocfs_unregister_obd(obd);
 	lprocfs_free_md_stats(obd);
 	mdc_llog_finish(obd);
@@ -2766,13 +3107,24 @@ static struct md_ops mdc_md_ops = {
 
 static int __init mdc_init(void)
 {
-	return class_register_type(&mdc_obd_ops, &mdc_md_ops, true, NULL,
-				   LUSTRE_MDC_NAME, &mdc_device_type);
+	int rc;
+
+	mdc_readdir_ra_wq = alloc_workqueue("mdc_readdir_ra", 0, 0);
+	if (mdc_readdir_ra_wq == NULL)
+		return -ENOMEM;
+
+	rc = class_register_type(&mdc_obd_ops, &mdc_md_ops, true, NULL,
+				 LUSTRE_MDC_NAME, &mdc_device_type);
+	if (rc)
+		destroy_workqueue(mdc_readdir_ra_wq);
+
+	return rc;
 }
 
 static void __exit mdc_exit(void)
 {
         class_unregister_type(LUSTRE_MDC_NAME);
+	destroy_workqueue(mdc_readdir_ra_wq);
 }
 
 MODULE_AUTHOR("OpenSFS, Inc. <http://www.lustre.org/>");
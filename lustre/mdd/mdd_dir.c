@@ -713,6 +713,28 @@ static int __mdd_index_delete(const struct lu_env *env, struct mdd_object *pobj,
         RETURN(rc);
 }
 
+/**
+ * Update the times of directory \a pobj after an entry was added or removed.
+ *
+ * \a pattr was read at the start of the operation. Creates and unlinks
+ * running in the same directory at once have usually already set these
+ * times by now, so read them again and only change the parent inode if
+ * they actually differ, instead of every operation dirtying it in turn.
+ */
+static int mdd_update_parent_time(const struct lu_env *env,
+				  struct mdd_object *pobj,
+				  struct lu_attr *pattr, struct lu_attr *la,
+				  struct thandle *handle)
+{
+	int rc;
+
+	rc = mdd_la_get(env, pobj, pattr);
+	if (rc)
+		return rc;
+
+	return mdd_update_time(env, pobj, pattr, la, handle);
+}
+
 static int mdd_llog_record_calc_size(const struct lu_env *env,
 				     const struct lu_name *tname,
 				     const struct lu_name *sname)
@@ -1551,9 +1573,10 @@ int mdd_unlink_sanity_check(const struct lu_env *env, struct mdd_object *pobj,
 }
 
 static int mdd_declare_unlink(const struct lu_env *env, struct mdd_device *mdd,
-			      struct mdd_object *p, struct mdd_object *c,
-			      const struct lu_name *name, struct md_attr *ma,
-			      struct thandle *handle, int no_name, int is_dir)
+			      struct mdd_object *p, const struct lu_attr *pattr,
+			      struct mdd_object *c, const struct lu_name *name,
+			      struct md_attr *ma, struct thandle *handle,
+			      int no_name, int is_dir)
 {
 	struct lu_attr	*la = &mdd_env_info(env)->mti_la_for_fix;
 	int		 rc;
@@ -1576,9 +1599,12 @@ static int mdd_declare_unlink(const struct lu_env *env, struct mdd_device *mdd,
 	LASSERT(ma->ma_attr.la_valid & LA_CTIME);
 	la->la_ctime = la->la_mtime = ma->ma_attr.la_ctime;
 	la->la_valid = LA_CTIME | LA_MTIME;
-	rc = mdo_declare_attr_set(env, p, la, handle);
-	if (rc)
-		return rc;
+	mdd_update_time_valid(pattr, la);
+	if (la->la_valid != 0) {
+		rc = mdo_declare_attr_set(env, p, la, handle);
+		if (rc)
+			return rc;
+	}
 
 	if (c != NULL) {
 		rc = mdo_declare_ref_del(env, c, handle);
@@ -1698,7 +1724,7 @@ static int mdd_unlink(const struct lu_env *env, struct md_object *pobj,
 	if (IS_ERR(handle))
 		RETURN(PTR_ERR(handle));
 
-	rc = mdd_declare_unlink(env, mdd, mdd_pobj, mdd_cobj,
+	rc = mdd_declare_unlink(env, mdd, mdd_pobj, pattr, mdd_cobj,
 				lname, ma, handle, no_name, is_dir);
 	if (rc)
 		GOTO(stop, rc);
@@ -1744,7 +1770,7 @@ static int mdd_unlink(const struct lu_env *env, struct md_object *pobj,
 	la->la_ctime = la->la_mtime = ma->ma_attr.la_ctime;
 
 	la->la_valid = LA_CTIME | LA_MTIME;
-	rc = mdd_update_time(env, mdd_pobj, pattr, la, handle);
+	rc = mdd_update_parent_time(env, mdd_pobj, pattr, la, handle);
 	if (rc)
 		GOTO(cleanup, rc);
 
@@ -2164,8 +2190,8 @@ out:
 }
 
 static int mdd_declare_create(const struct lu_env *env, struct mdd_device *mdd,
-			      struct mdd_object *p, struct mdd_object *c,
-			      const struct lu_name *name,
+			      struct mdd_object *p, const struct lu_attr *pattr,
+			      struct mdd_object *c, const struct lu_name *name,
 			      struct lu_attr *attr,
 			      struct thandle *handle,
 			      const struct md_op_spec *spec,
@@ -2206,9 +2232,13 @@ static int mdd_declare_create(const struct lu_env *env, struct mdd_device *mdd,
 
 		*la = *attr;
 		la->la_valid = LA_CTIME | LA_MTIME;
-		rc = mdo_declare_attr_set(env, p, la, handle);
-		if (rc)
-			return rc;
+		if (pattr != NULL)
+			mdd_update_time_valid(pattr, la);
+		if (la->la_valid != 0) {
+			rc = mdo_declare_attr_set(env, p, la, handle);
+			if (rc)
+				return rc;
+		}
 
 		type = S_ISDIR(attr->la_mode) ? CL_MKDIR :
 		       S_ISREG(attr->la_mode) ? CL_CREATE :
@@ -2543,7 +2573,7 @@ static int mdd_create(const struct lu_env *env, struct md_object *pobj,
 					lname, 1, 0, ldata);
 	}
 
-	rc = mdd_declare_create(env, mdd, mdd_pobj, son, lname, attr,
+	rc = mdd_declare_create(env, mdd, mdd_pobj, pattr, son, lname, attr,
 				handle, spec, ldata, &def_acl_buf, &acl_buf,
 				hint);
 	if (rc)
@@ -2575,7 +2605,7 @@ static int mdd_create(const struct lu_env *env, struct md_object *pobj,
 		/* update parent directory mtime/ctime */
 		*la = *attr;
 		la->la_valid = LA_CTIME | LA_MTIME;
-		rc = mdd_update_time(env, mdd_pobj, pattr, la, handle);
+		rc = mdd_update_parent_time(env, mdd_pobj, pattr, la, handle);
 		if (rc)
 			GOTO(err_insert, rc);
 	}
@@ -3881,9 +3911,9 @@ static int mdd_declare_migrate_create(const struct lu_env *env,
 		}
 	}
 
-	rc = mdd_declare_create(env, mdo2mdd(&tpobj->mod_obj), tpobj, tobj,
-				lname, attr, handle, spec, ldata, NULL, NULL,
-				hint);
+	rc = mdd_declare_create(env, mdo2mdd(&tpobj->mod_obj), tpobj, NULL,
+				tobj, lname, attr, handle, spec, ldata, NULL,
+				NULL, hint);
 	if (rc)
 		return rc;
 
@@ -218,6 +218,7 @@ int mdd_attr_set_internal(const struct lu_env *env,
 			  const struct lu_attr *attr,
 			  struct thandle *handle,
 			  int needacl);
+void mdd_update_time_valid(const struct lu_attr *oattr, struct lu_attr *attr);
 int mdd_update_time(const struct lu_env *env, struct mdd_object *obj,
 		    const struct lu_attr *oattr, struct lu_attr *attr,
 		    struct thandle *handle);
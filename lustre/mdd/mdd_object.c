@@ -613,6 +613,34 @@ int mdd_attr_set_internal(const struct lu_env *env, struct mdd_object *obj,
 	RETURN(rc);
 }
 
+/**
+ * Drop ctime/mtime from \a attr if setting them would not change \a oattr.
+ *
+ * Timestamps are kept with one second resolution, so all creates/unlinks
+ * in a directory within the same second need only one update of the
+ * parent. The declare and execution phases call this with the same
+ * \a oattr, so both make the same decision.
+ *
+ * \param[in] oattr	current attributes of the object
+ * \param[in,out] attr	time update, la_valid is adjusted
+ */
+void mdd_update_time_valid(const struct lu_attr *oattr, struct lu_attr *attr)
+{
+	/* Make sure the ctime is increased only, however, it's not strictly
+	 * reliable at here because there is not guarantee to hold lock on
+	 * object, so we just bypass some unnecessary cmtime setting first
+	 * and OSD has to check it again. */
+	if (attr->la_ctime < oattr->la_ctime) {
+		attr->la_valid &= ~(LA_MTIME | LA_CTIME);
+		return;
+	}
+
+	if ((attr->la_valid & LA_CTIME) && attr->la_ctime == oattr->la_ctime)
+		attr->la_valid &= ~LA_CTIME;
+	if ((attr->la_valid & LA_MTIME) && attr->la_mtime == oattr->la_mtime)
+		attr->la_valid &= ~LA_MTIME;
+}
+
 int mdd_update_time(const struct lu_env *env, struct mdd_object *obj,
 		    const struct lu_attr *oattr, struct lu_attr *attr,
 		    struct thandle *handle)
@@ -623,16 +651,7 @@ int mdd_update_time(const struct lu_env *env, struct mdd_object *obj,
 	LASSERT(attr->la_valid & LA_CTIME);
 	LASSERT(oattr != NULL);
 
-	/* Make sure the ctime is increased only, however, it's not strictly
-	 * reliable at here because there is not guarantee to hold lock on
-	 * object, so we just bypass some unnecessary cmtime setting first
-	 * and OSD has to check it again. */
-	if (attr->la_ctime < oattr->la_ctime)
-		attr->la_valid &= ~(LA_MTIME | LA_CTIME);
-	else if (attr->la_valid == LA_CTIME &&
-		 attr->la_ctime == oattr->la_ctime)
-		attr->la_valid &= ~LA_CTIME;
-
+	mdd_update_time_valid(oattr, attr);
 	if (attr->la_valid != 0)
 		rc = mdd_attr_set_internal(env, obj, attr, handle, 0);
 	RETURN(rc);
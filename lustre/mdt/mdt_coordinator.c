@@ -151,7 +151,6 @@ struct hsm_scan_data {
 
 static int mdt_cdt_waiting_cb(const struct lu_env *env,
 			      struct mdt_device *mdt,
-			      struct llog_handle *llh,
 			      struct llog_agent_req_rec *larr,
 			      struct hsm_scan_data *hsd)
 {
@@ -290,17 +289,8 @@ static int mdt_cdt_waiting_cb(const struct lu_env *env,
 
 	hsd->hsd_action_count++;
 
-	switch (hai->hai_action) {
-	case HSMA_CANCEL:
-		break;
-	case HSMA_RESTORE:
+	if (hai->hai_action == HSMA_RESTORE)
 		hsd->hsd_one_restore = true;
-		/* Intentional fallthrough */
-	default:
-		cdt_agent_record_hash_add(cdt, hai->hai_cookie,
-					  llh->lgh_hdr->llh_cat_idx,
-					  larr->arr_hdr.lrh_index);
-	}
 
 	RETURN(0);
 }
@@ -398,47 +388,143 @@ out_car:
 }
 
 /**
- *  llog_cat_process() callback, used to:
- *  - find waiting request and start action
- *  - purge canceled and done requests
+ * find waiting requests to start, from the in-memory index of the
+ * agent llog, see mdt_cdt_waiting_cb()
+ * \param env [IN] environment
+ * \param mdt [IN] MDT device
+ * \param hsd [IN/OUT] requests to send
+ * \retval 0 success
+ * \retval -ve failure
+ */
+static int mdt_cdt_scan_waiting(const struct lu_env *env,
+				struct mdt_device *mdt,
+				struct hsm_scan_data *hsd)
+{
+	struct coordinator *cdt = &mdt->mdt_coordinator;
+	struct cdt_action *ca;
+	int rc = 0;
+	ENTRY;
+
+	down_read(&cdt->cdt_llog_lock);
+	list_for_each_entry(ca, &cdt->cdt_actions_waiting, ca_list) {
+		dump_llog_agent_req_rec("mdt_cdt_scan_waiting(): ",
+					ca->ca_larr);
+		rc = mdt_cdt_waiting_cb(env, mdt, ca->ca_larr, hsd);
+		if (rc != 0)
+			break;
+	}
+	up_read(&cdt->cdt_llog_lock);
+
+	RETURN(rc == LLOG_PROC_BREAK ? 0 : rc);
+}
+
+/**
+ * data passed to llog_cat_process() callback
+ * to time out a started request
+ */
+struct hsm_timeout_data {
+	struct hsm_scan_data	*htd_hsd;
+	u32			 htd_cat_idx;
+	u32			 htd_rec_idx;
+};
+
+/**
+ *  llog_cat_process() callback, used to cancel a started request
+ *  which timed out, the scan starts on its record
  * \param env [IN] environment
  * \param llh [IN] llog handle
  * \param hdr [IN] llog record
- * \param data [IN/OUT] cb data = struct hsm_scan_data
+ * \param data [IN] cb data = struct hsm_timeout_data
  * \retval 0 success
  * \retval -ve failure
  */
-static int mdt_coordinator_cb(const struct lu_env *env,
+static int mdt_cdt_timeout_cb(const struct lu_env *env,
 			      struct llog_handle *llh,
-			      struct llog_rec_hdr *hdr,
-			      void *data)
+			      struct llog_rec_hdr *hdr, void *data)
 {
 	struct llog_agent_req_rec *larr = (struct llog_agent_req_rec *)hdr;
-	struct hsm_scan_data *hsd = data;
-	struct mdt_device *mdt = hsd->hsd_mti->mti_mdt;
+	struct hsm_timeout_data *htd = data;
+	struct mdt_device *mdt = htd->htd_hsd->hsd_mti->mti_mdt;
 	struct coordinator *cdt = &mdt->mdt_coordinator;
+	u32 cat_idx = llh->lgh_hdr->llh_cat_idx;
+	int rc;
 	ENTRY;
 
-	larr = (struct llog_agent_req_rec *)hdr;
-	dump_llog_agent_req_rec("mdt_coordinator_cb(): ", larr);
-	switch (larr->arr_status) {
-	case ARS_WAITING:
-		RETURN(mdt_cdt_waiting_cb(env, mdt, llh, larr, hsd));
-	case ARS_STARTED:
-		RETURN(mdt_cdt_started_cb(env, mdt, llh, larr, hsd));
-	default:
-		if (!hsd->hsd_housekeeping)
-			RETURN(0);
+	if (cat_idx != htd->htd_cat_idx || hdr->lrh_index != htd->htd_rec_idx)
+		RETURN(LLOG_PROC_BREAK);
 
-		if ((larr->arr_req_change + cdt->cdt_grace_delay) <
-		    ktime_get_real_seconds()) {
-			cdt_agent_record_hash_del(cdt,
-						  larr->arr_hai.hai_cookie);
-			RETURN(LLOG_DEL_RECORD);
-		}
+	/* the request may have been updated since it was found */
+	if (larr->arr_status != ARS_STARTED)
+		RETURN(LLOG_PROC_BREAK);
 
-		RETURN(0);
+	rc = mdt_cdt_started_cb(env, mdt, llh, larr, htd->htd_hsd);
+	if (rc == LLOG_DEL_RECORD) {
+		cdt_action_index_del(cdt, cat_idx, hdr->lrh_index);
+		RETURN(rc);
+	}
+	if (rc < 0)
+		RETURN(rc);
+
+	cdt_action_index_update(cdt, &llh->lgh_id, cat_idx, larr);
+
+	RETURN(LLOG_PROC_BREAK);
+}
+
+/**
+ * cancel the started requests which did not progress for longer than
+ * cdt_active_req_timeout, see mdt_cdt_started_cb()
+ * \param env [IN] environment
+ * \param mdt [IN] MDT device
+ * \param hsd [IN] scan data
+ */
+static void mdt_cdt_check_started(const struct lu_env *env,
+				  struct mdt_device *mdt,
+				  struct hsm_scan_data *hsd)
+{
+	struct coordinator *cdt = &mdt->mdt_coordinator;
+	struct hsm_timeout_data htd = { .htd_hsd = hsd };
+	time64_t now = ktime_get_real_seconds();
+	struct cdt_action *ca;
+	u64 *locs = NULL;
+	int locs_len = 0;
+	int count = 0;
+	int i;
+
+	down_read(&cdt->cdt_llog_lock);
+	list_for_each_entry(ca, &cdt->cdt_actions_started, ca_list)
+		locs_len++;
+
+	if (locs_len > 0)
+		OBD_ALLOC_LARGE(locs, locs_len * sizeof(*locs));
+
+	if (locs != NULL) {
+		list_for_each_entry(ca, &cdt->cdt_actions_started, ca_list) {
+			struct cdt_agent_req *car;
+			time64_t last = ca->ca_larr->arr_req_change;
+
+			car = mdt_cdt_find_request(cdt,
+					ca->ca_larr->arr_hai.hai_cookie);
+			if (car != NULL) {
+				last = car->car_req_update;
+				mdt_cdt_put_request(car);
+			}
+
+			if (now > last + cdt->cdt_active_req_timeout)
+				locs[count++] = ca->ca_loc;
+		}
+	}
+	up_read(&cdt->cdt_llog_lock);
+
+	/* the records are updated in the llog, one at a time */
+	for (i = 0; i < count; i++) {
+		htd.htd_cat_idx = locs[i] >> 32;
+		htd.htd_rec_idx = locs[i] & 0xffffffff;
+		cdt_llog_process(env, mdt, mdt_cdt_timeout_cb, &htd,
+				 htd.htd_cat_idx, htd.htd_rec_idx - 1, WRITE);
 	}
+
+	if (locs != NULL)
+		OBD_FREE_LARGE(locs, locs_len * sizeof(*locs));
 }
 
 /**
@@ -694,8 +780,15 @@ static int mdt_coordinator(void *data)
 		hsd.hsd_request_count = 0;
 		hsd.hsd_one_restore = false;
 
-		rc = cdt_llog_process(mti->mti_env, mdt, mdt_coordinator_cb,
-				      &hsd, 0, 0, WRITE);
+		if (hsd.hsd_housekeeping) {
+			if (cdt->cdt_actions_incomplete)
+				cdt_action_index_rebuild(mti->mti_env, mdt,
+							 NULL, NULL);
+			mdt_cdt_check_started(mti->mti_env, mdt, &hsd);
+			cdt_action_purge(mti->mti_env, mdt);
+		}
+
+		rc = mdt_cdt_scan_waiting(mti->mti_env, mdt, &hsd);
 		if (rc < 0)
 			goto clean_cb_alloc;
 
@@ -964,8 +1057,9 @@ static int mdt_hsm_pending_restore(struct mdt_thread_info *mti)
 
 	hrd.hrd_mti = mti;
 
-	rc = cdt_llog_process(mti->mti_env, mti->mti_mdt, hsm_restore_cb, &hrd,
-			      0, 0, WRITE);
+	/* this also loads the index of the llog used by the coordinator */
+	rc = cdt_action_index_rebuild(mti->mti_env, mti->mti_mdt,
+				      hsm_restore_cb, &hrd);
 
 	RETURN(rc);
 }
@@ -1044,10 +1138,14 @@ int mdt_hsm_cdt_init(struct mdt_device *mdt)
 	if (cdt->cdt_agent_record_hash == NULL)
 		GOTO(out_request_cookie_hash, rc = -ENOMEM);
 
-	rc = lu_env_init(&cdt->cdt_env, LCT_MD_THREAD);
+	rc = cdt_action_index_init(cdt);
 	if (rc < 0)
 		GOTO(out_agent_record_hash, rc);
 
+	rc = lu_env_init(&cdt->cdt_env, LCT_MD_THREAD);
+	if (rc < 0)
+		GOTO(out_action_index, rc);
+
 	/* for mdt_ucred(), lu_ucred stored in lu_ucred_key */
 	rc = lu_context_init(&cdt->cdt_session, LCT_SERVER_SESSION);
 	if (rc < 0)
@@ -1080,6 +1178,8 @@ int mdt_hsm_cdt_init(struct mdt_device *mdt)
 
 out_env:
 	lu_env_fini(&cdt->cdt_env);
+out_action_index:
+	cdt_action_index_fini(cdt);
 out_agent_record_hash:
 	cfs_hash_putref(cdt->cdt_agent_record_hash);
 	cdt->cdt_agent_record_hash = NULL;
@@ -1104,6 +1204,8 @@ int  mdt_hsm_cdt_fini(struct mdt_device *mdt)
 
 	lu_env_fini(&cdt->cdt_env);
 
+	cdt_action_index_fini(cdt);
+
 	cfs_hash_putref(cdt->cdt_agent_record_hash);
 	cdt->cdt_agent_record_hash = NULL;
 
@@ -1751,6 +1853,11 @@ static int mdt_cancel_all_cb(const struct lu_env *env,
 		larr->arr_status = ARS_CANCELED;
 		larr->arr_req_change = ktime_get_real_seconds();
 		rc = llog_write(env, llh, hdr, hdr->lrh_index);
+		if (rc == 0)
+			cdt_action_index_update(&hcad->mdt->mdt_coordinator,
+						&llh->lgh_id,
+						llh->lgh_hdr->llh_cat_idx,
+						larr);
 	}
 
 	RETURN(rc);
@@ -5067,6 +5067,8 @@ static int mdt_init0(const struct lu_env *env, struct mdt_device *m,
 	m->mdt_opts.mo_dom_lock = ALWAYS_DOM_LOCK_ON_OPEN;
 	/* DoM files are read at open and data is packed in the reply */
 	m->mdt_opts.mo_dom_read_open = 1;
+	/* new DoM files get IO lock at open-create for writing */
+	m->mdt_opts.mo_dom_create_lock = 1;
 
 	m->mdt_squash.rsi_uid = 0;
 	m->mdt_squash.rsi_gid = 0;
@@ -166,6 +166,317 @@ void cdt_agent_record_hash_del(struct coordinator *cdt, u64 cookie)
 	cfs_hash_del_key(cdt->cdt_agent_record_hash, &cookie);
 }
 
+/*
+ * In-memory index of the agent request log.
+ *
+ * Every record of the catalog has a struct cdt_action holding a copy of
+ * it, which can be found by llog location or by FID and which is chained
+ * on the list matching the record status. The index is filled by a scan
+ * of the catalog when the coordinator starts and is then kept in sync by
+ * each function writing to the catalog, so the coordinator and the HSM
+ * client requests do not have to walk the llog to find their records.
+ *
+ * All the index is protected by cdt_llog_lock, which also covers every
+ * lookup, so the hashes do not hold references on the entries.
+ */
+static inline u64 cdt_action_loc(u32 cat_idx, u32 rec_idx)
+{
+	return (u64)cat_idx << 32 | rec_idx;
+}
+
+static unsigned int
+cdt_action_loc_hash(struct cfs_hash *hs, const void *key, unsigned int mask)
+{
+	return cfs_hash_djb2_hash(key, sizeof(u64), mask);
+}
+
+static void *cdt_action_loc_object(struct hlist_node *hnode)
+{
+	return hlist_entry(hnode, struct cdt_action, ca_loc_hnode);
+}
+
+static void *cdt_action_loc_key(struct hlist_node *hnode)
+{
+	struct cdt_action *ca = cdt_action_loc_object(hnode);
+
+	return &ca->ca_loc;
+}
+
+static int cdt_action_loc_keycmp(const void *key, struct hlist_node *hnode)
+{
+	const u64 *loc2 = cdt_action_loc_key(hnode);
+
+	return *(const u64 *)key == *loc2;
+}
+
+static unsigned int
+cdt_action_fid_hash(struct cfs_hash *hs, const void *key, unsigned int mask)
+{
+	return cfs_hash_djb2_hash(key, sizeof(struct lu_fid), mask);
+}
+
+static void *cdt_action_fid_object(struct hlist_node *hnode)
+{
+	return hlist_entry(hnode, struct cdt_action, ca_fid_hnode);
+}
+
+static void *cdt_action_fid_key(struct hlist_node *hnode)
+{
+	struct cdt_action *ca = cdt_action_fid_object(hnode);
+
+	return &ca->ca_larr->arr_hai.hai_fid;
+}
+
+static int cdt_action_fid_keycmp(const void *key, struct hlist_node *hnode)
+{
+	return lu_fid_eq(key, cdt_action_fid_key(hnode));
+}
+
+static void cdt_action_get(struct cfs_hash *hs, struct hlist_node *hnode)
+{
+}
+
+static void cdt_action_put(struct cfs_hash *hs, struct hlist_node *hnode)
+{
+}
+
+static struct cfs_hash_ops cdt_action_loc_hash_ops = {
+	.hs_hash	= cdt_action_loc_hash,
+	.hs_key		= cdt_action_loc_key,
+	.hs_keycmp	= cdt_action_loc_keycmp,
+	.hs_object	= cdt_action_loc_object,
+	.hs_get		= cdt_action_get,
+	.hs_put_locked	= cdt_action_put,
+};
+
+static struct cfs_hash_ops cdt_action_fid_hash_ops = {
+	.hs_hash	= cdt_action_fid_hash,
+	.hs_key		= cdt_action_fid_key,
+	.hs_keycmp	= cdt_action_fid_keycmp,
+	.hs_object	= cdt_action_fid_object,
+	.hs_get		= cdt_action_get,
+	.hs_put_locked	= cdt_action_put,
+};
+
+static struct list_head *cdt_action_list(struct coordinator *cdt,
+					 enum agent_req_status status)
+{
+	switch (status) {
+	case ARS_WAITING:
+		return &cdt->cdt_actions_waiting;
+	case ARS_STARTED:
+		return &cdt->cdt_actions_started;
+	default:
+		return &cdt->cdt_actions_done;
+	}
+}
+
+static void cdt_action_free(struct coordinator *cdt, struct cdt_action *ca)
+{
+	int sz = ca->ca_larr->arr_hdr.lrh_len;
+
+	cfs_hash_del(cdt->cdt_action_loc_hash, &ca->ca_loc, &ca->ca_loc_hnode);
+	cfs_hash_del(cdt->cdt_action_fid_hash, &ca->ca_larr->arr_hai.hai_fid,
+		     &ca->ca_fid_hnode);
+	list_del(&ca->ca_list);
+	OBD_FREE(ca->ca_larr, sz);
+	OBD_FREE_PTR(ca);
+}
+
+/**
+ * initialize the in-memory index of the agent request log
+ * it is marked incomplete until the llog has been loaded
+ * \param cdt [IN] coordinator
+ * \retval 0 success
+ * \retval -ve failure
+ */
+int cdt_action_index_init(struct coordinator *cdt)
+{
+	INIT_LIST_HEAD(&cdt->cdt_actions_waiting);
+	INIT_LIST_HEAD(&cdt->cdt_actions_started);
+	INIT_LIST_HEAD(&cdt->cdt_actions_done);
+	cdt->cdt_actions_incomplete = true;
+
+	cdt->cdt_action_loc_hash = cfs_hash_create("HSM_ACTION_LOC_HASH",
+						   CFS_HASH_BITS_MIN,
+						   CFS_HASH_BITS_MAX,
+						   CFS_HASH_BKT_BITS,
+						   0 /* extra bytes */,
+						   CFS_HASH_MIN_THETA,
+						   CFS_HASH_MAX_THETA,
+						   &cdt_action_loc_hash_ops,
+						   CFS_HASH_DEFAULT |
+						   CFS_HASH_NO_ITEMREF);
+	if (cdt->cdt_action_loc_hash == NULL)
+		return -ENOMEM;
+
+	cdt->cdt_action_fid_hash = cfs_hash_create("HSM_ACTION_FID_HASH",
+						   CFS_HASH_BITS_MIN,
+						   CFS_HASH_BITS_MAX,
+						   CFS_HASH_BKT_BITS,
+						   0 /* extra bytes */,
+						   CFS_HASH_MIN_THETA,
+						   CFS_HASH_MAX_THETA,
+						   &cdt_action_fid_hash_ops,
+						   CFS_HASH_DEFAULT |
+						   CFS_HASH_NO_ITEMREF);
+	if (cdt->cdt_action_fid_hash == NULL) {
+		cfs_hash_putref(cdt->cdt_action_loc_hash);
+		cdt->cdt_action_loc_hash = NULL;
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
+/**
+ * free the in-memory index of the agent request log
+ * \param cdt [IN] coordinator
+ */
+void cdt_action_index_fini(struct coordinator *cdt)
+{
+	struct list_head *lists[] = { &cdt->cdt_actions_waiting,
+				      &cdt->cdt_actions_started,
+				      &cdt->cdt_actions_done };
+	struct cdt_action *ca, *tmp;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(lists); i++)
+		list_for_each_entry_safe(ca, tmp, lists[i], ca_list)
+			cdt_action_free(cdt, ca);
+
+	cfs_hash_putref(cdt->cdt_action_fid_hash);
+	cdt->cdt_action_fid_hash = NULL;
+	cfs_hash_putref(cdt->cdt_action_loc_hash);
+	cdt->cdt_action_loc_hash = NULL;
+}
+
+/**
+ * record the current content of an agent llog record in the index
+ * must be called with cdt_llog_lock held for write
+ * \param cdt [IN] coordinator
+ * \param logid [IN] plain llog holding the record
+ * \param cat_idx [IN] catalog index of the plain llog
+ * \param larr [IN] record, as written in the llog
+ * \retval 0 success
+ * \retval -ve failure, the index is then marked incomplete
+ */
+int cdt_action_index_update(struct coordinator *cdt,
+			    const struct llog_logid *logid, u32 cat_idx,
+			    const struct llog_agent_req_rec *larr)
+{
+	struct cdt_action *ca;
+	u64 loc = cdt_action_loc(cat_idx, larr->arr_hdr.lrh_index);
+	int sz = larr->arr_hdr.lrh_len;
+
+	ca = cfs_hash_lookup(cdt->cdt_action_loc_hash, &loc);
+	if (ca != NULL) {
+		/* records are rewritten in place, their size never changes */
+		LASSERT(ca->ca_larr->arr_hdr.lrh_len == sz);
+		if (ca->ca_larr->arr_status != larr->arr_status)
+			list_move_tail(&ca->ca_list,
+				       cdt_action_list(cdt, larr->arr_status));
+		memcpy(ca->ca_larr, larr, sz);
+		return 0;
+	}
+
+	OBD_ALLOC_PTR(ca);
+	if (ca == NULL)
+		goto out_incomplete;
+
+	OBD_ALLOC(ca->ca_larr, sz);
+	if (ca->ca_larr == NULL) {
+		OBD_FREE_PTR(ca);
+		goto out_incomplete;
+	}
+
+	memcpy(ca->ca_larr, larr, sz);
+	ca->ca_loc = loc;
+	ca->ca_logid = *logid;
+	cfs_hash_add(cdt->cdt_action_loc_hash, &ca->ca_loc, &ca->ca_loc_hnode);
+	cfs_hash_add(cdt->cdt_action_fid_hash, &ca->ca_larr->arr_hai.hai_fid,
+		     &ca->ca_fid_hnode);
+	list_add_tail(&ca->ca_list, cdt_action_list(cdt, larr->arr_status));
+
+	if (larr->arr_hai.hai_action != HSMA_CANCEL)
+		cdt_agent_record_hash_add(cdt, larr->arr_hai.hai_cookie,
+					  cat_idx, larr->arr_hdr.lrh_index);
+
+	return 0;
+
+out_incomplete:
+	cdt->cdt_actions_incomplete = true;
+	return -ENOMEM;
+}
+
+/**
+ * forget a record deleted from the agent llog
+ * must be called with cdt_llog_lock held for write
+ * \param cdt [IN] coordinator
+ * \param cat_idx [IN] catalog index of the plain llog
+ * \param rec_idx [IN] record index in the plain llog
+ */
+void cdt_action_index_del(struct coordinator *cdt, u32 cat_idx, u32 rec_idx)
+{
+	struct cdt_action *ca;
+	u64 loc = cdt_action_loc(cat_idx, rec_idx);
+
+	ca = cfs_hash_lookup(cdt->cdt_action_loc_hash, &loc);
+	if (ca != NULL)
+		cdt_action_free(cdt, ca);
+}
+
+struct cdt_action_find_data {
+	bool			 cafd_newest;
+	struct cdt_action	*cafd_action;
+};
+
+static int cdt_action_find_active_cb(struct cfs_hash *hs,
+				     struct cfs_hash_bd *bd,
+				     struct hlist_node *hnode, void *data)
+{
+	struct cdt_action_find_data *cafd = data;
+	struct cdt_action *ca = cdt_action_fid_object(hnode);
+	struct cdt_action *found = cafd->cafd_action;
+	struct llog_agent_req_rec *larr = ca->ca_larr;
+
+	if (larr->arr_hai.hai_action == HSMA_CANCEL ||
+	    agent_req_in_final_state(larr->arr_status))
+		return 0;
+
+	if (found == NULL ||
+	    (cafd->cafd_newest &&
+	     larr->arr_hai.hai_cookie > found->ca_larr->arr_hai.hai_cookie) ||
+	    (!cafd->cafd_newest &&
+	     larr->arr_hai.hai_cookie < found->ca_larr->arr_hai.hai_cookie))
+		cafd->cafd_action = ca;
+
+	return 0;
+}
+
+/**
+ * find a waiting or started request (cancel requests excepted) on a FID
+ * must be called with cdt_llog_lock held
+ * \param cdt [IN] coordinator
+ * \param fid [IN] FID of the file
+ * \param newest [IN] return the most recent request instead of the oldest
+ * \retval the index entry of the request, NULL if none
+ */
+struct cdt_action *cdt_action_find_active(struct coordinator *cdt,
+					  const struct lu_fid *fid,
+					  bool newest)
+{
+	struct cdt_action_find_data cafd = {
+		.cafd_newest	= newest,
+		.cafd_action	= NULL,
+	};
+
+	cfs_hash_for_each_key(cdt->cdt_action_fid_hash, fid,
+			      cdt_action_find_active_cb, &cafd);
+
+	return cafd.cafd_action;
+}
+
 void dump_llog_agent_req_rec(const char *prefix,
 			     const struct llog_agent_req_rec *larr)
 {
@@ -197,6 +508,14 @@ void dump_llog_agent_req_rec(const char *prefix,
 	       hai_dump_data_field(&larr->arr_hai, buf, sizeof(buf)));
 }
 
+static inline bool cdt_logid_eq(const struct llog_logid *logid1,
+				const struct llog_logid *logid2)
+{
+	return ostid_id(&logid1->lgl_oi) == ostid_id(&logid2->lgl_oi) &&
+	       ostid_seq(&logid1->lgl_oi) == ostid_seq(&logid2->lgl_oi) &&
+	       logid1->lgl_ogen == logid2->lgl_ogen;
+}
+
 /*
  * process the actions llog
  * \param env [IN] environment
@@ -246,6 +565,162 @@ int cdt_llog_process(const struct lu_env *env, struct mdt_device *mdt,
 	RETURN(rc);
 }
 
+/**
+ * data passed to llog_cat_process() callback
+ * to load the index of the agent llog
+ */
+struct cdt_action_rebuild_data {
+	struct coordinator	*carb_cdt;
+	llog_cb_t		 carb_cb;
+	void			*carb_data;
+};
+
+/**
+ *  llog_cat_process() callback, used to load a record in the index
+ *  after it has been handled by the caller callback, if any
+ */
+static int cdt_action_rebuild_cb(const struct lu_env *env,
+				 struct llog_handle *llh,
+				 struct llog_rec_hdr *hdr, void *data)
+{
+	struct cdt_action_rebuild_data *carb = data;
+	int rc;
+
+	if (carb->carb_cb != NULL) {
+		rc = carb->carb_cb(env, llh, hdr, carb->carb_data);
+		if (rc == LLOG_DEL_RECORD)
+			cdt_action_index_del(carb->carb_cdt,
+					     llh->lgh_hdr->llh_cat_idx,
+					     hdr->lrh_index);
+		if (rc != 0)
+			return rc;
+	}
+
+	return cdt_action_index_update(carb->carb_cdt, &llh->lgh_id,
+				       llh->lgh_hdr->llh_cat_idx,
+				       (struct llog_agent_req_rec *)hdr);
+}
+
+/**
+ * (re)load the in-memory index from the agent llog
+ * entries already indexed are refreshed, so it can be called at any time
+ * \param env [IN] environment
+ * \param mdt [IN] MDT device
+ * \param cb [IN] optional llog callback called first for each record
+ * \param data [IN] data of \a cb
+ * \retval 0 success
+ * \retval -ve failure
+ */
+int cdt_action_index_rebuild(const struct lu_env *env, struct mdt_device *mdt,
+			     llog_cb_t cb, void *data)
+{
+	struct obd_device		*obd = mdt2obd_dev(mdt);
+	struct coordinator		*cdt = &mdt->mdt_coordinator;
+	struct cdt_action_rebuild_data	 carb = {
+		.carb_cdt	= cdt,
+		.carb_cb	= cb,
+		.carb_data	= data,
+	};
+	struct llog_ctxt		*lctxt;
+	int				 rc;
+	ENTRY;
+
+	lctxt = llog_get_context(obd, LLOG_AGENT_ORIG_CTXT);
+	if (lctxt == NULL || lctxt->loc_handle == NULL)
+		RETURN(-ENOENT);
+
+	down_write(&cdt->cdt_llog_lock);
+	/* set again by cdt_action_index_update() on failure */
+	cdt->cdt_actions_incomplete = false;
+	rc = llog_cat_process(env, lctxt->loc_handle, cdt_action_rebuild_cb,
+			      &carb, 0, 0);
+	if (rc < 0) {
+		CERROR("%s: failed to load HSM_ACTIONS llog (rc=%d)\n",
+		       mdt_obd_name(mdt), rc);
+		cdt->cdt_actions_incomplete = true;
+	} else {
+		rc = 0;
+	}
+	up_write(&cdt->cdt_llog_lock);
+
+	llog_ctxt_put(lctxt);
+
+	RETURN(rc);
+}
+
+/**
+ * make sure the index covers the whole agent llog before looking it up
+ * \param env [IN] environment
+ * \param mdt [IN] MDT device
+ * \retval 0 success
+ * \retval -ve failure
+ */
+int cdt_action_index_load(const struct lu_env *env, struct mdt_device *mdt)
+{
+	if (likely(!mdt->mdt_coordinator.cdt_actions_incomplete))
+		return 0;
+
+	return cdt_action_index_rebuild(env, mdt, NULL, NULL);
+}
+
+/**
+ * remove from the agent llog and from the index the requests which
+ * have been in a final state for more than the grace delay
+ * an entry is dropped from the index only once its record is canceled,
+ * so that the index never misses a record still in the llog
+ * \param env [IN] environment
+ * \param mdt [IN] MDT device
+ * \retval 0 success
+ * \retval -ve failure
+ */
+int cdt_action_purge(const struct lu_env *env, struct mdt_device *mdt)
+{
+	struct obd_device	*obd = mdt2obd_dev(mdt);
+	struct coordinator	*cdt = &mdt->mdt_coordinator;
+	time64_t		 now = ktime_get_real_seconds();
+	struct llog_ctxt	*lctxt;
+	struct cdt_action	*ca, *tmp;
+	int			 rc = 0;
+	ENTRY;
+
+	lctxt = llog_get_context(obd, LLOG_AGENT_ORIG_CTXT);
+	if (lctxt == NULL || lctxt->loc_handle == NULL)
+		RETURN(-ENOENT);
+
+	down_write(&cdt->cdt_llog_lock);
+	list_for_each_entry_safe(ca, tmp, &cdt->cdt_actions_done, ca_list) {
+		struct llog_agent_req_rec *larr = ca->ca_larr;
+		struct llog_cookie cookie;
+
+		if (larr->arr_req_change + cdt->cdt_grace_delay >= now)
+			continue;
+
+		cookie.lgc_lgl = ca->ca_logid;
+		cookie.lgc_index = larr->arr_hdr.lrh_index;
+		rc = llog_cat_cancel_records(env, lctxt->loc_handle, 1,
+					     &cookie);
+		/* -ENOENT: the record or its plain llog is gone already */
+		if (rc < 0 && rc != -ENOENT) {
+			CERROR("%s: cannot cancel HSM request "DFID
+			       " cookie %#llx: rc = %d\n", mdt_obd_name(mdt),
+			       PFID(&larr->arr_hai.hai_fid),
+			       larr->arr_hai.hai_cookie, rc);
+			break;
+		}
+		rc = 0;
+
+		if (larr->arr_hai.hai_action != HSMA_CANCEL)
+			cdt_agent_record_hash_del(cdt,
+						  larr->arr_hai.hai_cookie);
+		cdt_action_free(cdt, ca);
+	}
+	up_write(&cdt->cdt_llog_lock);
+
+	llog_ctxt_put(lctxt);
+
+	RETURN(rc);
+}
+
 /**
  * add an entry in agent llog
  * \param env [IN] environment
@@ -263,6 +738,8 @@ int mdt_agent_record_add(const struct lu_env *env, struct mdt_device *mdt,
 	struct coordinator		*cdt = &mdt->mdt_coordinator;
 	struct llog_ctxt		*lctxt = NULL;
 	struct llog_agent_req_rec	*larr;
+	struct llog_cookie		 cookie = { .lgc_index = 0 };
+	struct llog_handle		*llh;
 	int				 rc;
 	int				 sz;
 	ENTRY;
@@ -296,10 +773,24 @@ int mdt_agent_record_add(const struct lu_env *env, struct mdt_device *mdt,
 		larr->arr_hai.hai_cookie = cdt->cdt_last_cookie;
 	}
 
-	rc = llog_cat_add(env, lctxt->loc_handle, &larr->arr_hdr, NULL);
+	rc = llog_cat_add(env, lctxt->loc_handle, &larr->arr_hdr, &cookie);
 	if (rc > 0)
 		rc = 0;
 
+	if (rc == 0) {
+		/* the record has been added to the current plain llog */
+		llh = lctxt->loc_handle->u.chd.chd_current_log;
+		if (llh != NULL &&
+		    cdt_logid_eq(&llh->lgh_id, &cookie.lgc_lgl)) {
+			larr->arr_hdr.lrh_index = cookie.lgc_index;
+			cdt_action_index_update(cdt, &cookie.lgc_lgl,
+						llh->lgh_hdr->llh_cat_idx,
+						larr);
+		} else {
+			cdt->cdt_actions_incomplete = true;
+		}
+	}
+
 	up_write(&cdt->cdt_llog_lock);
 	llog_ctxt_put(lctxt);
 
@@ -375,6 +866,11 @@ static int mdt_agent_record_update_cb(const struct lu_env *env,
 			larr->arr_status = update->status;
 			larr->arr_req_change = ducb->change_time;
 			rc = llog_write(env, llh, hdr, hdr->lrh_index);
+			if (rc == 0)
+				cdt_action_index_update(
+					&ducb->mdt->mdt_coordinator,
+					&llh->lgh_id,
+					llh->lgh_hdr->llh_cat_idx, larr);
 			ducb->updates_done++;
 			break;
 		}
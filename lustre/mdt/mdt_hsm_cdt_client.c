@@ -43,60 +43,6 @@
 #include <lustre_log.h>
 #include "mdt_internal.h"
 
-/**
- * llog_cat_process() callback, used to find record
- * compatibles with a new hsm_action_list
- * \param env [IN] environment
- * \param llh [IN] llog handle
- * \param hdr [IN] llog record
- * \param data [IN] cb data = hal
- * \retval 0 success
- * \retval -ve failure
- */
-static int hsm_find_compatible_cb(const struct lu_env *env,
-				  struct llog_handle *llh,
-				  struct llog_rec_hdr *hdr, void *data)
-{
-	struct llog_agent_req_rec *larr = (struct llog_agent_req_rec *)hdr;
-	struct hsm_action_list *hal = data;
-	struct hsm_action_item *hai;
-	int i;
-	ENTRY;
-
-	/* a compatible request must be WAITING or STARTED
-	 * and not a cancel */
-	if ((larr->arr_status != ARS_WAITING &&
-	     larr->arr_status != ARS_STARTED) ||
-	    larr->arr_hai.hai_action == HSMA_CANCEL)
-		RETURN(0);
-
-	hai = hai_first(hal);
-	for (i = 0; i < hal->hal_count; i++, hai = hai_next(hai)) {
-		/* if request is a CANCEL:
-		 * if cookie set in the request, there is no need to find a
-		 * compatible one, the cookie in the request is directly used.
-		 * if cookie is not set, we use the FID to find the request
-		 * to cancel (the "compatible" one)
-		 * if the caller sets the cookie, we assume he also sets the
-		 * arr_archive_id
-		 */
-		if (hai->hai_action == HSMA_CANCEL && hai->hai_cookie != 0)
-			continue;
-
-		if (!lu_fid_eq(&hai->hai_fid, &larr->arr_hai.hai_fid))
-			continue;
-
-		/* in V1 we do not manage partial transfer
-		 * so extent is always whole file
-		 */
-		hai->hai_cookie = larr->arr_hai.hai_cookie;
-		/* we read the archive number from the request we cancel */
-		if (hai->hai_action == HSMA_CANCEL && hal->hal_archive_id == 0)
-			hal->hal_archive_id = larr->arr_archive_id;
-	}
-	RETURN(0);
-}
-
 /**
  * find compatible requests already recorded
  * \param env [IN] environment
@@ -110,6 +56,7 @@ static int hsm_find_compatible_cb(const struct lu_env *env,
 static int hsm_find_compatible(const struct lu_env *env, struct mdt_device *mdt,
 			       struct hsm_action_list *hal)
 {
+	struct coordinator *cdt = &mdt->mdt_coordinator;
 	struct hsm_action_item *hai;
 	int rc, i, ok_cnt;
 	ENTRY;
@@ -135,10 +82,45 @@ static int hsm_find_compatible(const struct lu_env *env, struct mdt_device *mdt,
 	if (ok_cnt == hal->hal_count)
 		RETURN(0);
 
-	rc = cdt_llog_process(env, mdt, hsm_find_compatible_cb, hal, 0, 0,
-			      READ);
+	rc = cdt_action_index_load(env, mdt);
+	if (rc < 0)
+		RETURN(rc);
+
+	down_read(&cdt->cdt_llog_lock);
+	hai = hai_first(hal);
+	for (i = 0; i < hal->hal_count; i++, hai = hai_next(hai)) {
+		struct llog_agent_req_rec *larr;
+		struct cdt_action *ca;
+
+		/* if request is a CANCEL:
+		 * if cookie set in the request, there is no need to find a
+		 * compatible one, the cookie in the request is directly used.
+		 * if cookie is not set, we use the FID to find the request
+		 * to cancel (the "compatible" one)
+		 * if the caller sets the cookie, we assume he also sets the
+		 * arr_archive_id
+		 */
+		if (hai->hai_action == HSMA_CANCEL && hai->hai_cookie != 0)
+			continue;
+
+		/* a compatible request must be WAITING or STARTED and not a
+		 * cancel, the most recent one is used */
+		ca = cdt_action_find_active(cdt, &hai->hai_fid, true);
+		if (ca == NULL)
+			continue;
+
+		larr = ca->ca_larr;
+		/* in V1 we do not manage partial transfer
+		 * so extent is always whole file
+		 */
+		hai->hai_cookie = larr->arr_hai.hai_cookie;
+		/* we read the archive number from the request we cancel */
+		if (hai->hai_action == HSMA_CANCEL && hal->hal_archive_id == 0)
+			hal->hal_archive_id = larr->arr_archive_id;
+	}
+	up_read(&cdt->cdt_llog_lock);
 
-	RETURN(rc);
+	RETURN(0);
 }
 
 /**
@@ -468,33 +450,6 @@ bool mdt_hsm_restore_is_running(struct mdt_thread_info *mti,
 	RETURN(is_running);
 }
 
-struct hsm_get_action_data {
-	const struct lu_fid *hgad_fid;
-	struct hsm_action_item hgad_hai;
-	enum agent_req_status hgad_status;
-};
-
-static int hsm_get_action_cb(const struct lu_env *env,
-			     struct llog_handle *llh,
-			     struct llog_rec_hdr *hdr, void *data)
-{
-	struct llog_agent_req_rec *larr = (struct llog_agent_req_rec *)hdr;
-	struct hsm_get_action_data *hgad = data;
-
-	/* A compatible request must be WAITING or STARTED and not a
-	 * cancel. */
-	if ((larr->arr_status != ARS_WAITING &&
-	     larr->arr_status != ARS_STARTED) ||
-	    larr->arr_hai.hai_action == HSMA_CANCEL ||
-	    !lu_fid_eq(&larr->arr_hai.hai_fid, hgad->hgad_fid))
-		RETURN(0);
-
-	hgad->hgad_hai = larr->arr_hai;
-	hgad->hgad_status = larr->arr_status;
-
-	RETURN(LLOG_PROC_BREAK);
-}
-
 /**
  * get registered action on a FID
  * \param mti [IN]
@@ -514,27 +469,36 @@ int mdt_hsm_get_action(struct mdt_thread_info *mti,
 	const struct lu_env *env = mti->mti_env;
 	struct mdt_device *mdt = mti->mti_mdt;
 	struct coordinator *cdt = &mdt->mdt_coordinator;
-	struct hsm_get_action_data hgad = {
-		.hgad_fid = fid,
-		.hgad_hai.hai_action = HSMA_NONE,
-	};
+	struct cdt_action *ca;
 	struct cdt_agent_req *car;
+	__u64 cookie = 0;
 	int rc;
 	ENTRY;
 
 	/* 1st we search in recorded requests */
-	rc = cdt_llog_process(env, mdt, hsm_get_action_cb, &hgad, 0, 0, READ);
+	rc = cdt_action_index_load(env, mdt);
 	if (rc < 0)
 		RETURN(rc);
 
-	*action = hgad.hgad_hai.hai_action;
-	*extent = hgad.hgad_hai.hai_extent;
-	*status = hgad.hgad_status;
+	*action = HSMA_NONE;
+	*status = ARS_WAITING;
+	memset(extent, 0, sizeof(*extent));
+	down_read(&cdt->cdt_llog_lock);
+	/* A compatible request must be WAITING or STARTED and not a
+	 * cancel, the oldest one is reported. */
+	ca = cdt_action_find_active(cdt, fid, false);
+	if (ca != NULL) {
+		*action = ca->ca_larr->arr_hai.hai_action;
+		*extent = ca->ca_larr->arr_hai.hai_extent;
+		*status = ca->ca_larr->arr_status;
+		cookie = ca->ca_larr->arr_hai.hai_cookie;
+	}
+	up_read(&cdt->cdt_llog_lock);
 
 	if (*action == HSMA_NONE || *status != ARS_STARTED)
 		RETURN(0);
 
-	car = mdt_cdt_find_request(cdt, hgad.hgad_hai.hai_cookie);
+	car = mdt_cdt_find_request(cdt, cookie);
 	if (car != NULL) {
 		__u64 data_moved;
 
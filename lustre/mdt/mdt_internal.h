@@ -173,6 +173,17 @@ struct coordinator {
 	 * request log. */
 	struct cfs_hash		*cdt_agent_record_hash;
 
+	/* In-memory copy of the agent request log (struct cdt_action),
+	 * indexed by record location and by FID, and chained on the list
+	 * matching the record status. Protected by cdt_llog_lock. */
+	struct cfs_hash		*cdt_action_loc_hash;
+	struct cfs_hash		*cdt_action_fid_hash;
+	struct list_head	 cdt_actions_waiting;
+	struct list_head	 cdt_actions_started;
+	struct list_head	 cdt_actions_done;
+	/* a record could not be indexed, rebuild from the llog */
+	bool			 cdt_actions_incomplete;
+
 	/* Bitmasks indexed by the HSMA_XXX constants. */
 	__u64			 cdt_user_request_mask;
 	__u64			 cdt_group_request_mask;
@@ -226,6 +237,7 @@ struct mdt_device {
 				   mo_cos:1,
 				   mo_evict_tgt_nids:1,
 				   mo_dom_read_open:1,
+				   mo_dom_create_lock:1,
 				   mo_migrate_hsm_allowed:1;
 		unsigned int       mo_dom_lock;
 	} mdt_opts;
@@ -357,6 +369,8 @@ struct mdt_reint_record {
 	enum mds_reint_op		 rr_opcode;
 	const struct lustre_handle	*rr_open_handle;
 	const struct lustre_handle	*rr_lease_handle;
+	/* client EX lock on the parent, see MDS_PARENT_LOCKED */
+	const struct lustre_handle	*rr_parent_lock;
 	const struct lu_fid		*rr_fid1;
 	const struct lu_fid		*rr_fid2;
 	struct lu_name			 rr_name;
@@ -551,6 +565,19 @@ struct cdt_agent_req {
 };
 extern struct kmem_cache *mdt_hsm_car_kmem;
 
+/**
+ * In-memory copy of one record of the agent request log, see
+ * coordinator::cdt_action_loc_hash.
+ */
+struct cdt_action {
+	struct hlist_node	 ca_loc_hnode;	/**< find by llog location */
+	struct hlist_node	 ca_fid_hnode;	/**< find by FID */
+	struct list_head	 ca_list;	/**< chain on status list */
+	__u64			 ca_loc;	/**< cat_idx << 32 | rec_idx */
+	struct llog_logid	 ca_logid;	/**< plain llog of the record */
+	struct llog_agent_req_rec *ca_larr;	/**< copy of the record */
+};
+
 struct hsm_agent {
 	struct list_head ha_list;		/**< to chain the agents */
 	struct obd_uuid	 ha_uuid;		/**< agent uuid */
@@ -968,6 +995,19 @@ void cdt_agent_record_hash_add(struct coordinator *cdt, u64 cookie, u32 cat_idt,
 void cdt_agent_record_hash_lookup(struct coordinator *cdt, u64 cookie,
 				  u32 *cat_idt, u32 *rec_idx);
 void cdt_agent_record_hash_del(struct coordinator *cdt, u64 cookie);
+int cdt_action_index_init(struct coordinator *cdt);
+void cdt_action_index_fini(struct coordinator *cdt);
+int cdt_action_index_update(struct coordinator *cdt,
+			    const struct llog_logid *logid, u32 cat_idx,
+			    const struct llog_agent_req_rec *larr);
+void cdt_action_index_del(struct coordinator *cdt, u32 cat_idx, u32 rec_idx);
+int cdt_action_index_rebuild(const struct lu_env *env, struct mdt_device *mdt,
+			     llog_cb_t cb, void *data);
+int cdt_action_index_load(const struct lu_env *env, struct mdt_device *mdt);
+struct cdt_action *cdt_action_find_active(struct coordinator *cdt,
+					  const struct lu_fid *fid,
+					  bool newest);
+int cdt_action_purge(const struct lu_env *env, struct mdt_device *mdt);
 
 /* mdt/mdt_hsm_cdt_agent.c */
 extern const struct file_operations mdt_hsm_agent_fops;
@@ -1249,6 +1249,8 @@ static int mdt_create_unpack(struct mdt_thread_info *info)
 
         rr->rr_fid1 = &rec->cr_fid1;
         rr->rr_fid2 = &rec->cr_fid2;
+	if (rec->cr_bias & MDS_PARENT_LOCKED)
+		rr->rr_parent_lock = &rec->cr_open_handle_old;
         attr->la_mode = rec->cr_mode;
         attr->la_rdev  = rec->cr_rdev;
         attr->la_uid   = rec->cr_fsuid;
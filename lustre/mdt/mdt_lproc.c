@@ -951,6 +951,59 @@ mdt_dom_read_open_seq_write(struct file *file, const char __user *buffer,
 }
 LPROC_SEQ_FOPS(mdt_dom_read_open);
 
+/**
+ * Show MDT policy for DoM lock on open-create of DoM files.
+ *
+ * \param[in] m		seq_file handle
+ * \param[in] data	unused
+ *
+ * \retval		0 on success
+ * \retval		negative value on error
+ */
+static int mdt_dom_create_lock_seq_show(struct seq_file *m, void *data)
+{
+	struct obd_device *obd = m->private;
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+
+	seq_printf(m, "%u\n", !!mdt->mdt_opts.mo_dom_create_lock);
+	return 0;
+}
+
+/**
+ * Modify MDT policy for DoM lock on open-create of DoM files.
+ *
+ * If enabled then the open which creates the layout of a Data-on-MDT
+ * file for writing tries to return DoM lock in PW mode along with open
+ * reply, so the client can write file data without separate lock enqueue.
+ * It works only with mo_dom_lock enabled.
+ *
+ * \param[in] file	proc file
+ * \param[in] buffer	string which represents policy
+ * \param[in] count	\a buffer length
+ * \param[in] off	unused for single entry
+ *
+ * \retval		\a count on success
+ * \retval		negative number on error
+ */
+static ssize_t
+mdt_dom_create_lock_seq_write(struct file *file, const char __user *buffer,
+			      size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct obd_device *obd = m->private;
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+	bool val;
+	int rc;
+
+	rc = kstrtobool_from_user(buffer, count, &val);
+	if (rc)
+		return rc;
+
+	mdt->mdt_opts.mo_dom_create_lock = !!val;
+	return count;
+}
+LPROC_SEQ_FOPS(mdt_dom_create_lock);
+
 static int mdt_migrate_hsm_allowed_seq_show(struct seq_file *m, void *data)
 {
 	struct obd_device *obd = m->private;
@@ -1064,6 +1117,8 @@ static struct lprocfs_vars lprocfs_mdt_obd_vars[] = {
 	  .fops =	&mdt_dom_lock_fops			},
 	{ .name =	"dom_read_open",
 	  .fops =	&mdt_dom_read_open_fops			},
+	{ .name =	"dom_create_lock",
+	  .fops =	&mdt_dom_create_lock_fops		},
 	{ .name =	"migrate_hsm_allowed",
 	  .fops =	&mdt_migrate_hsm_allowed_fops		},
 	{ NULL }
@@ -1000,6 +1000,71 @@ out:
 	RETURN(rc);
 }
 
+/**
+ * Take DoM lock for the file which layout was created by this open.
+ *
+ * The layout of a new file is created in mdt_finish_open() after the open
+ * lock was taken, so mdt_object_open_lock() cannot know yet if the file
+ * has DoM layout. Take DoM lock now when the new layout has MDT stripe only
+ * and file is opened for write, so client can write data to it without
+ * separate lock enqueue RPC. That makes create-write-close sequence of a
+ * small DoM file just OPEN and CLOSE RPCs with data flushed later by BRW.
+ *
+ * The lock is taken in non-blocking mode after the layout lock is released,
+ * nothing is returned to the client if there is any conflict.
+ *
+ * \param[in] info	thread environment
+ * \param[in] obj	object opened
+ * \param[in] lhc	lock handle to return to the client
+ * \param[out] ibits	bits of lock granted
+ */
+static void mdt_dom_create_lock(struct mdt_thread_info *info,
+				struct mdt_object *obj,
+				struct mdt_lock_handle *lhc, __u64 *ibits)
+{
+	struct md_attr *ma = &info->mti_attr;
+	struct mdt_device *mdt = info->mti_mdt;
+	__u64 open_flags = info->mti_spec.sp_cr_flags;
+	int rc;
+
+	ENTRY;
+
+	if (!mdt->mdt_opts.mo_dom_create_lock ||
+	    mdt->mdt_opts.mo_dom_lock == NO_DOM_LOCK_ON_OPEN)
+		RETURN_EXIT;
+
+	/* open lock requested by client can't be replaced with DoM lock */
+	if (!(open_flags & MDS_FMODE_WRITE) ||
+	    open_flags & (MDS_OPEN_LOCK | MDS_OPEN_LEASE) ||
+	    req_is_replay(mdt_info_req(info)))
+		RETURN_EXIT;
+
+	/* layout was not created by this open or the lock is granted already */
+	if (!lustre_handle_is_used(&info->mti_lh[MDT_LH_LAYOUT].mlh_reg_lh) ||
+	    lustre_handle_is_used(&lhc->mlh_reg_lh))
+		RETURN_EXIT;
+
+	if (!(ma->ma_valid & MA_LOV) || ma->ma_lmm == NULL ||
+	    mdt_lmm_dom_entry(ma->ma_lmm) != LMM_DOM_ONLY)
+		RETURN_EXIT;
+
+	/* The layout is created, release the EX layout lock now instead of
+	 * in mdt_object_open_unlock(): two inodebits locks must never be
+	 * taken on the same resource at once (LU-3601). */
+	mdt_object_unlock(info, obj, &info->mti_lh[MDT_LH_LAYOUT], 1);
+
+	*ibits = 0;
+	mdt_lock_handle_init(lhc);
+	mdt_lock_reg_init(lhc, LCK_PW);
+	rc = mdt_object_lock_try(info, obj, lhc, ibits, MDS_INODELOCK_DOM,
+				 false);
+
+	CDEBUG(D_INODE, "%s: DoM lock on create "DFID", ibits = %#llx: "
+	       "rc = %d\n", mdt_obd_name(mdt), PFID(mdt_object_fid(obj)),
+	       *ibits, rc);
+	EXIT;
+}
+
 static void mdt_object_open_unlock(struct mdt_thread_info *info,
 				   struct mdt_object *obj,
 				   struct mdt_lock_handle *lhc,
@@ -1068,6 +1133,31 @@ static bool mdt_hsm_release_allow(const struct md_attr *ma)
 	return true;
 }
 
+/**
+ * Request the open lock for MDS_OPEN_RO_LOCK if \a obj is a regular file.
+ *
+ * A read-only open asks for the open lock before the client knows the type
+ * of the file, so it is decided here once the object is found.
+ *
+ * \retval open flags of the request
+ */
+static u64 mdt_open_ro_lock(struct mdt_thread_info *info,
+			    struct mdt_object *obj)
+{
+	u64 *open_flags = &info->mti_spec.sp_cr_flags;
+
+	if (!(*open_flags & MDS_OPEN_RO_LOCK))
+		return *open_flags;
+
+	*open_flags &= ~MDS_OPEN_RO_LOCK;
+	if (S_ISREG(lu_object_attr(&obj->mot_obj)) &&
+	    !(*open_flags & (MDS_FMODE_WRITE | MDS_FMODE_EXEC |
+			     MDS_OPEN_LEASE | MDS_OPEN_CREAT)))
+		*open_flags |= MDS_OPEN_LOCK;
+
+	return *open_flags;
+}
+
 static int mdt_open_by_fid_lock(struct mdt_thread_info *info,
 				struct ldlm_reply *rep,
 				struct mdt_lock_handle *lhc)
@@ -1135,6 +1225,8 @@ static int mdt_open_by_fid_lock(struct mdt_thread_info *info,
 	if (open_flags & MDS_OPEN_RELEASE && !mdt_hsm_release_allow(ma))
 		GOTO(out, rc = -EPERM);
 
+	open_flags = mdt_open_ro_lock(info, o);
+
 	rc = mdt_check_resent_lock(info, o, lhc);
 	if (rc < 0) {
 		GOTO(out, rc);
@@ -1575,6 +1667,8 @@ again:
 		}
         }
 
+	open_flags = mdt_open_ro_lock(info, child);
+
 	rc = mdt_check_resent_lock(info, child, lhc);
 	if (rc < 0) {
 		GOTO(out_child, result = rc);
@@ -1599,6 +1693,8 @@ again:
 	/* Try to open it now. */
 	rc = mdt_finish_open(info, parent, child, open_flags,
 			     created, ldlm_rep);
+	if (rc == 0 && object_locked)
+		mdt_dom_create_lock(info, child, lhc, &ibits);
 	if (rc) {
 		result = rc;
 		/* openlock will be released if mdt_finish_open() failed */
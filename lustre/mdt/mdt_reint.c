@@ -334,6 +334,46 @@ void mdt_reint_striped_unlock(struct mdt_thread_info *info,
 	mdt_object_unlock(info, o, lh, decref);
 }
 
+/**
+ * Check the parent lock sent with a create replayed from the client
+ * write-back cache. The client holds an EX UPDATE lock on @parent which
+ * nobody else can see the entries of, so the create doesn't take the parent
+ * lock, it would conflict with the client lock and wait for the client to
+ * flush the very create first.
+ *
+ * \retval true	the lock is granted to this client on @parent
+ * \retval false	no such lock, e.g. after eviction or in replay
+ */
+static bool mdt_parent_locked(struct mdt_thread_info *info,
+			      struct mdt_object *parent)
+{
+	const struct lustre_handle *lockh = info->mti_rr.rr_parent_lock;
+	struct ldlm_lock *lock;
+	bool locked = false;
+
+	if (lockh == NULL || !exp_connect_parent_locked(info->mti_exp))
+		return false;
+
+	lock = ldlm_handle2lock(lockh);
+	if (lock == NULL)
+		return false;
+
+	lock_res_and_lock(lock);
+	if (lock->l_export == info->mti_exp &&
+	    lock->l_granted_mode == LCK_EX &&
+	    lock->l_resource->lr_type == LDLM_IBITS &&
+	    lock->l_policy_data.l_inodebits.bits & MDS_INODELOCK_UPDATE &&
+	    fid_res_name_eq(mdt_object_fid(parent), &lock->l_resource->lr_name))
+		locked = true;
+	unlock_res_and_lock(lock);
+	/* the client flushes its creates before it cancels the lock */
+	if (locked && ldlm_is_ast_sent(lock))
+		ldlm_refresh_waiting_lock(lock, ldlm_bl_timeout(lock));
+	LDLM_LOCK_PUT(lock);
+
+	return locked;
+}
+
 /*
  * VBR: we save three versions in reply:
  * 0 - parent. Check that parent version is the same during replay.
@@ -400,9 +440,11 @@ static int mdt_create(struct mdt_thread_info *info)
 
 	lh = &info->mti_lh[MDT_LH_PARENT];
 	mdt_lock_pdo_init(lh, LCK_PW, &rr->rr_name);
-	rc = mdt_object_lock(info, parent, lh, MDS_INODELOCK_UPDATE);
-	if (rc)
-		GOTO(put_parent, rc);
+	if (!mdt_parent_locked(info, parent)) {
+		rc = mdt_object_lock(info, parent, lh, MDS_INODELOCK_UPDATE);
+		if (rc)
+			GOTO(put_parent, rc);
+	}
 
 	if (!mdt_object_remote(parent)) {
 		rc = mdt_version_get_check_save(info, parent, 0);
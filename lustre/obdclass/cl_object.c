@@ -480,14 +480,15 @@ static void cl_env_percpu_refill(void);
  */
 int cl_site_init(struct cl_site *s, struct cl_device *d)
 {
-	size_t i;
-        int result;
+	int result;
 
-        result = lu_site_init(&s->cs_lu, &d->cd_lu_dev);
-        if (result == 0) {
-                cache_stats_init(&s->cs_pages, "pages");
-                for (i = 0; i < ARRAY_SIZE(s->cs_pages_state); ++i)
-			atomic_set(&s->cs_pages_state[0], 0);
+	result = lu_site_init(&s->cs_lu, &d->cd_lu_dev);
+	if (result == 0) {
+		s->cs_pages = alloc_percpu(struct cl_site_page_stats);
+		if (s->cs_pages == NULL) {
+			lu_site_fini(&s->cs_lu);
+			return -ENOMEM;
+		}
 		cl_env_percpu_refill();
 	}
 	return result;
@@ -499,7 +500,9 @@ EXPORT_SYMBOL(cl_site_init);
  */
 void cl_site_fini(struct cl_site *s)
 {
-        lu_site_fini(&s->cs_lu);
+	lu_site_fini(&s->cs_lu);
+	free_percpu(s->cs_pages);
+	s->cs_pages = NULL;
 }
 EXPORT_SYMBOL(cl_site_fini);
 
@@ -521,7 +524,24 @@ int cl_site_stats_print(const struct cl_site *site, struct seq_file *m)
 		[CPS_PAGEIN]	= "r",
 		[CPS_FREEING]	= "f"
 	};
+	struct cl_site_page_stats stats = { { 0 } };
+	struct cache_stats pages;
 	size_t i;
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		struct cl_site_page_stats *cps;
+
+		cps = per_cpu_ptr(site->cs_pages, cpu);
+		for (i = 0; i < ARRAY_SIZE(stats.cps_stats); ++i)
+			stats.cps_stats[i] += cps->cps_stats[i];
+		for (i = 0; i < ARRAY_SIZE(stats.cps_state); ++i)
+			stats.cps_state[i] += cps->cps_state[i];
+	}
+
+	cache_stats_init(&pages, "pages");
+	for (i = 0; i < ARRAY_SIZE(stats.cps_stats); ++i)
+		atomic_set(&pages.cs_stats[i], stats.cps_stats[i]);
 
 /*
        lookup    hit  total   busy create
@@ -530,11 +550,10 @@ locks: ...... ...... ...... ...... ...... [...... ...... ...... ...... ......]
   env: ...... ...... ...... ...... ......
  */
 	lu_site_stats_seq_print(&site->cs_lu, m);
-	cache_stats_print(&site->cs_pages, m, 1);
+	cache_stats_print(&pages, m, 1);
 	seq_printf(m, " [");
-	for (i = 0; i < ARRAY_SIZE(site->cs_pages_state); ++i)
-		seq_printf(m, "%s: %u ", pstate[i],
-			   atomic_read(&site->cs_pages_state[i]));
+	for (i = 0; i < ARRAY_SIZE(stats.cps_state); ++i)
+		seq_printf(m, "%s: %ld ", pstate[i], stats.cps_state[i]);
 	seq_printf(m, "]\n");
 	cache_stats_print(&cl_env_stats, m, 0);
 	seq_printf(m, "\n");
@@ -1098,6 +1117,7 @@ void cl_global_fini(void)
 	cl_io_engine = NULL;
 	cl_env_percpu_fini();
 	lu_context_key_degister(&cl_key);
+	cl_page_kmem_fini();
 	lu_kmem_fini(cl_object_caches);
 	OBD_FREE(cl_envs, sizeof(*cl_envs) * num_possible_cpus());
 }
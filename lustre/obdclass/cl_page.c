@@ -41,6 +41,7 @@
 #include <libcfs/libcfs.h>
 #include <obd_class.h>
 #include <obd_support.h>
+#include <lustre_compat.h>
 
 #include <cl_object.h>
 #include "cl_internal.h"
@@ -73,37 +74,126 @@ static void cl_page_delete0(const struct lu_env *env, struct cl_page *pg);
 	 ((void)sizeof(env), (void)sizeof(page), (void)sizeof !!(exp))
 #endif /* !CONFIG_LUSTRE_DEBUG_EXPENSIVE_CHECK */
 
-/* Disable page statistic by default due to huge performance penalty. */
+/* Page statistics are per-cpu, so they are cheap enough to be always on. */
 static void cs_page_inc(const struct cl_object *obj,
 			enum cache_stats_item item)
 {
-#ifdef CONFIG_DEBUG_PAGESTATE_TRACKING
-	atomic_inc(&cl_object_site(obj)->cs_pages.cs_stats[item]);
-#endif
+	this_cpu_inc(cl_object_site(obj)->cs_pages->cps_stats[item]);
 }
 
 static void cs_page_dec(const struct cl_object *obj,
 			enum cache_stats_item item)
 {
-#ifdef CONFIG_DEBUG_PAGESTATE_TRACKING
-	atomic_dec(&cl_object_site(obj)->cs_pages.cs_stats[item]);
-#endif
+	this_cpu_dec(cl_object_site(obj)->cs_pages->cps_stats[item]);
 }
 
 static void cs_pagestate_inc(const struct cl_object *obj,
 			     enum cl_page_state state)
 {
-#ifdef CONFIG_DEBUG_PAGESTATE_TRACKING
-	atomic_inc(&cl_object_site(obj)->cs_pages_state[state]);
-#endif
+	this_cpu_inc(cl_object_site(obj)->cs_pages->cps_state[state]);
 }
 
 static void cs_pagestate_dec(const struct cl_object *obj,
 			      enum cl_page_state state)
 {
-#ifdef CONFIG_DEBUG_PAGESTATE_TRACKING
-	atomic_dec(&cl_object_site(obj)->cs_pages_state[state]);
-#endif
+	this_cpu_dec(cl_object_site(obj)->cs_pages->cps_state[state]);
+}
+
+/*
+ * cl_page buffers are allocated from slab caches, one per buffer size of a
+ * layer stack (cl_object_header::coh_page_bufsize), instead of the generic
+ * kmalloc size classes. This keeps allocations and frees of the pages of a
+ * large RPC on per-cpu slab freelists of an exactly sized cache. There are
+ * only a few different stacks, so the arrays are short.
+ *
+ * The caches are not merged with other caches of the same size, so that
+ * cl_page buffers are accounted on their own in slabinfo. Kernels without
+ * SLAB_NO_MERGE may merge them, which is fine: allocations still come from
+ * a cache of the exact size, only the accounting is shared.
+ */
+#define CL_PAGE_KMEM_NR		16
+static DEFINE_MUTEX(cl_page_kmem_mutex);
+static struct kmem_cache *cl_page_kmem_array[CL_PAGE_KMEM_NR];
+static unsigned short cl_page_kmem_size_array[CL_PAGE_KMEM_NR];
+static char cl_page_kmem_name_array[CL_PAGE_KMEM_NR][32];
+
+/**
+ * Returns slab cache for cl_page buffers of \a bufsize bytes, or NULL if it
+ * has not been created.
+ */
+static struct kmem_cache *cl_page_kmem_find(unsigned short bufsize)
+{
+	int i;
+
+	for (i = 0; i < CL_PAGE_KMEM_NR; i++) {
+		unsigned short size = cl_page_kmem_size_array[i];
+
+		if (size == bufsize) {
+			/* pairs with smp_wmb() in cl_page_kmem_get() */
+			smp_rmb();
+			return cl_page_kmem_array[i];
+		}
+		if (size == 0)
+			break;
+	}
+
+	return NULL;
+}
+
+/**
+ * Returns slab cache for cl_page buffers of \a bufsize bytes, creating it
+ * if needed. NULL is returned if all slots are used, and buffers are
+ * allocated by kmalloc then.
+ */
+static struct kmem_cache *cl_page_kmem_get(unsigned short bufsize)
+{
+	struct kmem_cache *kmem;
+	int i;
+
+	kmem = cl_page_kmem_find(bufsize);
+	if (likely(kmem != NULL))
+		return kmem;
+
+	mutex_lock(&cl_page_kmem_mutex);
+	for (i = 0; i < CL_PAGE_KMEM_NR; i++) {
+		if (cl_page_kmem_size_array[i] == bufsize) {
+			kmem = cl_page_kmem_array[i];
+			break;
+		}
+		if (cl_page_kmem_size_array[i] != 0)
+			continue;
+
+		snprintf(cl_page_kmem_name_array[i],
+			 sizeof(cl_page_kmem_name_array[i]),
+			 "cl_page_kmem-%u", bufsize);
+		kmem = kmem_cache_create(cl_page_kmem_name_array[i], bufsize,
+					 0, SLAB_NO_MERGE, NULL);
+		if (kmem != NULL) {
+			cl_page_kmem_array[i] = kmem;
+			smp_wmb();
+			cl_page_kmem_size_array[i] = bufsize;
+		}
+		break;
+	}
+	mutex_unlock(&cl_page_kmem_mutex);
+
+	return kmem;
+}
+
+/**
+ * Destroys slab caches of cl_page buffers, called on module unload.
+ */
+void cl_page_kmem_fini(void)
+{
+	int i;
+
+	for (i = 0; i < CL_PAGE_KMEM_NR; i++) {
+		if (cl_page_kmem_array[i] == NULL)
+			break;
+		kmem_cache_destroy(cl_page_kmem_array[i]);
+		cl_page_kmem_array[i] = NULL;
+		cl_page_kmem_size_array[i] = 0;
+	}
 }
 
 /**
@@ -146,7 +236,7 @@ static void cl_page_free(const struct lu_env *env, struct cl_page *page,
 			 struct pagevec *pvec)
 {
 	struct cl_object *obj  = page->cp_obj;
-	int pagesize = cl_object_header(obj)->coh_page_bufsize;
+	unsigned short pagesize = cl_object_header(obj)->coh_page_bufsize;
 
 	PASSERT(env, page, list_empty(&page->cp_batch));
 	PASSERT(env, page, page->cp_owner == NULL);
@@ -167,7 +257,10 @@ static void cl_page_free(const struct lu_env *env, struct cl_page *page,
 	lu_object_ref_del_at(&obj->co_lu, &page->cp_obj_ref, "cl_page", page);
 	cl_object_put(env, obj);
 	lu_ref_fini(&page->cp_reference);
-	OBD_FREE(page, pagesize);
+	if (page->cp_kmem != NULL)
+		OBD_SLAB_FREE(page, page->cp_kmem, pagesize);
+	else
+		OBD_FREE(page, pagesize);
 	EXIT;
 }
 
@@ -188,19 +281,29 @@ struct cl_page *cl_page_alloc(const struct lu_env *env,
 {
 	struct cl_page          *page;
 	struct lu_object_header *head;
+	unsigned short bufsize = cl_object_header(o)->coh_page_bufsize;
+	struct kmem_cache *kmem;
 
 	ENTRY;
-	OBD_ALLOC_GFP(page, cl_object_header(o)->coh_page_bufsize,
-			GFP_NOFS);
+	kmem = cl_page_kmem_get(bufsize);
+	if (kmem != NULL)
+		OBD_SLAB_ALLOC_GFP(page, kmem, bufsize, GFP_NOFS);
+	else
+		OBD_ALLOC_GFP(page, bufsize, GFP_NOFS);
 	if (page != NULL) {
 		int result = 0;
 		atomic_set(&page->cp_ref, 1);
+		page->cp_kmem = kmem;
 		page->cp_obj = o;
 		cl_object_get(o);
 		lu_object_ref_add_at(&o->co_lu, &page->cp_obj_ref, "cl_page",
 				     page);
 		page->cp_vmpage = vmpage;
 		cl_page_state_set_trust(page, CPS_CACHED);
+		/* accounted here as cl_page_free() is dual for failures too */
+		cs_page_inc(o, CS_total);
+		cs_page_inc(o, CS_create);
+		cs_pagestate_inc(o, CPS_CACHED);
 		page->cp_type = type;
 		INIT_LIST_HEAD(&page->cp_layers);
 		INIT_LIST_HEAD(&page->cp_batch);
@@ -219,11 +322,6 @@ struct cl_page *cl_page_alloc(const struct lu_env *env,
 				}
 			}
 		}
-		if (result == 0) {
-			cs_page_inc(o, CS_total);
-			cs_page_inc(o, CS_create);
-			cs_pagestate_dec(o, CPS_CACHED);
-		}
 	} else {
 		page = ERR_PTR(-ENOMEM);
 	}
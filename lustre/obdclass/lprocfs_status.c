@@ -782,6 +782,17 @@ static const char *obd_connect_names[] = {
 	"wbc",		/* 0x40 */
 	"lock_convert",  /* 0x80 */
 	"archive_id_array",	/* 0x100 */
+	"unknown", "unknown", "unknown", "unknown",	/* 0x200 - 0x1000 */
+	"unknown", "unknown", "unknown", "unknown",	/* 0x2000 - 0x10000 */
+	"unknown", "unknown", "unknown", "unknown",	/* 0x20000 - 0x100000 */
+	"unknown", "unknown", "unknown", "unknown",	/* 0x200000 - 0x1000000 */
+	"unknown", "unknown", "unknown", "unknown",	/* 0x2000000 - 0x10000000 */
+	"unknown", "unknown", "unknown", "unknown",	/* 0x20000000 - 0x100000000 */
+	"unknown", "unknown", "unknown", "unknown",	/* 0x200000000 - 0x1000000000 */
+	"unknown", "unknown", "unknown", "unknown",	/* 0x2000000000 - 0x10000000000 */
+	"unknown", "unknown", "unknown",	/* 0x20000000000 - 0x80000000000 */
+	"multiobj_brw",	/* 0x100000000000 */
+	"parent_locked",	/* 0x200000000000 */
 	NULL
 };
 
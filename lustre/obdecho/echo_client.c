@@ -212,7 +212,8 @@ static inline struct obd_device *emd2obd_dev(struct echo_md_device *d)
 
 static int cl_echo_object_put(struct echo_object *eco);
 static int cl_echo_object_brw(struct echo_object *eco, int rw, u64 offset,
-			      struct page **pages, int npages, int async);
+			      struct page **pages, int npages, int async,
+			      bool noio);
 
 struct echo_thread_info {
 	struct echo_object_conf eti_conf;
@@ -1275,8 +1276,14 @@ static void echo_commit_callback(const struct lu_env *env, struct cl_io *io,
 	cl_page_list_add(&queue->c2_qout, page);
 }
 
+/*
+ * Transfers \a npages at \a offset through the client stack. With \a noio
+ * the cl_pages are only set up and released without transfer, to measure
+ * the cost of page descriptor handling.
+ */
 static int cl_echo_object_brw(struct echo_object *eco, int rw, u64 offset,
-			      struct page **pages, int npages, int async)
+			      struct page **pages, int npages, int async,
+			      bool noio)
 {
         struct lu_env           *env;
         struct echo_thread_info *info;
@@ -1345,7 +1352,7 @@ static int cl_echo_object_brw(struct echo_object *eco, int rw, u64 offset,
                 offset += page_size;
         }
 
-        if (rc == 0) {
+        if (rc == 0 && !noio) {
                 enum cl_req_type typ = rw == READ ? CRT_READ : CRT_WRITE;
 
                 async = async && (typ == CRT_WRITE);
@@ -2479,7 +2486,7 @@ echo_client_page_debug_check(struct page *page, u64 id, u64 offset, u64 count)
 
 static int echo_client_kbrw(struct echo_device *ed, int rw, struct obdo *oa,
 			    struct echo_object *eco, u64 offset,
-			    u64 count, int async)
+			    u64 count, int async, bool noio)
 {
 	size_t			npages;
         struct brw_page        *pga;
@@ -2544,11 +2551,11 @@ static int echo_client_kbrw(struct echo_device *ed, int rw, struct obdo *oa,
 
         /* brw mode can only be used at client */
         LASSERT(ed->ed_next != NULL);
-        rc = cl_echo_object_brw(eco, rw, offset, pages, npages, async);
+	rc = cl_echo_object_brw(eco, rw, offset, pages, npages, async, noio);
 
  out:
-        if (rc != 0 || rw != OBD_BRW_READ)
-                verify = 0;
+	if (rc != 0 || rw != OBD_BRW_READ || noio)
+		verify = 0;
 
         for (i = 0, pgp = pga; i < npages; i++, pgp++) {
                 if (pgp->pg == NULL)
@@ -2702,7 +2709,12 @@ static int echo_client_brw_ioctl(const struct lu_env *env, int rw,
                 /* fall through */
         case 2:
 		rc = echo_client_kbrw(ed, rw, oa, eco, data->ioc_offset,
-				      data->ioc_count, async);
+				      data->ioc_count, async, false);
+		break;
+	case 4:
+		/* cl_page setup and release only, no transfer */
+		rc = echo_client_kbrw(ed, rw, oa, eco, data->ioc_offset,
+				      data->ioc_count, 0, true);
 		break;
 	case 3:
 		rc = echo_client_prep_commit(env, ec->ec_exp, rw, oa, eco,
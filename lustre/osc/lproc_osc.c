@@ -587,6 +587,43 @@ static ssize_t destroys_in_flight_show(struct kobject *kobj,
 }
 LUSTRE_RO_ATTR(destroys_in_flight);
 
+static ssize_t max_objs_per_rpc_show(struct kobject *kobj,
+				     struct attribute *attr,
+				     char *buf)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+
+	return sprintf(buf, "%u\n", obd->u.cli.cl_max_objs_per_rpc);
+}
+
+static ssize_t max_objs_per_rpc_store(struct kobject *kobj,
+				      struct attribute *attr,
+				      const char *buffer,
+				      size_t count)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct client_obd *cli = &obd->u.cli;
+	unsigned int val;
+	int rc;
+
+	rc = kstrtouint(buffer, 0, &val);
+	if (rc)
+		return rc;
+
+	/* 1 disables packing several objects into one write RPC */
+	if (val == 0 || val > PTLRPC_MAX_BRW_OBJS)
+		return -ERANGE;
+
+	spin_lock(&cli->cl_loi_list_lock);
+	cli->cl_max_objs_per_rpc = val;
+	spin_unlock(&cli->cl_loi_list_lock);
+
+	return count;
+}
+LUSTRE_RW_ATTR(max_objs_per_rpc);
+
 LPROC_SEQ_FOPS_RW_TYPE(osc, obd_max_pages_per_rpc);
 
 LUSTRE_RW_ATTR(short_io_bytes);
@@ -875,6 +912,24 @@ static int osc_rpc_stats_seq_show(struct seq_file *seq, void *v)
                         break;
         }
 
+	seq_printf(seq, "\n\t\t\tread\t\t\twrite\n");
+	seq_printf(seq, "objects per rpc       rpcs   %% cum %% |");
+	seq_printf(seq, "       rpcs   %% cum %%\n");
+
+	write_tot = lprocfs_oh_sum(&cli->cl_write_obj_hist);
+
+	write_cum = 0;
+	for (i = 1; i < OBD_HIST_MAX; i++) {
+		unsigned long w = cli->cl_write_obj_hist.oh_buckets[i];
+
+		write_cum += w;
+		seq_printf(seq, "%d:\t\t%10lu %3lu %3lu   | %10lu %3lu %3lu\n",
+			   i, 0UL, 0UL, 0UL, w, pct(w, write_tot),
+			   pct(write_cum, write_tot));
+		if (write_cum == write_tot)
+			break;
+	}
+
 	spin_unlock(&cli->cl_loi_list_lock);
 
         return 0;
@@ -895,11 +950,72 @@ static ssize_t osc_rpc_stats_seq_write(struct file *file,
         lprocfs_oh_clear(&cli->cl_write_page_hist);
         lprocfs_oh_clear(&cli->cl_read_offset_hist);
         lprocfs_oh_clear(&cli->cl_write_offset_hist);
+	lprocfs_oh_clear(&cli->cl_write_obj_hist);
 
         return len;
 }
 LPROC_SEQ_FOPS(osc_rpc_stats);
 
+#define pct(a, b) (b ? a * 100 / b : 0)
+
+static int osc_lru_shrink_stats_seq_show(struct seq_file *seq, void *v)
+{
+	struct timespec64 now;
+	struct obd_device *dev = seq->private;
+	struct client_obd *cli = &dev->u.cli;
+	struct obd_histogram *shrink = &cli->cl_lru_shrink_hist;
+	struct obd_histogram *reclaim = &cli->cl_lru_reclaim_hist;
+	unsigned long shrink_tot, reclaim_tot, shrink_cum, reclaim_cum;
+	int i;
+
+	ktime_get_real_ts64(&now);
+
+	seq_printf(seq, "snapshot_time:         %lld.%09lu (secs.nsecs)\n",
+		   (s64)now.tv_sec, now.tv_nsec);
+	seq_printf(seq, "lru pages:            %ld\n",
+		   atomic_long_read(&cli->cl_lru_in_list));
+	seq_printf(seq, "\n\t\t\tshrink\t\t\treclaim\n");
+	seq_printf(seq, "usecs              shrinks   %% cum %% |");
+	seq_printf(seq, "    reclaims   %% cum %%\n");
+
+	shrink_tot = lprocfs_oh_sum(shrink);
+	reclaim_tot = lprocfs_oh_sum(reclaim);
+
+	shrink_cum = 0;
+	reclaim_cum = 0;
+	for (i = 0; i < OBD_HIST_MAX; i++) {
+		unsigned long s = shrink->oh_buckets[i];
+		unsigned long r = reclaim->oh_buckets[i];
+
+		shrink_cum += s;
+		reclaim_cum += r;
+		seq_printf(seq, "%d:\t\t%10lu %3lu %3lu   | %10lu %3lu %3lu\n",
+			   1 << i, s, pct(s, shrink_tot),
+			   pct(shrink_cum, shrink_tot), r,
+			   pct(r, reclaim_tot), pct(reclaim_cum, reclaim_tot));
+		if (shrink_cum == shrink_tot && reclaim_cum == reclaim_tot)
+			break;
+	}
+
+	return 0;
+}
+#undef pct
+
+static ssize_t osc_lru_shrink_stats_seq_write(struct file *file,
+					      const char __user *buf,
+					      size_t len, loff_t *off)
+{
+	struct seq_file *seq = file->private_data;
+	struct obd_device *dev = seq->private;
+	struct client_obd *cli = &dev->u.cli;
+
+	lprocfs_oh_clear(&cli->cl_lru_shrink_hist);
+	lprocfs_oh_clear(&cli->cl_lru_reclaim_hist);
+
+	return len;
+}
+LPROC_SEQ_FOPS(osc_lru_shrink_stats);
+
 static int osc_stats_seq_show(struct seq_file *seq, void *v)
 {
 	struct timespec64 now;
@@ -942,6 +1058,9 @@ int lprocfs_osc_attach_seqstat(struct obd_device *dev)
 	if (rc == 0)
 		rc = lprocfs_obd_seq_create(dev, "rpc_stats", 0644,
 					    &osc_rpc_stats_fops, dev);
+	if (rc == 0)
+		rc = lprocfs_obd_seq_create(dev, "lru_shrink_stats", 0644,
+					    &osc_lru_shrink_stats_fops, dev);
 
 	return rc;
 }
@@ -959,6 +1078,7 @@ static struct attribute *osc_attrs[] = {
 	&lustre_attr_lockless_truncate.attr,
 	&lustre_attr_max_dirty_mb.attr,
 	&lustre_attr_max_rpcs_in_flight.attr,
+	&lustre_attr_max_objs_per_rpc.attr,
 	&lustre_attr_short_io_bytes.attr,
 	&lustre_attr_resend_count.attr,
 	&lustre_attr_ost_conn_uuid.attr,
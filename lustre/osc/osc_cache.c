@@ -2035,38 +2035,31 @@ static inline unsigned osc_max_write_chunks(const struct client_obd *cli)
  * 6. Above steps exit if there is no space in this RPC.
  */
 static unsigned int get_write_extents(struct osc_object *obj,
-				      struct list_head *rpclist)
+				      struct extent_rpc_data *data)
 {
 	struct client_obd *cli = osc_cli(obj);
 	struct osc_extent *ext;
-	struct extent_rpc_data data = {
-		.erd_rpc_list	= rpclist,
-		.erd_page_count	= 0,
-		.erd_max_pages	= cli->cl_max_pages_per_rpc,
-		.erd_max_chunks	= osc_max_write_chunks(cli),
-		.erd_max_extents = 256,
-	};
 
 	LASSERT(osc_object_is_locked(obj));
 	while (!list_empty(&obj->oo_hp_exts)) {
 		ext = list_entry(obj->oo_hp_exts.next, struct osc_extent,
 				 oe_link);
 		LASSERT(ext->oe_state == OES_CACHE);
-		if (!try_to_add_extent_for_io(cli, ext, &data))
-			return data.erd_page_count;
-		EASSERT(ext->oe_nr_pages <= data.erd_max_pages, ext);
+		if (!try_to_add_extent_for_io(cli, ext, data))
+			return data->erd_page_count;
+		EASSERT(ext->oe_nr_pages <= data->erd_max_pages, ext);
 	}
-	if (data.erd_page_count == data.erd_max_pages)
-		return data.erd_page_count;
+	if (data->erd_page_count == data->erd_max_pages)
+		return data->erd_page_count;
 
 	while (!list_empty(&obj->oo_urgent_exts)) {
 		ext = list_entry(obj->oo_urgent_exts.next,
 				 struct osc_extent, oe_link);
-		if (!try_to_add_extent_for_io(cli, ext, &data))
-			return data.erd_page_count;
+		if (!try_to_add_extent_for_io(cli, ext, data))
+			return data->erd_page_count;
 	}
-	if (data.erd_page_count == data.erd_max_pages)
-		return data.erd_page_count;
+	if (data->erd_page_count == data->erd_max_pages)
+		return data->erd_page_count;
 
 	/* One key difference between full extents and other extents: full
 	 * extents can usually only be added if the rpclist was empty, so if we
@@ -2076,11 +2069,11 @@ static unsigned int get_write_extents(struct osc_object *obj,
 	while (!list_empty(&obj->oo_full_exts)) {
 		ext = list_entry(obj->oo_full_exts.next,
 				 struct osc_extent, oe_link);
-		if (!try_to_add_extent_for_io(cli, ext, &data))
+		if (!try_to_add_extent_for_io(cli, ext, data))
 			break;
 	}
-	if (data.erd_page_count == data.erd_max_pages)
-		return data.erd_page_count;
+	if (data->erd_page_count == data->erd_max_pages)
+		return data->erd_page_count;
 
 	ext = first_extent(obj);
 	while (ext != NULL) {
@@ -2091,12 +2084,97 @@ static unsigned int get_write_extents(struct osc_object *obj,
 			continue;
 		}
 
-		if (!try_to_add_extent_for_io(cli, ext, &data))
-			return data.erd_page_count;
+		if (!try_to_add_extent_for_io(cli, ext, data))
+			return data->erd_page_count;
 
 		ext = next_extent(ext);
 	}
-	return data.erd_page_count;
+	return data->erd_page_count;
+}
+
+/**
+ * Move the write extents of \a osc which fit into the RPC described by
+ * \a data to its list, and mark them as being sent.
+ *
+ * \return the number of pages added to the RPC
+ */
+static unsigned int take_write_extents(struct osc_object *osc,
+				       struct extent_rpc_data *data)
+__must_hold(osc)
+{
+	struct osc_extent *ext;
+	unsigned int page_count = data->erd_page_count;
+
+	page_count = get_write_extents(osc, data) - page_count;
+	if (page_count == 0)
+		return 0;
+
+	osc_update_pending(osc, OBD_BRW_WRITE, -page_count);
+
+	list_for_each_entry(ext, data->erd_rpc_list, oe_link) {
+		if (ext->oe_obj != osc)
+			continue;
+		LASSERT(ext->oe_state == OES_CACHE ||
+			ext->oe_state == OES_LOCK_DONE);
+		if (ext->oe_state == OES_CACHE)
+			osc_extent_state_set(ext, OES_LOCKING);
+		else
+			osc_extent_state_set(ext, OES_RPC);
+	}
+	return page_count;
+}
+
+#define list_to_obj(list, item) ({					      \
+	struct list_head *__tmp = (list)->next;				      \
+	list_del_init(__tmp);					      \
+	list_entry(__tmp, struct osc_object, oo_##item);		      \
+})
+
+/**
+ * Add the write extents of other objects of \a cli which are ready for IO
+ * to the RPC described by \a data, so that small writes to many objects
+ * are sent in a single RPC. Only objects on the ready list are picked, the
+ * ones waiting for a blocked lock are left to be flushed on their own.
+ *
+ * \return the number of objects added to the RPC
+ */
+static int take_write_extents_buddies(const struct lu_env *env,
+				      struct client_obd *cli,
+				      struct osc_object *osc,
+				      struct extent_rpc_data *data)
+{
+	struct osc_object *buddy;
+	unsigned int page_count;
+	int nobjs = 1;
+
+	while (nobjs < cli->cl_max_objs_per_rpc &&
+	       data->erd_page_count < data->erd_max_pages &&
+	       data->erd_max_extents > 0) {
+		spin_lock(&cli->cl_loi_list_lock);
+		if (list_empty(&cli->cl_loi_ready_list)) {
+			spin_unlock(&cli->cl_loi_list_lock);
+			break;
+		}
+		buddy = list_to_obj(&cli->cl_loi_ready_list, ready_item);
+		cl_object_get(osc2cl(buddy));
+		spin_unlock(&cli->cl_loi_list_lock);
+
+		page_count = 0;
+		osc_object_lock(buddy);
+		if (buddy != osc && list_empty(&buddy->oo_hp_exts) &&
+		    osc_makes_rpc(cli, buddy, OBD_BRW_WRITE))
+			page_count = take_write_extents(buddy, data);
+		osc_object_unlock(buddy);
+
+		/* the pages taken keep the object alive until the RPC is
+		 * done, put it back on the lists if it has more to send */
+		osc_list_maint(cli, buddy);
+		cl_object_put(env, osc2cl(buddy));
+		if (page_count == 0)
+			break;
+		nobjs++;
+	}
+	return nobjs;
 }
 
 static int
@@ -2105,6 +2183,13 @@ osc_send_write_rpc(const struct lu_env *env, struct client_obd *cli,
 __must_hold(osc)
 {
 	struct list_head   rpclist = LIST_HEAD_INIT(rpclist);
+	struct extent_rpc_data data = {
+		.erd_rpc_list	= &rpclist,
+		.erd_page_count	= 0,
+		.erd_max_pages	= cli->cl_max_pages_per_rpc,
+		.erd_max_chunks	= osc_max_write_chunks(cli),
+		.erd_max_extents = 256,
+	};
 	struct osc_extent *ext;
 	struct osc_extent *tmp;
 	struct osc_extent *first = NULL;
@@ -2115,27 +2200,23 @@ __must_hold(osc)
 
 	LASSERT(osc_object_is_locked(osc));
 
-	page_count = get_write_extents(osc, &rpclist);
+	page_count = take_write_extents(osc, &data);
 	LASSERT(equi(page_count == 0, list_empty(&rpclist)));
 
 	if (list_empty(&rpclist))
 		RETURN(0);
 
-	osc_update_pending(osc, OBD_BRW_WRITE, -page_count);
-
-	list_for_each_entry(ext, &rpclist, oe_link) {
-		LASSERT(ext->oe_state == OES_CACHE ||
-			ext->oe_state == OES_LOCK_DONE);
-		if (ext->oe_state == OES_CACHE)
-			osc_extent_state_set(ext, OES_LOCKING);
-		else
-			osc_extent_state_set(ext, OES_RPC);
-	}
-
 	/* we're going to grab page lock, so release object lock because
 	 * lock order is page lock -> object lock. */
 	osc_object_unlock(osc);
 
+	/* fill the rest of the RPC with the writes of other objects, the
+	 * extents added must be compatible with the first one */
+	ext = list_first_entry(&rpclist, struct osc_extent, oe_link);
+	if (cli->cl_max_objs_per_rpc > 1 && !ext->oe_srvlock && !ext->oe_hp &&
+	    cli->cl_import != NULL && imp_connect_multiobj_brw(cli->cl_import))
+		take_write_extents_buddies(env, cli, osc, &data);
+
 	list_for_each_entry_safe(ext, tmp, &rpclist, oe_link) {
 		if (ext->oe_state == OES_LOCKING) {
 			rc = osc_extent_make_ready(env, ext);
@@ -2214,12 +2295,6 @@ __must_hold(osc)
 	RETURN(rc);
 }
 
-#define list_to_obj(list, item) ({					      \
-	struct list_head *__tmp = (list)->next;				      \
-	list_del_init(__tmp);					      \
-	list_entry(__tmp, struct osc_object, oo_##item);		      \
-})
-
 /* This is called by osc_check_rpcs() to find which objects have pages that
  * we could be sending.  These lists are maintained by osc_makes_rpc(). */
 static struct osc_object *osc_next_obj(struct client_obd *cli)
@@ -441,12 +441,48 @@ int lru_queue_work(const struct lu_env *env, void *data)
 	RETURN(0);
 }
 
+static inline struct cl_lru_part *osc_lru_part(struct client_obd *cli,
+					       struct osc_page *opg)
+{
+	return cli->cl_lru_parts[opg->ops_lru_cpt];
+}
+
+/**
+ * Lock the LRU part of \a opg. osc_page::ops_lru_cpt is only changed with
+ * the page off the LRU and the lock of its new part held, so once the lock
+ * of the part read here is taken and ops_lru_cpt still matches it, the
+ * page stays in that part, or off the LRU, until the lock is released.
+ */
+static struct cl_lru_part *osc_lru_part_lock(struct client_obd *cli,
+					     struct osc_page *opg)
+{
+	struct cl_lru_part *part;
+	int cpt;
+
+	for (;;) {
+		cpt = READ_ONCE(opg->ops_lru_cpt);
+		part = cli->cl_lru_parts[cpt];
+		spin_lock(&part->clp_lock);
+		if (likely(opg->ops_lru_cpt == cpt))
+			return part;
+		spin_unlock(&part->clp_lock);
+	}
+}
+
+/**
+ * Add pages of a finished transfer to the LRU part of the current CPT, so
+ * the whole batch is moved under one lock not shared with other CPTs.
+ */
 void osc_lru_add_batch(struct client_obd *cli, struct list_head *plist)
 {
-	struct list_head lru = LIST_HEAD_INIT(lru);
 	struct osc_async_page *oap;
+	struct cl_lru_part *part;
 	long npages = 0;
+	int cpt;
 
+	cpt = cfs_cpt_current(cfs_cpt_table, 1);
+	part = cli->cl_lru_parts[cpt];
+	spin_lock(&part->clp_lock);
 	list_for_each_entry(oap, plist, oap_pending_item) {
 		struct osc_page *opg = oap2osc_page(oap);
 
@@ -455,26 +491,28 @@ void osc_lru_add_batch(struct client_obd *cli, struct list_head *plist)
 
 		++npages;
 		LASSERT(list_empty(&opg->ops_lru));
-		list_add(&opg->ops_lru, &lru);
+		opg->ops_lru_cpt = cpt;
+		list_add_tail(&opg->ops_lru, &part->clp_list);
 	}
+	part->clp_nr += npages;
+	spin_unlock(&part->clp_lock);
 
 	if (npages > 0) {
-		spin_lock(&cli->cl_lru_list_lock);
-		list_splice_tail(&lru, &cli->cl_lru_list);
 		atomic_long_sub(npages, &cli->cl_lru_busy);
 		atomic_long_add(npages, &cli->cl_lru_in_list);
 		cli->cl_lru_last_used = ktime_get_real_seconds();
-		spin_unlock(&cli->cl_lru_list_lock);
 
 		if (waitqueue_active(&osc_lru_waitq))
 			(void)ptlrpcd_queue_work(cli->cl_lru_work);
 	}
 }
 
+/* Called with the lock of the LRU part of the page held. */
 static void __osc_lru_del(struct client_obd *cli, struct osc_page *opg)
 {
 	LASSERT(atomic_long_read(&cli->cl_lru_in_list) > 0);
 	list_del_init(&opg->ops_lru);
+	osc_lru_part(cli, opg)->clp_nr--;
 	atomic_long_dec(&cli->cl_lru_in_list);
 }
 
@@ -485,14 +523,15 @@ static void __osc_lru_del(struct client_obd *cli, struct osc_page *opg)
 static void osc_lru_del(struct client_obd *cli, struct osc_page *opg)
 {
 	if (opg->ops_in_lru) {
-		spin_lock(&cli->cl_lru_list_lock);
+		struct cl_lru_part *part = osc_lru_part_lock(cli, opg);
+
 		if (!list_empty(&opg->ops_lru)) {
 			__osc_lru_del(cli, opg);
 		} else {
 			LASSERT(atomic_long_read(&cli->cl_lru_busy) > 0);
 			atomic_long_dec(&cli->cl_lru_busy);
 		}
-		spin_unlock(&cli->cl_lru_list_lock);
+		spin_unlock(&part->clp_lock);
 
 		atomic_long_inc(cli->cl_lru_left);
 		/* this is a great place to release more LRU pages if
@@ -516,12 +555,13 @@ static void osc_lru_use(struct client_obd *cli, struct osc_page *opg)
 	/* If page is being transferred for the first time,
 	 * ops_lru should be empty */
 	if (opg->ops_in_lru) {
-		spin_lock(&cli->cl_lru_list_lock);
+		struct cl_lru_part *part = osc_lru_part_lock(cli, opg);
+
 		if (!list_empty(&opg->ops_lru)) {
 			__osc_lru_del(cli, opg);
 			atomic_long_inc(&cli->cl_lru_busy);
 		}
-		spin_unlock(&cli->cl_lru_list_lock);
+		spin_unlock(&part->clp_lock);
 	}
 }
 
@@ -570,6 +610,9 @@ static inline bool lru_page_busy(struct client_obd *cli, struct cl_page *page)
 
 /**
  * Drop @target of pages from LRU at most.
+ *
+ * The LRU parts of all CPTs are scanned in turn, starting from a different
+ * part each time so that pages of all parts get aged.
  */
 long osc_lru_shrink(const struct lu_env *env, struct client_obd *cli,
 		   long target, bool force)
@@ -577,11 +620,18 @@ long osc_lru_shrink(const struct lu_env *env, struct client_obd *cli,
 	struct cl_io *io;
 	struct cl_object *clobj = NULL;
 	struct cl_page **pvec;
+	struct cl_lru_part *part;
 	struct osc_page *opg;
+	ktime_t start;
 	long count = 0;
-	int maxscan = 0;
+	long maxscan = 0;
+	long partscan;
+	bool stop = false;
+	int nparts;
+	int first;
 	int index = 0;
 	int rc = 0;
+	int i;
 	ENTRY;
 
 	LASSERT(atomic_long_read(&cli->cl_lru_in_list) >= 0);
@@ -602,94 +652,116 @@ long osc_lru_shrink(const struct lu_env *env, struct client_obd *cli,
 		atomic_inc(&cli->cl_lru_shrinkers);
 	}
 
+	start = ktime_get();
 	pvec = (struct cl_page **)osc_env_info(env)->oti_pvec;
 	io = osc_env_thread_io(env);
 
-	spin_lock(&cli->cl_lru_list_lock);
 	if (force)
 		cli->cl_lru_reclaim++;
 	maxscan = min(target << 1, atomic_long_read(&cli->cl_lru_in_list));
-	while (!list_empty(&cli->cl_lru_list)) {
-		struct cl_page *page;
-		bool will_free = false;
+	nparts = cfs_percpt_number(cli->cl_lru_parts);
+	first = cli->cl_lru_part_next++ % nparts;
 
-		if (!force && atomic_read(&cli->cl_lru_shrinkers) > 1)
-			break;
+	for (i = 0; i < nparts && !stop; i++) {
+		part = cli->cl_lru_parts[(first + i) % nparts];
 
-		if (--maxscan < 0)
-			break;
-
-		opg = list_entry(cli->cl_lru_list.next, struct osc_page,
-				 ops_lru);
-		page = opg->ops_cl.cpl_page;
-		if (lru_page_busy(cli, page)) {
-			list_move_tail(&opg->ops_lru, &cli->cl_lru_list);
-			continue;
-		}
+		spin_lock(&part->clp_lock);
+		partscan = part->clp_nr;
+		while (!list_empty(&part->clp_list)) {
+			struct cl_page *page;
+			bool will_free = false;
 
-		LASSERT(page->cp_obj != NULL);
-		if (clobj != page->cp_obj) {
-			struct cl_object *tmp = page->cp_obj;
+			if (!force && atomic_read(&cli->cl_lru_shrinkers) > 1) {
+				stop = true;
+				break;
+			}
 
-			cl_object_get(tmp);
-			spin_unlock(&cli->cl_lru_list_lock);
+			if (--maxscan < 0) {
+				stop = true;
+				break;
+			}
 
-			if (clobj != NULL) {
-				discard_pagevec(env, io, pvec, index);
-				index = 0;
+			if (--partscan < 0)
+				break;
 
-				cl_io_fini(env, io);
-				cl_object_put(env, clobj);
-				clobj = NULL;
+			opg = list_entry(part->clp_list.next, struct osc_page,
+					 ops_lru);
+			page = opg->ops_cl.cpl_page;
+			if (lru_page_busy(cli, page)) {
+				list_move_tail(&opg->ops_lru, &part->clp_list);
+				continue;
 			}
 
-			clobj = tmp;
-			io->ci_obj = clobj;
-			io->ci_ignore_layout = 1;
-			rc = cl_io_init(env, io, CIT_MISC, clobj);
+			LASSERT(page->cp_obj != NULL);
+			if (clobj != page->cp_obj) {
+				struct cl_object *tmp = page->cp_obj;
 
-			spin_lock(&cli->cl_lru_list_lock);
+				cl_object_get(tmp);
+				spin_unlock(&part->clp_lock);
 
-			if (rc != 0)
-				break;
+				if (clobj != NULL) {
+					discard_pagevec(env, io, pvec, index);
+					index = 0;
 
-			++maxscan;
-			continue;
-		}
+					cl_io_fini(env, io);
+					cl_object_put(env, clobj);
+					clobj = NULL;
+				}
+
+				clobj = tmp;
+				io->ci_obj = clobj;
+				io->ci_ignore_layout = 1;
+				rc = cl_io_init(env, io, CIT_MISC, clobj);
+
+				spin_lock(&part->clp_lock);
 
-		if (cl_page_own_try(env, io, page) == 0) {
-			if (!lru_page_busy(cli, page)) {
-				/* remove it from lru list earlier to avoid
-				 * lock contention */
-				__osc_lru_del(cli, opg);
-				opg->ops_in_lru = 0; /* will be discarded */
-
-				cl_page_get(page);
-				will_free = true;
-			} else {
-				cl_page_disown(env, io, page);
+				if (rc != 0) {
+					stop = true;
+					break;
+				}
+
+				++maxscan;
+				++partscan;
+				continue;
 			}
-		}
 
-		if (!will_free) {
-			list_move_tail(&opg->ops_lru, &cli->cl_lru_list);
-			continue;
-		}
+			if (cl_page_own_try(env, io, page) == 0) {
+				if (!lru_page_busy(cli, page)) {
+					/* remove it from lru list earlier to
+					 * avoid lock contention */
+					__osc_lru_del(cli, opg);
+					opg->ops_in_lru = 0; /* will be discarded */
+
+					cl_page_get(page);
+					will_free = true;
+				} else {
+					cl_page_disown(env, io, page);
+				}
+			}
 
-		/* Don't discard and free the page with cl_lru_list held */
-		pvec[index++] = page;
-		if (unlikely(index == OTI_PVEC_SIZE)) {
-			spin_unlock(&cli->cl_lru_list_lock);
-			discard_pagevec(env, io, pvec, index);
-			index = 0;
+			if (!will_free) {
+				list_move_tail(&opg->ops_lru, &part->clp_list);
+				continue;
+			}
 
-			spin_lock(&cli->cl_lru_list_lock);
-		}
+			/* Don't discard and free the page with the LRU lock
+			 * held */
+			pvec[index++] = page;
+			if (unlikely(index == OTI_PVEC_SIZE)) {
+				spin_unlock(&part->clp_lock);
+				discard_pagevec(env, io, pvec, index);
+				index = 0;
 
-		if (++count >= target)
-			break;
+				spin_lock(&part->clp_lock);
+			}
+
+			if (++count >= target) {
+				stop = true;
+				break;
+			}
+		}
+		spin_unlock(&part->clp_lock);
 	}
-	spin_unlock(&cli->cl_lru_list_lock);
 
 	if (clobj != NULL) {
 		discard_pagevec(env, io, pvec, index);
@@ -703,6 +775,10 @@ long osc_lru_shrink(const struct lu_env *env, struct client_obd *cli,
 		atomic_long_add(count, cli->cl_lru_left);
 		wake_up_all(&osc_lru_waitq);
 	}
+
+	lprocfs_oh_tally_log2(force ? &cli->cl_lru_reclaim_hist :
+				      &cli->cl_lru_shrink_hist,
+			      ktime_us_delta(ktime_get(), start));
 	RETURN(count > 0 ? count : rc);
 }
 EXPORT_SYMBOL(osc_lru_shrink);
@@ -1100,6 +1100,13 @@ static inline int can_merge_pages(struct brw_page *p1, struct brw_page *p2)
         return (p1->off + p1->count == p2->off);
 }
 
+/* number of pages of the \a k-th object in a BRW page array */
+static inline u32 osc_brw_obj_pages(struct osc_brw_objs *objs, int k,
+				    u32 page_count)
+{
+	return objs != NULL ? objs->bo_pages[k] : page_count;
+}
+
 static int osc_checksum_bulk_t10pi(const char *obd_name, int nob,
 				   size_t pg_count, struct brw_page **pga,
 				   int opc, obd_dif_csum_fn *fn,
@@ -1276,15 +1283,20 @@ static int osc_checksum_bulk_rw(const char *obd_name,
 
 static int
 osc_brw_prep_request(int cmd, struct client_obd *cli, struct obdo *oa,
-		     u32 page_count, struct brw_page **pga,
-		     struct ptlrpc_request **reqp, int resend)
+		     struct osc_brw_objs *objs, u32 page_count,
+		     struct brw_page **pga, struct ptlrpc_request **reqp,
+		     int resend)
 {
         struct ptlrpc_request   *req;
         struct ptlrpc_bulk_desc *desc;
         struct ost_body         *body;
+	struct ost_body		*bodies = NULL;
         struct obd_ioobj        *ioobj;
         struct niobuf_remote    *niobuf;
 	int niocount, i, requested_nob, opc, rc, short_io_size = 0;
+	int nobjs = objs != NULL ? objs->bo_count : 1;
+	u32 first, last;
+	int k;
         struct osc_brw_async_args *aa;
         struct req_capsule      *pill;
         struct brw_page *pg_prev;
@@ -1309,16 +1321,23 @@ osc_brw_prep_request(int cmd, struct client_obd *cli, struct obdo *oa,
         if (req == NULL)
                 RETURN(-ENOMEM);
 
-        for (niocount = i = 1; i < page_count; i++) {
-                if (!can_merge_pages(pga[i - 1], pga[i]))
-                        niocount++;
-        }
+	/* niobufs are never merged across objects */
+	for (niocount = i = k = 0; k < nobjs; k++) {
+		last = i + osc_brw_obj_pages(objs, k, page_count);
+		for (niocount++, i++; i < last; i++) {
+			if (!can_merge_pages(pga[i - 1], pga[i]))
+				niocount++;
+		}
+	}
 
         pill = &req->rq_pill;
         req_capsule_set_size(pill, &RMF_OBD_IOOBJ, RCL_CLIENT,
-                             sizeof(*ioobj));
+			     nobjs * sizeof(*ioobj));
         req_capsule_set_size(pill, &RMF_NIOBUF_REMOTE, RCL_CLIENT,
                              niocount * sizeof(*niobuf));
+	if (opc == OST_WRITE)
+		req_capsule_set_size(pill, &RMF_OST_BODIES, RCL_CLIENT,
+				     (nobjs - 1) * sizeof(*bodies));
 
 	for (i = 0; i < page_count; i++)
 		short_io_size += pga[i]->count;
@@ -1368,6 +1387,10 @@ no_bulk:
         ioobj = req_capsule_client_get(pill, &RMF_OBD_IOOBJ);
         niobuf = req_capsule_client_get(pill, &RMF_NIOBUF_REMOTE);
         LASSERT(body != NULL && ioobj != NULL && niobuf != NULL);
+	if (nobjs > 1) {
+		bodies = req_capsule_client_get(pill, &RMF_OST_BODIES);
+		LASSERT(bodies != NULL);
+	}
 
 	lustre_set_wire_obdo(&req->rq_import->imp_connect_data, &body->oa, oa);
 
@@ -1380,18 +1403,6 @@ no_bulk:
 	body->oa.o_uid = oa->o_uid;
 	body->oa.o_gid = oa->o_gid;
 
-	obdo_to_ioobj(oa, ioobj);
-	ioobj->ioo_bufcnt = niocount;
-	/* The high bits of ioo_max_brw tells server _maximum_ number of bulks
-	 * that might be send for this request.  The actual number is decided
-	 * when the RPC is finally sent in ptlrpc_register_bulk(). It sends
-	 * "max - 1" for old client compatibility sending "0", and also so the
-	 * the actual maximum is a power-of-two number, not one less. LU-1431 */
-	if (desc != NULL)
-		ioobj_max_brw_set(ioobj, desc->bd_md_max_brw);
-	else /* short io */
-		ioobj_max_brw_set(ioobj, 0);
-
 	if (short_io_size != 0) {
 		if ((body->oa.o_valid & OBD_MD_FLFLAGS) == 0) {
 			body->oa.o_valid |= OBD_MD_FLFLAGS;
@@ -1408,53 +1419,88 @@ no_bulk:
 	}
 
 	LASSERT(page_count > 0);
-	pg_prev = pga[0];
-        for (requested_nob = i = 0; i < page_count; i++, niobuf++) {
-                struct brw_page *pg = pga[i];
-		int poff = pg->off & ~PAGE_MASK;
-
-                LASSERT(pg->count > 0);
-                /* make sure there is no gap in the middle of page array */
-		LASSERTF(page_count == 1 ||
-			 (ergo(i == 0, poff + pg->count == PAGE_SIZE) &&
-			  ergo(i > 0 && i < page_count - 1,
-			       poff == 0 && pg->count == PAGE_SIZE)   &&
-			  ergo(i == page_count - 1, poff == 0)),
-			 "i: %d/%d pg: %p off: %llu, count: %u\n",
-			 i, page_count, pg, pg->off, pg->count);
-                LASSERTF(i == 0 || pg->off > pg_prev->off,
-			 "i %d p_c %u pg %p [pri %lu ind %lu] off %llu"
-			 " prev_pg %p [pri %lu ind %lu] off %llu\n",
-                         i, page_count,
-                         pg->pg, page_private(pg->pg), pg->pg->index, pg->off,
-                         pg_prev->pg, page_private(pg_prev->pg),
-                         pg_prev->pg->index, pg_prev->off);
-                LASSERT((pga[0]->flag & OBD_BRW_SRVLOCK) ==
-                        (pg->flag & OBD_BRW_SRVLOCK));
-		if (short_io_size != 0 && opc == OST_WRITE) {
-			unsigned char *ptr = ll_kmap_atomic(pg->pg, KM_USER0);
-
-			LASSERT(short_io_size >= requested_nob + pg->count);
-			memcpy(short_io_buf + requested_nob,
-			       ptr + poff,
-			       pg->count);
-			ll_kunmap_atomic(ptr, KM_USER0);
-		} else if (short_io_size == 0) {
-			desc->bd_frag_ops->add_kiov_frag(desc, pg->pg, poff,
-							 pg->count);
+	for (requested_nob = i = k = 0; k < nobjs; k++, ioobj++) {
+		struct obdo *obj_oa = objs != NULL ? objs->bo_oa[k] : oa;
+		struct niobuf_remote *obj_niobuf = niobuf;
+
+		first = i;
+		last = i + osc_brw_obj_pages(objs, k, page_count);
+		pg_prev = pga[first];
+		for (; i < last; i++, niobuf++) {
+			struct brw_page *pg = pga[i];
+			int poff = pg->off & ~PAGE_MASK;
+
+			LASSERT(pg->count > 0);
+			/* make sure there is no gap in the middle of the
+			 * pages of an object */
+			LASSERTF(last - first == 1 ||
+				 (ergo(i == first,
+				       poff + pg->count == PAGE_SIZE) &&
+				  ergo(i > first && i < last - 1,
+				       poff == 0 && pg->count == PAGE_SIZE) &&
+				  ergo(i == last - 1, poff == 0)),
+				 "i: %d/%d pg: %p off: %llu, count: %u\n",
+				 i, page_count, pg, pg->off, pg->count);
+			LASSERTF(i == first || pg->off > pg_prev->off,
+				 "i %d p_c %u pg %p [pri %lu ind %lu] off %llu"
+				 " prev_pg %p [pri %lu ind %lu] off %llu\n",
+				 i, page_count,
+				 pg->pg, page_private(pg->pg), pg->pg->index,
+				 pg->off, pg_prev->pg, page_private(pg_prev->pg),
+				 pg_prev->pg->index, pg_prev->off);
+			LASSERT((pga[0]->flag & OBD_BRW_SRVLOCK) ==
+				(pg->flag & OBD_BRW_SRVLOCK));
+			if (short_io_size != 0 && opc == OST_WRITE) {
+				unsigned char *ptr;
+
+				ptr = ll_kmap_atomic(pg->pg, KM_USER0);
+				LASSERT(short_io_size >=
+					requested_nob + pg->count);
+				memcpy(short_io_buf + requested_nob,
+				       ptr + poff,
+				       pg->count);
+				ll_kunmap_atomic(ptr, KM_USER0);
+			} else if (short_io_size == 0) {
+				desc->bd_frag_ops->add_kiov_frag(desc, pg->pg,
+								 poff,
+								 pg->count);
+			}
+			requested_nob += pg->count;
+
+			if (i > first && can_merge_pages(pg_prev, pg)) {
+				niobuf--;
+				niobuf->rnb_len += pg->count;
+			} else {
+				niobuf->rnb_offset = pg->off;
+				niobuf->rnb_len    = pg->count;
+				niobuf->rnb_flags  = pg->flag;
+			}
+			pg_prev = pg;
 		}
-		requested_nob += pg->count;
 
-                if (i > 0 && can_merge_pages(pg_prev, pg)) {
-                        niobuf--;
-			niobuf->rnb_len += pg->count;
-		} else {
-			niobuf->rnb_offset = pg->off;
-			niobuf->rnb_len    = pg->count;
-			niobuf->rnb_flags  = pg->flag;
-                }
-                pg_prev = pg;
-        }
+		obdo_to_ioobj(obj_oa, ioobj);
+		ioobj->ioo_bufcnt = niobuf - obj_niobuf;
+		/* The high bits of ioo_max_brw tells server _maximum_ number
+		 * of bulks that might be send for this request.  The actual
+		 * number is decided when the RPC is finally sent in
+		 * ptlrpc_register_bulk(). It sends "max - 1" for old client
+		 * compatibility sending "0", and also so the the actual
+		 * maximum is a power-of-two number, not one less. LU-1431 */
+		if (desc != NULL)
+			ioobj_max_brw_set(ioobj, desc->bd_md_max_brw);
+		else /* short io */
+			ioobj_max_brw_set(ioobj, 0);
+
+		/* the other objects of a multi-object write carry their
+		 * attributes in RMF_OST_BODIES, grant and checksum are only
+		 * packed into the main body */
+		if (k > 0) {
+			lustre_set_wire_obdo(&req->rq_import->imp_connect_data,
+					     &bodies[k - 1].oa, obj_oa);
+			bodies[k - 1].oa.o_uid = obj_oa->o_uid;
+			bodies[k - 1].oa.o_gid = obj_oa->o_gid;
+		}
+	}
 
         LASSERTF((void *)(niobuf - niocount) ==
                 req_capsule_client_get(&req->rq_pill, &RMF_NIOBUF_REMOTE),
@@ -1533,6 +1579,7 @@ no_bulk:
 	CLASSERT(sizeof(*aa) <= sizeof(req->rq_async_args));
 	aa = ptlrpc_req_async_args(req);
 	aa->aa_oa = oa;
+	aa->aa_objs = objs;
 	aa->aa_requested_nob = requested_nob;
 	aa->aa_nio_count = niocount;
 	aa->aa_page_count = page_count;
@@ -1924,8 +1971,8 @@ static int osc_brw_redo_request(struct ptlrpc_request *request,
 
 	rc = osc_brw_prep_request(lustre_msg_get_opc(request->rq_reqmsg) ==
 				OST_WRITE ? OBD_BRW_WRITE : OBD_BRW_READ,
-				  aa->aa_cli, aa->aa_oa, aa->aa_page_count,
-				  aa->aa_ppga, &new_req, 1);
+				  aa->aa_cli, aa->aa_oa, aa->aa_objs,
+				  aa->aa_page_count, aa->aa_ppga, &new_req, 1);
         if (rc)
                 RETURN(rc);
 
@@ -2017,6 +2064,75 @@ static void osc_release_ppga(struct brw_page **ppga, size_t count)
         OBD_FREE(ppga, sizeof(*ppga) * count);
 }
 
+/* release the extra objects of a multi-object write, bo_oa[0] is aa_oa */
+static void osc_brw_objs_free(struct osc_brw_objs *objs)
+{
+	int k;
+
+	if (objs == NULL)
+		return;
+
+	for (k = 1; k < objs->bo_count; k++)
+		if (objs->bo_oa[k] != NULL)
+			OBD_SLAB_FREE_PTR(objs->bo_oa[k], osc_obdo_kmem);
+	OBD_FREE_PTR(objs);
+}
+
+/**
+ * Update the cached attributes of the object of page \a last, which is the
+ * last page of this object in the RPC. \a oa has the attributes returned
+ * by the server, if any.
+ */
+static void osc_brw_update_attr(const struct lu_env *env,
+				struct ptlrpc_request *req, struct obdo *oa,
+				struct osc_async_page *last)
+{
+	struct cl_attr *attr = &osc_env_info(env)->oti_attr;
+	unsigned long valid = 0;
+	struct cl_object *obj = osc2cl(last->oap_obj);
+
+	cl_object_attr_lock(obj);
+	if (oa != NULL && oa->o_valid & OBD_MD_FLBLOCKS) {
+		attr->cat_blocks = oa->o_blocks;
+		valid |= CAT_BLOCKS;
+	}
+	if (oa != NULL && oa->o_valid & OBD_MD_FLMTIME) {
+		attr->cat_mtime = oa->o_mtime;
+		valid |= CAT_MTIME;
+	}
+	if (oa != NULL && oa->o_valid & OBD_MD_FLATIME) {
+		attr->cat_atime = oa->o_atime;
+		valid |= CAT_ATIME;
+	}
+	if (oa != NULL && oa->o_valid & OBD_MD_FLCTIME) {
+		attr->cat_ctime = oa->o_ctime;
+		valid |= CAT_CTIME;
+	}
+
+	if (lustre_msg_get_opc(req->rq_reqmsg) == OST_WRITE) {
+		struct lov_oinfo *loi = cl2osc(obj)->oo_oinfo;
+		loff_t last_off = last->oap_count + last->oap_obj_off +
+			last->oap_page_off;
+
+		/* Change file size if this is an out of quota or
+		 * direct IO write and it extends the file size */
+		if (loi->loi_lvb.lvb_size < last_off) {
+			attr->cat_size = last_off;
+			valid |= CAT_SIZE;
+		}
+		/* Extend KMS if it's not a lockless write */
+		if (loi->loi_kms < last_off &&
+		    oap2osc_page(last)->ops_srvlock == 0) {
+			attr->cat_kms = last_off;
+			valid |= CAT_KMS;
+		}
+	}
+
+	if (valid != 0)
+		cl_object_attr_update(env, obj, attr, valid);
+	cl_object_attr_unlock(obj);
+}
+
 static int brw_interpret(const struct lu_env *env,
                          struct ptlrpc_request *req, void *data, int rc)
 {
@@ -2055,57 +2171,26 @@ static int brw_interpret(const struct lu_env *env,
 	}
 
 	if (rc == 0) {
-		struct obdo *oa = aa->aa_oa;
-		struct cl_attr *attr = &osc_env_info(env)->oti_attr;
-		unsigned long valid = 0;
-		struct cl_object *obj;
-		struct osc_async_page *last;
-
-		last = brw_page2oap(aa->aa_ppga[aa->aa_page_count - 1]);
-		obj = osc2cl(last->oap_obj);
-
-		cl_object_attr_lock(obj);
-		if (oa->o_valid & OBD_MD_FLBLOCKS) {
-			attr->cat_blocks = oa->o_blocks;
-			valid |= CAT_BLOCKS;
-		}
-		if (oa->o_valid & OBD_MD_FLMTIME) {
-			attr->cat_mtime = oa->o_mtime;
-			valid |= CAT_MTIME;
-		}
-		if (oa->o_valid & OBD_MD_FLATIME) {
-			attr->cat_atime = oa->o_atime;
-			valid |= CAT_ATIME;
-		}
-		if (oa->o_valid & OBD_MD_FLCTIME) {
-			attr->cat_ctime = oa->o_ctime;
-			valid |= CAT_CTIME;
-		}
-
-		if (lustre_msg_get_opc(req->rq_reqmsg) == OST_WRITE) {
-			struct lov_oinfo *loi = cl2osc(obj)->oo_oinfo;
-			loff_t last_off = last->oap_count + last->oap_obj_off +
-				last->oap_page_off;
+		u32 last = aa->aa_page_count;
+		int k;
 
-			/* Change file size if this is an out of quota or
-			 * direct IO write and it extends the file size */
-			if (loi->loi_lvb.lvb_size < last_off) {
-				attr->cat_size = last_off;
-				valid |= CAT_SIZE;
-			}
-			/* Extend KMS if it's not a lockless write */
-			if (loi->loi_kms < last_off &&
-			    oap2osc_page(last)->ops_srvlock == 0) {
-				attr->cat_kms = last_off;
-				valid |= CAT_KMS;
+		if (aa->aa_objs == NULL) {
+			osc_brw_update_attr(env, req, aa->aa_oa,
+					    brw_page2oap(aa->aa_ppga[last - 1]));
+		} else {
+			/* the reply only carries the attributes of the main
+			 * object, the others just have their size updated */
+			for (last = 0, k = 0; k < aa->aa_objs->bo_count; k++) {
+				last += aa->aa_objs->bo_pages[k];
+				osc_brw_update_attr(env, req,
+						    k == 0 ? aa->aa_oa : NULL,
+						    brw_page2oap(
+							aa->aa_ppga[last - 1]));
 			}
 		}
-
-		if (valid != 0)
-			cl_object_attr_update(env, obj, attr, valid);
-		cl_object_attr_unlock(obj);
 	}
 	OBD_SLAB_FREE_PTR(aa->aa_oa, osc_obdo_kmem);
+	osc_brw_objs_free(aa->aa_objs);
 
 	if (lustre_msg_get_opc(req->rq_reqmsg) == OST_WRITE && rc == 0)
 		osc_inc_unstable_pages(req);
@@ -2158,10 +2243,54 @@ static void brw_commit(struct ptlrpc_request *req)
 	}
 }
 
+/**
+ * Set the attributes of one object of a BRW RPC into \a oa, \a ext is the
+ * first extent of this object in \a ext_list.
+ */
+static void osc_brw_set_attr(const struct lu_env *env, struct osc_extent *ext,
+			     struct list_head *ext_list, struct obdo *oa,
+			     int cmd)
+{
+	struct osc_object	*obj = ext->oe_obj;
+	struct cl_req_attr	*crattr = &osc_env_info(env)->oti_req_attr;
+	__u32			 layout_version = 0;
+	int			 grant = 0;
+
+	memset(crattr, 0, sizeof(*crattr));
+	crattr->cra_type = (cmd & OBD_BRW_WRITE) ? CRT_WRITE : CRT_READ;
+	crattr->cra_flags = ~0ULL;
+	crattr->cra_page = oap2cl_page(list_first_entry(&ext->oe_pages,
+							struct osc_async_page,
+							oap_pending_item));
+	crattr->cra_oa = oa;
+	cl_req_attr_set(env, osc2cl(obj), crattr);
+
+	list_for_each_entry_from(ext, ext_list, oe_link) {
+		if (ext->oe_obj != obj)
+			break;
+		grant += ext->oe_grants;
+		layout_version = MAX(layout_version, ext->oe_layout_version);
+	}
+
+	if (cmd == OBD_BRW_WRITE) {
+		oa->o_grant_used = grant;
+		if (layout_version > 0) {
+			CDEBUG(D_LAYOUT, DFID": write with layout version %u\n",
+			       PFID(&oa->o_oi.oi_fid), layout_version);
+
+			oa->o_layout_version = layout_version;
+			oa->o_valid |= OBD_MD_LAYOUT_VERSION;
+		}
+	}
+}
+
 /**
  * Build an RPC by the list of extent @ext_list. The caller must ensure
  * that the total pages in this list are NOT over max pages per RPC.
  * Extents in the list must be in OES_RPC state.
+ *
+ * A write RPC may carry the extents of several objects, in which case the
+ * extents of each object must follow each other in @ext_list.
  */
 int osc_build_rpc(const struct lu_env *env, struct client_obd *cli,
 		  struct list_head *ext_list, int cmd)
@@ -2171,36 +2300,43 @@ int osc_build_rpc(const struct lu_env *env, struct client_obd *cli,
 	struct brw_page			**pga = NULL;
 	struct osc_brw_async_args	*aa = NULL;
 	struct obdo			*oa = NULL;
+	struct osc_brw_objs		*objs = NULL;
 	struct osc_async_page		*oap;
 	struct osc_object		*obj = NULL;
+	struct osc_object		*cur;
 	struct cl_req_attr		*crattr = NULL;
 	loff_t				starting_offset = OBD_OBJECT_EOF;
+	loff_t				obj_offset = OBD_OBJECT_EOF;
 	loff_t				ending_offset = 0;
 	int				mpflag = 0;
 	int				mem_tight = 0;
 	int				page_count = 0;
+	int				nobjs = 0;
 	bool				soft_sync = false;
 	bool				interrupted = false;
 	bool				ndelay = false;
-	int				i;
-	int				grant = 0;
+	int				i, k;
 	int				rc;
-	__u32				layout_version = 0;
 	struct list_head		rpc_list = LIST_HEAD_INIT(rpc_list);
 	struct ost_body			*body;
 	ENTRY;
 	LASSERT(!list_empty(ext_list));
 
 	/* add pages into rpc_list to build BRW rpc */
+	cur = NULL;
 	list_for_each_entry(ext, ext_list, oe_link) {
 		LASSERT(ext->oe_state == OES_RPC);
 		mem_tight |= ext->oe_memalloc;
-		grant += ext->oe_grants;
 		page_count += ext->oe_nr_pages;
-		layout_version = MAX(layout_version, ext->oe_layout_version);
 		if (obj == NULL)
 			obj = ext->oe_obj;
+		if (ext->oe_obj != cur) {
+			cur = ext->oe_obj;
+			nobjs++;
+		}
 	}
+	LASSERT(nobjs == 1 ||
+		(cmd == OBD_BRW_WRITE && nobjs <= PTLRPC_MAX_BRW_OBJS));
 
 	soft_sync = osc_over_unstable_soft_limit(cli);
 	if (mem_tight)
@@ -2214,8 +2350,33 @@ int osc_build_rpc(const struct lu_env *env, struct client_obd *cli,
 	if (oa == NULL)
 		GOTO(out, rc = -ENOMEM);
 
+	if (nobjs > 1) {
+		OBD_ALLOC_PTR(objs);
+		if (objs == NULL)
+			GOTO(out, rc = -ENOMEM);
+		objs->bo_count = nobjs;
+		objs->bo_oa[0] = oa;
+		for (k = 1; k < nobjs; k++) {
+			OBD_SLAB_ALLOC_PTR_GFP(objs->bo_oa[k], osc_obdo_kmem,
+					       GFP_NOFS);
+			if (objs->bo_oa[k] == NULL)
+				GOTO(out, rc = -ENOMEM);
+		}
+	}
+
 	i = 0;
+	k = -1;
+	cur = NULL;
 	list_for_each_entry(ext, ext_list, oe_link) {
+		if (ext->oe_obj != cur) {
+			/* page offsets are only ordered within an object */
+			cur = ext->oe_obj;
+			obj_offset = OBD_OBJECT_EOF;
+			ending_offset = 0;
+			k++;
+		}
+		if (objs != NULL)
+			objs->bo_pages[k] += ext->oe_nr_pages;
 		list_for_each_entry(oap, &ext->oe_pages, oap_pending_item) {
 			if (mem_tight)
 				oap->oap_brw_flags |= OBD_BRW_MEMALLOC;
@@ -2226,9 +2387,9 @@ int osc_build_rpc(const struct lu_env *env, struct client_obd *cli,
 			i++;
 
 			list_add_tail(&oap->oap_rpc_item, &rpc_list);
-			if (starting_offset == OBD_OBJECT_EOF ||
-			    starting_offset > oap->oap_obj_off)
-				starting_offset = oap->oap_obj_off;
+			if (obj_offset == OBD_OBJECT_EOF ||
+			    obj_offset > oap->oap_obj_off)
+				obj_offset = oap->oap_obj_off;
 			else
 				LASSERT(oap->oap_page_off == 0);
 			if (ending_offset < oap->oap_obj_off + oap->oap_count)
@@ -2240,6 +2401,8 @@ int osc_build_rpc(const struct lu_env *env, struct client_obd *cli,
 			if (oap->oap_interrupted)
 				interrupted = true;
 		}
+		if (starting_offset > obj_offset)
+			starting_offset = obj_offset;
 		if (ext->oe_ndelay)
 			ndelay = true;
 	}
@@ -2247,27 +2410,23 @@ int osc_build_rpc(const struct lu_env *env, struct client_obd *cli,
 	/* first page in the list */
 	oap = list_entry(rpc_list.next, typeof(*oap), oap_rpc_item);
 
-	crattr = &osc_env_info(env)->oti_req_attr;
-	memset(crattr, 0, sizeof(*crattr));
-	crattr->cra_type = (cmd & OBD_BRW_WRITE) ? CRT_WRITE : CRT_READ;
-	crattr->cra_flags = ~0ULL;
-	crattr->cra_page = oap2cl_page(oap);
-	crattr->cra_oa = oa;
-	cl_req_attr_set(env, osc2cl(obj), crattr);
-
-	if (cmd == OBD_BRW_WRITE) {
-		oa->o_grant_used = grant;
-		if (layout_version > 0) {
-			CDEBUG(D_LAYOUT, DFID": write with layout version %u\n",
-			       PFID(&oa->o_oi.oi_fid), layout_version);
-
-			oa->o_layout_version = layout_version;
-			oa->o_valid |= OBD_MD_LAYOUT_VERSION;
-		}
-	}
-
-	sort_brw_pages(pga, page_count);
-	rc = osc_brw_prep_request(cmd, cli, oa, page_count, pga, &req, 0);
+	/* set the attributes and sort the pages of each object */
+	i = 0;
+	k = 0;
+	cur = NULL;
+	list_for_each_entry(ext, ext_list, oe_link) {
+		if (ext->oe_obj == cur)
+			continue;
+		cur = ext->oe_obj;
+		osc_brw_set_attr(env, ext, ext_list,
+				 objs != NULL ? objs->bo_oa[k] : oa, cmd);
+		sort_brw_pages(pga + i, osc_brw_obj_pages(objs, k, page_count));
+		i += osc_brw_obj_pages(objs, k, page_count);
+		k++;
+	}
+
+	rc = osc_brw_prep_request(cmd, cli, oa, objs, page_count, pga, &req,
+				  0);
 	if (rc != 0) {
 		CERROR("prep_req failed: %d\n", rc);
 		GOTO(out, rc);
@@ -2292,10 +2451,23 @@ int osc_build_rpc(const struct lu_env *env, struct client_obd *cli,
 	 * the OST will not use BRW timestamps.  Sadly, there is no obvious
 	 * way to do this in a single call.  bug 10150 */
 	body = req_capsule_client_get(&req->rq_pill, &RMF_OST_BODY);
+	crattr = &osc_env_info(env)->oti_req_attr;
 	crattr->cra_oa = &body->oa;
 	crattr->cra_flags = OBD_MD_FLMTIME | OBD_MD_FLCTIME | OBD_MD_FLATIME;
 	cl_req_attr_set(env, osc2cl(obj), crattr);
 	lustre_msg_set_jobid(req->rq_reqmsg, crattr->cra_jobid);
+	if (objs != NULL) {
+		body = req_capsule_client_get(&req->rq_pill, &RMF_OST_BODIES);
+		k = 0;
+		cur = obj;
+		list_for_each_entry(ext, ext_list, oe_link) {
+			if (ext->oe_obj == cur)
+				continue;
+			cur = ext->oe_obj;
+			crattr->cra_oa = &body[k++].oa;
+			cl_req_attr_set(env, osc2cl(cur), crattr);
+		}
+	}
 
 	CLASSERT(sizeof(*aa) <= sizeof(req->rq_async_args));
 	aa = ptlrpc_req_async_args(req);
@@ -2318,11 +2490,12 @@ int osc_build_rpc(const struct lu_env *env, struct client_obd *cli,
 		lprocfs_oh_tally(&cli->cl_write_rpc_hist, cli->cl_w_in_flight);
 		lprocfs_oh_tally_log2(&cli->cl_write_offset_hist,
 				      starting_offset + 1);
+		lprocfs_oh_tally(&cli->cl_write_obj_hist, nobjs);
 	}
 	spin_unlock(&cli->cl_loi_list_lock);
 
-	DEBUG_REQ(D_INODE, req, "%d pages, aa %p. now %ur/%uw in flight",
-		  page_count, aa, cli->cl_r_in_flight,
+	DEBUG_REQ(D_INODE, req, "%d pages, %d objects, aa %p. now %ur/%uw in "
+		  "flight", page_count, nobjs, aa, cli->cl_r_in_flight,
 		  cli->cl_w_in_flight);
 	OBD_FAIL_TIMEOUT(OBD_FAIL_OSC_DELAY_IO, cfs_fail_val);
 
@@ -2339,6 +2512,7 @@ out:
 
 		if (oa)
 			OBD_SLAB_FREE_PTR(oa, osc_obdo_kmem);
+		osc_brw_objs_free(objs);
 		if (pga)
 			OBD_FREE(pga, sizeof(*pga) * page_count);
 		/* this should happen rarely and is pretty bad, it makes the
@@ -980,10 +980,8 @@ struct ptlrpc_request_set *ptlrpc_prep_set(void)
 	atomic_set(&set->set_refcount, 1);
 	INIT_LIST_HEAD(&set->set_requests);
 	init_waitqueue_head(&set->set_waitq);
-	atomic_set(&set->set_new_count, 0);
 	atomic_set(&set->set_remaining, 0);
-	spin_lock_init(&set->set_new_req_lock);
-	INIT_LIST_HEAD(&set->set_new_requests);
+	init_llist_head(&set->set_new_requests);
 	set->set_max_inflight = UINT_MAX;
 	set->set_producer     = NULL;
 	set->set_producer_arg = NULL;
@@ -1116,23 +1114,20 @@ void ptlrpc_set_add_new_req(struct ptlrpcd_ctl *pc,
                            struct ptlrpc_request *req)
 {
         struct ptlrpc_request_set *set = pc->pc_set;
-        int count, i;
+        int i;
 
         LASSERT(req->rq_set == NULL);
 	LASSERT(test_bit(LIOD_STOP, &pc->pc_flags) == 0);
 
-	spin_lock(&set->set_new_req_lock);
 	/*
 	 * The set takes over the caller's request reference.
 	 */
 	req->rq_set = set;
 	req->rq_queued_time = ktime_get_seconds();
-	list_add_tail(&req->rq_set_chain, &set->set_new_requests);
-	count = atomic_inc_return(&set->set_new_count);
-	spin_unlock(&set->set_new_req_lock);
 
-	/* Only need to call wakeup once for the first entry. */
-	if (count == 1) {
+	/* Only need to call wakeup once for the first entry, llist_add()
+	 * tells whether the queue was empty. */
+	if (llist_add(&req->rq_cli.cr_new_node, &set->set_new_requests)) {
 		wake_up(&set->set_waitq);
 
 		/* XXX: It maybe unnecessary to wakeup all the partners. But to
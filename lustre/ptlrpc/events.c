@@ -283,50 +283,49 @@ static void ptlrpc_req_add_history(struct ptlrpc_service_part *svcpt,
 }
 
 /*
- * Server's incoming request callback
+ * Build the request descriptor for an incoming request message, returns
+ * NULL if the message is dropped.
  */
-void request_in_callback(struct lnet_event *ev)
+static struct ptlrpc_request *request_in_prep(struct lnet_event *ev)
 {
 	struct ptlrpc_cb_id		  *cbid = ev->md.user_ptr;
 	struct ptlrpc_request_buffer_desc *rqbd = cbid->cbid_arg;
-	struct ptlrpc_service_part	  *svcpt = rqbd->rqbd_svcpt;
-	struct ptlrpc_service             *service = svcpt->scp_service;
-        struct ptlrpc_request             *req;
-        ENTRY;
+	struct ptlrpc_service		  *service = rqbd->rqbd_svcpt->scp_service;
+	struct ptlrpc_request		  *req;
 
-        LASSERT (ev->type == LNET_EVENT_PUT ||
-                 ev->type == LNET_EVENT_UNLINK);
-        LASSERT ((char *)ev->md.start >= rqbd->rqbd_buffer);
-        LASSERT ((char *)ev->md.start + ev->offset + ev->mlength <=
-                 rqbd->rqbd_buffer + service->srv_buf_size);
+	LASSERT(ev->type == LNET_EVENT_PUT ||
+		ev->type == LNET_EVENT_UNLINK);
+	LASSERT((char *)ev->md.start >= rqbd->rqbd_buffer);
+	LASSERT((char *)ev->md.start + ev->offset + ev->mlength <=
+		rqbd->rqbd_buffer + service->srv_buf_size);
 
-        CDEBUG((ev->status == 0) ? D_NET : D_ERROR,
-               "event type %d, status %d, service %s\n",
-               ev->type, ev->status, service->srv_name);
+	CDEBUG((ev->status == 0) ? D_NET : D_ERROR,
+	       "event type %d, status %d, service %s\n",
+	       ev->type, ev->status, service->srv_name);
 
-        if (ev->unlinked) {
-                /* If this is the last request message to fit in the
-                 * request buffer we can use the request object embedded in
-                 * rqbd.  Note that if we failed to allocate a request,
-                 * we'd have to re-post the rqbd, which we can't do in this
-                 * context. */
-                req = &rqbd->rqbd_req;
-                memset(req, 0, sizeof (*req));
-        } else {
-                LASSERT (ev->type == LNET_EVENT_PUT);
-                if (ev->status != 0) {
-                        /* We moaned above already... */
-                        return;
-                }
+	if (ev->unlinked) {
+		/* If this is the last request message to fit in the
+		 * request buffer we can use the request object embedded in
+		 * rqbd.  Note that if we failed to allocate a request,
+		 * we'd have to re-post the rqbd, which we can't do in this
+		 * context. */
+		req = &rqbd->rqbd_req;
+		memset(req, 0, sizeof(*req));
+	} else {
+		LASSERT(ev->type == LNET_EVENT_PUT);
+		if (ev->status != 0) {
+			/* We moaned above already... */
+			return NULL;
+		}
 		req = ptlrpc_request_cache_alloc(GFP_ATOMIC);
-                if (req == NULL) {
-                        CERROR("Can't allocate incoming request descriptor: "
-                               "Dropping %s RPC from %s\n",
-                               service->srv_name,
-                               libcfs_id2str(ev->initiator));
-                        return;
-                }
-        }
+		if (req == NULL) {
+			CERROR("Can't allocate incoming request descriptor: "
+			       "Dropping %s RPC from %s\n",
+			       service->srv_name,
+			       libcfs_id2str(ev->initiator));
+			return NULL;
+		}
+	}
 
 	ptlrpc_srv_req_init(req);
 	/* NB we ABSOLUTELY RELY on req being zeroed, so pointers are NULL,
@@ -350,7 +349,15 @@ void request_in_callback(struct lnet_event *ev)
 	CDEBUG(D_RPCTRACE, "peer: %s (source: %s)\n",
 		libcfs_id2str(req->rq_peer), libcfs_id2str(req->rq_source));
 
-	spin_lock(&svcpt->scp_lock);
+	return req;
+}
+
+/* Queue an incoming request, MUST be called with scp_lock held */
+static void request_in_queue_locked(struct lnet_event *ev,
+				    struct ptlrpc_request *req)
+{
+	struct ptlrpc_request_buffer_desc *rqbd = req->rq_rqbd;
+	struct ptlrpc_service_part	  *svcpt = rqbd->rqbd_svcpt;
 
 	ptlrpc_req_add_history(svcpt, req);
 
@@ -364,17 +371,38 @@ void request_in_callback(struct lnet_event *ev)
 		if (test_req_buffer_pressure &&
 		    ev->type != LNET_EVENT_UNLINK &&
 		    svcpt->scp_nrqbds_posted == 0)
-                        CWARN("All %s request buffers busy\n",
-                              service->srv_name);
+			CWARN("All %s request buffers busy\n",
+			      svcpt->scp_service->srv_name);
 
-                /* req takes over the network's ref on rqbd */
-        } else {
-                /* req takes a ref on rqbd */
-                rqbd->rqbd_refcount++;
-        }
+		/* req takes over the network's ref on rqbd */
+	} else {
+		/* req takes a ref on rqbd */
+		rqbd->rqbd_refcount++;
+	}
 
 	list_add_tail(&req->rq_list, &svcpt->scp_req_incoming);
 	svcpt->scp_nreqs_incoming++;
+}
+
+/*
+ * Server's incoming request callback
+ */
+void request_in_callback(struct lnet_event *ev)
+{
+	struct ptlrpc_request	   *req;
+	struct ptlrpc_service_part *svcpt;
+	ENTRY;
+
+	req = request_in_prep(ev);
+	if (req == NULL) {
+		EXIT;
+		return;
+	}
+
+	svcpt = req->rq_rqbd->rqbd_svcpt;
+	spin_lock(&svcpt->scp_lock);
+
+	request_in_queue_locked(ev, req);
 
 	/* NB everything can disappear under us once the request
 	 * has been queued and we unlock, so do the wake now... */
@@ -384,6 +412,61 @@ void request_in_callback(struct lnet_event *ev)
 	EXIT;
 }
 
+/* max # incoming requests queued under a single scp_lock hold */
+#define PTLRPC_REQ_IN_BATCH	16
+
+static inline struct ptlrpc_service_part *
+request_in_svcpt(struct lnet_event *ev)
+{
+	struct ptlrpc_cb_id		  *cbid = ev->md.user_ptr;
+	struct ptlrpc_request_buffer_desc *rqbd = cbid->cbid_arg;
+
+	return rqbd->rqbd_svcpt;
+}
+
+/*
+ * Queue the leading run of incoming requests in \a events which are for the
+ * same service partition, taking scp_lock and waking service threads only
+ * once for all of them. Returns the number of events consumed.
+ */
+static int request_in_callback_batch(struct lnet_event **events, int nevents)
+{
+	struct ptlrpc_request	   *reqs[PTLRPC_REQ_IN_BATCH];
+	struct ptlrpc_service_part *svcpt = request_in_svcpt(events[0]);
+	struct ptlrpc_cb_id	   *cbid;
+	int			    nqueued = 0;
+	int			    n;
+	int			    i;
+
+	for (n = 1; n < nevents && n < PTLRPC_REQ_IN_BATCH; n++) {
+		cbid = events[n]->md.user_ptr;
+		LASSERT(cbid->cbid_arg != LP_POISON);
+		if (cbid->cbid_fn != request_in_callback ||
+		    request_in_svcpt(events[n]) != svcpt)
+			break;
+	}
+
+	for (i = 0; i < n; i++)
+		reqs[i] = request_in_prep(events[i]);
+
+	spin_lock(&svcpt->scp_lock);
+	for (i = 0; i < n; i++) {
+		if (reqs[i] == NULL)
+			continue;
+
+		request_in_queue_locked(events[i], reqs[i]);
+		nqueued++;
+	}
+
+	/* service threads wait exclusively, one per queued request */
+	if (nqueued > 0)
+		wake_up_nr(&svcpt->scp_waitq, nqueued);
+
+	spin_unlock(&svcpt->scp_lock);
+
+	return n;
+}
+
 /*
  *  Server's outgoing reply callback
  */
@@ -498,6 +581,26 @@ static void ptlrpc_master_callback(struct lnet_event *ev)
         callback (ev);
 }
 
+static void ptlrpc_master_batch_callback(struct lnet_event **events,
+					 int nevents)
+{
+	struct ptlrpc_cb_id *cbid;
+	int i = 0;
+
+	while (i < nevents) {
+		cbid = events[i]->md.user_ptr;
+		LASSERT(cbid->cbid_arg != LP_POISON);
+
+		/* incoming requests of a busy service usually come in runs,
+		 * the other callbacks each work on their own object */
+		if (cbid->cbid_fn == request_in_callback)
+			i += request_in_callback_batch(&events[i],
+						       nevents - i);
+		else
+			ptlrpc_master_callback(events[i++]);
+	}
+}
+
 int ptlrpc_uuid_to_peer(struct obd_uuid *uuid,
 			struct lnet_process_id *peer, lnet_nid_t *self)
 {
@@ -605,8 +708,10 @@ int ptlrpc_ni_init(void)
 	/* kernel LNet calls our master callback when there are new event,
 	 * because we are guaranteed to get every event via callback,
 	 * so we just set EQ size to 0 to avoid overhread of serializing
-	 * enqueue/dequeue operations in LNet. */
-	rc = LNetEQAlloc(0, ptlrpc_master_callback, &ptlrpc_eq_h);
+	 * enqueue/dequeue operations in LNet. Events completed together
+	 * are handed over as a vector so that incoming requests share
+	 * scp_lock and wakeups. */
+	rc = LNetEQAllocBatch(ptlrpc_master_batch_callback, &ptlrpc_eq_h);
         if (rc == 0)
                 return 0;
 
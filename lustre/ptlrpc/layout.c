@@ -608,6 +608,16 @@ static const struct req_msg_field *ost_brw_client[] = {
 	&RMF_SHORT_IO
 };
 
+static const struct req_msg_field *ost_brw_write_client[] = {
+	&RMF_PTLRPC_BODY,
+	&RMF_OST_BODY,
+	&RMF_OBD_IOOBJ,
+	&RMF_NIOBUF_REMOTE,
+	&RMF_CAPA1,
+	&RMF_SHORT_IO,
+	&RMF_OST_BODIES
+};
+
 static const struct req_msg_field *ost_brw_read_server[] = {
 	&RMF_PTLRPC_BODY,
 	&RMF_OST_BODY,
@@ -1108,6 +1118,13 @@ struct req_msg_field RMF_OST_BODY =
 		    dump_ost_body);
 EXPORT_SYMBOL(RMF_OST_BODY);
 
+/* bodies of the objects after the first one in a multi-object OST_WRITE */
+struct req_msg_field RMF_OST_BODIES =
+	DEFINE_MSGF("ost_bodies", RMF_F_STRUCT_ARRAY,
+		    sizeof(struct ost_body), lustre_swab_ost_body,
+		    dump_ost_body);
+EXPORT_SYMBOL(RMF_OST_BODIES);
+
 struct req_msg_field RMF_OBD_IOOBJ =
         DEFINE_MSGF("obd_ioobj", RMF_F_STRUCT_ARRAY,
                     sizeof(struct obd_ioobj), lustre_swab_obd_ioobj, dump_ioo);
@@ -1657,7 +1674,8 @@ struct req_format RQF_OST_BRW_READ =
 EXPORT_SYMBOL(RQF_OST_BRW_READ);
 
 struct req_format RQF_OST_BRW_WRITE =
-        DEFINE_REQ_FMT0("OST_BRW_WRITE", ost_brw_client, ost_brw_write_server);
+	DEFINE_REQ_FMT0("OST_BRW_WRITE", ost_brw_write_client,
+			ost_brw_write_server);
 EXPORT_SYMBOL(RQF_OST_BRW_WRITE);
 
 struct req_format RQF_OST_STATFS =
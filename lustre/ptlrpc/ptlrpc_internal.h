@@ -290,6 +290,14 @@ void sptlrpc_plain_fini(void);
 int  sptlrpc_enc_pool_init(void);
 void sptlrpc_enc_pool_fini(void);
 int sptlrpc_proc_enc_pool_seq_show(struct seq_file *m, void *v);
+int  sptlrpc_msgbuf_pool_init(void);
+void sptlrpc_msgbuf_pool_fini(void);
+void *sptlrpc_msgbuf_alloc(int size);
+void sptlrpc_msgbuf_free(void *buf, int size);
+int sptlrpc_proc_msgbuf_pool_seq_show(struct seq_file *m, void *v);
+ssize_t sptlrpc_proc_msgbuf_pool_seq_write(struct file *file,
+					   const char __user *buffer,
+					   size_t count, loff_t *off);
 
 /* sec_lproc.c */
 int  sptlrpc_lproc_init(void);
@@ -200,28 +200,30 @@ void ptlrpcd_add_rqset(struct ptlrpc_request_set *set)
 	struct list_head *tmp, *pos;
 	struct ptlrpcd_ctl *pc;
 	struct ptlrpc_request_set *new;
-	int count, i;
+	bool first = false;
+	int i;
 
 	pc = ptlrpcd_select_pc(NULL);
 	new = pc->pc_set;
 
+	atomic_set(&set->set_remaining, 0);
+
 	list_for_each_safe(pos, tmp, &set->set_requests) {
 		struct ptlrpc_request *req =
 			list_entry(pos, struct ptlrpc_request,
 				   rq_set_chain);
 
 		LASSERT(req->rq_phase == RQ_PHASE_NEW);
+		list_del_init(&req->rq_set_chain);
 		req->rq_set = new;
 		req->rq_queued_time = ktime_get_seconds();
+		if (llist_add(&req->rq_cli.cr_new_node,
+			      &new->set_new_requests))
+			first = true;
 	}
 
-	spin_lock(&new->set_new_req_lock);
-	list_splice_init(&set->set_requests, &new->set_new_requests);
-	i = atomic_read(&set->set_remaining);
-	count = atomic_add_return(i, &new->set_new_count);
-	atomic_set(&set->set_remaining, 0);
-	spin_unlock(&new->set_new_req_lock);
-	if (count == i) {
+	/* Only need to call wakeup if the queue was empty before. */
+	if (first) {
 		wake_up(&new->set_waitq);
 
 		/* XXX: It maybe unnecessary to wakeup all the partners. But to
@@ -233,29 +235,38 @@ void ptlrpcd_add_rqset(struct ptlrpc_request_set *set)
 }
 
 /**
+ * Move all new requests queued on \a src to the request list of \a des.
+ *
+ * Producers push requests onto \a src->set_new_requests without any lock,
+ * so the whole queue is detached atomically here and may race with both
+ * new producers and a partner stealing from the same set; whoever detaches
+ * the queue owns its requests. The detached chain is in LIFO order, so
+ * adding each entry at the head of a local list restores the queue order.
+ *
  * Return transferred RPCs count.
  */
-static int ptlrpcd_steal_rqset(struct ptlrpc_request_set *des,
-                               struct ptlrpc_request_set *src)
+static int ptlrpcd_take_new_reqs(struct ptlrpc_request_set *des,
+				 struct ptlrpc_request_set *src)
 {
-	struct list_head *tmp, *pos;
+	struct llist_node *node;
 	struct ptlrpc_request *req;
+	LIST_HEAD(list);
 	int rc = 0;
 
-	spin_lock(&src->set_new_req_lock);
-	if (likely(!list_empty(&src->set_new_requests))) {
-		list_for_each_safe(pos, tmp, &src->set_new_requests) {
-			req = list_entry(pos, struct ptlrpc_request,
-					 rq_set_chain);
-			req->rq_set = des;
-		}
-		list_splice_init(&src->set_new_requests,
-				 &des->set_requests);
-		rc = atomic_read(&src->set_new_count);
+	node = llist_del_all(&src->set_new_requests);
+	while (node != NULL) {
+		req = llist_entry(node, struct ptlrpc_request,
+				  rq_cli.cr_new_node);
+		node = node->next;
+		req->rq_set = des;
+		list_add(&req->rq_set_chain, &list);
+		rc++;
+	}
+
+	if (rc > 0) {
+		list_splice(&list, &des->set_requests);
 		atomic_add(rc, &des->set_remaining);
-		atomic_set(&src->set_new_count, 0);
 	}
-	spin_unlock(&src->set_new_req_lock);
 	return rc;
 }
 
@@ -320,20 +331,12 @@ static int ptlrpcd_check(struct lu_env *env, struct ptlrpcd_ctl *pc)
         int rc2;
         ENTRY;
 
-	if (atomic_read(&set->set_new_count)) {
-		spin_lock(&set->set_new_req_lock);
-		if (likely(!list_empty(&set->set_new_requests))) {
-			list_splice_init(&set->set_new_requests,
-					     &set->set_requests);
-			atomic_add(atomic_read(&set->set_new_count),
-				   &set->set_remaining);
-			atomic_set(&set->set_new_count, 0);
-			/*
-			 * Need to calculate its timeout.
-			 */
-			rc = 1;
-		}
-		spin_unlock(&set->set_new_req_lock);
+	if (!llist_empty(&set->set_new_requests) &&
+	    ptlrpcd_take_new_reqs(set, set) > 0) {
+		/*
+		 * Need to calculate its timeout.
+		 */
+		rc = 1;
 	}
 
 	/* We should call lu_env_refill() before handling new requests to make
@@ -374,7 +377,7 @@ static int ptlrpcd_check(struct lu_env *env, struct ptlrpcd_ctl *pc)
 		/*
 		 * If new requests have been added, make sure to wake up.
 		 */
-		rc = atomic_read(&set->set_new_count);
+		rc = !llist_empty(&set->set_new_requests);
 
                 /* If we have nothing to do, check whether we can take some
                  * work from our partner threads. */
@@ -400,8 +403,8 @@ static int ptlrpcd_check(struct lu_env *env, struct ptlrpcd_ctl *pc)
 				ptlrpc_reqset_get(ps);
 				spin_unlock(&partner->pc_lock);
 
-				if (atomic_read(&ps->set_new_count)) {
-					rc = ptlrpcd_steal_rqset(set, ps);
+				if (!llist_empty(&ps->set_new_requests)) {
+					rc = ptlrpcd_take_new_reqs(set, ps);
 					if (rc > 0)
 						CDEBUG(D_RPCTRACE, "transfer %d"
 						       " async RPCs [%d->%d]\n",
@@ -848,6 +848,226 @@ void sptlrpc_enc_pool_fini(void)
 	}
 }
 
+/****************************************
+ * rpc message buffer pools             *
+ ****************************************/
+
+/*
+ * Request, reply and reply state buffers of the null and plain policies
+ * are rounded up to power-of-2 sizes and allocated/freed for every RPC.
+ * Keep a few freed buffers of each size class on a per-CPU stack, so the
+ * common small RPC case doesn't go through the slab allocator at all.
+ * Buffers larger than the biggest class are not pooled.
+ */
+#define MSGBUF_POOL_MIN_SHIFT	(9)	/* 512 bytes */
+#define MSGBUF_POOL_MAX_SHIFT	(15)	/* 32KB */
+#define MSGBUF_POOL_NR		(MSGBUF_POOL_MAX_SHIFT - \
+				 MSGBUF_POOL_MIN_SHIFT + 1)
+#define MSGBUF_POOL_DEPTH_MAX	(32)
+
+static unsigned int msgbuf_pool_cpu_kb = 16;
+module_param(msgbuf_pool_cpu_kb, uint, 0444);
+MODULE_PARM_DESC(msgbuf_pool_cpu_kb,
+		 "Per-CPU memory (KB) cached for each RPC buffer size class, 0 to disable");
+
+struct msgbuf_pool_cpu {
+	unsigned int	 mpc_count[MSGBUF_POOL_NR];
+	void		*mpc_bufs[MSGBUF_POOL_NR][MSGBUF_POOL_DEPTH_MAX];
+	/*
+	 * statistics
+	 */
+	unsigned long	 mpc_hits[MSGBUF_POOL_NR];	/* served from pool */
+	unsigned long	 mpc_misses[MSGBUF_POOL_NR];	/* pool was empty */
+	unsigned long	 mpc_overflows[MSGBUF_POOL_NR];	/* pool was full */
+	unsigned long	 mpc_large;			/* too big to pool */
+};
+
+static struct msgbuf_pool_cpu __percpu *msgbuf_pools;
+static unsigned int msgbuf_pool_depth[MSGBUF_POOL_NR];
+
+static inline int msgbuf_pool_idx(int size)
+{
+	if (size <= (1 << MSGBUF_POOL_MIN_SHIFT))
+		return 0;
+	if (size > (1 << MSGBUF_POOL_MAX_SHIFT))
+		return -1;
+
+	return fls(size - 1) - MSGBUF_POOL_MIN_SHIFT;
+}
+
+/**
+ * Allocate a zeroed rpc message buffer of \a size bytes.
+ *
+ * The buffer must be released by sptlrpc_msgbuf_free() with the same
+ * \a size.
+ */
+void *sptlrpc_msgbuf_alloc(int size)
+{
+	struct msgbuf_pool_cpu *mpc;
+	unsigned long flags;
+	void *buf = NULL;
+	int idx = msgbuf_pool_idx(size);
+
+	LASSERT(size > 0);
+
+	local_irq_save(flags);
+	mpc = this_cpu_ptr(msgbuf_pools);
+	if (idx < 0) {
+		mpc->mpc_large++;
+	} else if (mpc->mpc_count[idx] > 0) {
+		buf = mpc->mpc_bufs[idx][--mpc->mpc_count[idx]];
+		mpc->mpc_hits[idx]++;
+	} else {
+		mpc->mpc_misses[idx]++;
+	}
+	local_irq_restore(flags);
+
+	if (buf != NULL) {
+		memset(buf, 0, size);
+		return buf;
+	}
+
+	if (idx >= 0)
+		size = 1 << (idx + MSGBUF_POOL_MIN_SHIFT);
+
+	OBD_ALLOC_LARGE(buf, size);
+	return buf;
+}
+
+void sptlrpc_msgbuf_free(void *buf, int size)
+{
+	struct msgbuf_pool_cpu *mpc;
+	unsigned long flags;
+	int idx = msgbuf_pool_idx(size);
+
+	LASSERT(buf != NULL);
+
+	if (idx < 0) {
+		OBD_FREE_LARGE(buf, size);
+		return;
+	}
+
+	local_irq_save(flags);
+	mpc = this_cpu_ptr(msgbuf_pools);
+	if (mpc->mpc_count[idx] < msgbuf_pool_depth[idx]) {
+		mpc->mpc_bufs[idx][mpc->mpc_count[idx]++] = buf;
+		buf = NULL;
+	} else {
+		mpc->mpc_overflows[idx]++;
+	}
+	local_irq_restore(flags);
+
+	if (buf != NULL)
+		OBD_FREE_LARGE(buf, 1 << (idx + MSGBUF_POOL_MIN_SHIFT));
+}
+
+/*
+ * /proc/fs/lustre/sptlrpc/msgbuf_pools
+ */
+int sptlrpc_proc_msgbuf_pool_seq_show(struct seq_file *m, void *v)
+{
+	unsigned long large = 0;
+	int idx;
+	int cpu;
+
+	seq_printf(m, "%-8s %6s %6s %12s %12s %12s %5s\n", "size", "depth",
+		   "cached", "hits", "misses", "overflows", "hit%");
+
+	for (idx = 0; idx < MSGBUF_POOL_NR; idx++) {
+		unsigned long cached = 0;
+		unsigned long hits = 0;
+		unsigned long misses = 0;
+		unsigned long overflows = 0;
+
+		for_each_possible_cpu(cpu) {
+			struct msgbuf_pool_cpu *mpc;
+
+			mpc = per_cpu_ptr(msgbuf_pools, cpu);
+			cached += mpc->mpc_count[idx];
+			hits += mpc->mpc_hits[idx];
+			misses += mpc->mpc_misses[idx];
+			overflows += mpc->mpc_overflows[idx];
+		}
+
+		seq_printf(m, "%-8u %6u %6lu %12lu %12lu %12lu %5lu\n",
+			   1U << (idx + MSGBUF_POOL_MIN_SHIFT),
+			   msgbuf_pool_depth[idx], cached, hits, misses,
+			   overflows,
+			   hits + misses ? hits * 100 / (hits + misses) : 0);
+	}
+
+	for_each_possible_cpu(cpu)
+		large += per_cpu_ptr(msgbuf_pools, cpu)->mpc_large;
+	seq_printf(m, "large allocations: %lu\n", large);
+
+	return 0;
+}
+
+/* any write clears the statistics, cached buffers are kept */
+ssize_t sptlrpc_proc_msgbuf_pool_seq_write(struct file *file,
+					   const char __user *buffer,
+					   size_t count, loff_t *off)
+{
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		struct msgbuf_pool_cpu *mpc = per_cpu_ptr(msgbuf_pools, cpu);
+
+		memset(mpc->mpc_hits, 0, sizeof(mpc->mpc_hits));
+		memset(mpc->mpc_misses, 0, sizeof(mpc->mpc_misses));
+		memset(mpc->mpc_overflows, 0, sizeof(mpc->mpc_overflows));
+		mpc->mpc_large = 0;
+	}
+
+	return count;
+}
+
+int sptlrpc_msgbuf_pool_init(void)
+{
+	int idx;
+
+	msgbuf_pools = alloc_percpu(struct msgbuf_pool_cpu);
+	if (msgbuf_pools == NULL)
+		return -ENOMEM;
+
+	/* at least one buffer per class unless pooling is disabled */
+	for (idx = 0; idx < MSGBUF_POOL_NR; idx++) {
+		unsigned int depth;
+
+		depth = (msgbuf_pool_cpu_kb << 10) >>
+			(idx + MSGBUF_POOL_MIN_SHIFT);
+		if (depth == 0 && msgbuf_pool_cpu_kb > 0)
+			depth = 1;
+		msgbuf_pool_depth[idx] = min_t(unsigned int, depth,
+					       MSGBUF_POOL_DEPTH_MAX);
+	}
+
+	return 0;
+}
+
+void sptlrpc_msgbuf_pool_fini(void)
+{
+	int idx;
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		struct msgbuf_pool_cpu *mpc = per_cpu_ptr(msgbuf_pools, cpu);
+
+		for (idx = 0; idx < MSGBUF_POOL_NR; idx++) {
+			while (mpc->mpc_count[idx] > 0) {
+				void *buf;
+
+				buf = mpc->mpc_bufs[idx][--mpc->mpc_count[idx]];
+				OBD_FREE_LARGE(buf,
+					1 << (idx + MSGBUF_POOL_MIN_SHIFT));
+			}
+		}
+	}
+
+	free_percpu(msgbuf_pools);
+	msgbuf_pools = NULL;
+}
+
 
 static int cfs_hash_alg_id[] = {
 	[BULK_HASH_ALG_NULL]	= CFS_HASH_ALG_NULL,
@@ -1335,6 +1335,10 @@ void lustre_assert_wire_constants(void)
 		 OBD_CONNECT2_LOCK_CONVERT);
 	LASSERTF(OBD_CONNECT2_ARCHIVE_ID_ARRAY == 0x100ULL, "found 0x%.16llxULL\n",
 		 OBD_CONNECT2_ARCHIVE_ID_ARRAY);
+	LASSERTF(OBD_CONNECT2_MULTIOBJ_BRW == 0x100000000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT2_MULTIOBJ_BRW);
+	LASSERTF(OBD_CONNECT2_PARENT_LOCKED == 0x200000000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT2_PARENT_LOCKED);
 	LASSERTF(OBD_CKSUM_CRC32 == 0x00000001UL, "found 0x%.8xUL\n",
 		(unsigned)OBD_CKSUM_CRC32);
 	LASSERTF(OBD_CKSUM_ADLER == 0x00000002UL, "found 0x%.8xUL\n",
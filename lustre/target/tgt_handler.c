@@ -191,6 +191,8 @@ static int tgt_io_data_unpack(struct tgt_session_info *tsi, struct ost_id *oi)
 	struct niobuf_remote	*rnb;
 	struct obd_ioobj	*ioo;
 	int			 obj_count;
+	int			 nio_count = 0;
+	int			 i;
 
 	ENTRY;
 
@@ -217,27 +219,93 @@ static int tgt_io_data_unpack(struct tgt_session_info *tsi, struct ost_id *oi)
 	if (obj_count == 0) {
 		CERROR("%s: short ioobj\n", tgt_name(tsi->tsi_tgt));
 		RETURN(-EPROTO);
-	} else if (obj_count > 1) {
+	} else if (obj_count > 1 &&
+		   (obj_count > PTLRPC_MAX_BRW_OBJS ||
+		    !exp_connect_multiobj_brw(tsi->tsi_exp) ||
+		    lustre_msg_get_opc(tgt_ses_req(tsi)->rq_reqmsg) !=
+		    OST_WRITE)) {
 		CERROR("%s: too many ioobjs (%d)\n", tgt_name(tsi->tsi_tgt),
 		       obj_count);
 		RETURN(-EPROTO);
 	}
 
-	if (ioo->ioo_bufcnt == 0) {
-		CERROR("%s: ioo has zero bufcnt\n", tgt_name(tsi->tsi_tgt));
-		RETURN(-EPROTO);
+	for (i = 0; i < obj_count; i++) {
+		if (ioo[i].ioo_bufcnt == 0) {
+			CERROR("%s: ioo has zero bufcnt\n",
+			       tgt_name(tsi->tsi_tgt));
+			RETURN(-EPROTO);
+		}
+		nio_count += ioo[i].ioo_bufcnt;
 	}
 
-	if (ioo->ioo_bufcnt > PTLRPC_MAX_BRW_PAGES) {
+	if (nio_count > PTLRPC_MAX_BRW_PAGES) {
 		DEBUG_REQ(D_RPCTRACE, tgt_ses_req(tsi),
-			  "bulk has too many pages (%d)",
-			  ioo->ioo_bufcnt);
+			  "bulk has too many pages (%d)", nio_count);
 		RETURN(-EPROTO);
 	}
 
 	RETURN(0);
 }
 
+/**
+ * Unpack the bodies of the objects following the first one in a
+ * multi-object OST_WRITE.
+ *
+ * Each body is validated and has its IDs mapped like the main body in
+ * tgt_ost_body_unpack(). Grant information is only accounted from the
+ * main body, and server-side locking is not supported for such writes.
+ */
+static struct ost_body *tgt_brw_bodies_unpack(struct tgt_session_info *tsi,
+					      struct obd_ioobj *ioo,
+					      int objcount,
+					      struct niobuf_remote *rnb,
+					      int niocount)
+{
+	struct req_capsule	*pill = tsi->tsi_pill;
+	struct lu_nodemap	*nodemap;
+	struct ost_body		*bodies;
+	int			 rc;
+	int			 i;
+
+	ENTRY;
+
+	bodies = req_capsule_client_get(pill, &RMF_OST_BODIES);
+	if (bodies == NULL ||
+	    req_capsule_get_size(pill, &RMF_OST_BODIES, RCL_CLIENT) /
+	    sizeof(*bodies) != objcount - 1)
+		RETURN(ERR_PTR(-EPROTO));
+
+	for (i = 0; i < niocount; i++)
+		if (rnb[i].rnb_flags & OBD_BRW_SRVLOCK)
+			RETURN(ERR_PTR(-EPROTO));
+
+	nodemap = nodemap_get_from_exp(tsi->tsi_exp);
+	if (IS_ERR(nodemap))
+		RETURN(ERR_CAST(nodemap));
+
+	for (i = 1; i < objcount; i++) {
+		struct obdo *oa = &bodies[i - 1].oa;
+
+		if (!(oa->o_valid & OBD_MD_FLID))
+			GOTO(out, rc = -EPROTO);
+
+		rc = tgt_validate_obdo(tsi, oa);
+		if (rc)
+			GOTO(out, rc);
+
+		oa->o_uid = nodemap_map_id(nodemap, NODEMAP_UID,
+					   NODEMAP_CLIENT_TO_FS, oa->o_uid);
+		oa->o_gid = nodemap_map_id(nodemap, NODEMAP_GID,
+					   NODEMAP_CLIENT_TO_FS, oa->o_gid);
+		oa->o_valid &= ~OBD_MD_FLGRANT;
+		ioo[i].ioo_oid = oa->o_oi;
+	}
+	rc = 0;
+out:
+	nodemap_putref(nodemap);
+	RETURN(rc ? ERR_PTR(rc) : bodies);
+}
+
 static int tgt_ost_body_unpack(struct tgt_session_info *tsi, __u32 flags)
 {
 	struct ost_body		*body;
@@ -2438,14 +2506,17 @@ int tgt_brw_write(struct tgt_session_info *tsi)
 	struct ptlrpc_bulk_desc	*desc = NULL;
 	struct obd_export	*exp = req->rq_export;
 	struct niobuf_remote	*remote_nb;
+	struct niobuf_remote	*nb;
 	struct niobuf_local	*local_nb;
 	struct obd_ioobj	*ioo;
 	struct ost_body		*body, *repbody;
+	struct ost_body		*bodies = NULL;
 	struct l_wait_info	 lwi;
 	struct lustre_handle	 lockh = {0};
 	__u32			*rcs;
 	int			 objcount, niocount, npages;
-	int			 rc, i, j;
+	int			 objpages[PTLRPC_MAX_BRW_OBJS];
+	int			 rc, rc2, i, j;
 	enum cksum_types cksum_type = OBD_CKSUM_CRC32;
 	bool			 no_reply = false, mmap;
 	struct tgt_thread_big_cache *tbc = req->rq_svc_thread->t_data;
@@ -2504,6 +2575,13 @@ int tgt_brw_write(struct tgt_session_info *tsi)
 			sizeof(*remote_nb))
 		RETURN(err_serious(-EPROTO));
 
+	if (objcount > 1) {
+		bodies = tgt_brw_bodies_unpack(tsi, ioo, objcount, remote_nb,
+					       niocount);
+		if (IS_ERR(bodies))
+			RETURN(err_serious(PTR_ERR(bodies)));
+	}
+
 	if ((remote_nb[0].rnb_flags & OBD_BRW_MEMALLOC) &&
 	    ptlrpc_connection_is_local(exp->exp_connection))
 		memory_pressure_set();
@@ -2552,11 +2630,32 @@ int tgt_brw_write(struct tgt_session_info *tsi)
 		GOTO(out_lock, rc = -ENOMEM);
 	repbody->oa = body->oa;
 
-	npages = PTLRPC_MAX_BRW_PAGES;
-	rc = obd_preprw(tsi->tsi_env, OBD_BRW_WRITE, exp, &repbody->oa,
-			objcount, ioo, remote_nb, &npages, local_nb);
-	if (rc < 0)
+	/* objects of a multi-object write are prepared one by one, their
+	 * local buffers follow each other in local_nb */
+	npages = 0;
+	for (i = 0, nb = remote_nb; i < objcount;
+	     nb += ioo[i].ioo_bufcnt, i++) {
+		objpages[i] = PTLRPC_MAX_BRW_PAGES - npages;
+		rc = obd_preprw(tsi->tsi_env, OBD_BRW_WRITE, exp,
+				i == 0 ? &repbody->oa : &bodies[i - 1].oa,
+				1, &ioo[i], nb, &objpages[i],
+				local_nb + npages);
+		if (rc < 0)
+			break;
+		npages += objpages[i];
+	}
+	if (rc < 0) {
+		/* release the objects which were prepared already */
+		for (j = 0, nb = remote_nb, npages = 0; j < i;
+		     nb += ioo[j].ioo_bufcnt, j++) {
+			obd_commitrw(tsi->tsi_env, OBD_BRW_WRITE, exp,
+				     j == 0 ? &repbody->oa : &bodies[j - 1].oa,
+				     1, &ioo[j], nb, objpages[j],
+				     local_nb + npages, rc);
+			npages += objpages[j];
+		}
 		GOTO(out_lock, rc);
+	}
 	if (body->oa.o_flags & OBD_FL_SHORT_IO) {
 		int short_io_size;
 		unsigned char *short_io_buf;
@@ -2636,8 +2735,17 @@ skip_transfer:
 
 out_commitrw:
 	/* Must commit after prep above in all cases */
-	rc = obd_commitrw(tsi->tsi_env, OBD_BRW_WRITE, exp, &repbody->oa,
-			  objcount, ioo, remote_nb, npages, local_nb, rc);
+	for (i = 0, j = 0, nb = remote_nb, rc2 = rc, rc = 0; i < objcount;
+	     j += objpages[i], nb += ioo[i].ioo_bufcnt, i++) {
+		int err;
+
+		err = obd_commitrw(tsi->tsi_env, OBD_BRW_WRITE, exp,
+				   i == 0 ? &repbody->oa : &bodies[i - 1].oa,
+				   1, &ioo[i], nb, objpages[i], local_nb + j,
+				   rc2);
+		if (rc == 0)
+			rc = err;
+	}
 	if (rc == -ENOTCONN)
 		/* quota acquire process has been given up because
 		 * either the client has been evicted or the client
@@ -60,14 +60,16 @@ int main(int argc, char **argv)
         char *buf, *fname;
         int blocks, seek_blocks;
         long len;
+	long offset = 0;
         off64_t seek;
         struct stat64 st;
         char pad = 0xba;
         int action;
         int rc;
 
-        if (argc < 5 || argc > 6) {
-                printf("Usage: %s <read/write/rdwr/readhole> file seek nr_blocks [blocksize]\n", argv[0]);
+        if (argc < 5 || argc > 7) {
+		printf("Usage: %s <read/write/rdwr/readhole> file seek nr_blocks [blocksize [offset]]\n",
+		       argv[0]);
                 return 1;
         }
 
@@ -106,17 +108,24 @@ int main(int argc, char **argv)
                 return 1;
         }
 
-	printf("directio on %s for %dx%lu bytes\n", fname, blocks,
-	       (unsigned long)st.st_blksize);
+	/* shift both the file offset and the buffer by the same number of
+	 * bytes, so the IO is unaligned but at the same offset in page */
+	if (argc >= 7)
+		offset = strtoul(argv[6], 0, 0);
 
-        seek = (off64_t)seek_blocks * (off64_t)st.st_blksize;
+	printf("directio on %s for %dx%lu bytes at offset %ld\n", fname,
+	       blocks, (unsigned long)st.st_blksize, offset);
+
+	seek = (off64_t)seek_blocks * (off64_t)st.st_blksize + offset;
         len = blocks * st.st_blksize;
 
-        buf = mmap(0, len, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANON, 0, 0);
+	buf = mmap(0, len + offset, PROT_READ|PROT_WRITE,
+		   MAP_PRIVATE|MAP_ANON, 0, 0);
         if (buf == MAP_FAILED) {
                 printf("No memory %s\n", strerror(errno));
                 return 1;
         }
+	buf += offset;
         memset(buf, pad, len);
 
         if (action == O_WRONLY || action == O_RDWR) {
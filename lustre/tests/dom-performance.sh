@@ -205,6 +205,29 @@ run_SmallIO() {
 	return 0
 }
 
+run_CreateWrite() {
+	local TDIR=${1:-$DIR}
+	local count=$((DP_FNUM / 16))
+	local bsize=${DP_CW_BSIZE:-4096}
+	local nodes=$(comma_list $(mdts_nodes))
+	local lock
+
+	# compare create-write-close of small files with and without
+	# DoM lock returned by open-create, see MDC RPCs count
+	for lock in 0 1 ; do
+		echo "----- dom_create_lock=$lock, $count files"
+		do_nodes $nodes "lctl set_param -n mdt.*.dom_create_lock=$lock"
+		dp_run_cmd "time (for ((i = 0; i < $count; i++)); do \
+			dd if=/dev/zero of=$TDIR/cw-\$i bs=$bsize count=1 \
+			2>/dev/null || exit 1; done)"
+		if [ ${PIPESTATUS[0]} != 0 ]; then
+			error "Create-write-close failed, aborting"
+		fi
+		rm -rf $TDIR/*
+	done
+	return 0
+}
+
 run_IOR() {
 	if ! which IOR > /dev/null 2>&1 ; then
 		echo "IOR is not installed, skipping"
@@ -365,6 +388,7 @@ dp_test_run() {
 	local p="$TMP/$TESTSUITE-$TESTNAME.parameters"
 
 	save_lustre_params $facets "mdt.*.dom_lock" >> $p
+	save_lustre_params $facets "mdt.*.dom_create_lock" >> $p
 
 	printf "\n##### $test: DoM files\n"
 	do_nodes $nodes "lctl set_param -n mdt.*.dom_lock=1"
@@ -390,6 +414,11 @@ test_smallio() {
 }
 run_test smallio "Performance comparision: smallio"
 
+test_createwrite() {
+	dp_test_run CreateWrite
+}
+run_test createwrite "Performance comparision: create-write-close"
+
 test_mdtest() {
 	dp_test_run MDtest
 }
@@ -28,6 +28,9 @@ if [ "$SLOW" = no ]; then
     [ $smoke_DURATION -le 300 ] || smoke_DURATION=300
 fi
 
+ping_DURATION=${ping_DURATION:-120}
+[ "$SLOW" = no ] && ping_DURATION=30
+
 nodes=$(comma_list "$(osts_nodes) $(mdts_nodes)")
 lst_SERVERS=${lst_SERVERS:-$(comma_list "$(host_nids_address $nodes $NETTYPE)")}
 lst_CLIENTS=${lst_CLIENTS:-$(comma_list "$(host_nids_address $CLIENTS $NETTYPE)")}
@@ -181,6 +184,302 @@ test_smoke () {
 }
 run_test smoke "lst regression test"
 
+lnet_slabinfo () {
+	local nodes=$(comma_list $(nodes_list))
+
+	do_nodes $nodes "grep -E '^(lnet_msgs|lnet_MEs|lnet_small_MDs|lnet_large_MDs) ' /proc/slabinfo" ||
+		true
+}
+
+# LNet messages currently allocated on node $1
+lnet_msgs_alloc () {
+	do_node $1 "lnetctl stats show" | awk '/ msgs_alloc:/ { print $2 }'
+}
+
+test_ping_rate () {
+	lst_prepare
+
+	local servers=$lst_SERVERS
+	local clients=$lst_CLIENTS
+	local nc=$(echo ${clients//,/ } | wc -w)
+	local ns=$(echo ${servers//,/ } | wc -w)
+	local runlst=$TMP/ping_rate.sh
+	local log=$TMP/$tfile.log
+	local -A base
+	local rates
+	local node
+	local rate
+	local rc
+	local c
+
+	for node in $(nodes_list); do
+		do_node $node "grep -q '^lnet_msgs ' /proc/slabinfo" ||
+			error "no lnet_msgs slab cache on $node"
+		base[$node]=$(lnet_msgs_alloc $node)
+	done
+
+	# one batch per concurrency, each stopped before the next one runs,
+	# so every sample is the rate of a single concurrency
+	{
+		echo '#!/bin/bash'
+		echo 'set -e'
+		echo "$LST new_session --timeo 100000 pr"
+		echo "$LST add_group c $(nids_list $clients)"
+		echo "$LST add_group s $(nids_list $servers)"
+		for c in $lst_CONCR; do
+			echo "$LST add_batch b$c"
+			echo "$LST add_test --batch b$c --loop -1" \
+			     "--concurrency $c --distribute ${nc}:${ns}" \
+			     "--from c --to s ping"
+			echo "$LST run b$c"
+			echo "$LST stat --delay $ping_DURATION --count 1" \
+			     "--format yaml c"
+			echo "$LST stop b$c"
+		done
+	} > $runlst
+	cat $runlst
+
+	# LNet messages and MDs come from dedicated slab caches, so the
+	# allocation load of the ping storm shows up in /proc/slabinfo
+	echo "LNet descriptor caches before:"
+	lnet_slabinfo
+
+	run_lst $runlst | tee $log
+	rc=${PIPESTATUS[0]}
+	[ $rc = 0 ] || { _restore_mount; error "$runlst failed: $rc"; }
+
+	echo "LNet descriptor caches after:"
+	lnet_slabinfo
+
+	# the read rate of the clients is the rate of ping replies
+	rates=$(awk '/^  rates:/ { getline; gsub(",", "", $4); print $4 }' $log)
+	echo "ping RPC/s at concurrency $lst_CONCR: $(echo $rates)"
+	[ $(echo $rates | wc -w) = $(echo $lst_CONCR | wc -w) ] ||
+		error "$(echo $rates | wc -w) ping rates for $lst_CONCR"
+	for rate in $rates; do
+		(( $(bc <<< "$rate > 0") )) || error "no ping replies"
+	done
+	! grep -q "^  errors: [1-9]" $log || error "nodes failed to report"
+
+	lst_end_session --verbose | tee -a $log
+	check_lst_err $log
+	lst_cleanup_all
+
+	# every message of the storm went back to its cache
+	for node in $(nodes_list); do
+		rc=$(lnet_msgs_alloc $node)
+		[ $rc -le $((base[$node] + 16)) ] ||
+			error "$node has $rc LNet messages, ${base[$node]} before"
+	done
+}
+run_test ping_rate "lst ping rate with LNet descriptor caches"
+
+sweep_DURATION=${sweep_DURATION:-10}
+[ "$SLOW" = no ] && sweep_DURATION=3
+
+test_sweep () {
+	lst_prepare
+
+	local servers=$lst_SERVERS
+	local clients=$lst_CLIENTS
+	local nc=$(echo ${clients//,/ } | wc -w)
+	local ns=$(echo ${servers//,/ } | wc -w)
+	local concr=$(echo $lst_CONCR | tr ' ' ',')
+	local sizes=$(echo $lst_SIZES | tr ' ' ',')
+	local steps=$(($(echo $lst_CONCR | wc -w) * $(echo $lst_SIZES | wc -w)))
+	local runlst=$TMP/sweep.sh
+	local log=$TMP/$tfile.log
+	local rc
+
+	{
+		echo '#!/bin/bash'
+		echo 'set -e'
+		echo "$LST new_session --timeo 100000 sweep"
+		echo "$LST add_group c $(nids_list $clients)"
+		echo "$LST add_group s $(nids_list $servers)"
+		echo "$LST sweep --concurrency $concr --distribute ${nc}:${ns}" \
+		     "--duration $sweep_DURATION --format yaml" \
+		     "--from c --to s brw write check=simple size=$sizes"
+	} > $runlst
+	cat $runlst
+
+	run_lst $runlst | tee $log
+	rc=${PIPESTATUS[0]}
+	[ $rc = 0 ] || { _restore_mount; error "$runlst failed: $rc"; }
+
+	local done=$(grep -c "^- concurrency:" $log)
+	[ $done = $steps ] || error "$done of $steps sweep steps reported"
+	! grep -q "rpcs: 0$" $log || error "sweep step without completed RPCs"
+
+	lst_end_session --verbose | tee -a $log
+	check_lst_err $log
+	lst_cleanup_all
+}
+run_test sweep "lst concurrency/size sweep with latency percentiles"
+
+# routers between lst_CLIENTS and lst_SERVERS when they are on different
+# networks, comma separated host names
+lst_ROUTERS=${lst_ROUTERS:-""}
+forward_DURATION=${forward_DURATION:-60}
+[ "$SLOW" = no ] && forward_DURATION=20
+
+# all credits of the router buffer pools are back once traffic stopped
+check_router_buffers () {
+	local node
+
+	for node in ${1//,/ }; do
+		do_node $node "$LCTL get_param -n buffers"
+		do_node $node "$LCTL get_param -n buffers" |
+			awk 'NR > 1 && $2 != $3 { bad = 1 } END { exit bad }' ||
+			error "router buffer credits not returned on $node"
+	done
+}
+
+test_forward_empty () {
+	[ -n "$lst_ROUTERS" ] || skip_env "no lst_ROUTERS between the nodes"
+
+	lst_prepare
+
+	local param=/sys/module/lnet/parameters/router_forward_empty
+	local servers=$lst_SERVERS
+	local clients=$lst_CLIENTS
+	local nc=$(echo ${clients//,/ } | wc -w)
+	local ns=$(echo ${servers//,/ } | wc -w)
+	local runlst=$TMP/forward_empty.sh
+	local log=$TMP/$tfile.log
+	local end
+	local rc
+	local v
+
+	# bulk writes make the servers send GET requests, messages without
+	# payload, through the routers
+	{
+		echo '#!/bin/bash'
+		echo 'set -e'
+		echo "$LST new_session --timeo 100000 fe"
+		echo "$LST add_group c $(nids_list $clients)"
+		echo "$LST add_group s $(nids_list $servers)"
+		echo "$LST add_batch b"
+		echo "$LST add_test --batch b --loop -1 --concurrency 8" \
+		     "--distribute ${nc}:${ns} --from c --to s" \
+		     "brw write check=full size=1M"
+		echo "$LST run b"
+	} > $runlst
+	cat $runlst
+
+	run_lst $runlst | tee $log
+	rc=${PIPESTATUS[0]}
+	[ $rc = 0 ] || { _restore_mount; error "$runlst failed: $rc"; }
+
+	# flip forwarding without buffer while messages wait for credits
+	export LST_SESSION=$$
+	end=$((SECONDS + forward_DURATION))
+	v=0
+	while [ $SECONDS -lt $end ]; do
+		do_nodes $lst_ROUTERS "echo $v > $param" ||
+			error "cannot set router_forward_empty"
+		v=$((1 - v))
+		sleep 1
+	done
+	do_nodes $lst_ROUTERS "echo 1 > $param"
+
+	$LST stat --delay 5 --count 1 c s 2>&1 | tee -a $log
+	lst_end_session --verbose | tee -a $log
+	check_lst_err $log
+	check_router_buffers $lst_ROUTERS
+	lst_cleanup_all
+}
+run_test forward_empty "toggle router_forward_empty under routed bulk load"
+
+# "<nbuffers> <credits>" of all router buffer pools of a node
+router_pool_counts () {
+	do_node $1 "lnetctl routing show" |
+		awk '/ nbuffers:/ { n += $2 } / credits:/ { c += $2 }
+		     END { print n, c }'
+}
+
+test_router_pools () {
+	[ -n "$lst_ROUTERS" ] || skip_env "no lst_ROUTERS between the nodes"
+
+	lst_prepare
+
+	local param=/sys/module/lnet/parameters/auto_router_buffers
+	local servers=$lst_SERVERS
+	local clients=$lst_CLIENTS
+	local nc=$(echo ${clients//,/ } | wc -w)
+	local ns=$(echo ${servers//,/ } | wc -w)
+	local runlst=$TMP/router_pools.sh
+	local log=$TMP/$tfile.log
+	local -A base
+	local router
+	local counts
+	local end
+	local rc
+
+	for router in ${lst_ROUTERS//,/ }; do
+		do_node $router "echo 4 > $param" ||
+			error "cannot set auto_router_buffers on $router"
+		# give back anything grown by earlier tests
+		do_node $router "echo 2 > /proc/sys/vm/drop_caches"
+		base[$router]=$(router_pool_counts $router | cut -d' ' -f1)
+	done
+
+	{
+		echo '#!/bin/bash'
+		echo 'set -e'
+		echo "$LST new_session --timeo 100000 rp"
+		echo "$LST add_group c $(nids_list $clients)"
+		echo "$LST add_group s $(nids_list $servers)"
+		echo "$LST add_batch b"
+		echo "$LST add_test --batch b --loop -1 --concurrency 64" \
+		     "--distribute ${nc}:${ns} --from c --to s" \
+		     "brw write check=full size=1M"
+		echo "$LST add_test --batch b --loop -1 --concurrency 64" \
+		     "--distribute ${nc}:${ns} --from c --to s" \
+		     "brw read check=full size=4k"
+		echo "$LST run b"
+	} > $runlst
+	cat $runlst
+
+	run_lst $runlst | tee $log
+	rc=${PIPESTATUS[0]}
+	[ $rc = 0 ] || { _restore_mount; error "$runlst failed: $rc"; }
+
+	# pools grow under load while the shrinker and the pool ioctl race
+	# with the monitor thread resizing them
+	export LST_SESSION=$$
+	end=$((SECONDS + forward_DURATION))
+	while [ $SECONDS -lt $end ]; do
+		do_nodes $lst_ROUTERS "echo 2 > /proc/sys/vm/drop_caches" &
+		do_nodes $lst_ROUTERS "lnetctl routing show > /dev/null" &
+		wait
+		for router in ${lst_ROUTERS//,/ }; do
+			counts=$(router_pool_counts $router)
+			echo "$router: base ${base[$router]} nbuffers/credits $counts"
+			[ ${counts% *} -le $((${base[$router]} * 4)) ] ||
+				error "$router pools above 4 times ${base[$router]}: $counts"
+		done
+		sleep 1
+	done
+
+	$LST stat --delay 5 --count 1 c s 2>&1 | tee -a $log
+	lst_end_session --verbose | tee -a $log
+	check_lst_err $log
+	lst_cleanup_all
+
+	# once idle, the shrinker gives back everything above the configured
+	# sizes and all credits are back
+	for router in ${lst_ROUTERS//,/ }; do
+		do_node $router "echo 2 > /proc/sys/vm/drop_caches"
+		counts=$(router_pool_counts $router)
+		echo "$router: base ${base[$router]} nbuffers/credits $counts"
+		[ "$counts" = "${base[$router]} ${base[$router]}" ] ||
+			error "$router pools not back to ${base[$router]}: $counts"
+	done
+	check_router_buffers $lst_ROUTERS
+}
+run_test router_pools "grow and shrink router buffer pools under load"
+
 complete $SECONDS
 _restore_mount
 check_and_cleanup_lustre
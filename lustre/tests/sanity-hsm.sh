@@ -1664,6 +1664,39 @@ test_12q() {
 }
 run_test 12q "file attributes are refreshed after restore"
 
+test_12r() {
+	# test needs a running copytool
+	copytool setup --threads 4 --direct-io
+
+	local f=$DIR/$tdir/$tfile
+	mkdir -p $DIR/$tdir
+	$LFS setstripe -c -1 -S 1M "$f" || error "setstripe $f failed"
+
+	# data extents separated by holes, unaligned data, and a file
+	# ending with a hole which is not page aligned
+	dd if=/dev/urandom of=$f bs=1M count=3 conv=notrunc ||
+		error "write $f failed"
+	dd if=/dev/urandom of=$f bs=1M count=5 seek=16 conv=notrunc ||
+		error "write $f failed"
+	dd if=/dev/urandom of=$f bs=1 count=777 seek=$((30 * 1048576 + 5)) \
+		conv=notrunc || error "write $f failed"
+	local size=$((64 * 1048576 + 12345))
+	$TRUNCATE $f $size || error "truncate $f failed"
+
+	local fid=$(path2fid $f)
+	local sum=$(md5sum < $f)
+
+	$LFS hsm_archive $f || error "could not archive file"
+	wait_request_state $fid ARCHIVE SUCCEED
+	$LFS hsm_release $f || error "could not release file"
+	$LFS hsm_restore $f || error "could not restore file"
+	wait_request_state $fid RESTORE SUCCEED
+
+	[ $(stat -c %s $f) -eq $size ] || error "wrong size after restore"
+	[ "$(md5sum < $f)" == "$sum" ] || error "restored file differs"
+}
+run_test 12r "Archive and restore a sparse file with parallel copy streams"
+
 test_13() {
 	local -i i j k=0
 	for i in {1..10}; do
@@ -4629,6 +4662,44 @@ test_254b()
 }
 run_test 254b "Request counters are correctly incremented and decremented"
 
+test_254c()
+{
+	# Number of files to archive, the copytool does not copy any data so
+	# this measures how fast the coordinator dispatches queued requests
+	local nfiles=$([ "$SLOW" = "no" ] && echo 1000 || echo 10000)
+	local start
+	local elapsed
+
+	mkdir -p $DIR/$tdir || error "mkdir $DIR/$tdir failed"
+	createmany -o $DIR/$tdir/$tfile- $nfiles ||
+		error "createmany $nfiles files failed"
+
+	stack_trap \
+		"set_hsm_param max_requests $(get_hsm_param max_requests)" EXIT
+	set_hsm_param max_requests 100
+
+	# queue all the requests before the copytool can take any of them
+	cdt_disable
+	stack_trap cdt_enable EXIT
+	# hsm_archive --filelist is limited by the LNet message size
+	ls -1 $DIR/$tdir/$tfile-* | xargs -n 50 $LFS hsm_archive ||
+		error "cannot archive $nfiles files"
+
+	copytool setup --dry-run
+
+	start=$(date +%s.%N)
+	cdt_enable
+	wait_all_done $((nfiles / 10 + 100))
+	elapsed=$(echo "$(date +%s.%N) - $start" | bc)
+
+	printf "%d archive requests in %.2fs: %.1f requests/s\n" \
+		$nfiles $elapsed $(echo "$nfiles / $elapsed" | bc -l)
+
+	unlinkmany $DIR/$tdir/$tfile- $nfiles ||
+		error "unlinkmany $nfiles files failed"
+}
+run_test 254c "Coordinator dispatch rate with a fake copytool"
+
 # tests 260[a-c] rely on the parsing of the copytool's log file, they might
 # break in the future because of that.
 test_260a()
@@ -3822,6 +3822,34 @@ test_39q() { # LU-8041
 }
 run_test 39q "close won't zero out atime"
 
+test_39r() {
+	local dir=$DIR/$tdir
+	local mtime0
+	local mtime1
+	local ctime1
+
+	test_mkdir $dir
+	touch $dir/f0 || error "touch $dir/f0 failed"
+	cancel_lru_locks mdc
+	mtime0=$(stat -c %Y $dir)
+
+	# parent times are only written when they change
+	sleep 2
+	createmany -o $dir/f- 100 || error "create files failed"
+	cancel_lru_locks mdc
+	mtime1=$(stat -c %Y $dir)
+	ctime1=$(stat -c %Z $dir)
+	(( mtime1 > mtime0 )) || error "mtime $mtime1 not after $mtime0"
+	[ $ctime1 -eq $mtime1 ] || error "ctime $ctime1 != mtime $mtime1"
+
+	sleep 2
+	unlinkmany $dir/f- 100 || error "unlink files failed"
+	cancel_lru_locks mdc
+	(( $(stat -c %Y $dir) > mtime1 )) || error "mtime not updated by unlink"
+	(( $(stat -c %Z $dir) > ctime1 )) || error "ctime not updated by unlink"
+}
+run_test 39r "parent times updated by create and unlink in same second"
+
 test_40() {
 	dd if=/dev/zero of=$DIR/$tfile bs=4096 count=1
 	$RUNAS $OPENFILE -f O_WRONLY:O_TRUNC $DIR/$tfile &&
@@ -13397,6 +13425,47 @@ test_180c() { # LU-2598
 }
 run_test 180c "test huge bulk I/O size on obdfilter, don't LASSERT"
 
+test_180d() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run"
+
+	if ! module_loaded obdecho; then
+		load_module obdecho/obdecho &&
+			stack_trap "rmmod obdecho" EXIT ||
+			error "unable to load obdecho on client"
+	fi
+
+	local osc=$($LCTL dl | grep -v mdt | awk '$3 == "osc" {print $4; exit}')
+	local host=$($LCTL get_param -n osc.$osc.import |
+		     awk '/current_connection:/ { print $2 }' )
+	local target=$($LCTL get_param -n osc.$osc.import |
+		       awk '/target:/ { print $2 }' )
+	local pages=1024
+	local count=1000
+	local id
+
+	target=${target%_UUID}
+	[ -n "$target" ] || error "there is no osc.$osc.import target"
+
+	setup_obdecho_osc $host $target &&
+		stack_trap "cleanup_obdecho_osc $target" EXIT ||
+		{ error "obdecho setup failed with $?"; return; }
+
+	$LCTL attach echo_client ec ec_uuid || error "attach echo_client failed"
+	stack_trap "$LCTL --device ec detach" EXIT
+	$LCTL --device ec setup ${target}_osc || error "setup ec failed"
+	stack_trap "$LCTL --device ec cleanup" EXIT
+	id=$($LCTL --device ec create 1 | awk '/object id/ { print $6 }')
+	[ -n "$id" ] || error "create echo object failed"
+	stack_trap "$LCTL --device ec destroy $id 1" EXIT
+
+	# cl_page setup and release only, without transfer; the rate of
+	# test_brw is the cl_page throughput of the client stack
+	$LCTL --device ec test_brw $count w v $pages $id c0 ||
+		error "test_brw of cl_page setup failed"
+	grep "^cl_page_kmem" /proc/slabinfo
+}
+run_test 180d "cl_page setup and release rate on obdecho over osc"
+
 test_181() { # bug 22177
 	test_mkdir $DIR/$tdir
 	# create enough files to index the directory
@@ -17435,6 +17504,59 @@ test_271f() {
 }
 run_test 271f "DoM: read on open (200K file and read tail)"
 
+test_271g() {
+	[ $(lustre_version_code $SINGLEMDS) -lt $(version_code 2.11.56) ] &&
+		skip "Need MDS version at least 2.11.56"
+
+	local dom=$DIR/$tdir/dom
+	local count=100
+	local enq
+	local enq_2
+	local i
+
+	mkdir -p $DIR/$tdir
+
+	$LFS setstripe -E 1024K -L mdt $DIR/$tdir
+
+	local mdtidx=$($LFS getstripe -m $DIR/$tdir)
+	local facet=mds$((mdtidx + 1))
+	local saved=$(do_facet $facet $LCTL get_param -n \
+		      mdt.*MDT*$(printf %04x $mdtidx).dom_create_lock)
+
+	stack_trap "do_facet $facet $LCTL set_param -n \
+		   mdt.*.dom_create_lock=$saved" EXIT
+
+	cancel_lru_locks mdc
+	do_facet $facet $LCTL set_param -n mdt.*.dom_create_lock=0
+	lctl set_param -n mdc.*.stats=clear
+	for ((i = 0; i < $count; i++)); do
+		dd if=/dev/zero of=$dom.$i bs=4096 count=1 2>/dev/null ||
+			error "write $dom.$i failed"
+	done
+	enq=$(get_mdc_stats $mdtidx ldlm_ibits_enqueue)
+	rm -f $dom.*
+
+	cancel_lru_locks mdc
+	do_facet $facet $LCTL set_param -n mdt.*.dom_create_lock=1
+	lctl set_param -n mdc.*.stats=clear
+	for ((i = 0; i < $count; i++)); do
+		dd if=/dev/zero of=$dom.$i bs=4096 count=1 2>/dev/null ||
+			error "write $dom.$i failed"
+	done
+	enq_2=$(get_mdc_stats $mdtidx ldlm_ibits_enqueue)
+	# Each file has 1 open-create enqueue and IO lock is returned with it
+	[ $((enq - enq_2)) -ge $count ] ||
+		error "Too many enqueues $enq_2, expected about $((enq - count))"
+
+	cancel_lru_locks mdc
+	for ((i = 0; i < $count; i++)); do
+		$CHECKSTAT -t file -s 4096 $dom.$i ||
+			error "bad size of $dom.$i"
+	done
+	rm -f $dom.*
+}
+run_test 271g "DoM: IO lock at open-create saves enqueue RPCs"
+
 test_272a() {
 	[ $(lustre_version_code $SINGLEMDS) -lt $(version_code 2.11.50) ] &&
 		skip "Need MDS version at least 2.11.50"
@@ -19338,6 +19460,408 @@ test_417() {
 }
 run_test 417 "disable remote dir, striped dir and dir migration"
 
+test_418() {
+	local saved=$($LCTL get_param -n llite.*.ro_open_cache | head -n1)
+	local count=100
+	local closes
+	local opens
+	local i
+
+	[ -n "$saved" ] || skip "no ro_open_cache support on client"
+	stack_trap "$LCTL set_param -n llite.*.ro_open_cache=$saved" EXIT
+
+	mkdir -p $DIR/$tdir || error "mkdir $tdir failed"
+	echo "data" > $DIR/$tdir/$tfile || error "write $tfile failed"
+	cancel_lru_locks mdc
+
+	$LCTL set_param -n llite.*.ro_open_cache=1
+	# the first open is by name of a file not in the dcache
+	echo 2 > /proc/sys/vm/drop_caches
+	$LCTL set_param -n mdc.*.stats=clear
+	for ((i = 0; i < $count; i++)); do
+		cat $DIR/$tdir/$tfile > /dev/null || error "read $tfile failed"
+	done
+	$LCTL get_param mdc.*.stats
+	closes=$(calc_stats mdc.*.stats mds_close)
+	opens=$(calc_stats mdc.*.stats ldlm_ibits_enqueue)
+	[ $closes -eq 0 ] || error "$closes CLOSE RPCs with open cache"
+	[ $opens -le 1 ] || error "$opens OPEN RPCs with open cache"
+
+	# cached open handle is closed when the open lock is cancelled
+	cancel_lru_locks mdc
+	closes=$(calc_stats mdc.*.stats mds_close)
+	[ $closes -eq 1 ] || error "$closes CLOSE RPCs after lock cancel"
+
+	# open handle must not prevent unlink from other mount or this one
+	rm -f $DIR/$tdir/$tfile || error "unlink $tfile failed"
+	[ ! -e $DIR/$tdir/$tfile ] || error "$tfile still exists"
+
+	# no open lock is granted for a directory opened read-only without
+	# O_DIRECTORY, whose type is only known by the MDT
+	cancel_lru_locks mdc
+	echo 2 > /proc/sys/vm/drop_caches
+	$LCTL set_param -n mdc.*.stats=clear
+	$MULTIOP $DIR/$tdir oc || error "open $tdir failed"
+	closes=$(calc_stats mdc.*.stats mds_close)
+	[ $closes -eq 1 ] || error "$closes CLOSE RPCs for directory"
+}
+run_test 418 "read-only open handles are cached with ro_open_cache"
+
+test_419() {
+	local saved=$($LCTL get_param -n mdc.*.readdir_ra | head -n1)
+	local count=10000
+	local rpcs
+	local ra
+	local n
+
+	[ -n "$saved" ] || skip "no readdir_ra support"
+
+	test_mkdir -c1 -i0 $DIR/$tdir
+	createmany -m $DIR/$tdir/f- $count || error "create files failed"
+	stack_trap "$LCTL set_param -n mdc.*.readdir_ra=$saved" EXIT
+
+	# readahead window of 1 and several RPCs
+	for ra in 1 4; do
+		$LCTL set_param -n mdc.*.readdir_ra=$ra
+		cancel_lru_locks mdc
+		$LCTL set_param -n mdc.*.readdir_ra_stats=0
+		n=$(ls -f $DIR/$tdir | grep -c "^f-")
+		[ $n -eq $count ] ||
+			error "ls found $n entries, expected $count, ra $ra"
+		rpcs=$($LCTL get_param -n mdc.*.readdir_ra_stats |
+		       awk '/^rpcs:/ { sum += $2 } END { print sum + 0 }')
+		echo "readdir_ra=$ra: readahead RPCs: $rpcs"
+		[ $rpcs -gt 0 ] || error "no readdir readahead RPCs, ra $ra"
+	done
+
+	$LCTL set_param -n mdc.*.readdir_ra=0
+	cancel_lru_locks mdc
+	$LCTL set_param -n mdc.*.readdir_ra_stats=0
+	n=$(ls -f $DIR/$tdir | grep -c "^f-")
+	[ $n -eq $count ] || error "ls found $n entries, expected $count"
+	rpcs=$($LCTL get_param -n mdc.*.readdir_ra_stats |
+	       awk '/^rpcs:/ { sum += $2 } END { print sum + 0 }')
+	[ $rpcs -eq 0 ] || error "$rpcs readahead RPCs with readdir_ra=0"
+}
+run_test 419 "readdir readahead reads directory pages asynchronously"
+
+test_420() {
+	[ $OSTCOUNT -lt 2 ] && skip_env "needs >= 2 OSTs" && return
+	local saved=$($LCTL get_param -n llite.*.parallel_dio | head -n1)
+	local src=$TMP/$tfile.src
+	local sum
+	local p
+
+	stack_trap "rm -f $src; $LCTL set_param -n llite.*.parallel_dio=$saved" EXIT
+	dd if=/dev/urandom of=$src bs=1M count=16 ||
+		error "dd to $src failed"
+	sum=$(md5sum < $src)
+
+	test_mkdir $DIR/$tdir
+	for p in 0 1; do
+		$LCTL set_param -n llite.*.parallel_dio=$p
+		$LFS setstripe -c $OSTCOUNT -S 1M $DIR/$tdir/$tfile.$p ||
+			error "setstripe $DIR/$tdir/$tfile.$p failed"
+		dd if=$src of=$DIR/$tdir/$tfile.$p bs=8M oflag=direct ||
+			error "direct write with parallel_dio=$p failed"
+		cancel_lru_locks osc
+		[ "$(dd if=$DIR/$tdir/$tfile.$p bs=8M iflag=direct |
+		     md5sum)" == "$sum" ] ||
+			error "data mismatch with parallel_dio=$p"
+	done
+}
+run_test 420 "direct IO across stripes waits once per syscall"
+
+test_421() {
+	local src=$TMP/$tfile.src
+	local count
+	local bs
+
+	stack_trap "rm -f $src" EXIT
+	dd if=/dev/urandom of=$src bs=1M count=2 || error "dd to $src failed"
+
+	$LCTL set_param llite.*.stats=0
+	for bs in 512 1000 4096 65536; do
+		rm -f $DIR/$tfile
+		dd if=$src of=$DIR/$tfile bs=$bs skip=1 seek=1 oflag=direct ||
+			error "unaligned direct write bs=$bs failed"
+		dd if=$src bs=$bs skip=1 seek=1 of=$TMP/$tfile.ref 2>/dev/null
+		cancel_lru_locks osc
+		cmp $TMP/$tfile.ref $DIR/$tfile ||
+			error "data mismatch after direct write bs=$bs"
+		rm -f $TMP/$tfile.ref
+
+		[ "$(dd if=$DIR/$tfile bs=$bs skip=1 iflag=direct | md5sum)" == \
+		  "$(dd if=$src bs=$bs skip=1 | md5sum)" ] ||
+			error "data mismatch after direct read bs=$bs"
+	done
+	# dd buffers are page aligned, the file offsets above are not
+	count=$(calc_stats llite.*.stats dio_unaligned_bounce)
+	(( count > 0 )) || error "unaligned direct IO did not use bounce pages"
+
+	# file offset and buffer both 1000 bytes into the page: no bounce
+	rm -f $DIR/$tfile
+	$LCTL set_param llite.*.stats=0
+	$DIRECTIO rdwr $DIR/$tfile 0 4 4096 1000 ||
+		error "direct IO at matching unaligned offsets failed"
+	count=$(calc_stats llite.*.stats dio_unaligned_zero_copy)
+	(( count >= 2 )) ||
+		error "unaligned direct IO was not zero copy: $count"
+	count=$(calc_stats llite.*.stats dio_unaligned_bounce)
+	(( count == 0 )) || error "$count unaligned direct IO used bounce pages"
+
+	cancel_lru_locks osc
+	(( $(stat -c %s $DIR/$tfile) == 1000 + 4 * 4096 )) ||
+		error "bad size $(stat -c %s $DIR/$tfile)"
+	(( $(head -c 1000 $DIR/$tfile | tr -d '\000' | wc -c) == 0 )) ||
+		error "data before the direct write is not a hole"
+	(( $(tail -c +1001 $DIR/$tfile | tr -d '\272' | wc -c) == 0 )) ||
+		error "data mismatch after direct write at offset 1000"
+}
+run_test 421 "unaligned direct IO does not fail"
+
+test_422() {
+	local osc
+	local reclaims
+
+	$LFS setstripe -c 1 -i 0 $DIR/$tfile || error "setstripe failed"
+	osc=$(get_osc_import_name client ost1)
+	$LCTL set_param osc.$osc.lru_shrink_stats=clear
+
+	dd if=/dev/zero of=$DIR/$tfile bs=1M count=16 conv=fsync ||
+		error "dd to $DIR/$tfile failed"
+	cat $DIR/$tfile > /dev/null
+	# shrink all pages of this OSC from LRU
+	$LCTL set_param osc.$osc.osc_cached_mb=0
+
+	$LCTL get_param osc.$osc.lru_shrink_stats
+	reclaims=$($LCTL get_param -n osc.$osc.lru_shrink_stats |
+		   awk '/^[0-9]+:/ { sum += $6 } END { print sum + 0 }')
+	[ $reclaims -gt 0 ] || error "no LRU reclaim accounted"
+	[ $($LCTL get_param -n osc.$osc.lru_shrink_stats |
+	    awk '/^lru pages:/ { print $3 }') -eq 0 ] ||
+		error "LRU pages left after shrink"
+}
+run_test 422 "per-CPT client LRU lists shrink with latency stats"
+
+test_423() {
+	local hits
+
+	$LCTL get_param -n sptlrpc.msgbuf_pools > /dev/null 2>&1 ||
+		skip "no RPC message buffer pools"
+	$LCTL set_param sptlrpc.msgbuf_pools=clear
+
+	createmany -o $DIR/$tfile- 100 || error "createmany failed"
+	unlinkmany $DIR/$tfile- 100 || error "unlinkmany failed"
+
+	$LCTL get_param sptlrpc.msgbuf_pools
+	hits=$($LCTL get_param -n sptlrpc.msgbuf_pools |
+	       awk '/^[0-9]+ / { sum += $4 } END { print sum + 0 }')
+	[ $hits -gt 0 ] || error "no RPC buffer served from pools"
+}
+run_test 423 "RPC message buffers are recycled through per-CPU pools"
+
+test_424() {
+	local osc
+	local multi
+	local i
+
+	osc=$(get_osc_import_name client ost1)
+	$LCTL get_param -n osc.$osc.import | grep -q multiobj_brw ||
+		skip "OST does not support multi-object writes"
+
+	test_mkdir $DIR/$tdir
+	$LFS setstripe -c 1 -i 0 $DIR/$tdir || error "setstripe failed"
+	stack_trap "$LCTL set_param osc.$osc.max_objs_per_rpc=$($LCTL get_param \
+		-n osc.$osc.max_objs_per_rpc)" EXIT
+	$LCTL set_param osc.$osc.max_objs_per_rpc=16
+	$LCTL set_param osc.$osc.rpc_stats=clear
+
+	dd if=/dev/urandom of=$TMP/$tfile bs=4k count=1 ||
+		error "dd to $TMP/$tfile failed"
+	stack_trap "rm -f $TMP/$tfile" EXIT
+	for i in $(seq 64); do
+		cp $TMP/$tfile $DIR/$tdir/f$i || error "cp to f$i failed"
+	done
+	sync
+
+	$LCTL get_param osc.$osc.rpc_stats
+	multi=$($LCTL get_param -n osc.$osc.rpc_stats |
+		awk '/^objects per rpc/ { found = 1; next }
+		     found && /^[0-9]+:/ && $1 != "1:" { sum += $6 }
+		     END { print sum + 0 }')
+	[ $multi -gt 0 ] || error "no write RPC carried several objects"
+
+	cancel_lru_locks osc
+	for i in $(seq 64); do
+		cmp $TMP/$tfile $DIR/$tdir/f$i || error "f$i data mismatch"
+	done
+}
+run_test 424 "small writes to several objects share one BRW RPC"
+
+wbc_stat() {
+	$LCTL get_param -n llite.$FSNAME-*.wbc_stats |
+		awk -v name="$1:" '$1 == name { sum += $2 } END { print sum + 0 }'
+}
+
+test_425() {
+	local deferred
+	local old
+	local d
+
+	$LCTL get_param -n llite.*.wbc_max_pending > /dev/null 2>&1 ||
+		skip "no write-back cache of creates"
+
+	old=$($LCTL get_param -n llite.$FSNAME-*.wbc_max_pending | head -n 1)
+	stack_trap "$LCTL set_param llite.$FSNAME-*.wbc_max_pending=$old" EXIT
+	$LCTL set_param llite.$FSNAME-*.wbc_max_pending=1000
+
+	# the root of the cached tree itself is created on MDT
+	deferred=$(wbc_stat deferred)
+	mkdir $DIR/$tdir || error "mkdir $DIR/$tdir failed"
+	[ $(wbc_stat deferred) -eq $deferred ] ||
+		error "root of the cached tree not created on MDT"
+	mkdir $DIR/$tdir 2> /dev/null && error "second mkdir $tdir succeeded"
+	for d in 1 2 3 4; do
+		mkdir $DIR/$tdir/d$d || error "mkdir d$d failed"
+		createmany -m $DIR/$tdir/d$d/f 10 ||
+			error "createmany in d$d failed"
+	done
+	echo "write-back" > $DIR/$tdir/d2/data || error "write to data failed"
+	$LCTL get_param llite.$FSNAME-*.wbc_stats
+	[ $(wbc_stat deferred) -gt 0 ] || error "no create was cached"
+
+	unlinkmany $DIR/$tdir/d4/f 10 || error "unlinkmany in d4 failed"
+	rmdir $DIR/$tdir/d4 || error "rmdir d4 failed"
+	[ $(wbc_stat cancelled) -gt 0 ] || error "no cached create cancelled"
+
+	sync
+	$LCTL get_param llite.$FSNAME-*.wbc_stats
+	[ $(wbc_stat pending) -eq 0 ] || error "creates left after sync"
+	[ $(wbc_stat flushed) -gt 0 ] || error "no cached create flushed"
+	[ $(wbc_stat errors) -eq 0 ] || error "cached creates failed"
+
+	cancel_lru_locks mdc
+	cancel_lru_locks osc
+	for d in 1 2 3; do
+		[ $(ls $DIR/$tdir/d$d | wc -l) -ge 10 ] ||
+			error "entries of d$d missing on MDT"
+	done
+	[ -e $DIR/$tdir/d4 ] && error "cancelled d4 exists on MDT"
+	[ "$(cat $DIR/$tdir/d2/data)" == "write-back" ] ||
+		error "data mismatch"
+}
+run_test 425 "write-back cache of namespace operations"
+
+test_426() {
+	[ $(lustre_version_code ost1) -lt $(version_code 2.10.50) ] &&
+		skip "lustre < 2.10.53 does not support lockahead"
+	$LCTL get_param -n llite.*.lockahead_depth > /dev/null 2>&1 ||
+		skip "no automatic lockahead"
+
+	local cmd="O"
+	local requests
+	local i
+
+	$LFS setstripe -c 1 -i 0 $DIR/$tfile || error "setstripe failed"
+	cancel_lru_locks osc
+
+	# 4k blocks at a 16k stride, as one rank of a N-to-1 checkpoint
+	for i in $(seq 16); do
+		cmd+="w4096Z12288"
+	done
+	$MULTIOP $DIR/$tfile ${cmd}c || error "strided write failed"
+
+	$LCTL get_param llite.$FSNAME-*.lockahead_stats
+	requests=$($LCTL get_param -n llite.$FSNAME-*.lockahead_stats |
+		   awk '/^lockahead requests:/ { sum += $3 } END { print sum + 0 }')
+	[ $requests -gt 0 ] || error "no lock requested ahead of the writes"
+	[ $(stat -c %s $DIR/$tfile) -eq $((15 * 16384 + 4096)) ] ||
+		error "wrong file size"
+}
+run_test 426 "write locks are requested ahead of strided writes"
+
+lolnd_zero_copy() {
+	$LCTL get_param -n lolnd_stats |
+		awk '/^zero_copy_bytes:/ { print $2 }'
+}
+
+test_427() {
+	local before
+	local nid
+
+	[ -x "$LST" ] || skip_env "lst not found LST=$LST"
+	$LCTL get_param -n lolnd_stats > /dev/null 2>&1 ||
+		skip "no loopback LND statistics"
+
+	lsmod | grep -q lnet_selftest || stack_trap lst_cleanup EXIT
+	lst_setup || skip_env "cannot load lnet_selftest"
+	nid=$($LCTL list_nids | head -n 1)
+
+	before=$(lolnd_zero_copy)
+	export LST_SESSION=$$
+	$LST new_session --timeout 30 sanity_$testnum ||
+		error "lst new_session failed"
+	stack_trap "$LST end_session" EXIT
+	$LST add_group local $nid || error "lst add_group failed"
+	$LST add_batch b || error "lst add_batch failed"
+	# adding the test sends it with the destination NIDs as a bulk to
+	# this very node, both sides own their pages, which are swapped
+	$LST add_test --batch b --from local --to local brw write size=4k ||
+		error "lst add_test failed"
+	$LST run b || error "lst run failed"
+	sleep 2
+	$LST stop b || error "lst stop failed"
+
+	$LCTL get_param lolnd_stats
+	[ $(lolnd_zero_copy) -gt $before ] ||
+		error "loopback bulk was copied"
+}
+run_test 427 "loopback bulk between page owners swaps pages"
+
+# create $2 files with $1 processes in $DIR/$tdir, print files per second
+shared_dir_create_rate() {
+	local threads=$1
+	local nfiles=$2
+	local start
+	local i
+
+	rm -rf $DIR/$tdir
+	test_mkdir -i 0 -c 1 $DIR/$tdir
+	start=$(date +%s.%N)
+	for i in $(seq $threads); do
+		createmany -o $DIR/$tdir/f$i- $((nfiles / threads)) >/dev/null &
+	done
+	wait
+	bc <<< "$nfiles / ($(date +%s.%N) - $start)"
+	[ $(ls $DIR/$tdir | wc -l) -eq $nfiles ] ||
+		error "$(ls $DIR/$tdir | wc -l) of $nfiles files created"
+}
+
+test_428() {
+	local nfiles=100000
+	local threads=8
+	local serial
+	local parallel
+
+	[ "$SLOW" = "no" ] && nfiles=20000
+	[ $(facet_fstype $SINGLEMDS) == ldiskfs ] ||
+		skip "ldiskfs only test"
+
+	stack_trap "rm -rf $DIR/$tdir" EXIT
+	serial=$(shared_dir_create_rate 1 $nfiles) || error "create failed"
+	parallel=$(shared_dir_create_rate $threads $nfiles) ||
+		error "create failed"
+	echo "shared directory creates/s: 1 thread $serial," \
+	     "$threads threads $parallel"
+
+	# creates in one directory only contend on the leaf blocks they touch,
+	# so more threads must not make the directory slower
+	(( $(bc <<< "$parallel * 2 >= $serial") )) ||
+		error "$threads threads create at $parallel/s, 1 at $serial/s"
+}
+run_test 428 "parallel creates in a shared directory scale"
+
 prep_801() {
 	[[ $(lustre_version_code mds1) -lt $(version_code 2.9.55) ]] ||
 	[[ $(lustre_version_code ost1) -lt $(version_code 2.9.55) ]] &&
@@ -4483,6 +4483,74 @@ test_102() {
 }
 run_test 102 "Test open by handle of unlinked file"
 
+test_103() {
+	local param="ldlm.namespaces.filter-*.extent_contention"
+	local sized
+	local i
+
+	do_facet ost1 $LCTL get_param -n $param > /dev/null 2>&1 ||
+		skip "no extent lock contention history on OST"
+
+	$LFS setstripe -c 1 -i 0 $DIR1/$tfile || error "setstripe failed"
+
+	# interleaved 1MB blocks from both clients
+	for i in $(seq 0 15); do
+		dd if=/dev/zero of=$DIR1/$tfile bs=1M count=1 seek=$((2 * i)) \
+			conv=notrunc 2> /dev/null || error "dd on $DIR1 failed"
+		dd if=/dev/zero of=$DIR2/$tfile bs=1M count=1 \
+			seek=$((2 * i + 1)) conv=notrunc 2> /dev/null ||
+			error "dd on $DIR2 failed"
+	done
+
+	do_facet ost1 $LCTL get_param $param
+	sized=$(do_facet ost1 $LCTL get_param -n $param |
+		awk '/sized_grants:/ { sum += $2 } END { print sum + 0 }')
+	[ $sized -gt 0 ] || error "no lock sized from contention history"
+
+	cmp $DIR1/$tfile $DIR2/$tfile || error "file differs between mounts"
+	rm -f $DIR1/$tfile
+}
+run_test 103 "extent locks are sized to the access pattern under contention"
+
+wbc_stat() {
+	$LCTL get_param -n llite.$FSNAME-*.wbc_stats |
+		awk -v name="$1:" '$1 == name { sum += $2 } END { print sum + 0 }'
+}
+
+test_104() {
+	local old
+	local d
+
+	$LCTL get_param -n llite.*.wbc_max_pending > /dev/null 2>&1 ||
+		skip "no write-back cache of creates"
+
+	old=$($LCTL get_param -n llite.$FSNAME-*.wbc_max_pending | head -n 1)
+	stack_trap "$LCTL set_param llite.$FSNAME-*.wbc_max_pending=$old" EXIT
+	$LCTL set_param llite.$FSNAME-*.wbc_max_pending=1000
+
+	mkdir $DIR1/$tdir || error "mkdir $tdir failed"
+	for d in 1 2 3; do
+		mkdir $DIR1/$tdir/d$d || error "mkdir d$d failed"
+	done
+	touch $DIR1/$tdir/d1/$tfile || error "touch $tfile failed"
+	[ $(wbc_stat pending) -gt 0 ] || error "no create was cached"
+
+	# the lookup from the second mount conflicts with the lock on the
+	# root, the first one flushes its tree before it is granted
+	mkdir $DIR2/$tdir/d2 2> /dev/null && error "d2 created twice"
+	mkdir $DIR2/$tdir/d4 || error "mkdir d4 on $DIR2 failed"
+	[ -f $DIR2/$tdir/d1/$tfile ] || error "$tfile missing on $DIR2"
+
+	$LCTL get_param llite.$FSNAME-*.wbc_stats
+	[ $(wbc_stat pending) -eq 0 ] || error "creates left after conflict"
+	[ $(wbc_stat errors) -eq 0 ] || error "cached creates failed"
+	for d in 1 2 3 4; do
+		[ -d $DIR1/$tdir/d$d ] || error "d$d missing on $DIR1"
+	done
+	rm -rf $DIR1/$tdir
+}
+run_test 104 "cached creates are flushed before another client's access"
+
 log "cleanup: ======================================================"
 
 # kill and wait in each test only guarentee script finish, but command in script
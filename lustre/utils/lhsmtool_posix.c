@@ -83,6 +83,8 @@ struct options {
 	int			 o_copy_attrs;
 	int			 o_daemonize;
 	int			 o_dry_run;
+	int			 o_direct_io;
+	int			 o_copy_threads;
 	int			 o_abort_on_error;
 	int			 o_shadow_tree;
 	int			 o_verbose;
@@ -109,6 +111,7 @@ struct options opt = {
 	.o_copy_xattrs = 1,
 	.o_report_int = REPORT_INTERVAL_DEFAULT,
 	.o_chunk_size = ONE_MB,
+	.o_copy_threads = 1,
 };
 
 /* hsm_copytool_private will hold an open FD on the lustre mount point
@@ -196,9 +199,13 @@ static void usage(const char *name, int rc)
 	"   --dry-run                 Don't run, just show what would be done\n"
 	"   -c, --chunk-size <sz>     I/O size used during data copy\n"
 	"                             (unit can be used, default is MB)\n"
+	"   --direct-io               Use O_DIRECT on Lustre files with\n"
+	"                             parallel copy streams\n"
 	"   -f, --event-fifo <path>   Write events stream to fifo\n"
 	"   -p, --hsm-root <path>     Target HSM mount point\n"
 	"   -q, --quiet               Produce less verbose output\n"
+	"   -t, --threads <n>         Number of parallel copy streams per\n"
+	"                             file (default is 1)\n"
 	"   -u, --update-interval <s> Interval between progress reports sent\n"
 	"                             to Coordinator\n"
 	"   -v, --verbose             Produce more verbose output\n",
@@ -222,6 +229,8 @@ static int ct_parseopts(int argc, char * const *argv)
 	  .flag = &opt.o_daemonize },
 	{ .val = 'f',	.name = "event-fifo",	.has_arg = required_argument },
 	{ .val = 'f',	.name = "event_fifo",	.has_arg = required_argument },
+	{ .val = 1,	.name = "direct-io",	.has_arg = no_argument,
+	  .flag = &opt.o_direct_io },
 	{ .val = 1,	.name = "dry-run",	.has_arg = no_argument,
 	  .flag = &opt.o_dry_run },
 	{ .val = 'h',	.name = "help",		.has_arg = no_argument },
@@ -244,6 +253,7 @@ static int ct_parseopts(int argc, char * const *argv)
 	{ .val = 'p',	.name = "hsm_root",	.has_arg = required_argument },
 	{ .val = 'q',	.name = "quiet",	.has_arg = no_argument },
 	{ .val = 'r',	.name = "rebind",	.has_arg = no_argument },
+	{ .val = 't',	.name = "threads",	.has_arg = required_argument },
 	{ .val = 'u',	.name = "update-interval",
 						.has_arg = required_argument },
 	{ .val = 'u',	.name = "update_interval",
@@ -255,7 +265,7 @@ static int ct_parseopts(int argc, char * const *argv)
 	unsigned long long	 unit;
 
 	optind = 0;
-	while ((c = getopt_long(argc, argv, "A:b:c:f:hiMp:qru:v",
+	while ((c = getopt_long(argc, argv, "A:b:c:f:hiMp:qrt:u:v",
 				long_opts, NULL)) != -1) {
 		switch (c) {
 		case 'A': {
@@ -314,6 +324,15 @@ static int ct_parseopts(int argc, char * const *argv)
 		case 'r':
 			opt.o_action = CA_REBIND;
 			break;
+		case 't':
+			opt.o_copy_threads = atoi(optarg);
+			if (opt.o_copy_threads < 1) {
+				rc = -EINVAL;
+				CT_ERROR(rc, "bad value for -%c '%s'", c,
+					 optarg);
+				return rc;
+			}
+			break;
 		case 'u':
 			opt.o_report_int = atoi(optarg);
 			if (opt.o_report_int < 0) {
@@ -536,6 +555,433 @@ static int ct_restore_stripe(const char *src, const char *dst, int dst_fd,
 	return rc;
 }
 
+/*
+ * Parallel copy engine, used when more than one copy stream is requested.
+ *
+ * The extent to copy is split in as many contiguous regions as there are
+ * streams, aligned on the stripe size of the Lustre file, and each region
+ * is copied by its own thread. Holes of the source file are skipped
+ * (SEEK_DATA/SEEK_HOLE) when the destination has just been created or
+ * truncated. With --direct-io, the aligned I/Os on the Lustre side go
+ * through an O_DIRECT descriptor. The calling thread waits for the
+ * streams and reports their progress to the coordinator.
+ */
+struct ct_copy_job;
+
+struct ct_copy_stream {
+	struct ct_copy_job	*cs_job;
+	pthread_t		 cs_thread;
+	__u64			 cs_start;	/* region of the stream */
+	__u64			 cs_end;
+	__u64			 cs_done;	/* bytes done, holes included */
+	__u64			 cs_reported;	/* bytes reported to the CDT */
+	int			 cs_rc;
+};
+
+struct ct_copy_job {
+	const char		*cj_src;
+	const char		*cj_dst;
+	int			 cj_src_fd;
+	int			 cj_dst_fd;
+	int			 cj_src_dio_fd;	/* O_DIRECT fd or -1 */
+	int			 cj_dst_dio_fd;	/* O_DIRECT fd or -1 */
+	bool			 cj_sparse;	/* holes can be skipped */
+	size_t			 cj_align;	/* O_DIRECT alignment */
+	size_t			 cj_chunk;	/* I/O size */
+	unsigned long long	 cj_bandwidth;	/* per stream, in B/s */
+	pthread_mutex_t		 cj_lock;	/* protects the fields below
+						 * and cs_done */
+	pthread_cond_t		 cj_cond;
+	int			 cj_running;	/* streams not finished */
+	bool			 cj_stop;	/* abort the copy */
+};
+
+static inline __u64 ct_round_up(__u64 val, __u64 unit)
+{
+	return (val + unit - 1) / unit * unit;
+}
+
+/* Stripe size of a Lustre file, ONE_MB if it cannot be found */
+static __u64 ct_stripe_size(int fd)
+{
+	struct llapi_layout	*layout;
+	uint64_t		 size = 0;
+
+	layout = llapi_layout_get_by_fd(fd, 0);
+	if (layout == NULL)
+		return ONE_MB;
+
+	if (llapi_layout_stripe_size_get(layout, &size) < 0 ||
+	    size == 0 || size >= LLAPI_LAYOUT_INVALID)
+		size = ONE_MB;
+
+	llapi_layout_free(layout);
+
+	return size;
+}
+
+/* Open an O_DIRECT descriptor on the file opened as fd */
+static int ct_open_direct(int fd, int flags, const char *path)
+{
+	char	fd_path[PATH_MAX];
+	int	dio_fd;
+
+	snprintf(fd_path, sizeof(fd_path), "/proc/self/fd/%d", fd);
+	dio_fd = open(fd_path, flags | O_DIRECT);
+	if (dio_fd < 0)
+		CT_WARN("cannot open '%s' with O_DIRECT (%s), "
+			"using buffered I/O", path, strerror(errno));
+
+	return dio_fd;
+}
+
+/* Account bytes handled by a stream, returns -ECANCELED if the copy is
+ * aborted */
+static int ct_copy_stream_advance(struct ct_copy_stream *cs, __u64 bytes)
+{
+	struct ct_copy_job	*cj = cs->cs_job;
+	bool			 stop;
+
+	pthread_mutex_lock(&cj->cj_lock);
+	cs->cs_done += bytes;
+	stop = cj->cj_stop;
+	pthread_mutex_unlock(&cj->cj_lock);
+
+	return stop ? -ECANCELED : 0;
+}
+
+/* Sleep if needed to honor the bandwidth limit of a stream */
+static void ct_copy_stream_throttle(struct ct_copy_job *cj, double start,
+				    __u64 written)
+{
+	double		elapsed = ct_now() - start;
+	double		excess;
+	struct timespec	delay;
+
+	if (cj->cj_bandwidth == 0)
+		return;
+
+	excess = (double)written / cj->cj_bandwidth - elapsed;
+	if (excess <= 0)
+		return;
+
+	delay.tv_sec = excess;
+	delay.tv_nsec = (excess - delay.tv_sec) * NSEC_PER_SEC;
+	while (nanosleep(&delay, &delay) < 0 && errno == EINTR)
+		;
+}
+
+/* Copy the data extent [start, end) of a stream region */
+static int ct_copy_stream_extent(struct ct_copy_stream *cs, char *buf,
+				 __u64 start, __u64 end, double start_time,
+				 __u64 *written)
+{
+	struct ct_copy_job *cj = cs->cs_job;
+	int rc;
+
+	while (start < end) {
+		size_t	size = end - start > cj->cj_chunk ?
+			       cj->cj_chunk : end - start;
+		bool	aligned = start % cj->cj_align == 0 &&
+				  size % cj->cj_align == 0;
+		int	rfd = cj->cj_src_fd;
+		int	wfd = cj->cj_dst_fd;
+		ssize_t	rsize;
+		ssize_t	wsize;
+
+		if (aligned && cj->cj_src_dio_fd >= 0)
+			rfd = cj->cj_src_dio_fd;
+
+		rsize = pread(rfd, buf, size, start);
+		if (rsize < 0) {
+			rc = -errno;
+			CT_ERROR(rc, "cannot read from '%s'", cj->cj_src);
+			return rc;
+		}
+
+		if (rsize == 0)
+			/* EOF */
+			return ct_copy_stream_advance(cs, end - start);
+
+		/* a short read at EOF cannot be written with O_DIRECT */
+		if (aligned && rsize == size && cj->cj_dst_dio_fd >= 0)
+			wfd = cj->cj_dst_dio_fd;
+
+		wsize = pwrite(wfd, buf, rsize, start);
+		if (wsize < 0) {
+			rc = -errno;
+			CT_ERROR(rc, "cannot write to '%s'", cj->cj_dst);
+			return rc;
+		}
+
+		start += wsize;
+		*written += wsize;
+		rc = ct_copy_stream_advance(cs, wsize);
+		if (rc < 0)
+			return rc;
+
+		ct_copy_stream_throttle(cj, start_time, *written);
+	}
+
+	return 0;
+}
+
+static void *ct_copy_stream_thread(void *data)
+{
+	struct ct_copy_stream	*cs = data;
+	struct ct_copy_job	*cj = cs->cs_job;
+	double			 start_time = ct_now();
+	__u64			 written = 0;
+	__u64			 pos = cs->cs_start;
+	char			*buf = NULL;
+	int			 rc;
+
+	rc = -posix_memalign((void **)&buf, cj->cj_align, cj->cj_chunk);
+	if (rc < 0)
+		goto out;
+
+	while (pos < cs->cs_end) {
+		__u64	data_start = pos;
+		__u64	data_end = cs->cs_end;
+		off_t	off;
+
+		if (cj->cj_sparse) {
+			off = lseek(cj->cj_src_fd, pos, SEEK_DATA);
+			if (off < 0 && errno == ENXIO) {
+				/* only a hole up to the end of file */
+				data_start = cs->cs_end;
+			} else if (off >= 0) {
+				/* keep the O_DIRECT alignment */
+				data_start = off / cj->cj_align * cj->cj_align;
+				if (data_start < pos)
+					data_start = pos;
+				if (data_start > cs->cs_end)
+					data_start = cs->cs_end;
+
+				off = lseek(cj->cj_src_fd, off, SEEK_HOLE);
+				if (off >= 0 &&
+				    ct_round_up(off, cj->cj_align) < cs->cs_end)
+					data_end = ct_round_up(off,
+							       cj->cj_align);
+			}
+			/* on other errors, copy everything */
+		}
+
+		if (data_start > pos) {
+			rc = ct_copy_stream_advance(cs, data_start - pos);
+			if (rc < 0)
+				goto out;
+			pos = data_start;
+		}
+
+		if (pos < data_end) {
+			rc = ct_copy_stream_extent(cs, buf, pos, data_end,
+						   start_time, &written);
+			if (rc < 0)
+				goto out;
+			pos = data_end;
+		}
+	}
+
+out:
+	free(buf);
+
+	pthread_mutex_lock(&cj->cj_lock);
+	cs->cs_rc = rc;
+	/* stop the other streams on failure */
+	if (rc < 0)
+		cj->cj_stop = true;
+	cj->cj_running--;
+	pthread_cond_signal(&cj->cj_cond);
+	pthread_mutex_unlock(&cj->cj_lock);
+
+	return NULL;
+}
+
+/* Report the progress of each stream since the last report */
+static int ct_copy_report(struct hsm_copyaction_private *hcp,
+			  struct ct_copy_job *cj, struct ct_copy_stream *cs,
+			  int count, __u64 length)
+{
+	__u64	total = 0;
+	int	i;
+	int	rc;
+
+	for (i = 0; i < count; i++) {
+		struct hsm_extent	he;
+		__u64			done;
+
+		pthread_mutex_lock(&cj->cj_lock);
+		done = cs[i].cs_done;
+		pthread_mutex_unlock(&cj->cj_lock);
+
+		total += done;
+		if (done == cs[i].cs_reported)
+			continue;
+
+		/* only give the extent copied since the last report */
+		he.offset = cs[i].cs_start + cs[i].cs_reported;
+		he.length = done - cs[i].cs_reported;
+		rc = llapi_hsm_action_progress(hcp, &he, length, 0);
+		if (rc < 0)
+			return rc;
+
+		cs[i].cs_reported = done;
+	}
+
+	CT_TRACE("%%%ju ", (uintmax_t)(100 * total / length));
+
+	return 0;
+}
+
+static int ct_copy_data_parallel(struct hsm_copyaction_private *hcp,
+				 const char *src, const char *dst,
+				 int src_fd, int dst_fd,
+				 const struct hsm_action_item *hai,
+				 __u64 offset, __u64 length)
+{
+	struct ct_copy_job	 cj = {
+		.cj_src		= src,
+		.cj_dst		= dst,
+		.cj_src_fd	= src_fd,
+		.cj_dst_fd	= dst_fd,
+		.cj_src_dio_fd	= -1,
+		.cj_dst_dio_fd	= -1,
+		.cj_align	= sysconf(_SC_PAGESIZE),
+	};
+	bool			 restore = hai->hai_action == HSMA_RESTORE;
+	struct ct_copy_stream	*cs;
+	__u64			 region;
+	time_t			 last_report_time = time(NULL);
+	int			 count;
+	int			 started;
+	int			 rc = 0;
+	int			 i;
+
+	/* split the extent in stripe aligned regions, one per stream */
+	region = ct_round_up((length + opt.o_copy_threads - 1) /
+			     opt.o_copy_threads,
+			     ct_stripe_size(restore ? dst_fd : src_fd));
+	count = (length + region - 1) / region;
+	if (count == 0)
+		return 0;
+
+	cs = calloc(count, sizeof(*cs));
+	if (cs == NULL)
+		return -ENOMEM;
+
+	/* the destination is empty when the whole file is copied */
+	cj.cj_sparse = restore || hai->hai_extent.length == -1;
+	cj.cj_chunk = ct_round_up(opt.o_chunk_size, cj.cj_align);
+	if (opt.o_bandwidth != 0) {
+		cj.cj_bandwidth = opt.o_bandwidth / count;
+		if (cj.cj_bandwidth == 0)
+			cj.cj_bandwidth = 1;
+	}
+
+	if (opt.o_direct_io) {
+		if (restore)
+			cj.cj_dst_dio_fd = ct_open_direct(dst_fd, O_WRONLY,
+							  dst);
+		else
+			cj.cj_src_dio_fd = ct_open_direct(src_fd,
+						O_RDONLY | O_NOATIME, src);
+	}
+
+	pthread_mutex_init(&cj.cj_lock, NULL);
+	pthread_cond_init(&cj.cj_cond, NULL);
+
+	CT_TRACE("start copy of %ju bytes from '%s' to '%s' with %d streams",
+		 (uintmax_t)length, src, dst, count);
+
+	for (started = 0; started < count; started++) {
+		struct ct_copy_stream *stream = &cs[started];
+
+		stream->cs_job = &cj;
+		stream->cs_start = offset + started * region;
+		stream->cs_end = stream->cs_start + region;
+		if (stream->cs_end > offset + length)
+			stream->cs_end = offset + length;
+
+		pthread_mutex_lock(&cj.cj_lock);
+		cj.cj_running++;
+		pthread_mutex_unlock(&cj.cj_lock);
+
+		rc = pthread_create(&stream->cs_thread, NULL,
+				    ct_copy_stream_thread, stream);
+		if (rc != 0) {
+			rc = -rc;
+			CT_ERROR(rc, "cannot create copy stream for '%s'", src);
+			pthread_mutex_lock(&cj.cj_lock);
+			cj.cj_running--;
+			cj.cj_stop = true;
+			pthread_mutex_unlock(&cj.cj_lock);
+			break;
+		}
+	}
+
+	pthread_mutex_lock(&cj.cj_lock);
+	while (cj.cj_running > 0) {
+		struct timespec	deadline;
+		time_t		now;
+
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		deadline.tv_sec += opt.o_report_int > 0 ? opt.o_report_int : 1;
+		pthread_cond_timedwait(&cj.cj_cond, &cj.cj_lock, &deadline);
+		if (cj.cj_running == 0 || cj.cj_stop || rc < 0)
+			continue;
+
+		now = time(NULL);
+		if (now < last_report_time + opt.o_report_int)
+			continue;
+		last_report_time = now;
+
+		pthread_mutex_unlock(&cj.cj_lock);
+		rc = ct_copy_report(hcp, &cj, cs, started, length);
+		pthread_mutex_lock(&cj.cj_lock);
+		if (rc < 0) {
+			/* Action has been canceled or something wrong
+			 * is happening. Stop copying data. */
+			CT_ERROR(rc, "progress ioctl for copy '%s'->'%s' "
+				 "failed", src, dst);
+			cj.cj_stop = true;
+		}
+	}
+	pthread_mutex_unlock(&cj.cj_lock);
+
+	for (i = 0; i < started; i++) {
+		pthread_join(cs[i].cs_thread, NULL);
+		/* report the error which stopped the other streams */
+		if (cs[i].cs_rc < 0 && (rc == 0 || rc == -ECANCELED))
+			rc = cs[i].cs_rc;
+	}
+
+	/* the file may end with a hole which was not written */
+	if (rc == 0 && cj.cj_sparse) {
+		struct stat st;
+
+		if (fstat(dst_fd, &st) < 0) {
+			rc = -errno;
+			CT_ERROR(rc, "cannot stat '%s'", dst);
+		} else if (st.st_size < offset + length &&
+			   ftruncate(dst_fd, offset + length) < 0) {
+			rc = -errno;
+			CT_ERROR(rc, "cannot truncate '%s' to size %ju",
+				 dst, (uintmax_t)(offset + length));
+		}
+	}
+
+	if (cj.cj_src_dio_fd >= 0)
+		close(cj.cj_src_dio_fd);
+	if (cj.cj_dst_dio_fd >= 0)
+		close(cj.cj_dst_dio_fd);
+	pthread_cond_destroy(&cj.cj_cond);
+	pthread_mutex_destroy(&cj.cj_lock);
+	free(cs);
+
+	return rc;
+}
+
 static int ct_copy_data(struct hsm_copyaction_private *hcp, const char *src,
 			const char *dst, int src_fd, int dst_fd,
 			const struct hsm_action_item *hai, long hal_flags)
@@ -605,6 +1051,12 @@ static int ct_copy_data(struct hsm_copyaction_private *hcp, const char *src,
 		goto out;
 	}
 
+	if (opt.o_copy_threads > 1) {
+		rc = ct_copy_data_parallel(hcp, src, dst, src_fd, dst_fd, hai,
+					   offset, length);
+		goto out;
+	}
+
 	errno = 0;
 
 	buf = malloc(opt.o_chunk_size);
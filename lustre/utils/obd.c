@@ -2056,9 +2056,14 @@ int jt_obd_test_brw(int argc, char **argv)
                                 data.ioc_plen1 = strtoull(argv[6] + 1, &end,
                                                           0);
                                 break;
+			case 'c': /* client page setup only, no transfer */
+				data.ioc_pbuf1 = (void *)4;
+				data.ioc_plen1 = strtoull(argv[6] + 1, &end,
+							  0);
+				break;
                         default:
                                 fprintf(stderr, "error: %s: batching '%s' "
-                                        "needs to specify 'p' or 'g'\n",
+                                        "needs to specify 'p', 'g' or 'c'\n",
                                         jt_cmdname(argv[0]), argv[6]);
                                 return CMD_HELP;
                 }